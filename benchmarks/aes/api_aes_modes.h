@@ -0,0 +1,261 @@
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "riscvcrypto/aes/api_aes.h"
+
+/*!
+@defgroup crypto_block_aes_modes Crypto Block AES Modes
+@{
+
+Authentication modes built on the single-block AES 128 API.
+
+- CMAC (NIST SP 800-38B / RFC 4493) is a single serial CBC chain.
+- CCM (NIST SP 800-38C) runs a serial CBC-MAC chain and a parallel CTR
+  keystream over the same payload. Each step encrypts one block of each
+  stream with aes_128_ecb_encrypt_x2, so an implementation of that function
+  can interleave the two independent block encryptions.
+- CTR (NIST SP 800-38A) and GCM (NIST SP 800-38D) encrypt two counter
+  blocks at a time with aes_128_ecb_encrypt_x2. GCM is also offered as an
+  init / update / final stream, for data which arrives (or is mapped) a
+  piece at a time. Its GHASH is portable C without table lookups, so runs
+  in constant time but far slower than a carry-less multiply would.
+
+*/
+
+#ifndef __API_AES_MODES_H__
+#define __API_AES_MODES_H__
+
+//! Minimum / maximum CCM nonce length in bytes.
+#define AES_CCM_NONCE_MIN_BYTES  7
+#define AES_CCM_NONCE_MAX_BYTES 13
+
+//! Minimum / maximum CCM tag length in bytes. Must be even.
+#define AES_CCM_TAG_MIN_BYTES    4
+#define AES_CCM_TAG_MAX_BYTES   16
+
+/*!
+@brief Encrypt two independent blocks under the same AES 128 key schedule.
+@details Provided by aes/zscrypto_rv64 with the rounds of both blocks
+    interleaved, and by the aes_x2_generic library as two calls to
+    aes_128_ecb_encrypt for every other implementation.
+@param [out] ct0 - Output cipher text of the first block
+@param [in]  pt0 - Input plaintext of the first block
+@param [out] ct1 - Output cipher text of the second block
+@param [in]  pt1 - Input plaintext of the second block
+@param [in]  rk  - The expanded key schedule
+*/
+void    aes_128_ecb_encrypt_x2 (
+    uint8_t     ct0 [AES_BLOCK_BYTES],
+    uint8_t     pt0 [AES_BLOCK_BYTES],
+    uint8_t     ct1 [AES_BLOCK_BYTES],
+    uint8_t     pt1 [AES_BLOCK_BYTES],
+    uint32_t  * rk
+);
+
+/*!
+@brief AES 128 CMAC of an arbitrary length message.
+@param [out] mac - Output 16 byte message authentication code
+@param [in]  msg - Input message
+@param [in]  len - Length of the message in bytes
+@param [in]  rk  - The expanded encrypt key schedule
+*/
+void    aes_128_cmac (
+    uint8_t     mac [AES_BLOCK_BYTES],
+    uint8_t   * msg,
+    size_t      len,
+    uint32_t  * rk
+);
+
+/*!
+@brief AES 128 CCM authenticated encryption.
+@param [out] ct       - Output cipher text, len bytes. May equal pt.
+@param [out] tag      - Output tag, taglen bytes
+@param [in]  pt       - Input plaintext
+@param [in]  len      - Length of the plaintext in bytes
+@param [in]  aad      - Input additional authenticated data
+@param [in]  aadlen   - Length of the additional data in bytes
+@param [in]  nonce    - Input nonce
+@param [in]  noncelen - Nonce length in bytes, 7..13
+@param [in]  taglen   - Tag length in bytes, even and 4..16
+@param [in]  rk       - The expanded encrypt key schedule
+@returns 0 on success, non-zero if noncelen or taglen are invalid.
+*/
+int     aes_128_ccm_encrypt (
+    uint8_t   * ct,
+    uint8_t   * tag,
+    uint8_t   * pt,
+    size_t      len,
+    uint8_t   * aad,
+    size_t      aadlen,
+    uint8_t   * nonce,
+    size_t      noncelen,
+    size_t      taglen,
+    uint32_t  * rk
+);
+
+/*!
+@brief AES 128 CCM authenticated decryption.
+@details The plaintext is written to pt even when the tag does not match.
+    Callers must discard it if a non-zero value is returned.
+@param [out] pt       - Output plaintext, len bytes. May equal ct.
+@param [in]  ct       - Input cipher text
+@param [in]  len      - Length of the cipher text in bytes
+@param [in]  aad      - Input additional authenticated data
+@param [in]  aadlen   - Length of the additional data in bytes
+@param [in]  nonce    - Input nonce
+@param [in]  noncelen - Nonce length in bytes, 7..13
+@param [in]  tag      - Input tag to check, taglen bytes
+@param [in]  taglen   - Tag length in bytes, even and 4..16
+@param [in]  rk       - The expanded encrypt key schedule
+@returns 0 if the tag matches, non-zero otherwise.
+*/
+int     aes_128_ccm_decrypt (
+    uint8_t   * pt,
+    uint8_t   * ct,
+    size_t      len,
+    uint8_t   * aad,
+    size_t      aadlen,
+    uint8_t   * nonce,
+    size_t      noncelen,
+    uint8_t   * tag,
+    size_t      taglen,
+    uint32_t  * rk
+);
+
+/*!
+@brief AES 128 CTR mode, with a 128-bit big endian counter.
+@details May be called repeatedly on consecutive pieces of a stream, as
+    long as every piece but the last is a multiple of 16 bytes long.
+@param [out]    out - Output text, len bytes. May equal in.
+@param [in]     in  - Input text
+@param [in]     len - Length of the text in bytes
+@param [in,out] ctr - The first counter block. Advanced by the number of
+    blocks used, rounding up.
+@param [in]     rk  - The expanded encrypt key schedule
+*/
+void    aes_128_ctr (
+    uint8_t   * out,
+    uint8_t   * in,
+    size_t      len,
+    uint8_t     ctr [AES_BLOCK_BYTES],
+    uint32_t  * rk
+);
+
+//! GCM tag length in bytes. Shorter tags are truncations of it.
+#define AES_GCM_TAG_BYTES       16
+
+//! State of an AES 128 GCM stream. Its fields are private.
+typedef struct {
+    uint32_t  * rk;
+    uint64_t    h   [2];                // Hash subkey H, high word first
+    uint64_t    x   [2];                // GHASH accumulator
+    uint8_t     j0  [AES_BLOCK_BYTES];  // Pre-counter block
+    uint8_t     ctr [AES_BLOCK_BYTES];  // Last counter block used
+    uint8_t     ks  [AES_BLOCK_BYTES];  // Keystream of a partial block
+    uint8_t     blk [AES_BLOCK_BYTES];  // Cipher text of a partial block
+    size_t      used;                   // Bytes of the partial block
+    uint64_t    aadlen;
+    uint64_t    len;
+} aes_128_gcm_ctx;
+
+/*!
+@brief Starts an AES 128 GCM stream, and authenticates the additional data.
+@param [out] ctx    - Stream state
+@param [in]  iv     - Input initialisation vector
+@param [in]  ivlen  - IV length in bytes, ideally 12
+@param [in]  aad    - Input additional authenticated data
+@param [in]  aadlen - Length of the additional data in bytes
+@param [in]  rk     - The expanded encrypt key schedule. Must outlive ctx.
+@returns 0 on success, non-zero if ivlen is zero.
+*/
+int     aes_128_gcm_init (
+    aes_128_gcm_ctx * ctx,
+    uint8_t   * iv,
+    size_t      ivlen,
+    uint8_t   * aad,
+    size_t      aadlen,
+    uint32_t  * rk
+);
+
+/*!
+@brief Encrypts the next len bytes of a GCM stream. Pieces may have any
+    length.
+@param [out] ct - Output cipher text, len bytes. May equal pt.
+*/
+void    aes_128_gcm_encrypt_update (
+    aes_128_gcm_ctx * ctx,
+    uint8_t   * ct,
+    uint8_t   * pt,
+    size_t      len
+);
+
+/*!
+@brief Decrypts the next len bytes of a GCM stream. Pieces may have any
+    length.
+@details The plaintext is not authentic until aes_128_gcm_final's tag
+    has been checked.
+@param [out] pt - Output plaintext, len bytes. May equal ct.
+*/
+void    aes_128_gcm_decrypt_update (
+    aes_128_gcm_ctx * ctx,
+    uint8_t   * pt,
+    uint8_t   * ct,
+    size_t      len
+);
+
+//! Ends a GCM stream, giving its AES_GCM_TAG_BYTES long tag.
+void    aes_128_gcm_final (
+    aes_128_gcm_ctx * ctx,
+    uint8_t     tag [AES_GCM_TAG_BYTES]
+);
+
+/*!
+@brief AES 128 GCM authenticated encryption.
+@param [out] ct     - Output cipher text, len bytes. May equal pt.
+@param [out] tag    - Output tag, taglen bytes
+@param [in]  pt     - Input plaintext
+@param [in]  len    - Length of the plaintext in bytes
+@param [in]  aad    - Input additional authenticated data
+@param [in]  aadlen - Length of the additional data in bytes
+@param [in]  iv     - Input initialisation vector
+@param [in]  ivlen  - IV length in bytes, ideally 12
+@param [in]  taglen - Tag length in bytes, 1..16
+@param [in]  rk     - The expanded encrypt key schedule
+@returns 0 on success, non-zero if ivlen or taglen are invalid.
+*/
+int     aes_128_gcm_encrypt (
+    uint8_t   * ct,
+    uint8_t   * tag,
+    uint8_t   * pt,
+    size_t      len,
+    uint8_t   * aad,
+    size_t      aadlen,
+    uint8_t   * iv,
+    size_t      ivlen,
+    size_t      taglen,
+    uint32_t  * rk
+);
+
+/*!
+@brief AES 128 GCM authenticated decryption.
+@details The plaintext is written to pt even when the tag does not match.
+    Callers must discard it if a non-zero value is returned.
+@returns 0 if the tag matches, non-zero otherwise.
+*/
+int     aes_128_gcm_decrypt (
+    uint8_t   * pt,
+    uint8_t   * ct,
+    size_t      len,
+    uint8_t   * aad,
+    size_t      aadlen,
+    uint8_t   * iv,
+    size_t      ivlen,
+    uint8_t   * tag,
+    size_t      taglen,
+    uint32_t  * rk
+);
+
+#endif
+
+//! @}
@@ -0,0 +1,208 @@
+
+#include <string.h>
+
+#include "riscvcrypto/aes/api_aes_modes.h"
+
+/*!
+@addtogroup crypto_block_aes_modes
+@{
+*/
+
+//! Write the low len bytes of val big-endian into out.
+static void aes_ccm_store_be (
+    uint8_t   * out,
+    size_t      len,
+    uint64_t    val
+){
+    for(size_t i = len; i > 0; i --) {
+        out[i-1] = (uint8_t)val;
+        val    >>= 8;
+    }
+}
+
+//! Increment the big-endian counter held in the last q bytes of ctr.
+static void aes_ccm_ctr_inc (
+    uint8_t     ctr [AES_BLOCK_BYTES],
+    size_t      q
+){
+    for(size_t i = AES_BLOCK_BYTES - 1; i >= AES_BLOCK_BYTES - q; i --) {
+        if(++ctr[i] != 0) {
+            break;
+        }
+    }
+}
+
+/*!
+@brief Run CCM over a payload.
+@details The CBC-MAC input for payload block i is only known once block i
+    has been en/decrypted, so the MAC chain lags the keystream by one
+    block. Each step encrypts the pending MAC block together with the next
+    counter block. The last step pairs the final MAC block with Ctr_0,
+    yielding the tag mask S_0.
+*/
+static int aes_ccm_transform (
+    uint8_t   * dst,
+    uint8_t   * src,
+    size_t      len,
+    uint8_t   * aad,
+    size_t      aadlen,
+    uint8_t   * nonce,
+    size_t      noncelen,
+    uint8_t     tag [AES_BLOCK_BYTES],
+    size_t      taglen,
+    uint32_t  * rk,
+    int         decrypt
+){
+    uint8_t x   [AES_BLOCK_BYTES];       // MAC chain / pending MAC input
+    uint8_t ctr [AES_BLOCK_BYTES];       // Counter block
+    uint8_t ks  [AES_BLOCK_BYTES];       // Keystream block
+    uint8_t p   [AES_BLOCK_BYTES];       // Current plaintext block
+
+    if(noncelen < AES_CCM_NONCE_MIN_BYTES ||
+       noncelen > AES_CCM_NONCE_MAX_BYTES ||
+       taglen   < AES_CCM_TAG_MIN_BYTES   ||
+       taglen   > AES_CCM_TAG_MAX_BYTES   || (taglen & 1)) {
+        return 1;
+    }
+
+    size_t q = AES_BLOCK_BYTES - 1 - noncelen;
+
+    if((q < 8 && (uint64_t)len >> (8 * q)) || (uint64_t)aadlen >> 32) {
+        return 1;
+    }
+
+    // B_0 = flags || N || Q
+    x[0] = (aadlen ? 0x40 : 0) | (((taglen - 2) / 2) << 3) | (q - 1);
+    memcpy(x + 1, nonce, noncelen);
+    aes_ccm_store_be(x + 1 + noncelen, q, len);
+
+    // Ctr_0 = flags || N || 0. Payload counters start at 1.
+    ctr[0] = q - 1;
+    memcpy(ctr + 1, nonce, noncelen);
+    memset(ctr + 1 + noncelen, 0, q);
+
+    // Associated data, prefixed by its encoded length and zero padded.
+    // The block which completes the associated data is left pending.
+    if(aadlen) {
+        uint8_t blk[AES_BLOCK_BYTES];
+        size_t  fill;
+        size_t  used = 0;
+        if(aadlen < 0xFF00) {
+            aes_ccm_store_be(blk, 2, aadlen);
+            fill = 2;
+        } else {
+            blk[0] = 0xFF; blk[1] = 0xFE;
+            aes_ccm_store_be(blk + 2, 4, aadlen);
+            fill = 6;
+        }
+        while(used < aadlen) {
+            size_t take = AES_BLOCK_BYTES - fill;
+            if(take > aadlen - used) {
+                take = aadlen - used;
+            }
+            memcpy(blk + fill, aad + used, take);
+            memset(blk + fill + take, 0, AES_BLOCK_BYTES - fill - take);
+            used += take;
+            fill  = 0;
+            aes_128_ecb_encrypt(x, x, rk);
+            for(int i = 0; i < AES_BLOCK_BYTES; i ++) {
+                x[i] ^= blk[i];
+            }
+        }
+    }
+
+    // Payload. x always holds the next, not yet encrypted, MAC input.
+    size_t blocks = (len + AES_BLOCK_BYTES - 1) / AES_BLOCK_BYTES;
+
+    for(size_t b = 0; b <= blocks; b ++) {
+
+        if(b == blocks) {
+            // Final MAC block alongside Ctr_0, giving the tag mask S_0.
+            memset(ctr + 1 + noncelen, 0, q);
+        } else {
+            aes_ccm_ctr_inc(ctr, q);
+        }
+
+        aes_128_ecb_encrypt_x2(x, x, ks, ctr, rk);
+
+        if(b == blocks) {
+            break;
+        }
+
+        size_t off = AES_BLOCK_BYTES * b;
+        size_t n   = len - off < AES_BLOCK_BYTES ? len - off : AES_BLOCK_BYTES;
+
+        memset(p, 0, AES_BLOCK_BYTES);
+        if(decrypt) {
+            for(size_t i = 0; i < n; i ++) {
+                p[i] = src[off + i] ^ ks[i];
+            }
+            memcpy(dst + off, p, n);
+        } else {
+            memcpy(p, src + off, n);
+            for(size_t i = 0; i < n; i ++) {
+                dst[off + i] = p[i] ^ ks[i];
+            }
+        }
+
+        for(int i = 0; i < AES_BLOCK_BYTES; i ++) {
+            x[i] ^= p[i];
+        }
+    }
+
+    for(int i = 0; i < AES_BLOCK_BYTES; i ++) {
+        tag[i] = x[i] ^ ks[i];
+    }
+
+    return 0;
+}
+
+int     aes_128_ccm_encrypt (
+    uint8_t   * ct,
+    uint8_t   * tag,
+    uint8_t   * pt,
+    size_t      len,
+    uint8_t   * aad,
+    size_t      aadlen,
+    uint8_t   * nonce,
+    size_t      noncelen,
+    size_t      taglen,
+    uint32_t  * rk
+){
+    uint8_t t[AES_BLOCK_BYTES];
+    int     rc = aes_ccm_transform(
+        ct, pt, len, aad, aadlen, nonce, noncelen, t, taglen, rk, 0
+    );
+    if(rc == 0) {
+        memcpy(tag, t, taglen);
+    }
+    return rc;
+}
+
+int     aes_128_ccm_decrypt (
+    uint8_t   * pt,
+    uint8_t   * ct,
+    size_t      len,
+    uint8_t   * aad,
+    size_t      aadlen,
+    uint8_t   * nonce,
+    size_t      noncelen,
+    uint8_t   * tag,
+    size_t      taglen,
+    uint32_t  * rk
+){
+    uint8_t t[AES_BLOCK_BYTES];
+    uint8_t diff = 0;
+    int     rc = aes_ccm_transform(
+        pt, ct, len, aad, aadlen, nonce, noncelen, t, taglen, rk, 1
+    );
+    if(rc != 0) {
+        return rc;
+    }
+    for(size_t i = 0; i < taglen; i ++) {
+        diff |= t[i] ^ tag[i];
+    }
+    return diff != 0;
+}
+
+//! @}
@@ -0,0 +1,63 @@
+
+#include <string.h>
+
+#include "riscvcrypto/aes/api_aes_modes.h"
+
+/*!
+@addtogroup crypto_block_aes_modes
+@{
+*/
+
+//! Multiply a block by x in GF(2^128), big-endian bit order (SP 800-38B).
+static void aes_cmac_dbl (
+    uint8_t     out [AES_BLOCK_BYTES],
+    uint8_t     in  [AES_BLOCK_BYTES]
+){
+    uint8_t msb = in[0] >> 7;
+    for(int i = 0; i < AES_BLOCK_BYTES - 1; i ++) {
+        out[i] = (in[i] << 1) | (in[i+1] >> 7);
+    }
+    out[AES_BLOCK_BYTES-1] = (in[AES_BLOCK_BYTES-1] << 1) ^ (msb ? 0x87 : 0);
+}
+
+void    aes_128_cmac (
+    uint8_t     mac [AES_BLOCK_BYTES],
+    uint8_t   * msg,
+    size_t      len,
+    uint32_t  * rk
+){
+    uint8_t k  [AES_BLOCK_BYTES] = {0};
+    uint8_t x  [AES_BLOCK_BYTES] = {0};
+    uint8_t last[AES_BLOCK_BYTES];
+
+    // Subkeys: L = E(0), K1 = 2L, K2 = 4L.
+    aes_128_ecb_encrypt(k, k, rk);
+    aes_cmac_dbl(k, k);
+
+    // The final block is always held back, so an exact multiple of the
+    // block size (including the empty message) is handled below.
+    size_t  full = len == 0 ? 0 : (len - 1) / AES_BLOCK_BYTES;
+    size_t  rem  = len - full * AES_BLOCK_BYTES;
+
+    for(size_t b = 0; b < full; b ++) {
+        for(int i = 0; i < AES_BLOCK_BYTES; i ++) {
+            x[i] ^= msg[AES_BLOCK_BYTES * b + i];
+        }
+        aes_128_ecb_encrypt(x, x, rk);
+    }
+
+    memset(last, 0, AES_BLOCK_BYTES);
+    memcpy(last, msg + full * AES_BLOCK_BYTES, rem);
+
+    if(rem != AES_BLOCK_BYTES) {
+        last[rem] = 0x80;                // Pad and use K2.
+        aes_cmac_dbl(k, k);
+    }
+
+    for(int i = 0; i < AES_BLOCK_BYTES; i ++) {
+        x[i] ^= last[i] ^ k[i];
+    }
+    aes_128_ecb_encrypt(mac, x, rk);
+}
+
+//! @}
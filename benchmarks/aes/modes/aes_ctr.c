@@ -0,0 +1,63 @@
+
+#include <string.h>
+
+#include "riscvcrypto/aes/api_aes_modes.h"
+
+/*!
+@addtogroup crypto_block_aes_modes
+@{
+*/
+
+//! Increment a 128-bit big-endian counter block.
+static void aes_ctr_inc (
+    uint8_t     ctr [AES_BLOCK_BYTES]
+){
+    for(int i = AES_BLOCK_BYTES - 1; i >= 0; i --) {
+        if(++ctr[i] != 0) {
+            break;
+        }
+    }
+}
+
+void    aes_128_ctr (
+    uint8_t   * out,
+    uint8_t   * in,
+    size_t      len,
+    uint8_t     ctr [AES_BLOCK_BYTES],
+    uint32_t  * rk
+){
+    uint8_t c1  [AES_BLOCK_BYTES];
+    uint8_t ks0 [AES_BLOCK_BYTES];
+    uint8_t ks1 [AES_BLOCK_BYTES];
+
+    // Two blocks per step, so that aes_128_ecb_encrypt_x2 can interleave.
+    while(len >= 2 * AES_BLOCK_BYTES) {
+        memcpy(c1, ctr, AES_BLOCK_BYTES);
+        aes_ctr_inc(c1);
+        aes_128_ecb_encrypt_x2(ks0, ctr, ks1, c1, rk);
+        memcpy(ctr, c1, AES_BLOCK_BYTES);
+        aes_ctr_inc(ctr);
+
+        for(int i = 0; i < AES_BLOCK_BYTES; i ++) {
+            out[i                  ] = in[i                  ] ^ ks0[i];
+            out[i + AES_BLOCK_BYTES] = in[i + AES_BLOCK_BYTES] ^ ks1[i];
+        }
+        out += 2 * AES_BLOCK_BYTES;
+        in  += 2 * AES_BLOCK_BYTES;
+        len -= 2 * AES_BLOCK_BYTES;
+    }
+
+    while(len > 0) {
+        size_t n = len < AES_BLOCK_BYTES ? len : AES_BLOCK_BYTES;
+        aes_128_ecb_encrypt(ks0, ctr, rk);
+        aes_ctr_inc(ctr);
+        for(size_t i = 0; i < n; i ++) {
+            out[i] = in[i] ^ ks0[i];
+        }
+        out += n;
+        in  += n;
+        len -= n;
+    }
+}
+
+//! @}
@@ -0,0 +1,24 @@
+
+#include "riscvcrypto/aes/api_aes_modes.h"
+
+/*!
+@addtogroup crypto_block_aes_modes
+@{
+*/
+
+/*!
+@details Generic fallback for implementations without an interleaved
+    two-block routine.
+*/
+void    aes_128_ecb_encrypt_x2 (
+    uint8_t     ct0 [AES_BLOCK_BYTES],
+    uint8_t     pt0 [AES_BLOCK_BYTES],
+    uint8_t     ct1 [AES_BLOCK_BYTES],
+    uint8_t     pt1 [AES_BLOCK_BYTES],
+    uint32_t  * rk
+){
+    aes_128_ecb_encrypt(ct0, pt0, rk);
+    aes_128_ecb_encrypt(ct1, pt1, rk);
+}
+
+//! @}
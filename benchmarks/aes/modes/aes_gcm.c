@@ -0,0 +1,388 @@
+
+#include <string.h>
+
+#include "riscvcrypto/aes/api_aes_modes.h"
+
+/*!
+@addtogroup crypto_block_aes_modes
+@{
+*/
+
+static uint64_t aes_gcm_load_be64 (
+    const uint8_t * in
+){
+    uint64_t r = 0;
+    for(int i = 0; i < 8; i ++) {
+        r = (r << 8) | in[i];
+    }
+    return r;
+}
+
+static void aes_gcm_store_be64 (
+    uint8_t   * out,
+    uint64_t    val
+){
+    for(int i = 7; i >= 0; i --) {
+        out[i] = (uint8_t)val;
+        val  >>= 8;
+    }
+}
+
+//! Increment the low 32 bits of a counter block, modulo 2^32 (inc_32).
+static void aes_gcm_inc32 (
+    uint8_t     ctr [AES_BLOCK_BYTES]
+){
+    for(int i = AES_BLOCK_BYTES - 1; i >= AES_BLOCK_BYTES - 4; i --) {
+        if(++ctr[i] != 0) {
+            break;
+        }
+    }
+}
+
+/*!
+@brief Low 64 bits of the carry-less product of x and y.
+@details Integer multiplies of operands with only every fourth bit set,
+    so that carries fall into the holes and are masked off.
+*/
+static uint64_t aes_gcm_bmul64 (
+    uint64_t    x,
+    uint64_t    y
+){
+    uint64_t x0 = x & 0x1111111111111111ULL;
+    uint64_t x1 = x & 0x2222222222222222ULL;
+    uint64_t x2 = x & 0x4444444444444444ULL;
+    uint64_t x3 = x & 0x8888888888888888ULL;
+    uint64_t y0 = y & 0x1111111111111111ULL;
+    uint64_t y1 = y & 0x2222222222222222ULL;
+    uint64_t y2 = y & 0x4444444444444444ULL;
+    uint64_t y3 = y & 0x8888888888888888ULL;
+    uint64_t z0 = (x0 * y0) ^ (x1 * y3) ^ (x2 * y2) ^ (x3 * y1);
+    uint64_t z1 = (x0 * y1) ^ (x1 * y0) ^ (x2 * y3) ^ (x3 * y2);
+    uint64_t z2 = (x0 * y2) ^ (x1 * y1) ^ (x2 * y0) ^ (x3 * y3);
+    uint64_t z3 = (x0 * y3) ^ (x1 * y2) ^ (x2 * y1) ^ (x3 * y0);
+    return (z0 & 0x1111111111111111ULL) | (z1 & 0x2222222222222222ULL) |
+           (z2 & 0x4444444444444444ULL) | (z3 & 0x8888888888888888ULL);
+}
+
+//! Bit reversal of a 64-bit word.
+static uint64_t aes_gcm_rev64 (
+    uint64_t    x
+){
+    x = ((x & 0x5555555555555555ULL) <<  1) | ((x >>  1) & 0x5555555555555555ULL);
+    x = ((x & 0x3333333333333333ULL) <<  2) | ((x >>  2) & 0x3333333333333333ULL);
+    x = ((x & 0x0F0F0F0F0F0F0F0FULL) <<  4) | ((x >>  4) & 0x0F0F0F0F0F0F0F0FULL);
+    x = ((x & 0x00FF00FF00FF00FFULL) <<  8) | ((x >>  8) & 0x00FF00FF00FF00FFULL);
+    x = ((x & 0x0000FFFF0000FFFFULL) << 16) | ((x >> 16) & 0x0000FFFF0000FFFFULL);
+    return (x << 32) | (x >> 32);
+}
+
+/*!
+@brief x = x * h in GF(2^128), in GCM's bit order.
+@details One Karatsuba step of 64-bit carry-less multiplies. The high half
+    of each product is the low half of the product of the bit reversed
+    operands, reversed. The 256-bit result is shifted left by one (GCM's
+    bit order is reflected) and reduced by x^128 + x^7 + x^2 + x + 1.
+*/
+static void aes_gcm_gmult (
+    uint64_t        x [2],
+    const uint64_t  h [2]
+){
+    uint64_t y1  = x[0], y0 = x[1];
+    uint64_t h1  = h[0], h0 = h[1];
+    uint64_t h2  = h0 ^ h1;
+    uint64_t y2  = y0 ^ y1;
+    uint64_t h0r = aes_gcm_rev64(h0), h1r = aes_gcm_rev64(h1);
+    uint64_t y0r = aes_gcm_rev64(y0), y1r = aes_gcm_rev64(y1);
+    uint64_t h2r = h0r ^ h1r;
+    uint64_t y2r = y0r ^ y1r;
+
+    uint64_t z0  = aes_gcm_bmul64(y0 , h0 );
+    uint64_t z1  = aes_gcm_bmul64(y1 , h1 );
+    uint64_t z2  = aes_gcm_bmul64(y2 , h2 );
+    uint64_t z0h = aes_gcm_bmul64(y0r, h0r);
+    uint64_t z1h = aes_gcm_bmul64(y1r, h1r);
+    uint64_t z2h = aes_gcm_bmul64(y2r, h2r);
+
+    z2  ^= z0  ^ z1 ;
+    z2h ^= z0h ^ z1h;
+    z0h  = aes_gcm_rev64(z0h) >> 1;
+    z1h  = aes_gcm_rev64(z1h) >> 1;
+    z2h  = aes_gcm_rev64(z2h) >> 1;
+
+    uint64_t v0 = z0;
+    uint64_t v1 = z0h ^ z2;
+    uint64_t v2 = z1  ^ z2h;
+    uint64_t v3 = z1h;
+
+    v3 = (v3 << 1) | (v2 >> 63);
+    v2 = (v2 << 1) | (v1 >> 63);
+    v1 = (v1 << 1) | (v0 >> 63);
+    v0 = (v0 << 1);
+
+    v2 ^= v0 ^ (v0 >> 1) ^ (v0 >> 2) ^ (v0 >> 7);
+    v1 ^= (v0 << 63) ^ (v0 << 62) ^ (v0 << 57);
+    v3 ^= v1 ^ (v1 >> 1) ^ (v1 >> 2) ^ (v1 >> 7);
+    v2 ^= (v1 << 63) ^ (v1 << 62) ^ (v1 << 57);
+
+    x[0] = v3;
+    x[1] = v2;
+}
+
+//! Absorb one 16 byte block into a GHASH accumulator.
+static void aes_gcm_ghash_block (
+    uint64_t        x [2],
+    const uint64_t  h [2],
+    const uint8_t * blk
+){
+    x[0] ^= aes_gcm_load_be64(blk    );
+    x[1] ^= aes_gcm_load_be64(blk + 8);
+    aes_gcm_gmult(x, h);
+}
+
+//! Absorb len bytes, the last block zero padded.
+static void aes_gcm_ghash (
+    uint64_t        x [2],
+    const uint64_t  h [2],
+    const uint8_t * in,
+    size_t          len
+){
+    uint8_t blk[AES_BLOCK_BYTES];
+    while(len >= AES_BLOCK_BYTES) {
+        aes_gcm_ghash_block(x, h, in);
+        in  += AES_BLOCK_BYTES;
+        len -= AES_BLOCK_BYTES;
+    }
+    if(len > 0) {
+        memset(blk, 0, AES_BLOCK_BYTES);
+        memcpy(blk, in, len);
+        aes_gcm_ghash_block(x, h, blk);
+    }
+}
+
+int     aes_128_gcm_init (
+    aes_128_gcm_ctx * ctx,
+    uint8_t   * iv,
+    size_t      ivlen,
+    uint8_t   * aad,
+    size_t      aadlen,
+    uint32_t  * rk
+){
+    uint8_t blk[AES_BLOCK_BYTES];
+
+    if(ivlen == 0) {
+        return 1;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx -> rk     = rk;
+    ctx -> aadlen = aadlen;
+
+    // H = E(K, 0^128)
+    memset(blk, 0, AES_BLOCK_BYTES);
+    aes_128_ecb_encrypt(blk, blk, rk);
+    ctx -> h[0] = aes_gcm_load_be64(blk    );
+    ctx -> h[1] = aes_gcm_load_be64(blk + 8);
+
+    // J0 = IV || 0^31 || 1 for 96-bit IVs, otherwise GHASH of the padded
+    // IV and its length in bits.
+    if(ivlen == 12) {
+        memcpy(ctx -> j0, iv, 12);
+        ctx -> j0[15] = 1;
+    } else {
+        uint64_t j[2] = {0, 0};
+        aes_gcm_ghash(j, ctx -> h, iv, ivlen);
+        j[1] ^= (uint64_t)ivlen * 8;
+        aes_gcm_gmult(j, ctx -> h);
+        aes_gcm_store_be64(ctx -> j0    , j[0]);
+        aes_gcm_store_be64(ctx -> j0 + 8, j[1]);
+    }
+    memcpy(ctx -> ctr, ctx -> j0, AES_BLOCK_BYTES);
+
+    aes_gcm_ghash(ctx -> x, ctx -> h, aad, aadlen);
+
+    return 0;
+}
+
+//! En/decrypt one whole block. The cipher text is hashed either way.
+static void aes_gcm_xor_block (
+    aes_128_gcm_ctx * ctx,
+    uint8_t   * out,
+    uint8_t   * in,
+    uint8_t     ks [AES_BLOCK_BYTES],
+    int         decrypt
+){
+    if(decrypt) {
+        aes_gcm_ghash_block(ctx -> x, ctx -> h, in);
+    }
+    for(int i = 0; i < AES_BLOCK_BYTES; i ++) {
+        out[i] = in[i] ^ ks[i];
+    }
+    if(!decrypt) {
+        aes_gcm_ghash_block(ctx -> x, ctx -> h, out);
+    }
+}
+
+/*!
+@brief Run GCM over the next len bytes of a stream.
+@details A piece which ends within a block leaves that block's keystream
+    and cipher text so far in ctx, for the next piece (or final) to finish.
+*/
+static void aes_gcm_update (
+    aes_128_gcm_ctx * ctx,
+    uint8_t   * out,
+    uint8_t   * in,
+    size_t      len,
+    int         decrypt
+){
+    uint8_t c1  [AES_BLOCK_BYTES];
+    uint8_t ks0 [AES_BLOCK_BYTES];
+    uint8_t ks1 [AES_BLOCK_BYTES];
+
+    ctx -> len += len;
+
+    // Finish the partial block of the previous piece.
+    while(len > 0 && ctx -> used > 0) {
+        uint8_t o = *in ^ ctx -> ks[ctx -> used];
+        ctx -> blk[ctx -> used ++] = decrypt ? *in : o;
+        *out ++ = o;
+        in  ++;
+        len --;
+        if(ctx -> used == AES_BLOCK_BYTES) {
+            aes_gcm_ghash_block(ctx -> x, ctx -> h, ctx -> blk);
+            ctx -> used = 0;
+        }
+    }
+
+    while(len >= 2 * AES_BLOCK_BYTES) {
+        aes_gcm_inc32(ctx -> ctr);
+        memcpy(c1, ctx -> ctr, AES_BLOCK_BYTES);
+        aes_gcm_inc32(c1);
+        aes_128_ecb_encrypt_x2(ks0, ctx -> ctr, ks1, c1, ctx -> rk);
+        memcpy(ctx -> ctr, c1, AES_BLOCK_BYTES);
+
+        aes_gcm_xor_block(ctx, out                  , in                  ,
+            ks0, decrypt);
+        aes_gcm_xor_block(ctx, out + AES_BLOCK_BYTES, in + AES_BLOCK_BYTES,
+            ks1, decrypt);
+        out += 2 * AES_BLOCK_BYTES;
+        in  += 2 * AES_BLOCK_BYTES;
+        len -= 2 * AES_BLOCK_BYTES;
+    }
+
+    if(len >= AES_BLOCK_BYTES) {
+        aes_gcm_inc32(ctx -> ctr);
+        aes_128_ecb_encrypt(ks0, ctx -> ctr, ctx -> rk);
+        aes_gcm_xor_block(ctx, out, in, ks0, decrypt);
+        out += AES_BLOCK_BYTES;
+        in  += AES_BLOCK_BYTES;
+        len -= AES_BLOCK_BYTES;
+    }
+
+    // Start a partial block, finished by the next piece or by final.
+    if(len > 0) {
+        aes_gcm_inc32(ctx -> ctr);
+        aes_128_ecb_encrypt(ctx -> ks, ctx -> ctr, ctx -> rk);
+        for(size_t i = 0; i < len; i ++) {
+            out[i] = in[i] ^ ctx -> ks[i];
+            ctx -> blk[i] = decrypt ? in[i] : out[i];
+        }
+        ctx -> used = len;
+    }
+}
+
+void    aes_128_gcm_encrypt_update (
+    aes_128_gcm_ctx * ctx,
+    uint8_t   * ct,
+    uint8_t   * pt,
+    size_t      len
+){
+    aes_gcm_update(ctx, ct, pt, len, 0);
+}
+
+void    aes_128_gcm_decrypt_update (
+    aes_128_gcm_ctx * ctx,
+    uint8_t   * pt,
+    uint8_t   * ct,
+    size_t      len
+){
+    aes_gcm_update(ctx, pt, ct, len, 1);
+}
+
+void    aes_128_gcm_final (
+    aes_128_gcm_ctx * ctx,
+    uint8_t     tag [AES_GCM_TAG_BYTES]
+){
+    uint8_t s[AES_BLOCK_BYTES];
+
+    if(ctx -> used > 0) {
+        aes_gcm_ghash(ctx -> x, ctx -> h, ctx -> blk, ctx -> used);
+        ctx -> used = 0;
+    }
+
+    // len(A) || len(C), in bits.
+    ctx -> x[0] ^= ctx -> aadlen * 8;
+    ctx -> x[1] ^= ctx -> len    * 8;
+    aes_gcm_gmult(ctx -> x, ctx -> h);
+
+    aes_128_ecb_encrypt(s, ctx -> j0, ctx -> rk);
+    aes_gcm_store_be64(tag    , ctx -> x[0]);
+    aes_gcm_store_be64(tag + 8, ctx -> x[1]);
+    for(int i = 0; i < AES_GCM_TAG_BYTES; i ++) {
+        tag[i] ^= s[i];
+    }
+}
+
+int     aes_128_gcm_encrypt (
+    uint8_t   * ct,
+    uint8_t   * tag,
+    uint8_t   * pt,
+    size_t      len,
+    uint8_t   * aad,
+    size_t      aadlen,
+    uint8_t   * iv,
+    size_t      ivlen,
+    size_t      taglen,
+    uint32_t  * rk
+){
+    aes_128_gcm_ctx ctx;
+    uint8_t         t[AES_GCM_TAG_BYTES];
+
+    if(taglen == 0 || taglen > AES_GCM_TAG_BYTES ||
+       aes_128_gcm_init(&ctx, iv, ivlen, aad, aadlen, rk)) {
+        return 1;
+    }
+    aes_128_gcm_encrypt_update(&ctx, ct, pt, len);
+    aes_128_gcm_final(&ctx, t);
+    memcpy(tag, t, taglen);
+    return 0;
+}
+
+int     aes_128_gcm_decrypt (
+    uint8_t   * pt,
+    uint8_t   * ct,
+    size_t      len,
+    uint8_t   * aad,
+    size_t      aadlen,
+    uint8_t   * iv,
+    size_t      ivlen,
+    uint8_t   * tag,
+    size_t      taglen,
+    uint32_t  * rk
+){
+    aes_128_gcm_ctx ctx;
+    uint8_t         t[AES_GCM_TAG_BYTES];
+    uint8_t         diff = 0;
+
+    if(taglen == 0 || taglen > AES_GCM_TAG_BYTES ||
+       aes_128_gcm_init(&ctx, iv, ivlen, aad, aadlen, rk)) {
+        return 1;
+    }
+    aes_128_gcm_decrypt_update(&ctx, pt, ct, len);
+    aes_128_gcm_final(&ctx, t);
+    for(size_t i = 0; i < taglen; i ++) {
+        diff |= t[i] ^ tag[i];
+    }
+    return diff != 0;
+}
+
+//! @}
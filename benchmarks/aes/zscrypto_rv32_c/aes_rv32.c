@@ -0,0 +1,201 @@
+
+#include <string.h>
+
+#include "riscvcrypto/aes/api_aes.h"
+#include "riscvcrypto/share/riscv-crypto-intrinsics.h"
+
+/*!
+@addtogroup crypto_block_aes
+@{
+
+The aes/zscrypto_rv32 kernels written in C with the RV32 AES intrinsics,
+rather than assembly. On a host (config/host-rv32.conf) the intrinsics
+are emulated, so this is the RV32 AES zscrypto kernel which runs there.
+
+*/
+
+static inline uint32_t ld32(const void * p) {
+    uint32_t r; memcpy(&r, p, sizeof(r)); return r;
+}
+
+static inline void sd32(void * p, uint32_t v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+//! SubWord(w), one byte per aes32esi, xor'd into rs1.
+static inline uint32_t aes_rv32_subword(uint32_t rs1, uint32_t w) {
+    rs1 = _aes32esi(rs1, w, 0);
+    rs1 = _aes32esi(rs1, w, 1);
+    rs1 = _aes32esi(rs1, w, 2);
+    rs1 = _aes32esi(rs1, w, 3);
+    return rs1;
+}
+
+//! InvMixColumns(w): aes32dsmi undoes the SubWord, leaving the mix.
+static inline uint32_t aes_rv32_invmc(uint32_t w) {
+    uint32_t s = aes_rv32_subword(0, w), r = 0;
+    r = _aes32dsmi(r, s, 0);
+    r = _aes32dsmi(r, s, 1);
+    r = _aes32dsmi(r, s, 2);
+    r = _aes32dsmi(r, s, 3);
+    return r;
+}
+
+//
+// Key schedules
+// ------------------------------------------------------------
+
+//! FIPS 197 key expansion, one 32-bit word at a time.
+static void aes_rv32_enc_key_schedule(
+    uint32_t * const rk,
+    uint8_t  * const ck,
+    int              nk,
+    int              nr
+){
+    static const uint8_t rcon[10] = {
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36};
+    int r = 0;
+
+    memcpy(rk, ck, 4 * nk);
+
+    for(int i = nk; i < 4 * (nr + 1); i ++) {
+        uint32_t t = rk[i - 1];
+        if(i % nk == 0) {
+            t = aes_rv32_subword(rcon[r ++], (t >> 8) | (t << 24));
+        } else if(nk > 6 && i % nk == 4) {
+            t = aes_rv32_subword(0, t);
+        }
+        rk[i] = rk[i - nk] ^ t;
+    }
+}
+
+//! Apply InvMixColumns to the middle round keys, as aes_ks_dec_invmc does.
+static void aes_rv32_dec_key_schedule(
+    uint32_t * const rk,
+    uint8_t  * const ck,
+    int              nk,
+    int              nr
+){
+    aes_rv32_enc_key_schedule(rk, ck, nk, nr);
+
+    for(int i = 4; i < 4 * nr; i ++) {
+        rk[i] = aes_rv32_invmc(rk[i]);
+    }
+}
+
+void    aes_128_enc_key_schedule (uint32_t * const rk, uint8_t * const ck) {
+    aes_rv32_enc_key_schedule(rk, ck, AES_128_NK, AES_128_NR);
+}
+
+void    aes_192_enc_key_schedule (uint32_t * const rk, uint8_t * const ck) {
+    aes_rv32_enc_key_schedule(rk, ck, AES_192_NK, AES_192_NR);
+}
+
+void    aes_256_enc_key_schedule (uint32_t * const rk, uint8_t * const ck) {
+    aes_rv32_enc_key_schedule(rk, ck, AES_256_NK, AES_256_NR);
+}
+
+void    aes_128_dec_key_schedule (uint32_t * const rk, uint8_t * const ck) {
+    aes_rv32_dec_key_schedule(rk, ck, AES_128_NK, AES_128_NR);
+}
+
+void    aes_192_dec_key_schedule (uint32_t * const rk, uint8_t * const ck) {
+    aes_rv32_dec_key_schedule(rk, ck, AES_192_NK, AES_192_NR);
+}
+
+void    aes_256_dec_key_schedule (uint32_t * const rk, uint8_t * const ck) {
+    aes_rv32_dec_key_schedule(rk, ck, AES_256_NK, AES_256_NR);
+}
+
+//
+// Block encrypt / decrypt
+// ------------------------------------------------------------
+
+//! One output column: byte i of it comes from column c_i (ShiftRows).
+#define AES_RV32_COLUMN(OP, K, C0, C1, C2, C3) \
+    OP(OP(OP(OP(K, C0, 0), C1, 1), C2, 2), C3, 3)
+
+static inline void aes_rv32_ecb_encrypt(
+    uint8_t     ct [AES_BLOCK_BYTES],
+    uint8_t     pt [AES_BLOCK_BYTES],
+    uint32_t  * rk,
+    int         nr
+){
+    uint32_t t0 = ld32(pt     ) ^ rk[0], t1 = ld32(pt +  4) ^ rk[1];
+    uint32_t t2 = ld32(pt +  8) ^ rk[2], t3 = ld32(pt + 12) ^ rk[3];
+    uint32_t u0, u1, u2, u3;
+
+    for(int r = 1; r < nr; r ++) {                  // Shift, Sub, Mix, Add
+        u0 = AES_RV32_COLUMN(_aes32esmi, rk[4*r    ], t0, t1, t2, t3);
+        u1 = AES_RV32_COLUMN(_aes32esmi, rk[4*r + 1], t1, t2, t3, t0);
+        u2 = AES_RV32_COLUMN(_aes32esmi, rk[4*r + 2], t2, t3, t0, t1);
+        u3 = AES_RV32_COLUMN(_aes32esmi, rk[4*r + 3], t3, t0, t1, t2);
+        t0 = u0; t1 = u1; t2 = u2; t3 = u3;
+    }
+
+    u0 = AES_RV32_COLUMN(_aes32esi, rk[4*nr    ], t0, t1, t2, t3);   // Final
+    u1 = AES_RV32_COLUMN(_aes32esi, rk[4*nr + 1], t1, t2, t3, t0);
+    u2 = AES_RV32_COLUMN(_aes32esi, rk[4*nr + 2], t2, t3, t0, t1);
+    u3 = AES_RV32_COLUMN(_aes32esi, rk[4*nr + 3], t3, t0, t1, t2);
+
+    sd32(ct     , u0);
+    sd32(ct +  4, u1);
+    sd32(ct +  8, u2);
+    sd32(ct + 12, u3);
+}
+
+//! Equivalent inverse cipher, see aes_rv32_dec_key_schedule.
+static inline void aes_rv32_ecb_decrypt(
+    uint8_t     pt [AES_BLOCK_BYTES],
+    uint8_t     ct [AES_BLOCK_BYTES],
+    uint32_t  * rk,
+    int         nr
+){
+    uint32_t t0 = ld32(ct     ) ^ rk[4*nr    ], t1 = ld32(ct +  4) ^ rk[4*nr + 1];
+    uint32_t t2 = ld32(ct +  8) ^ rk[4*nr + 2], t3 = ld32(ct + 12) ^ rk[4*nr + 3];
+    uint32_t u0, u1, u2, u3;
+
+    for(int r = nr - 1; r > 0; r --) {              // Shift, Sub, Mix, Add
+        u0 = AES_RV32_COLUMN(_aes32dsmi, rk[4*r    ], t0, t3, t2, t1);
+        u1 = AES_RV32_COLUMN(_aes32dsmi, rk[4*r + 1], t1, t0, t3, t2);
+        u2 = AES_RV32_COLUMN(_aes32dsmi, rk[4*r + 2], t2, t1, t0, t3);
+        u3 = AES_RV32_COLUMN(_aes32dsmi, rk[4*r + 3], t3, t2, t1, t0);
+        t0 = u0; t1 = u1; t2 = u2; t3 = u3;
+    }
+
+    u0 = AES_RV32_COLUMN(_aes32dsi, rk[0], t0, t3, t2, t1);          // Final
+    u1 = AES_RV32_COLUMN(_aes32dsi, rk[1], t1, t0, t3, t2);
+    u2 = AES_RV32_COLUMN(_aes32dsi, rk[2], t2, t1, t0, t3);
+    u3 = AES_RV32_COLUMN(_aes32dsi, rk[3], t3, t2, t1, t0);
+
+    sd32(pt     , u0);
+    sd32(pt +  4, u1);
+    sd32(pt +  8, u2);
+    sd32(pt + 12, u3);
+}
+
+void    aes_128_ecb_encrypt (uint8_t ct [AES_BLOCK_BYTES], uint8_t pt [AES_BLOCK_BYTES], uint32_t * rk) {
+    aes_rv32_ecb_encrypt(ct, pt, rk, AES_128_NR);
+}
+
+void    aes_192_ecb_encrypt (uint8_t ct [AES_BLOCK_BYTES], uint8_t pt [AES_BLOCK_BYTES], uint32_t * rk) {
+    aes_rv32_ecb_encrypt(ct, pt, rk, AES_192_NR);
+}
+
+void    aes_256_ecb_encrypt (uint8_t ct [AES_BLOCK_BYTES], uint8_t pt [AES_BLOCK_BYTES], uint32_t * rk) {
+    aes_rv32_ecb_encrypt(ct, pt, rk, AES_256_NR);
+}
+
+void    aes_128_ecb_decrypt (uint8_t pt [AES_BLOCK_BYTES], uint8_t ct [AES_BLOCK_BYTES], uint32_t * rk) {
+    aes_rv32_ecb_decrypt(pt, ct, rk, AES_128_NR);
+}
+
+void    aes_192_ecb_decrypt (uint8_t pt [AES_BLOCK_BYTES], uint8_t ct [AES_BLOCK_BYTES], uint32_t * rk) {
+    aes_rv32_ecb_decrypt(pt, ct, rk, AES_192_NR);
+}
+
+void    aes_256_ecb_decrypt (uint8_t pt [AES_BLOCK_BYTES], uint8_t ct [AES_BLOCK_BYTES], uint32_t * rk) {
+    aes_rv32_ecb_decrypt(pt, ct, rk, AES_256_NR);
+}
+
+//! @}
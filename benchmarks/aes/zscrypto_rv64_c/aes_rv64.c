@@ -0,0 +1,175 @@
+
+#include <string.h>
+
+#include "riscvcrypto/aes/api_aes.h"
+#include "riscvcrypto/share/riscv-crypto-intrinsics.h"
+
+/*!
+@addtogroup crypto_block_aes
+@{
+
+The aes/zscrypto_rv64 kernels written in C with the RV64 AES intrinsics,
+rather than assembly. On RISC-V this shows what the compiler makes of
+them. On a host (config/host.conf, config/host-x86.conf) the intrinsics
+are emulated, so this is the AES zscrypto kernel which runs there.
+
+*/
+
+static inline uint64_t ld64(const void * p) {
+    uint64_t r; memcpy(&r, p, sizeof(r)); return r;
+}
+
+static inline void sd64(void * p, uint64_t v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+//
+// Key schedules
+// ------------------------------------------------------------
+
+/*
+@details FIPS 197 key expansion, one 32-bit word at a time. aes64ks1i
+    computes SubWord(RotWord(w)) ^ Rcon from the high word of rs1, or just
+    SubWord(w) when rnum is 0xA.
+*/
+static void aes_rv64_enc_key_schedule(
+    uint32_t * const rk,
+    uint8_t  * const ck,
+    int              nk,
+    int              nr
+){
+    int rcon = 0;
+
+    memcpy(rk, ck, 4 * nk);
+
+    for(int i = nk; i < 4 * (nr + 1); i ++) {
+        uint32_t t = rk[i - 1];
+        if(i % nk == 0) {
+            t = _aes64ks1i((uint64_t)t << 32, rcon ++);
+        } else if(nk > 6 && i % nk == 4) {
+            t = _aes64ks1i((uint64_t)t << 32, 0xA);
+        }
+        rk[i] = rk[i - nk] ^ t;
+    }
+}
+
+//! Apply InvMixColumns to the middle round keys, as aes_ks_dec_invmc does.
+static void aes_rv64_dec_key_schedule(
+    uint32_t * const rk,
+    uint8_t  * const ck,
+    int              nk,
+    int              nr
+){
+    aes_rv64_enc_key_schedule(rk, ck, nk, nr);
+
+    for(int i = 4; i < 4 * nr; i += 2) {
+        sd64(rk + i, _aes64im(ld64(rk + i)));
+    }
+}
+
+void    aes_128_enc_key_schedule (uint32_t * const rk, uint8_t * const ck) {
+    aes_rv64_enc_key_schedule(rk, ck, AES_128_NK, AES_128_NR);
+}
+
+void    aes_192_enc_key_schedule (uint32_t * const rk, uint8_t * const ck) {
+    aes_rv64_enc_key_schedule(rk, ck, AES_192_NK, AES_192_NR);
+}
+
+void    aes_256_enc_key_schedule (uint32_t * const rk, uint8_t * const ck) {
+    aes_rv64_enc_key_schedule(rk, ck, AES_256_NK, AES_256_NR);
+}
+
+void    aes_128_dec_key_schedule (uint32_t * const rk, uint8_t * const ck) {
+    aes_rv64_dec_key_schedule(rk, ck, AES_128_NK, AES_128_NR);
+}
+
+void    aes_192_dec_key_schedule (uint32_t * const rk, uint8_t * const ck) {
+    aes_rv64_dec_key_schedule(rk, ck, AES_192_NK, AES_192_NR);
+}
+
+void    aes_256_dec_key_schedule (uint32_t * const rk, uint8_t * const ck) {
+    aes_rv64_dec_key_schedule(rk, ck, AES_256_NK, AES_256_NR);
+}
+
+//
+// Block encrypt / decrypt
+// ------------------------------------------------------------
+
+static inline void aes_rv64_ecb_encrypt(
+    uint8_t     ct [AES_BLOCK_BYTES],
+    uint8_t     pt [AES_BLOCK_BYTES],
+    uint32_t  * rk,
+    int         nr
+){
+    uint64_t s0 = ld64(pt    ), s1 = ld64(pt + 8), n0, n1;
+
+    for(int r = 0; r < nr - 1; r ++) {
+        s0 ^= ld64(rk + 4*r    );                  // AddRoundKey
+        s1 ^= ld64(rk + 4*r + 2);
+        n0  = _aes64esm(s0, s1);                    // Shift, Sub, Mix
+        n1  = _aes64esm(s1, s0);
+        s0  = n0;
+        s1  = n1;
+    }
+
+    s0 ^= ld64(rk + 4*(nr-1)    );
+    s1 ^= ld64(rk + 4*(nr-1) + 2);
+    n0  = _aes64es(s0, s1) ^ ld64(rk + 4*nr    );   // Final round
+    n1  = _aes64es(s1, s0) ^ ld64(rk + 4*nr + 2);
+
+    sd64(ct    , n0);
+    sd64(ct + 8, n1);
+}
+
+//! Equivalent inverse cipher, see aes_rv64_dec_key_schedule.
+static inline void aes_rv64_ecb_decrypt(
+    uint8_t     pt [AES_BLOCK_BYTES],
+    uint8_t     ct [AES_BLOCK_BYTES],
+    uint32_t  * rk,
+    int         nr
+){
+    uint64_t s0 = ld64(ct    ), s1 = ld64(ct + 8), n0, n1;
+
+    for(int r = nr; r > 1; r --) {
+        s0 ^= ld64(rk + 4*r    );                  // AddRoundKey
+        s1 ^= ld64(rk + 4*r + 2);
+        n0  = _aes64dsm(s0, s1);                    // Shift, Sub, Mix
+        n1  = _aes64dsm(s1, s0);
+        s0  = n0;
+        s1  = n1;
+    }
+
+    s0 ^= ld64(rk + 4    );
+    s1 ^= ld64(rk + 4 + 2);
+    n0  = _aes64ds(s0, s1) ^ ld64(rk    );          // Final round
+    n1  = _aes64ds(s1, s0) ^ ld64(rk + 2);
+
+    sd64(pt    , n0);
+    sd64(pt + 8, n1);
+}
+
+void    aes_128_ecb_encrypt (uint8_t ct [AES_BLOCK_BYTES], uint8_t pt [AES_BLOCK_BYTES], uint32_t * rk) {
+    aes_rv64_ecb_encrypt(ct, pt, rk, AES_128_NR);
+}
+
+void    aes_192_ecb_encrypt (uint8_t ct [AES_BLOCK_BYTES], uint8_t pt [AES_BLOCK_BYTES], uint32_t * rk) {
+    aes_rv64_ecb_encrypt(ct, pt, rk, AES_192_NR);
+}
+
+void    aes_256_ecb_encrypt (uint8_t ct [AES_BLOCK_BYTES], uint8_t pt [AES_BLOCK_BYTES], uint32_t * rk) {
+    aes_rv64_ecb_encrypt(ct, pt, rk, AES_256_NR);
+}
+
+void    aes_128_ecb_decrypt (uint8_t pt [AES_BLOCK_BYTES], uint8_t ct [AES_BLOCK_BYTES], uint32_t * rk) {
+    aes_rv64_ecb_decrypt(pt, ct, rk, AES_128_NR);
+}
+
+void    aes_192_ecb_decrypt (uint8_t pt [AES_BLOCK_BYTES], uint8_t ct [AES_BLOCK_BYTES], uint32_t * rk) {
+    aes_rv64_ecb_decrypt(pt, ct, rk, AES_192_NR);
+}
+
+void    aes_256_ecb_decrypt (uint8_t pt [AES_BLOCK_BYTES], uint8_t ct [AES_BLOCK_BYTES], uint32_t * rk) {
+    aes_rv64_ecb_decrypt(pt, ct, rk, AES_256_NR);
+}
+
+//! @}
@@ -0,0 +1,187 @@
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "riscvcrypto/cli/cli_util.h"
+
+//! Reads all of fd into a growing buffer.
+static int cli_read_all(cli_input * in, int fd) {
+    size_t cap = 1 << 20;
+    int    err = ENOMEM;
+    in -> data = malloc(cap);
+    in -> len  = 0;
+    while(in -> data != NULL) {
+        if(in -> len == cap) {
+            uint8_t * grown = realloc(in -> data, cap * 2);
+            if(grown == NULL) {
+                break;
+            }
+            in -> data = grown;
+            cap       *= 2;
+        }
+        ssize_t n = read(fd, in -> data + in -> len, cap - in -> len);
+        if(n == 0) {
+            return 0;
+        } else if(n < 0 && errno != EINTR) {
+            err = errno;
+            break;
+        } else if(n > 0) {
+            in -> len += n;
+        }
+    }
+    free(in -> data);
+    in -> data = NULL;
+    errno      = err;
+    return -1;
+}
+
+int cli_input_open(cli_input * in, const char * path) {
+    struct stat st;
+    int         fd = strcmp(path, "-") ? open(path, O_RDONLY) : STDIN_FILENO;
+
+    in -> data   = NULL;
+    in -> len    = 0;
+    in -> mapped = 0;
+
+    if(fd < 0 || fstat(fd, &st) < 0) {
+        return -1;
+    }
+
+    if(S_ISREG(st.st_mode) && st.st_size > 0) {
+        void * map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(map != MAP_FAILED) {
+            posix_madvise(map, st.st_size, POSIX_MADV_SEQUENTIAL);
+            in -> data   = map;
+            in -> len    = st.st_size;
+            in -> mapped = 1;
+        }
+    } else if(S_ISREG(st.st_mode)) {
+        in -> mapped = 1;               // Empty: nothing to map.
+    }
+
+    int rc = in -> mapped ? 0 : cli_read_all(in, fd);
+    if(fd != STDIN_FILENO) {
+        close(fd);
+    }
+    return rc;
+}
+
+void cli_input_close(cli_input * in) {
+    if(in -> mapped && in -> len > 0) {
+        munmap(in -> data, in -> len);
+    } else if(!in -> mapped) {
+        free(in -> data);
+    }
+    in -> data = NULL;
+    in -> len  = 0;
+}
+
+int cli_output_open(cli_output * out, const char * path, size_t len) {
+    struct stat st;
+
+    out -> path = path != NULL && strcmp(path, "-") ? path : NULL;
+    out -> map  = NULL;
+    out -> len  = len;
+    out -> fd   = out -> path ? open(path, O_RDWR | O_CREAT | O_TRUNC, 0644)
+                              : STDOUT_FILENO;
+
+    if(out -> fd < 0 || fstat(out -> fd, &st) < 0) {
+        return -1;
+    }
+    // Mapping needs read access too, which a shell's "> file" lacks.
+    int flags = fcntl(out -> fd, F_GETFL);
+    if(!S_ISREG(st.st_mode) || len == 0 || (flags & O_ACCMODE) != O_RDWR) {
+        return 0;
+    }
+    if(ftruncate(out -> fd, len) < 0) {
+        return -1;
+    }
+    void * map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      out -> fd, 0);
+    if(map != MAP_FAILED) {
+        posix_madvise(map, len, POSIX_MADV_SEQUENTIAL);
+        out -> map = map;
+    }
+    return 0;
+}
+
+uint8_t * cli_output_window(cli_output * out, size_t off, uint8_t * buf) {
+    return out -> map != NULL ? out -> map + off : buf;
+}
+
+int cli_output_write(cli_output * out, const uint8_t * buf, size_t n) {
+    if(out -> map != NULL) {
+        return 0;
+    }
+    while(n > 0) {
+        ssize_t w = write(out -> fd, buf, n);
+        if(w < 0 && errno != EINTR) {
+            return -1;
+        } else if(w > 0) {
+            buf += w;
+            n   -= w;
+        }
+    }
+    return 0;
+}
+
+int cli_output_close(cli_output * out, int keep) {
+    int rc = 0;
+    if(out -> map != NULL) {
+        rc = munmap(out -> map, out -> len);
+    }
+    if(!keep && out -> path != NULL) {
+        unlink(out -> path);
+    } else if(!keep && out -> map != NULL && ftruncate(out -> fd, 0) < 0) {
+        rc = -1;                        // e.g. stdout redirected to a file.
+    }
+    if(out -> fd != STDOUT_FILENO && close(out -> fd) < 0) {
+        rc = -1;
+    }
+    return rc;
+}
+
+int cli_unhex(uint8_t * out, size_t len, const char * hex) {
+    if(strlen(hex) != 2 * len) {
+        return -1;
+    }
+    for(size_t i = 0; i < len; i ++) {
+        char b[3] = {hex[2 * i], hex[2 * i + 1], 0};
+        char * end;
+        out[i] = (uint8_t)strtoul(b, &end, 16);
+        if(*end != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+uint64_t cli_now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void cli_report(
+    const char * tool   ,
+    const char * name   ,
+    const char * op     ,
+    const char * impl   ,
+    unsigned     threads,
+    size_t       bytes  ,
+    uint64_t     ns
+) {
+    double s = (ns ? ns : 1) / 1e9;
+    fprintf(stderr, "%s: %s: %s (%s, %u thread%s): %lu bytes in %.3f s, "
+        "%.3f GiB/s\n", tool, name, op, impl, threads, threads == 1 ? "" : "s",
+        (unsigned long)bytes, s, bytes / s / (1024.0 * 1024.0 * 1024.0));
+}
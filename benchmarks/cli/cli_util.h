@@ -0,0 +1,100 @@
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+@defgroup cli Command Line Tools
+@{
+@details File handling shared by rvcrypto-sum and rvcrypto-enc.
+
+    Inputs are memory mapped read only, and advised as read sequentially,
+    so that the kernel reads ahead while the hash or cipher walks the
+    mapping: the time a tool reports is that of the page cache (or disk)
+    and the crypto together. Inputs which cannot be mapped, such as pipes,
+    are read into memory first.
+
+    Outputs which are regular files are sized up front and mapped, so the
+    cipher writes straight into the page cache. Others, such as /dev/null
+    or a pipe, are written a window at a time from a buffer.
+*/
+
+#ifndef __CLI_UTIL_H__
+#define __CLI_UTIL_H__
+
+//! Bytes handed to a cipher at once, when the input is processed in pieces.
+#define CLI_WINDOW_BYTES (8 * 1024 * 1024)
+
+//! An input file, mapped or read into memory.
+typedef struct {
+    uint8_t * data;
+    size_t    len;
+    int       mapped;
+} cli_input;
+
+//! An output file, mapped or written with write().
+typedef struct {
+    const char * path;
+    int          fd;
+    uint8_t    * map;
+    size_t       len;
+} cli_output;
+
+/*!
+@brief Maps path, or reads it if it cannot be mapped. "-" is stdin.
+@returns 0, or -1 with errno set.
+*/
+int       cli_input_open(cli_input * in, const char * path);
+
+//! Unmaps or frees an input.
+void      cli_input_close(cli_input * in);
+
+/*!
+@brief Creates (or truncates) a len byte output. NULL or "-" is stdout.
+@returns 0, or -1 with errno set.
+*/
+int       cli_output_open(cli_output * out, const char * path, size_t len);
+
+/*!
+@brief Where the bytes at off of the output should be written: into the
+    mapping, or else into buf, to be passed to cli_output_write.
+*/
+uint8_t * cli_output_window(cli_output * out, size_t off, uint8_t * buf);
+
+/*!
+@brief Writes n bytes of a window, unless the output is mapped.
+@returns 0, or -1 with errno set.
+*/
+int       cli_output_write(cli_output * out, const uint8_t * buf, size_t n);
+
+/*!
+@brief Closes an output. If keep is zero, e.g. because its contents failed
+    authentication, a named output file is removed, and a mapped stdout
+    truncated.
+@returns 0, or -1 with errno set.
+*/
+int       cli_output_close(cli_output * out, int keep);
+
+//! Reads a hex string of exactly len bytes. Returns 0, or -1 if malformed.
+int       cli_unhex(uint8_t * out, size_t len, const char * hex);
+
+//! Monotonic time, in nanoseconds.
+uint64_t  cli_now_ns();
+
+/*!
+@brief Prints the throughput of one file to stderr, as
+    "<tool>: <name>: <op> (<impl>, <threads> threads): <bytes> bytes in
+    <seconds> s, <GiB/s> GiB/s".
+*/
+void      cli_report(
+    const char * tool   ,
+    const char * name   ,
+    const char * op     ,
+    const char * impl   ,
+    unsigned     threads,
+    size_t       bytes  ,
+    uint64_t     ns
+);
+
+#endif
+
+//! @}
@@ -0,0 +1,232 @@
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "riscvcrypto/aes/api_aes.h"
+#include "riscvcrypto/aes/api_aes_modes.h"
+
+#include "riscvcrypto/libriscvcrypto/api_riscvcrypto.h"
+#include "riscvcrypto/parallel/api_parallel.h"
+#include "riscvcrypto/cli/cli_util.h"
+
+//
+// rvcrypto-enc: AES-128 CTR or GCM encryption of a file, reporting the
+// throughput on stderr.
+//
+// CTR output matches "openssl enc -aes-128-ctr -K <key> -iv <iv>". GCM
+// output is the cipher text followed by the 16 byte tag. Decrypting GCM
+// writes nothing (and exits with 1) unless the tag matches.
+//
+
+#define TOOL "rvcrypto-enc"
+
+#define GCM_IV_BYTES 12
+
+static void usage() {
+    fprintf(stderr,
+        "usage: " TOOL " [-d] [-m ctr|gcm] -k key [-i iv] [-t threads] "
+        "[-o out] [-q] [in]\n"
+        "  -d  decrypt\n"
+        "  -m  mode, ctr by default\n"
+        "  -k  key, 32 hex digits\n"
+        "  -i  initial counter block (ctr, 32 hex digits) or IV (gcm, 24 hex\n"
+        "      digits by default), zero by default\n"
+        "  -t  ctr over this many threads, 0 for one per CPU\n"
+        "  -o  output file, standard output by default\n"
+        "  -q  do not report throughput\n"
+        "With no in, or when in is -, read standard input.\n");
+    exit(2);
+}
+
+int main(int argc, char ** argv) {
+
+    int          decrypt = 0;
+    int          gcm     = 0;
+    int          quiet   = 0;
+    int          tree    = 0;
+    unsigned     threads = 1;
+    const char * key_hex = NULL;
+    const char * iv_hex  = NULL;
+    const char * out_path= NULL;
+    int          opt;
+
+    while((opt = getopt(argc, argv, "dm:k:i:t:o:q")) != -1) {
+        switch(opt) {
+            case 'd': decrypt  = 1;                                  break;
+            case 'k': key_hex  = optarg;                             break;
+            case 'i': iv_hex   = optarg;                             break;
+            case 'o': out_path = optarg;                             break;
+            case 'q': quiet    = 1;                                  break;
+            case 't': tree     = 1; threads = strtoul(optarg,NULL,0);break;
+            case 'm':
+                if(!strcmp(optarg, "gcm")) {
+                    gcm = 1;
+                } else if(strcmp(optarg, "ctr")) {
+                    usage();
+                }
+                break;
+            default:
+                usage();
+        }
+    }
+    if(key_hex == NULL || argc - optind > 1) {
+        usage();
+    }
+
+    uint8_t  key [AES_128_KEY_BYTES];
+    uint8_t  iv  [AES_BLOCK_BYTES] = {0};
+    size_t   ivlen = gcm ? GCM_IV_BYTES : AES_BLOCK_BYTES;
+    uint32_t rk  [AES_128_RK_WORDS];
+
+    if(cli_unhex(key, sizeof(key), key_hex) < 0) {
+        fprintf(stderr, TOOL ": the key must be 32 hex digits\n");
+        return 2;
+    }
+    if(iv_hex != NULL) {
+        ivlen = strlen(iv_hex) / 2;
+        if((!gcm && ivlen != AES_BLOCK_BYTES) || ivlen == 0 ||
+           ivlen > AES_BLOCK_BYTES || cli_unhex(iv, ivlen, iv_hex) < 0) {
+            fprintf(stderr, TOOL ": malformed iv\n");
+            return 2;
+        }
+    }
+    if(gcm && tree) {
+        fprintf(stderr, TOOL ": gcm runs on one thread only\n");
+        return 2;
+    }
+    aes_128_enc_key_schedule(rk, key);
+
+    parallel_engine * engine = NULL;
+    if(tree) {
+        parallel_config cfg = {threads, 0, 0};
+        engine = parallel_engine_new(&cfg);
+        if(engine == NULL) {
+            fprintf(stderr, TOOL ": could not start %u threads\n", threads);
+            return 1;
+        }
+        threads = parallel_engine_threads(engine);
+    }
+
+    const char * in_path = optind < argc ? argv[optind] : "-";
+    uint64_t     start   = cli_now_ns();
+    cli_input    in;
+    cli_output   out;
+
+    if(cli_input_open(&in, in_path) < 0) {
+        fprintf(stderr, TOOL ": %s: %s\n", in_path, strerror(errno));
+        return 1;
+    }
+
+    // GCM decryption reads the tag from the end of the input, and encryption
+    // appends it to the output.
+    size_t len     = in.len;
+    size_t out_len = in.len;
+    if(gcm && decrypt) {
+        if(in.len < AES_GCM_TAG_BYTES) {
+            fprintf(stderr, TOOL ": %s: too short for a gcm tag\n", in_path);
+            return 1;
+        }
+        len     -= AES_GCM_TAG_BYTES;
+        out_len  = len;
+    } else if(gcm) {
+        out_len += AES_GCM_TAG_BYTES;
+    }
+
+    if(cli_output_open(&out, out_path, out_len) < 0) {
+        fprintf(stderr, TOOL ": %s: %s\n", out_path ? out_path : "-",
+            strerror(errno));
+        return 1;
+    }
+
+    // Unmapped outputs are written a window at a time from buf, except GCM
+    // plaintext, which is held back until the tag has been checked.
+    int       hold = gcm && decrypt;
+    uint8_t * buf  = NULL;
+    if(out.map == NULL) {
+        buf = malloc(hold ? out_len + 1 : CLI_WINDOW_BYTES);
+        if(buf == NULL) {
+            fprintf(stderr, TOOL ": out of memory\n");
+            cli_output_close(&out, 0);
+            return 1;
+        }
+    }
+
+    aes_128_gcm_ctx ctx;
+    if(gcm) {
+        aes_128_gcm_init(&ctx, iv, ivlen, NULL, 0, rk);
+    }
+
+    int rc = 0;
+    for(size_t off = 0; off < len && rc == 0; off += CLI_WINDOW_BYTES) {
+        size_t    n   = len - off < CLI_WINDOW_BYTES ? len - off
+                                                     : CLI_WINDOW_BYTES;
+        uint8_t * src = in.data + off;
+        uint8_t * dst = cli_output_window(&out, off, hold ? buf + off : buf);
+
+        if(gcm && decrypt) {
+            aes_128_gcm_decrypt_update(&ctx, dst, src, n);
+        } else if(gcm) {
+            aes_128_gcm_encrypt_update(&ctx, dst, src, n);
+        } else if(engine != NULL) {
+            parallel_aes_128_ctr(engine, dst, src, n, iv, rk);
+        } else {
+            aes_128_ctr(dst, src, n, iv, rk);
+        }
+
+        if(!hold) {
+            rc = cli_output_write(&out, dst, n);
+        }
+    }
+
+    if(gcm && rc == 0) {
+        uint8_t tag [AES_GCM_TAG_BYTES];
+        aes_128_gcm_final(&ctx, tag);
+        if(decrypt) {
+            uint8_t diff = 0;
+            for(int i = 0; i < AES_GCM_TAG_BYTES; i ++) {
+                diff |= tag[i] ^ in.data[len + i];
+            }
+            if(diff) {
+                fprintf(stderr, TOOL ": %s: tag mismatch\n", in_path);
+                free(buf);
+                cli_input_close(&in);
+                cli_output_close(&out, 0);
+                return 1;
+            }
+            rc = cli_output_write(&out, buf, out_len);
+        } else {
+            uint8_t * dst = cli_output_window(&out, len, tag);
+            if(dst != tag) {
+                memcpy(dst, tag, AES_GCM_TAG_BYTES);
+            }
+            rc = cli_output_write(&out, dst, AES_GCM_TAG_BYTES);
+        }
+    }
+
+    free(buf);
+    cli_input_close(&in);
+    if(cli_output_close(&out, rc == 0) < 0 || rc < 0) {
+        fprintf(stderr, TOOL ": %s: %s\n", out_path ? out_path : "-",
+            strerror(errno));
+        return 1;
+    }
+    uint64_t ns = cli_now_ns() - start;
+
+    if(!quiet) {
+        char op[32];
+        snprintf(op, sizeof(op), "aes-128-%s %s", gcm ? "gcm" : "ctr",
+            decrypt ? "decrypt" : "encrypt");
+        cli_report(TOOL, in_path, op, riscvcrypto_impl(RISCVCRYPTO_AES),
+            threads, len, ns);
+    }
+
+    if(engine != NULL) {
+        parallel_engine_free(engine);
+    }
+    return 0;
+}
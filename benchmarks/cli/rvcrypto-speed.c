@@ -0,0 +1,329 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "riscvcrypto/share/test.h"
+
+#include "riscvcrypto/aes/api_aes.h"
+#include "riscvcrypto/aes/api_aes_modes.h"
+#include "riscvcrypto/sm4/api_sm4.h"
+#include "riscvcrypto/sha256/api_sha256.h"
+#include "riscvcrypto/sha512/api_sha512.h"
+#include "riscvcrypto/sha3/fips202.h"
+#include "riscvcrypto/sm3/api_sm3.h"
+
+#include "riscvcrypto/libriscvcrypto/api_riscvcrypto.h"
+
+//
+// rvcrypto-speed: openssl speed for libriscvcrypto.
+//
+// Times each algorithm, with each implementation of it the hart supports,
+// over inputs of each of speed_sizes bytes. Every size is run for a cycle
+// budget rather than a number of calls, so that slow and fast kernels take
+// about as long. Prints one table row per algorithm, implementation and
+// size, with the rate in operations (calls) per second of wall clock time,
+// and in bytes per rdcycle cycle.
+//
+// doc/vector/code-samples has a rvcrypto-speed for the vector kernels
+// which prints the same table. It is built by that directory's own
+// Makefile, without this tree, so it keeps its own copy of the timing loop
+// and list parsing below: change both together.
+//
+
+#define TOOL "rvcrypto-speed"
+
+//! Cycles each algorithm is timed for at each size, unless -c is given.
+#ifndef SPEED_CYCLES
+#define SPEED_CYCLES 100000000
+#endif
+
+//! Input lengths in bytes, as openssl speed.
+static const size_t speed_sizes[] = {16, 64, 256, 1024, 8192, 16384};
+
+#define SPEED_MAX_BYTES 16384
+
+//! Inputs and keys shared by every algorithm.
+typedef struct {
+    uint8_t   buf   [SPEED_MAX_BYTES];
+    uint8_t   key   [AES_256_KEY_BYTES];
+    uint8_t   iv    [AES_BLOCK_BYTES];
+    uint32_t  rk    [AES_256_RK_WORDS];
+    uint64_t  digest[8];
+} speed_ctx;
+
+//! Makes the key schedule of an algorithm, once per implementation.
+typedef void (*speed_setup_fn)(speed_ctx * ctx);
+
+//! One operation: processes the first len bytes of ctx -> buf.
+typedef void (*speed_run_fn)(speed_ctx * ctx, size_t len);
+
+typedef struct {
+    const char     * name;  //!< As given on the command line.
+    riscvcrypto_alg  alg;   //!< Whose implementations it is timed with.
+    speed_setup_fn   setup;
+    speed_run_fn     run;
+} speed_alg;
+
+//
+// Algorithms
+// ------------------------------------------------------------------
+
+static void setup_aes_128_enc(speed_ctx * ctx) {
+    aes_128_enc_key_schedule(ctx -> rk, ctx -> key);
+}
+
+static void setup_aes_192_enc(speed_ctx * ctx) {
+    aes_192_enc_key_schedule(ctx -> rk, ctx -> key);
+}
+
+static void setup_aes_256_enc(speed_ctx * ctx) {
+    aes_256_enc_key_schedule(ctx -> rk, ctx -> key);
+}
+
+static void setup_aes_128_dec(speed_ctx * ctx) {
+    aes_128_dec_key_schedule(ctx -> rk, ctx -> key);
+}
+
+static void setup_sm4(speed_ctx * ctx) {
+    sm4_key_schedule_enc(ctx -> rk, ctx -> key);
+}
+
+static void setup_none(speed_ctx * ctx) {
+}
+
+//! ECB over whole blocks, in place.
+#define SPEED_ECB(NAME, FN)                                                 \
+static void NAME(speed_ctx * ctx, size_t len) {                             \
+    for(size_t i = 0; i + AES_BLOCK_BYTES <= len; i += AES_BLOCK_BYTES) {   \
+        FN(ctx -> buf + i, ctx -> buf + i, ctx -> rk);                      \
+    }                                                                       \
+}
+
+SPEED_ECB(run_aes_128_ecb    , aes_128_ecb_encrypt)
+SPEED_ECB(run_aes_192_ecb    , aes_192_ecb_encrypt)
+SPEED_ECB(run_aes_256_ecb    , aes_256_ecb_encrypt)
+SPEED_ECB(run_aes_128_ecb_dec, aes_128_ecb_decrypt)
+SPEED_ECB(run_sm4_ecb        , sm4_block_enc_dec  )
+
+static void run_aes_128_ctr(speed_ctx * ctx, size_t len) {
+    aes_128_ctr(ctx -> buf, ctx -> buf, len, ctx -> iv, ctx -> rk);
+}
+
+static void run_aes_128_gcm(speed_ctx * ctx, size_t len) {
+    aes_128_gcm_encrypt(ctx -> buf, (uint8_t*)ctx -> digest, ctx -> buf, len,
+        NULL, 0, ctx -> iv, 12, AES_GCM_TAG_BYTES, ctx -> rk);
+}
+
+static void run_aes_128_ccm(speed_ctx * ctx, size_t len) {
+    aes_128_ccm_encrypt(ctx -> buf, (uint8_t*)ctx -> digest, ctx -> buf, len,
+        NULL, 0, ctx -> iv, 12, 16, ctx -> rk);
+}
+
+static void run_aes_128_cmac(speed_ctx * ctx, size_t len) {
+    aes_128_cmac((uint8_t*)ctx -> digest, ctx -> buf, len, ctx -> rk);
+}
+
+static void run_sha256(speed_ctx * ctx, size_t len) {
+    sha256_hash((uint32_t*)ctx -> digest, ctx -> buf, len);
+}
+
+static void run_sha512(speed_ctx * ctx, size_t len) {
+    sha512_hash(ctx -> digest, ctx -> buf, len);
+}
+
+static void run_sha3_256(speed_ctx * ctx, size_t len) {
+    FIPS202_SHA3_256(ctx -> buf, len, (uint8_t*)ctx -> digest);
+}
+
+static void run_sm3(speed_ctx * ctx, size_t len) {
+    sm3_hash((uint8_t*)ctx -> digest, ctx -> buf, len);
+}
+
+static const speed_alg speed_algs[] = {
+    {"aes-128-ecb"    , RISCVCRYPTO_AES   , setup_aes_128_enc, run_aes_128_ecb    },
+    {"aes-192-ecb"    , RISCVCRYPTO_AES   , setup_aes_192_enc, run_aes_192_ecb    },
+    {"aes-256-ecb"    , RISCVCRYPTO_AES   , setup_aes_256_enc, run_aes_256_ecb    },
+    {"aes-128-ecb-dec", RISCVCRYPTO_AES   , setup_aes_128_dec, run_aes_128_ecb_dec},
+    {"aes-128-ctr"    , RISCVCRYPTO_AES   , setup_aes_128_enc, run_aes_128_ctr    },
+    {"aes-128-gcm"    , RISCVCRYPTO_AES   , setup_aes_128_enc, run_aes_128_gcm    },
+    {"aes-128-ccm"    , RISCVCRYPTO_AES   , setup_aes_128_enc, run_aes_128_ccm    },
+    {"aes-128-cmac"   , RISCVCRYPTO_AES   , setup_aes_128_enc, run_aes_128_cmac   },
+    {"sm4-ecb"        , RISCVCRYPTO_SM4   , setup_sm4        , run_sm4_ecb        },
+    {"sha256"         , RISCVCRYPTO_SHA256, setup_none       , run_sha256         },
+    {"sha512"         , RISCVCRYPTO_SHA512, setup_none       , run_sha512         },
+    {"sha3-256"       , RISCVCRYPTO_SHA3  , setup_none       , run_sha3_256       },
+    {"sm3"            , RISCVCRYPTO_SM3   , setup_none       , run_sm3            },
+};
+
+#define SPEED_ALGS (sizeof(speed_algs) / sizeof(speed_algs[0]))
+
+//
+// Timing
+// ------------------------------------------------------------------
+
+static uint64_t speed_now_ns() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000000ULL + (uint64_t)tv.tv_usec * 1000;
+}
+
+/*!
+@brief Runs an algorithm over len bytes until budget cycles have passed.
+@details Calls are made in batches, so that reading the counters costs
+    little next to short operations. Each batch is sized from the rate of
+    those before it to end near the budget, and at most doubles.
+*/
+static void speed_time(
+    speed_ctx       * ctx   ,
+    const speed_alg * alg   ,
+    size_t            len   ,
+    uint64_t          budget,
+    uint64_t        * ops   ,
+    uint64_t        * cycles,
+    uint64_t        * ns
+) {
+    alg -> run(ctx, len);                   // Warm up.
+
+    *ops    = 0;
+    *cycles = 0;
+    *ns     = 0;
+
+    for(uint64_t batch = 1; *cycles < budget; ) {
+        uint64_t ns_start = speed_now_ns();
+        uint64_t c_start  = test_rdcycle();
+        for(uint64_t i = 0; i < batch; i ++) {
+            alg -> run(ctx, len);
+        }
+        *cycles += test_rdcycle()  - c_start;
+        *ns     += speed_now_ns() - ns_start;
+        *ops    += batch;
+
+        uint64_t per_op = *cycles / *ops + 1;
+        uint64_t left   = *cycles < budget ? (budget - *cycles) / per_op : 0;
+        batch = left < 2 * batch ? left + 1 : 2 * batch;
+    }
+}
+
+//! Is name in a comma separated list? A NULL list has every name.
+static int speed_listed(const char * list, const char * name) {
+    size_t len = strlen(name);
+    if(list == NULL) {
+        return 1;
+    }
+    for(;;) {
+        if(strncmp(list, name, len) == 0 &&
+           (list[len] == ',' || list[len] == '\0')) {
+            return 1;
+        }
+        const char * next = strchr(list, ',');
+        if(next == NULL) {
+            return 0;
+        }
+        list = next + 1;
+    }
+}
+
+static void usage() {
+    printf("usage: " TOOL " [-c cycles] [-i impl,...] [-l] [algorithm ...]\n"
+           "  -c  cycles to time each algorithm and size for, default %llu\n"
+           "  -i  implementations to time, default all the hart supports\n"
+           "  -l  list algorithms and implementations\n"
+           "With no algorithm, time them all.\n",
+           (unsigned long long)SPEED_CYCLES);
+    exit(2);
+}
+
+static void speed_list() {
+    for(size_t a = 0; a < SPEED_ALGS; a ++) {
+        const char * impl;
+        printf("%-16s", speed_algs[a].name);
+        for(size_t i = 0; (impl = riscvcrypto_impl_at(speed_algs[a].alg, i));
+            i ++) {
+            printf(" %s", impl);
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char ** argv) {
+
+    uint64_t     budget = SPEED_CYCLES;
+    const char * impls  = NULL;
+    int          opt;
+
+    while((opt = getopt(argc, argv, "c:i:l")) != -1) {
+        switch(opt) {
+            case 'c': budget = strtoull(optarg, NULL, 0); break;
+            case 'i': impls  = optarg;                     break;
+            case 'l': speed_list();                        return 0;
+            default : usage();
+        }
+    }
+
+    for(int i = optind; i < argc; i ++) {
+        size_t a = 0;
+        while(a < SPEED_ALGS && strcmp(argv[i], speed_algs[a].name)) {
+            a ++;
+        }
+        if(a == SPEED_ALGS) {
+            printf(TOOL ": unknown algorithm %s\n", argv[i]);
+            usage();
+        }
+    }
+
+    static speed_ctx ctx;
+    test_rdrandom(ctx.buf, sizeof(ctx.buf));
+    test_rdrandom(ctx.key, sizeof(ctx.key));
+    test_rdrandom(ctx.iv , sizeof(ctx.iv ));
+
+    uint32_t caps = riscvcrypto_caps();
+    int      rows = 0;
+
+    printf("# " TOOL ": %llu cycles per algorithm and size\n",
+        (unsigned long long)budget);
+    printf("%-16s %-30s %6s %14s %12s\n",
+        "algorithm", "implementation", "bytes", "ops/s", "bytes/cycle");
+
+    for(size_t a = 0; a < SPEED_ALGS; a ++) {
+        const speed_alg * alg = &speed_algs[a];
+        const char      * impl;
+
+        int wanted = optind == argc;
+        for(int i = optind; i < argc; i ++) {
+            wanted |= !strcmp(argv[i], alg -> name);
+        }
+        if(!wanted) {
+            continue;
+        }
+
+        for(size_t i = 0; (impl = riscvcrypto_impl_at(alg -> alg, i)); i ++) {
+            if(!speed_listed(impls, impl) ||
+               riscvcrypto_use(alg -> alg, impl) != 0) {
+                continue;
+            }
+            alg -> setup(&ctx);
+
+            for(size_t s = 0; s < sizeof(speed_sizes) / sizeof(size_t); s++) {
+                size_t   len = speed_sizes[s];
+                uint64_t ops, cycles, ns;
+                speed_time(&ctx, alg, len, budget, &ops, &cycles, &ns);
+
+                printf("%-16s %-30s %6lu %14.1f %12.4f\n", alg -> name, impl,
+                    (unsigned long)len, ns ? ops * 1e9 / ns : 0.0,
+                    cycles ? (double)ops * len / cycles : 0.0);
+                fflush(stdout);
+                rows ++;
+            }
+        }
+        riscvcrypto_set_caps(caps);
+    }
+
+    if(rows == 0) {
+        printf(TOOL ": nothing to time\n");
+        return 1;
+    }
+    return 0;
+}
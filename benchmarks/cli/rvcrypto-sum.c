@@ -0,0 +1,191 @@
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "riscvcrypto/sha256/api_sha256.h"
+#include "riscvcrypto/sha512/api_sha512.h"
+#include "riscvcrypto/sm3/api_sm3.h"
+
+#include "riscvcrypto/libriscvcrypto/api_riscvcrypto.h"
+#include "riscvcrypto/parallel/api_parallel.h"
+#include "riscvcrypto/cli/cli_util.h"
+
+//
+// rvcrypto-sum: hashes files the way sha256sum does, printing
+// "<digest>  <file>" for each, and how long each took on stderr.
+//
+// With -t (or -l) the file is instead hashed as a two level tree over the
+// threads of a parallel engine (see parallel_sha256_tree). The digest then
+// depends on the leaf length, and is not the SHA-256 of the file.
+//
+
+#define TOOL "rvcrypto-sum"
+
+typedef enum {SUM_SHA256, SUM_SHA512, SUM_SM3} sum_alg;
+
+static const struct {
+    const char     * name;
+    sum_alg          alg;
+    size_t           digest_bytes;
+    riscvcrypto_alg  rvc;
+} sum_algs[] = {
+    {"sha256", SUM_SHA256, 32, RISCVCRYPTO_SHA256},
+    {"sha512", SUM_SHA512, 64, RISCVCRYPTO_SHA512},
+    {"sm3"   , SUM_SM3   , 32, RISCVCRYPTO_SM3   },
+};
+
+static void usage() {
+    fprintf(stderr,
+        "usage: " TOOL " [-a sha256|sha512|sm3] [-t threads] [-l leaf] [-q] "
+        "[file ...]\n"
+        "  -a  hash algorithm, sha256 by default\n"
+        "  -t  tree hash over this many threads, 0 for one per CPU\n"
+        "  -l  tree hash leaf length in bytes, %d by default\n"
+        "  -q  do not report throughput\n"
+        "With no file, or when file is -, read standard input.\n",
+        PARALLEL_LEAF_BYTES);
+    exit(2);
+}
+
+//! Hashes one input. Returns 0, or -1 if the tree hash failed.
+static int sum_hash(
+    uint8_t           * digest,
+    sum_alg             alg   ,
+    parallel_engine   * engine,
+    size_t              leaf  ,
+    const cli_input   * in
+) {
+    if(engine != NULL) {
+        return alg == SUM_SM3 ?
+            parallel_sm3_tree   (engine, digest, in -> data, in -> len, leaf) :
+            parallel_sha256_tree(engine, digest, in -> data, in -> len, leaf);
+    }
+    switch(alg) {
+        case SUM_SHA256:
+            sha256_hash((uint32_t*)digest, in -> data, in -> len);
+            break;
+        case SUM_SHA512:
+            sha512_hash((uint64_t*)digest, in -> data, in -> len);
+            break;
+        case SUM_SM3:
+            sm3_hash(digest, in -> data, in -> len);
+            break;
+    }
+    return 0;
+}
+
+int main(int argc, char ** argv) {
+
+    size_t   a       = 0;
+    int      tree    = 0;
+    unsigned threads = 1;
+    size_t   leaf    = 0;
+    int      quiet   = 0;
+    int      opt;
+
+    while((opt = getopt(argc, argv, "a:t:l:q")) != -1) {
+        switch(opt) {
+            case 'a':
+                for(a = 0; a < sizeof(sum_algs) / sizeof(sum_algs[0]); a ++) {
+                    if(!strcmp(optarg, sum_algs[a].name)) {
+                        break;
+                    }
+                }
+                if(a == sizeof(sum_algs) / sizeof(sum_algs[0])) {
+                    usage();
+                }
+                break;
+            case 't':
+                tree    = 1;
+                threads = strtoul(optarg, NULL, 0);
+                break;
+            case 'l':
+                tree    = 1;
+                leaf    = strtoul(optarg, NULL, 0);
+                break;
+            case 'q':
+                quiet   = 1;
+                break;
+            default:
+                usage();
+        }
+    }
+
+    if(tree && sum_algs[a].alg == SUM_SHA512) {
+        fprintf(stderr, TOOL ": there is no sha512 tree hash\n");
+        return 2;
+    }
+
+    // Digests are written over the uint32_t / uint64_t state arrays.
+    uint64_t          digest[8];
+    uint8_t         * d      = (uint8_t*)digest;
+    parallel_engine * engine = NULL;
+    const char      * impl   = riscvcrypto_impl(sum_algs[a].rvc);
+    char              op[32];
+    int               rc     = 0;
+
+    if(tree) {
+        parallel_config cfg = {threads, 0, 0};
+        engine = parallel_engine_new(&cfg);
+        if(engine == NULL) {
+            fprintf(stderr, TOOL ": could not start %u threads\n", threads);
+            return 1;
+        }
+        threads = parallel_engine_threads(engine);
+        snprintf(op, sizeof(op), "%s tree", sum_algs[a].name);
+    } else {
+        snprintf(op, sizeof(op), "%s", sum_algs[a].name);
+    }
+
+    const char * stdin_only[] = {"-"};
+    const char * const * files = optind < argc ?
+        (const char * const *)argv + optind : stdin_only;
+    int          nfiles = optind < argc ? argc - optind : 1;
+    size_t       total  = 0;
+    uint64_t     all_ns = 0;
+
+    for(int f = 0; f < nfiles; f ++) {
+        cli_input in;
+        uint64_t  start = cli_now_ns();
+
+        if(cli_input_open(&in, files[f]) < 0) {
+            fprintf(stderr, TOOL ": %s: %s\n", files[f], strerror(errno));
+            rc = 1;
+            continue;
+        }
+        size_t    len    = in.len;
+        int       failed = sum_hash(d, sum_algs[a].alg, engine, leaf, &in);
+        cli_input_close(&in);
+        uint64_t ns = cli_now_ns() - start;
+
+        if(failed) {
+            fprintf(stderr, TOOL ": %s: out of memory\n", files[f]);
+            rc = 1;
+            continue;
+        }
+        for(size_t i = 0; i < sum_algs[a].digest_bytes; i ++) {
+            printf("%02x", d[i]);
+        }
+        printf("  %s\n", files[f]);
+
+        if(!quiet) {
+            cli_report(TOOL, files[f], op, impl, threads, len, ns);
+        }
+        total  += len;
+        all_ns += ns;
+    }
+
+    if(!quiet && nfiles > 1) {
+        cli_report(TOOL, "total", op, impl, threads, total, all_ns);
+    }
+
+    if(engine != NULL) {
+        parallel_engine_free(engine);
+    }
+    return rc;
+}
@@ -9,15 +9,103 @@ include config/$(CONFIG).conf
 
 SPIKE   = $(RISCV)/bin/spike
 
-BUILD_DIR = $(REPO_BUILD)/benchmarks/$(CONFIG)
+# bash, so that recipes piping a run into a tool can "set -o pipefail" and
+# fail when the run does.
+SHELL   = /bin/bash
+
+# Command which runs a test executable. Host configs set this empty.
+RUN_ELF?= $(SPIKE) --isa=$(CONF_ARCH_SPIKE) $(PK)
+
+# Seed of the test input generator (see test_init in share/test.h). Set it
+# to replay the inputs of an earlier run, e.g. TEST_SEED=0x1234.
+TEST_SEED ?=
+TEST_ARGS  = $(if $(TEST_SEED),--seed $(TEST_SEED))
+
+#
+# Build variants, for trading code size against speed. VARIANT=os builds
+# everything with -Os, VARIANT=unroll adds -funroll-loops. A variant is
+# built into its own $(BUILD_DIR), named <config>-<variant>, so results of
+# the variants of a config can be told apart. Hand written assembly
+# kernels are the same in every variant.
+VARIANT                ?= default
+VARIANT_CFLAGS_default  =
+VARIANT_CFLAGS_os       = -Os
+VARIANT_CFLAGS_unroll   = -funroll-loops
+
+ifeq ($(origin VARIANT_CFLAGS_$(VARIANT)),undefined)
+    $(error Unknown VARIANT '$(VARIANT)', expected one of default os unroll)
+endif
+
+VARIANT_SUFFIX = $(if $(filter-out default,$(VARIANT)),-$(VARIANT))
+
+BUILD_DIR = $(REPO_BUILD)/benchmarks/$(CONFIG)$(VARIANT_SUFFIX)
 
 CFLAGS  += -Wall
 CFLAGS  += -I$(BUILD_DIR)/include
 CFLAGS  += -I$(BUILD_DIR)/include/riscvcrypto/share
 CFLAGS  += $(CONF_CFLAGS)
+CFLAGS  += $(VARIANT_CFLAGS_$(VARIANT))
 
 TEST_SRC = $(REPO_HOME)/benchmarks/share/test.c
 
+SWEEP_SRC = $(REPO_HOME)/benchmarks/share/sweep.c
+
+CT_SRC    = $(REPO_HOME)/benchmarks/share/ct.c
+
+RESULTS   = python3 $(REPO_HOME)/benchmarks/tools/results.py
+
+MATRIX    = python3 $(REPO_HOME)/benchmarks/tools/matrix.py
+
+PARETO    = python3 $(REPO_HOME)/benchmarks/tools/pareto.py
+
+empty    :=
+space    := $(empty) $(empty)
+
+INSNMIX   = python3 $(REPO_HOME)/benchmarks/tools/insnmix.py
+
+PIPELINE  = python3 $(REPO_HOME)/benchmarks/tools/pipeline.py
+
+# Latencies and issue width used by the pipe-test-* estimates.
+PIPELINE_CONFIG   ?= $(REPO_HOME)/benchmarks/pipeline/rtl-inorder.cfg
+
+#
+# Spike --ic/--dc cache geometries, as <sets>:<ways>:<block bytes>, which
+# the cache-test-* targets run each test with. The same geometry is used
+# for both caches. The default sweeps 2-way caches from 1 to 16 KiB.
+CACHE_GEOMETRIES  ?= 16:2:32 32:2:32 64:2:32 128:2:32 256:2:32
+CACHE_MISS_PENALTY?= 20
+
+#
+# QEMU user mode runner, used by the qemu-test-* and qemu-sweep-* targets.
+# tools/qemu/roi.c is built for the host into QEMU_PLUGIN, and makes
+# rdinstret read the guest instruction count. Sweeps under QEMU run up to
+# QEMU_SWEEP_MAX_BYTES long inputs.
+QEMU                ?= qemu-riscv$(XLEN)
+QEMU_CPU            ?= max
+QEMU_PLUGIN_CC      ?= cc
+QEMU_PLUGIN_CFLAGS  ?= -O2 -Wall $(shell pkg-config --cflags glib-2.0)
+QEMU_PLUGIN          = $(REPO_BUILD)/benchmarks/qemu/libroi.so
+QEMU_RUN             = $(QEMU) -cpu $(QEMU_CPU) -plugin $(QEMU_PLUGIN)
+QEMU_SWEEP_MAX_BYTES?= 67108864
+
+#
+# POSIX threads, for the parallel engine (parallel/). On for host configs.
+# Set PTHREAD=1 to build it with a Linux (rather than newlib) toolchain,
+# for running under QEMU user mode. SCALE_THREADS lists the thread counts
+# the scale-* targets try, or is empty for 1, 2, 4 ... up to the number
+# of online CPUs.
+PTHREAD             ?= $(HOST)
+PTHREAD_LDFLAGS      = -pthread
+SCALE_THREADS       ?=
+
+#
+# Checked in instret baseline for this config, and the regression in percent
+# which "make check" allows against it.
+BASELINE_FILE        = $(REPO_HOME)/benchmarks/baseline/$(CONFIG)$(VARIANT_SUFFIX).csv
+REGRESSION_THRESHOLD?= 1
+# Set to 1 to pass results which have no baseline entry yet.
+REGRESSION_ALLOW_NEW?= 0
+
 #
 # 1. Relative header file path, as found by running "find"
 define map_header
@@ -63,6 +151,34 @@ define map_run_py
 $(BUILD_DIR)/log/${1:%.c=%-${2}.py}
 endef
 
+#
+# 1. Input file name
+# 2. Optional distinguisher
+define map_prof
+$(BUILD_DIR)/prof/${1:%.c=%-${2}.txt}
+endef
+
+#
+# 1. Input file name
+# 2. Optional distinguisher
+define map_cache
+$(BUILD_DIR)/cache/${1:%.c=%-${2}.log}
+endef
+
+#
+# 1. Input file name
+# 2. Optional distinguisher
+define map_pipe
+$(BUILD_DIR)/pipe/${1:%.c=%-${2}.txt}
+endef
+
+#
+# 1. Input file name
+# 2. Optional distinguisher
+define map_qemu_py
+$(BUILD_DIR)/qemu/${1:%.c=%-${2}.py}
+endef
+
 #
 # 1. Relative header file path, as found by running "find"
 define add_header_target
@@ -78,7 +194,7 @@ endef
 # 1. Input file
 define add_obj_target
 
-$(call map_obj,${1}) : ${1} headers
+$(call map_obj,${1}) : ${1} $(HEADERS_OUT)
 	@mkdir -p $(dir $(call map_obj,${1}))
 	$(CC) $(CFLAGS) -c -o $${@} $${<}
 
@@ -115,11 +231,50 @@ BUILDTARGETS += build-lib-${1}
 
 endef
 
+#
+# 1. Implementation name
+# 2. Input file name
+define map_rvc_obj
+$(BUILD_DIR)/obj/libriscvcrypto/${1}/${2:%.c=%.o}
+endef
+
+#
+# Builds one input file of an implementation again for libriscvcrypto,
+# with each of the given symbols renamed to <implementation>__<symbol>.
+# Assembly goes through the preprocessor too, so this works for .S files.
+#
+# 1. Implementation name, e.g. aes_reference
+# 2. Input file
+# 3. Symbols to rename
+define add_rvc_obj_target
+
+$(call map_rvc_obj,${1},${2:%.S=%.o}) : ${2} $(HEADERS_OUT)
+	@mkdir -p $(dir $(call map_rvc_obj,${1},${2}))
+	$(CC) $(CFLAGS) $(foreach SYM,${3},-D${SYM}=${1}__${SYM}) -c -o $${@} $${<}
+
+RVC_OBJS += $(call map_rvc_obj,${1},${2:%.S=%.o})
+endef
+
+#
+# Adds an implementation to libriscvcrypto, unless it has no input files
+# (i.e. is not built for this config). See libriscvcrypto/Makefile.in.
+#
+# 1. Implementation name, e.g. aes_reference
+# 2. Input files
+# 3. Symbols to rename
+define add_rvc_impl
+
+$(foreach INFILE,$(filter %.c %.S,${2}),$(call add_rvc_obj_target,${1},${INFILE},${3}))
+
+RVC_IMPLS += $(if $(strip ${2}),${1})
+endef
+
 
 #
 # 1. Source Files
 # 2. Libraries and extra source files.
 # 3. Test executable name.
+# 4. Optional extra link flags, e.g. $(PTHREAD_LDFLAGS)
 define add_test_elf_target
 
 $(call map_elf,${1},${3}) : ${1} $(TEST_SRC) $(foreach LIB,${2},$(call map_lib,${LIB}))
@@ -127,7 +282,7 @@ $(call map_elf,${1},${3}) : ${1} $(TEST_SRC) $(foreach LIB,${2},$(call map_lib,$
 	$(CC) $(CFLAGS) -DTEST_NAME=${3} -o $${@} \
         ${1} \
         $(TEST_SRC) \
-        $(foreach LIB,${2},$(call map_lib,${LIB}))
+        $(foreach LIB,${2},$(call map_lib,${LIB})) ${4}
 
 $(call map_dis,${1},${3}) : $(call map_elf,${1},${3})
 	@mkdir -p $(dir $(call map_dis,${1},${3}))
@@ -135,7 +290,7 @@ $(call map_dis,${1},${3}) : $(call map_elf,${1},${3})
 
 $(call map_run_py,${1},-${3}) : $(call map_elf,${1},${3})
 	@mkdir -p $(dir $(call map_run_py,${1},${3}))
-	$(SPIKE) --isa=$(CONF_ARCH_SPIKE) $(PK) $(call map_elf,${1},${3}) > $${@}
+	$(RUN_ELF) $(call map_elf,${1},${3}) $$(TEST_ARGS) > $${@}
 	sed -i "s/^bbl loader/#/" $${@}
 
 TARGETS += $(call map_elf,${1},${3})
@@ -146,9 +301,233 @@ run-test-${3}   : $(call map_run_py,${1},-${3})
 
 RUNTARGETS += run-test-${3}
 
+RUNMATRIX  += run-test-${3},$(call map_elf,${1},${3}),$(call map_run_py,${1},-${3})
+
+TESTLIBS   += ${3},$(subst $(space),:,$(strip $(foreach LIB,${2},$(call map_lib,${LIB}))))
+
+TEST_LOGS  += $(call map_run_py,${1},-${3})
+
+ifneq ($(HOST),1)
+check-test-${3} : $(call map_run_py,${1},-${3})
+	$(RESULTS) check --test ${3} --threshold $(REGRESSION_THRESHOLD) \
+        $(if $(filter 1,$(REGRESSION_ALLOW_NEW)),--allow-new) \
+        --baseline $(BASELINE_FILE) $${^}
+
+CHECKTARGETS += check-test-${3}
+endif
+
+#
+# Instruction mix profile. Spike only: the -l trace goes to stderr, the
+# test output is discarded.
+$(call map_prof,${1},-${3}) : $(call map_elf,${1},${3})
+	@mkdir -p $(dir $(call map_prof,${1},${3}))
+	$(OBJDUMP) -t $(call map_elf,${1},${3}) > $${@}.syms
+	set -o pipefail; \
+    $(SPIKE) -l --isa=$(CONF_ARCH_SPIKE) $(PK) $(call map_elf,${1},${3}) \
+        2>&1 >/dev/null | $(INSNMIX) --name ${3} --xlen $(XLEN) \
+        --symbols $${@}.syms --opcodes $(REPO_HOME)/tools -o $${@} \
+        || { rm -f $${@}; exit 1; }
+
+prof-test-${3}  : $(call map_prof,${1},-${3})
+	cat $${^}
+
+PROFTARGETS += prof-test-${3}
+
+#
+# Cache model runs, one per CACHE_GEOMETRIES entry, appended to one log.
+# Spike only.
+$(call map_cache,${1},-${3}) : $(call map_elf,${1},${3})
+	@mkdir -p $(dir $(call map_cache,${1},${3}))
+	rm -f $${@}
+	for G in $(CACHE_GEOMETRIES) ; do \
+        echo "#!cache-geometry $$$$G" >> $${@} ; \
+        $(SPIKE) --isa=$(CONF_ARCH_SPIKE) --ic=$$$$G --dc=$$$$G $(PK) \
+            $(call map_elf,${1},${3}) >> $${@} || exit 1 ; \
+    done
+
+cache-test-${3} : $(call map_cache,${1},-${3})
+	$(RESULTS) cache --miss-penalty $(CACHE_MISS_PENALTY) $${^}
+
+CACHETARGETS += cache-test-${3}
+CACHE_LOGS   += $(call map_cache,${1},-${3})
+
+#
+# In-order pipeline estimate, from the same trace as the profile. Spike only.
+$(call map_pipe,${1},-${3}) : $(call map_elf,${1},${3}) $(PIPELINE_CONFIG)
+	@mkdir -p $(dir $(call map_pipe,${1},${3}))
+	$(OBJDUMP) -t $(call map_elf,${1},${3}) > $${@}.syms
+	set -o pipefail; \
+    $(SPIKE) -l --isa=$(CONF_ARCH_SPIKE) $(PK) $(call map_elf,${1},${3}) \
+        2>&1 >/dev/null | $(PIPELINE) estimate --name ${3} --xlen $(XLEN) \
+        --config $(PIPELINE_CONFIG) --symbols $${@}.syms \
+        --opcodes $(REPO_HOME)/tools -o $${@} \
+        || { rm -f $${@}; exit 1; }
+
+pipe-test-${3}  : $(call map_pipe,${1},-${3})
+	cat $${^}
+
+PIPETARGETS  += pipe-test-${3}
+PIPE_REPORTS += $(call map_pipe,${1},-${3})
+
+$(call map_qemu_py,${1},-${3}) : $(call map_elf,${1},${3}) $(QEMU_PLUGIN)
+	@mkdir -p $(dir $(call map_qemu_py,${1},${3}))
+	$(QEMU_RUN) $(call map_elf,${1},${3}) $$(TEST_ARGS) > $${@}
+
+qemu-test-${3}  : $(call map_qemu_py,${1},-${3})
+	python3 $${<}
+
+QEMUTARGETS += qemu-test-${3}
+
 build-test-${3} : $(call map_dis,${1},${3}) $(call map_elf,${1},${3})
 
 BUILDTARGETS += build-test-${3}
 
 endef
 
+
+#
+# Throughput sweep programs. Like add_test_elf_target, but also linked
+# against the sweep harness, and run by "make sweep" rather than "make run".
+#
+# 1. Source Files
+# 2. Libraries and extra source files.
+# 3. Sweep executable name.
+define add_sweep_elf_target
+
+$(call map_elf,${1},${3}) : ${1} $(TEST_SRC) $(SWEEP_SRC) $(foreach LIB,${2},$(call map_lib,${LIB}))
+	@mkdir -p $(dir $(call map_elf,${1},${3}))
+	$(CC) $(CFLAGS) -DTEST_NAME=${3} -o $${@} \
+        ${1} \
+        $(TEST_SRC) \
+        $(SWEEP_SRC) \
+        $(foreach LIB,${2},$(call map_lib,${LIB}))
+
+$(call map_run_py,${1},-${3}) : $(call map_elf,${1},${3})
+	@mkdir -p $(dir $(call map_run_py,${1},${3}))
+	$(RUN_ELF) $(call map_elf,${1},${3}) $$(TEST_ARGS) > $${@}
+	sed -i "s/^bbl loader/#/" $${@}
+
+TARGETS += $(call map_elf,${1},${3})
+
+run-sweep-${3}  : $(call map_run_py,${1},-${3})
+	python3 $${^}
+
+SWEEPTARGETS += run-sweep-${3}
+
+$(call map_qemu_py,${1},-${3}) : $(call map_elf,${1},${3}) $(QEMU_PLUGIN)
+	@mkdir -p $(dir $(call map_qemu_py,${1},${3}))
+	TEST_SWEEP_MAX_BYTES=$(QEMU_SWEEP_MAX_BYTES) \
+        $(QEMU_RUN) $(call map_elf,${1},${3}) $$(TEST_ARGS) > $${@}
+
+qemu-sweep-${3} : $(call map_qemu_py,${1},-${3})
+	python3 $${<}
+
+QEMUSWEEPTARGETS += qemu-sweep-${3}
+
+build-sweep-${3} : $(call map_elf,${1},${3})
+
+BUILDTARGETS += build-sweep-${3}
+
+endef
+
+
+#
+# Constant time checks. Like add_sweep_elf_target, but linked against the
+# harness in share/ct.h, and run by "make ct".
+#
+# 1. Source Files
+# 2. Libraries and extra source files.
+# 3. Check executable name.
+define add_ct_elf_target
+
+$(call map_elf,${1},${3}) : ${1} $(TEST_SRC) $(CT_SRC) $(foreach LIB,${2},$(call map_lib,${LIB}))
+	@mkdir -p $(dir $(call map_elf,${1},${3}))
+	$(CC) $(CFLAGS) -DTEST_NAME=${3} -o $${@} \
+        ${1} \
+        $(TEST_SRC) \
+        $(CT_SRC) \
+        $(foreach LIB,${2},$(call map_lib,${LIB})) -lm
+
+$(call map_run_py,${1},-${3}) : $(call map_elf,${1},${3})
+	@mkdir -p $(dir $(call map_run_py,${1},${3}))
+	$(RUN_ELF) $(call map_elf,${1},${3}) $$(TEST_ARGS) > $${@}
+	sed -i "s/^bbl loader/#/" $${@}
+
+TARGETS += $(call map_elf,${1},${3})
+
+run-ct-${3}     : $(call map_run_py,${1},-${3})
+	python3 $${^}
+
+CTTARGETS += run-ct-${3}
+CT_LOGS   += $(call map_run_py,${1},-${3})
+
+build-ct-${3} : $(call map_elf,${1},${3})
+
+BUILDTARGETS += build-ct-${3}
+
+endef
+
+#
+# Thread scaling benchmarks. Like add_sweep_elf_target, but linked with
+# POSIX threads, and run natively (or under QEMU user mode) by "make scale"
+# since Spike's proxy kernel has no threads.
+#
+# 1. Source Files
+# 2. Libraries and extra source files.
+# 3. Benchmark executable name.
+define add_scale_elf_target
+
+$(call map_elf,${1},${3}) : ${1} $(TEST_SRC) $(foreach LIB,${2},$(call map_lib,${LIB}))
+	@mkdir -p $(dir $(call map_elf,${1},${3}))
+	$(CC) $(CFLAGS) -DTEST_NAME=${3} -o $${@} \
+        ${1} \
+        $(TEST_SRC) \
+        $(foreach LIB,${2},$(call map_lib,${LIB})) $(PTHREAD_LDFLAGS)
+
+TARGETS += $(call map_elf,${1},${3})
+
+run-scale-${3}  : $(call map_elf,${1},${3})
+	@mkdir -p $(dir $(call map_run_py,${1},-${3}))
+	$(call map_elf,${1},${3}) $(SCALE_THREADS) $$(TEST_ARGS) \
+        > $(call map_run_py,${1},-${3})
+	python3 $(call map_run_py,${1},-${3})
+
+SCALETARGETS += run-scale-${3}
+
+qemu-scale-${3} : $(call map_elf,${1},${3})
+	@mkdir -p $(dir $(call map_qemu_py,${1},${3}))
+	$(QEMU) -cpu $(QEMU_CPU) $(call map_elf,${1},${3}) $(SCALE_THREADS) \
+        $$(TEST_ARGS) > $(call map_qemu_py,${1},-${3})
+	python3 $(call map_qemu_py,${1},-${3})
+
+QEMUSCALETARGETS += qemu-scale-${3}
+
+build-scale-${3} : $(call map_elf,${1},${3})
+
+BUILDTARGETS += build-scale-${3}
+
+endef
+
+#
+# Command line tools. Built into $(BUILD_DIR)/bin under their own name, and
+# by "make cli".
+#
+# 1. Source Files
+# 2. Libraries
+# 3. Tool name.
+# 4. Optional extra link flags, e.g. $(PTHREAD_LDFLAGS)
+define add_cli_target
+
+$(BUILD_DIR)/bin/${3} : ${1} $(foreach LIB,${2},$(call map_lib,${LIB}))
+	@mkdir -p $(BUILD_DIR)/bin
+	$(CC) $(CFLAGS) -o $${@} ${1} \
+        $(foreach LIB,${2},$(call map_lib,${LIB})) ${4}
+
+TARGETS += $(BUILD_DIR)/bin/${3}
+
+build-cli-${3} : $(BUILD_DIR)/bin/${3}
+
+BUILDTARGETS += build-cli-${3}
+CLITARGETS   += build-cli-${3}
+
+endef
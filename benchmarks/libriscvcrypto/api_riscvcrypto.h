@@ -0,0 +1,105 @@
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+@defgroup libriscvcrypto libriscvcrypto
+@{
+@details One library holding every implementation a config builds. It
+    defines the usual API of each algorithm (api_aes.h, api_sha256.h etc),
+    and calls through to the first implementation in that algorithm's
+    preference order whose extensions the running hart has.
+
+    The extensions are found once, before main where the toolchain allows:
+
+    - On Linux, with the riscv_hwprobe system call, or failing that from
+      the "isa" lines of /proc/cpuinfo.
+    - Elsewhere (e.g. under pk), RISCVCRYPTO_ASSUME_CAPS are assumed. The
+      Makefile sets this to RISCVCRYPTO_ALL for zscrypto configs. Otherwise
+      it comes from the __riscv_zk* macros of the compiler.
+
+    Either way, the RISCVCRYPTO_CAPS environment variable overrides them. It
+    is an ISA string, or a list of extensions joined by '_', e.g.
+    "zkne_zknd" or "rv64gc_zkn". "none" leaves only the portable kernels.
+*/
+
+#ifndef __API_RISCVCRYPTO_H__
+#define __API_RISCVCRYPTO_H__
+
+//! Scalar crypto extensions, as a bit mask.
+#define RISCVCRYPTO_ZBKB    (1 << 0)
+#define RISCVCRYPTO_ZBKC    (1 << 1)
+#define RISCVCRYPTO_ZBKX    (1 << 2)
+#define RISCVCRYPTO_ZKNE    (1 << 3)
+#define RISCVCRYPTO_ZKND    (1 << 4)
+#define RISCVCRYPTO_ZKNH    (1 << 5)
+#define RISCVCRYPTO_ZKSED   (1 << 6)
+#define RISCVCRYPTO_ZKSH    (1 << 7)
+
+//! The NIST suite.
+#define RISCVCRYPTO_ZKN     (RISCVCRYPTO_ZBKB  | RISCVCRYPTO_ZBKC | \
+                             RISCVCRYPTO_ZBKX  | RISCVCRYPTO_ZKNE | \
+                             RISCVCRYPTO_ZKND  | RISCVCRYPTO_ZKNH )
+
+//! The ShangMi suite.
+#define RISCVCRYPTO_ZKS     (RISCVCRYPTO_ZBKB  | RISCVCRYPTO_ZBKC | \
+                             RISCVCRYPTO_ZBKX  | RISCVCRYPTO_ZKSED| \
+                             RISCVCRYPTO_ZKSH  )
+
+#define RISCVCRYPTO_ALL     (RISCVCRYPTO_ZKN | RISCVCRYPTO_ZKS)
+
+//! Algorithms which riscvcrypto_impl reports on.
+typedef enum {
+    RISCVCRYPTO_AES     = 0,
+    RISCVCRYPTO_SM4     = 1,
+    RISCVCRYPTO_SHA256  = 2,
+    RISCVCRYPTO_SHA512  = 3,
+    RISCVCRYPTO_SHA3    = 4,
+    RISCVCRYPTO_SM3     = 5,
+    RISCVCRYPTO_ALGS    = 6
+} riscvcrypto_alg;
+
+/*!
+@brief The extensions found on the running hart, or set with
+    riscvcrypto_set_caps.
+*/
+uint32_t    riscvcrypto_caps();
+
+/*!
+@brief Binds every algorithm again, as if the hart had exactly the given
+    extensions. Extensions it does not have must not be given.
+@details Key schedules made before the call may not be in the format of
+    the newly bound implementation, so must be made again.
+*/
+void        riscvcrypto_set_caps(uint32_t caps);
+
+/*!
+@brief Name of the implementation an algorithm is bound to, e.g.
+    "aes_zscrypto_rv64" or "sha256_reference".
+*/
+const char* riscvcrypto_impl(riscvcrypto_alg alg);
+
+/*!
+@brief Name of the i'th implementation of an algorithm the library was
+    built with, fastest first, or NULL once i is past the last one.
+*/
+const char* riscvcrypto_impl_at(riscvcrypto_alg alg, size_t i);
+
+/*!
+@brief Binds one algorithm to the named implementation, e.g. to compare
+    implementations in one program. riscvcrypto_set_caps undoes this.
+@details As with riscvcrypto_set_caps, key schedules must be made again.
+@returns 0, or -1 if the library has no such implementation, or it needs
+    extensions riscvcrypto_caps does not have.
+*/
+int         riscvcrypto_use(riscvcrypto_alg alg, const char * name);
+
+/*!
+@brief Parses an ISA string, or a list of extensions joined by '_', into
+    a RISCVCRYPTO_* mask. Unknown extensions are ignored.
+*/
+uint32_t    riscvcrypto_parse_isa(const char * isa);
+
+#endif
+
+//! @}
@@ -0,0 +1,686 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "riscvcrypto/aes/api_aes.h"
+#include "riscvcrypto/aes/api_aes_modes.h"
+#include "riscvcrypto/sm4/api_sm4.h"
+#include "riscvcrypto/sha256/api_sha256.h"
+#include "riscvcrypto/sha512/api_sha512.h"
+#include "riscvcrypto/sha3/Keccak.h"
+#include "riscvcrypto/sm3/api_sm3.h"
+
+#include "riscvcrypto/libriscvcrypto/api_riscvcrypto.h"
+
+#if defined(__linux__) && defined(__riscv)
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+/*!
+@addtogroup libriscvcrypto
+@{
+*/
+
+//
+// Extensions the compiler was told the target has. These are always safe
+// to assume, and are all that is known when nothing can be probed.
+//
+
+#if defined(__riscv_zbkb)
+#define RVC_TARGET_ZBKB     RISCVCRYPTO_ZBKB
+#else
+#define RVC_TARGET_ZBKB     0
+#endif
+
+#if defined(__riscv_zbkc)
+#define RVC_TARGET_ZBKC     RISCVCRYPTO_ZBKC
+#else
+#define RVC_TARGET_ZBKC     0
+#endif
+
+#if defined(__riscv_zbkx)
+#define RVC_TARGET_ZBKX     RISCVCRYPTO_ZBKX
+#else
+#define RVC_TARGET_ZBKX     0
+#endif
+
+#if defined(__riscv_zkne)
+#define RVC_TARGET_ZKNE     RISCVCRYPTO_ZKNE
+#else
+#define RVC_TARGET_ZKNE     0
+#endif
+
+#if defined(__riscv_zknd)
+#define RVC_TARGET_ZKND     RISCVCRYPTO_ZKND
+#else
+#define RVC_TARGET_ZKND     0
+#endif
+
+#if defined(__riscv_zknh)
+#define RVC_TARGET_ZKNH     RISCVCRYPTO_ZKNH
+#else
+#define RVC_TARGET_ZKNH     0
+#endif
+
+#if defined(__riscv_zksed)
+#define RVC_TARGET_ZKSED    RISCVCRYPTO_ZKSED
+#else
+#define RVC_TARGET_ZKSED    0
+#endif
+
+#if defined(__riscv_zksh)
+#define RVC_TARGET_ZKSH     RISCVCRYPTO_ZKSH
+#else
+#define RVC_TARGET_ZKSH     0
+#endif
+
+#define RVC_TARGET_CAPS (RVC_TARGET_ZBKB | RVC_TARGET_ZBKC  | \
+                         RVC_TARGET_ZBKX | RVC_TARGET_ZKNE  | \
+                         RVC_TARGET_ZKND | RVC_TARGET_ZKNH  | \
+                         RVC_TARGET_ZKSED| RVC_TARGET_ZKSH  )
+
+//! What to assume where nothing can be probed, i.e. not on Linux.
+#ifndef RISCVCRYPTO_ASSUME_CAPS
+#define RISCVCRYPTO_ASSUME_CAPS RVC_TARGET_CAPS
+#endif
+
+//! Name an implementation's copy of a symbol was renamed to by the Makefile.
+#define RVC_SYM(IMPL, SYM) IMPL ## __ ## SYM
+
+//! Common to the implementation descriptions of every algorithm.
+typedef struct {
+    const char * name;  //!< Implementation name, e.g. aes_ttable.
+    uint32_t     caps;  //!< Extensions it needs, as RISCVCRYPTO_* bits.
+} rvc_impl;
+
+//
+// AES
+//
+
+typedef void (*rvc_aes_ks_fn)(uint32_t * const rk, uint8_t * const ck);
+
+typedef void (*rvc_aes_ecb_fn)(
+    uint8_t out[AES_BLOCK_BYTES], uint8_t in[AES_BLOCK_BYTES], uint32_t * rk);
+
+typedef void (*rvc_aes_x2_fn)(
+    uint8_t ct0[AES_BLOCK_BYTES], uint8_t pt0[AES_BLOCK_BYTES],
+    uint8_t ct1[AES_BLOCK_BYTES], uint8_t pt1[AES_BLOCK_BYTES], uint32_t * rk);
+
+typedef struct {
+    rvc_impl        impl;
+    rvc_aes_ks_fn   enc_ks    [3];  //!< AES 128, 192 and 256.
+    rvc_aes_ks_fn   dec_ks    [3];
+    rvc_aes_ecb_fn  encrypt   [3];
+    rvc_aes_ecb_fn  decrypt   [3];
+    rvc_aes_x2_fn   encrypt_x2;     //!< NULL unless interleaved.
+} rvc_aes;
+
+#define RVC_DECLARE_AES(IMPL)                                               \
+void RVC_SYM(IMPL,aes_128_enc_key_schedule)(uint32_t * const, uint8_t * const);\
+void RVC_SYM(IMPL,aes_192_enc_key_schedule)(uint32_t * const, uint8_t * const);\
+void RVC_SYM(IMPL,aes_256_enc_key_schedule)(uint32_t * const, uint8_t * const);\
+void RVC_SYM(IMPL,aes_128_dec_key_schedule)(uint32_t * const, uint8_t * const);\
+void RVC_SYM(IMPL,aes_192_dec_key_schedule)(uint32_t * const, uint8_t * const);\
+void RVC_SYM(IMPL,aes_256_dec_key_schedule)(uint32_t * const, uint8_t * const);\
+void RVC_SYM(IMPL,aes_128_ecb_encrypt)(uint8_t *, uint8_t *, uint32_t *);  \
+void RVC_SYM(IMPL,aes_192_ecb_encrypt)(uint8_t *, uint8_t *, uint32_t *);  \
+void RVC_SYM(IMPL,aes_256_ecb_encrypt)(uint8_t *, uint8_t *, uint32_t *);  \
+void RVC_SYM(IMPL,aes_128_ecb_decrypt)(uint8_t *, uint8_t *, uint32_t *);  \
+void RVC_SYM(IMPL,aes_192_ecb_decrypt)(uint8_t *, uint8_t *, uint32_t *);  \
+void RVC_SYM(IMPL,aes_256_ecb_decrypt)(uint8_t *, uint8_t *, uint32_t *);
+
+#define RVC_AES(IMPL, CAPS, X2) {{#IMPL, CAPS},                             \
+    {RVC_SYM(IMPL,aes_128_enc_key_schedule),                                \
+     RVC_SYM(IMPL,aes_192_enc_key_schedule),                                \
+     RVC_SYM(IMPL,aes_256_enc_key_schedule)},                               \
+    {RVC_SYM(IMPL,aes_128_dec_key_schedule),                                \
+     RVC_SYM(IMPL,aes_192_dec_key_schedule),                                \
+     RVC_SYM(IMPL,aes_256_dec_key_schedule)},                               \
+    {RVC_SYM(IMPL,aes_128_ecb_encrypt),                                     \
+     RVC_SYM(IMPL,aes_192_ecb_encrypt),                                     \
+     RVC_SYM(IMPL,aes_256_ecb_encrypt)},                                    \
+    {RVC_SYM(IMPL,aes_128_ecb_decrypt),                                     \
+     RVC_SYM(IMPL,aes_192_ecb_decrypt),                                     \
+     RVC_SYM(IMPL,aes_256_ecb_decrypt)},                                    \
+    X2}
+
+#define RVC_AES_CAPS (RISCVCRYPTO_ZKNE | RISCVCRYPTO_ZKND)
+
+#if defined(RVC_HAVE_aes_zscrypto_rv64)
+RVC_DECLARE_AES(aes_zscrypto_rv64)
+void RVC_SYM(aes_zscrypto_rv64,aes_128_ecb_encrypt_x2)(
+    uint8_t *, uint8_t *, uint8_t *, uint8_t *, uint32_t *);
+#endif
+#if defined(RVC_HAVE_aes_zscrypto_rv64_c)
+RVC_DECLARE_AES(aes_zscrypto_rv64_c)
+#endif
+#if defined(RVC_HAVE_aes_zscrypto_rv32)
+RVC_DECLARE_AES(aes_zscrypto_rv32)
+#endif
+#if defined(RVC_HAVE_aes_zscrypto_rv32_c)
+RVC_DECLARE_AES(aes_zscrypto_rv32_c)
+#endif
+RVC_DECLARE_AES(aes_ttable)
+RVC_DECLARE_AES(aes_reference)
+
+/*!
+@brief AES implementations, fastest first. The last must need nothing.
+@details The T-table implementation is preferred to the reference one for
+    speed, though its table lookups depend on the key and data.
+*/
+static const rvc_aes rvc_aes_impls[] = {
+#if defined(RVC_HAVE_aes_zscrypto_rv64)
+    RVC_AES(aes_zscrypto_rv64  , RVC_AES_CAPS,
+        RVC_SYM(aes_zscrypto_rv64,aes_128_ecb_encrypt_x2)),
+#endif
+#if defined(RVC_HAVE_aes_zscrypto_rv64_c)
+    RVC_AES(aes_zscrypto_rv64_c, RVC_AES_CAPS, NULL),
+#endif
+#if defined(RVC_HAVE_aes_zscrypto_rv32)
+    RVC_AES(aes_zscrypto_rv32  , RVC_AES_CAPS, NULL),
+#endif
+#if defined(RVC_HAVE_aes_zscrypto_rv32_c)
+    RVC_AES(aes_zscrypto_rv32_c, RVC_AES_CAPS, NULL),
+#endif
+    RVC_AES(aes_ttable         , 0           , NULL),
+    RVC_AES(aes_reference      , 0           , NULL)
+};
+
+//
+// SM4
+//
+
+typedef struct {
+    rvc_impl impl;
+    void (*enc_ks )(uint32_t rk[32], uint8_t mk[16]);
+    void (*dec_ks )(uint32_t rk[32], uint8_t mk[16]);
+    void (*enc_dec)(uint8_t out[16], uint8_t in[16], uint32_t rk[32]);
+} rvc_sm4;
+
+#define RVC_DECLARE_SM4(IMPL)                                               \
+void RVC_SYM(IMPL,sm4_key_schedule_enc)(uint32_t *, uint8_t *);             \
+void RVC_SYM(IMPL,sm4_key_schedule_dec)(uint32_t *, uint8_t *);             \
+void RVC_SYM(IMPL,sm4_block_enc_dec)(uint8_t *, uint8_t *, uint32_t *);
+
+#define RVC_SM4(IMPL, CAPS) {{#IMPL, CAPS},                                 \
+    RVC_SYM(IMPL,sm4_key_schedule_enc),                                     \
+    RVC_SYM(IMPL,sm4_key_schedule_dec),                                     \
+    RVC_SYM(IMPL,sm4_block_enc_dec)}
+
+#if defined(RVC_HAVE_sm4_zscrypto)
+RVC_DECLARE_SM4(sm4_zscrypto)
+#endif
+RVC_DECLARE_SM4(sm4_reference)
+
+static const rvc_sm4 rvc_sm4_impls[] = {
+#if defined(RVC_HAVE_sm4_zscrypto)
+    RVC_SM4(sm4_zscrypto , RISCVCRYPTO_ZKSED),
+#endif
+    RVC_SM4(sm4_reference, 0)
+};
+
+//
+// Hashes. These have one entry point each, so share a description.
+//
+
+typedef struct {
+    rvc_impl impl;
+    void   (*hash)();   //!< Cast to the algorithm's own type to call.
+} rvc_hash;
+
+typedef void (*rvc_sha256_fn)(uint32_t H[8], uint8_t * M, size_t len);
+typedef void (*rvc_sha512_fn)(uint64_t H[8], uint8_t * M, size_t len);
+typedef void (*rvc_sm3_fn)(
+    uint8_t hash[32], const uint8_t * message, size_t len);
+typedef void (*rvc_keccak_fn)(
+    unsigned int rate, unsigned int capacity, const unsigned char * input,
+    unsigned long long int inputByteLen, unsigned char delimitedSuffix,
+    unsigned char * output, unsigned long long int outputByteLen);
+
+#define RVC_HASH(IMPL, SYM, CAPS) {{#IMPL, CAPS}, (void(*)())RVC_SYM(IMPL,SYM)}
+
+#if defined(RVC_HAVE_sha256_zscrypto)
+void RVC_SYM(sha256_zscrypto,sha256_hash)(uint32_t *, uint8_t *, size_t);
+#endif
+void RVC_SYM(sha256_reference,sha256_hash)(uint32_t *, uint8_t *, size_t);
+
+static const rvc_hash rvc_sha256_impls[] = {
+#if defined(RVC_HAVE_sha256_zscrypto)
+    RVC_HASH(sha256_zscrypto , sha256_hash, RISCVCRYPTO_ZKNH),
+#endif
+    RVC_HASH(sha256_reference, sha256_hash, 0)
+};
+
+#if defined(RVC_HAVE_sha512_zscrypto_rv64)
+void RVC_SYM(sha512_zscrypto_rv64,sha512_hash)(uint64_t *, uint8_t *, size_t);
+#endif
+#if defined(RVC_HAVE_sha512_zscrypto_rv32)
+void RVC_SYM(sha512_zscrypto_rv32,sha512_hash)(uint64_t *, uint8_t *, size_t);
+#endif
+void RVC_SYM(sha512_reference,sha512_hash)(uint64_t *, uint8_t *, size_t);
+
+static const rvc_hash rvc_sha512_impls[] = {
+#if defined(RVC_HAVE_sha512_zscrypto_rv64)
+    RVC_HASH(sha512_zscrypto_rv64, sha512_hash, RISCVCRYPTO_ZKNH),
+#endif
+#if defined(RVC_HAVE_sha512_zscrypto_rv32)
+    RVC_HASH(sha512_zscrypto_rv32, sha512_hash, RISCVCRYPTO_ZKNH),
+#endif
+    RVC_HASH(sha512_reference    , sha512_hash, 0)
+};
+
+#define RVC_DECLARE_KECCAK(IMPL)                                            \
+void RVC_SYM(IMPL,Keccak)(unsigned int, unsigned int, const unsigned char *,\
+    unsigned long long int, unsigned char, unsigned char *,                 \
+    unsigned long long int);
+
+#if defined(RVC_HAVE_sha3_zscrypto_rv64)
+RVC_DECLARE_KECCAK(sha3_zscrypto_rv64)
+#endif
+RVC_DECLARE_KECCAK(sha3_reference)
+
+static const rvc_hash rvc_sha3_impls[] = {
+#if defined(RVC_HAVE_sha3_zscrypto_rv64)
+    RVC_HASH(sha3_zscrypto_rv64, Keccak, RISCVCRYPTO_ZBKB),
+#endif
+    RVC_HASH(sha3_reference    , Keccak, 0)
+};
+
+#if defined(RVC_HAVE_sm3_zscrypto_rv64)
+void RVC_SYM(sm3_zscrypto_rv64,sm3_hash)(uint8_t *, const uint8_t *, size_t);
+#endif
+#if defined(RVC_HAVE_sm3_zscrypto_rv32)
+void RVC_SYM(sm3_zscrypto_rv32,sm3_hash)(uint8_t *, const uint8_t *, size_t);
+#endif
+void RVC_SYM(sm3_reference,sm3_hash)(uint8_t *, const uint8_t *, size_t);
+
+#define RVC_SM3_CAPS (RISCVCRYPTO_ZKSH | RISCVCRYPTO_ZBKB)
+
+static const rvc_hash rvc_sm3_impls[] = {
+#if defined(RVC_HAVE_sm3_zscrypto_rv64)
+    RVC_HASH(sm3_zscrypto_rv64, sm3_hash, RVC_SM3_CAPS),
+#endif
+#if defined(RVC_HAVE_sm3_zscrypto_rv32)
+    RVC_HASH(sm3_zscrypto_rv32, sm3_hash, RVC_SM3_CAPS),
+#endif
+    RVC_HASH(sm3_reference    , sm3_hash, 0)
+};
+
+//
+// Binding
+//
+
+//! Set once every algorithm is bound.
+static int              rvc_bound   = 0;
+
+static uint32_t         rvc_caps    = 0;
+
+static const rvc_aes  * rvc_aes_bound;
+static const rvc_sm4  * rvc_sm4_bound;
+static const rvc_hash * rvc_sha256_bound;
+static const rvc_hash * rvc_sha512_bound;
+static const rvc_hash * rvc_sha3_bound;
+static const rvc_hash * rvc_sm3_bound;
+
+//! First entry of a table whose extensions are all in caps.
+static const void * rvc_pick(
+    const void * table,
+    size_t       size ,
+    size_t       count,
+    uint32_t     caps
+){
+    const uint8_t * entry = table;
+    for(size_t i = 0; i < count - 1; i ++, entry += size) {
+        const rvc_impl * impl = (const rvc_impl*)entry;
+        if((impl -> caps & caps) == impl -> caps) {
+            break;
+        }
+    }
+    return entry;
+}
+
+#define RVC_PICK(TABLE, CAPS) \
+    rvc_pick(TABLE, sizeof(TABLE[0]), sizeof(TABLE)/sizeof(TABLE[0]), CAPS)
+
+void riscvcrypto_set_caps(uint32_t caps) {
+    rvc_caps         = caps;
+    rvc_aes_bound    = RVC_PICK(rvc_aes_impls   , caps);
+    rvc_sm4_bound    = RVC_PICK(rvc_sm4_impls   , caps);
+    rvc_sha256_bound = RVC_PICK(rvc_sha256_impls, caps);
+    rvc_sha512_bound = RVC_PICK(rvc_sha512_impls, caps);
+    rvc_sha3_bound   = RVC_PICK(rvc_sha3_impls  , caps);
+    rvc_sm3_bound    = RVC_PICK(rvc_sm3_impls   , caps);
+    rvc_bound        = 1;
+}
+
+//! Extension names of ISA strings, and what they imply.
+static const struct {
+    const char * name;
+    uint32_t     caps;
+} rvc_extensions[] = {
+    {"zbkb" , RISCVCRYPTO_ZBKB },
+    {"zbkc" , RISCVCRYPTO_ZBKC },
+    {"zbkx" , RISCVCRYPTO_ZBKX },
+    {"zkne" , RISCVCRYPTO_ZKNE },
+    {"zknd" , RISCVCRYPTO_ZKND },
+    {"zknh" , RISCVCRYPTO_ZKNH },
+    {"zksed", RISCVCRYPTO_ZKSED},
+    {"zksh" , RISCVCRYPTO_ZKSH },
+    {"zkn"  , RISCVCRYPTO_ZKN  },
+    {"zks"  , RISCVCRYPTO_ZKS  },
+    {"zk"   , RISCVCRYPTO_ZKN  },
+};
+
+uint32_t riscvcrypto_parse_isa(const char * isa) {
+    uint32_t caps = 0;
+    while(*isa) {
+        char   ext[16];
+        size_t len = 0;
+        for(; *isa && !strchr("_, \t\n", *isa); isa ++) {
+            if(len < sizeof(ext) - 1) {
+                ext[len ++] = *isa | 0x20;
+            }
+        }
+        ext[len] = '\0';
+        for(size_t i = 0; i < sizeof(rvc_extensions) /
+                              sizeof(rvc_extensions[0]); i ++) {
+            if(strcmp(ext, rvc_extensions[i].name) == 0) {
+                caps |= rvc_extensions[i].caps;
+            }
+        }
+        if(*isa) {
+            isa ++;
+        }
+    }
+    return caps;
+}
+
+#if defined(__linux__) && defined(__riscv)
+
+//
+// riscv_hwprobe, from linux/asm/hwprobe.h. Defined here, so that older
+// kernel headers still build.
+//
+
+#define RVC_HWPROBE_SYSCALL         258
+#define RVC_HWPROBE_KEY_IMA_EXT_0   4
+
+static const struct {
+    uint64_t bit;
+    uint32_t caps;
+} rvc_hwprobe_bits[] = {
+    {1ULL <<  8, RISCVCRYPTO_ZBKB },
+    {1ULL <<  9, RISCVCRYPTO_ZBKC },
+    {1ULL << 10, RISCVCRYPTO_ZBKX },
+    {1ULL << 11, RISCVCRYPTO_ZKND },
+    {1ULL << 12, RISCVCRYPTO_ZKNE },
+    {1ULL << 13, RISCVCRYPTO_ZKNH },
+    {1ULL << 14, RISCVCRYPTO_ZKSED},
+    {1ULL << 15, RISCVCRYPTO_ZKSH },
+};
+
+//! Extensions all harts have, from riscv_hwprobe. Zero if unsupported.
+static uint32_t rvc_probe_hwprobe() {
+    struct {
+        int64_t  key;
+        uint64_t value;
+    } pair = {RVC_HWPROBE_KEY_IMA_EXT_0, 0};
+
+    if(syscall(RVC_HWPROBE_SYSCALL, &pair, 1, 0, NULL, 0) != 0 ||
+       pair.key < 0) {
+        return 0;
+    }
+
+    uint32_t caps = 0;
+    for(size_t i = 0; i < sizeof(rvc_hwprobe_bits) /
+                          sizeof(rvc_hwprobe_bits[0]); i ++) {
+        if(pair.value & rvc_hwprobe_bits[i].bit) {
+            caps |= rvc_hwprobe_bits[i].caps;
+        }
+    }
+    return caps;
+}
+
+//! Extensions all harts list in /proc/cpuinfo. Zero if unreadable.
+static uint32_t rvc_probe_cpuinfo() {
+    FILE   * fh    = fopen("/proc/cpuinfo", "r");
+    char     line[4096];
+    uint32_t caps  = RISCVCRYPTO_ALL;
+    int      harts = 0;
+
+    if(fh == NULL) {
+        return 0;
+    }
+    while(fgets(line, sizeof(line), fh)) {
+        char * colon = strchr(line, ':');
+        if(strncmp(line, "isa", 3) == 0 && colon != NULL) {
+            caps &= riscvcrypto_parse_isa(colon + 1);
+            harts ++;
+        }
+    }
+    fclose(fh);
+    return harts ? caps : 0;
+}
+
+#endif
+
+/*!
+@brief Find the extensions of the running hart.
+@details Kernels before 6.8 have riscv_hwprobe, but not the scalar crypto
+    bits of it, so /proc/cpuinfo is read when it reports none of them.
+*/
+static uint32_t rvc_probe() {
+    const char * env = getenv("RISCVCRYPTO_CAPS");
+    if(env != NULL) {
+        return riscvcrypto_parse_isa(env);
+    }
+#if defined(__linux__) && defined(__riscv)
+    uint32_t caps = rvc_probe_hwprobe();
+    if(caps == 0) {
+        caps = rvc_probe_cpuinfo();
+    }
+    return caps | RVC_TARGET_CAPS;
+#else
+    return RISCVCRYPTO_ASSUME_CAPS;
+#endif
+}
+
+static inline void rvc_init() {
+    if(!rvc_bound) {
+        riscvcrypto_set_caps(rvc_probe());
+    }
+}
+
+#if defined(__GNUC__)
+//! Bind before main, so that threads never race to do it.
+__attribute__((constructor)) static void rvc_constructor() {
+    rvc_init();
+}
+#endif
+
+uint32_t riscvcrypto_caps() {
+    rvc_init();
+    return rvc_caps;
+}
+
+const char* riscvcrypto_impl(riscvcrypto_alg alg) {
+    rvc_init();
+    switch(alg) {
+        case RISCVCRYPTO_AES   : return rvc_aes_bound    -> impl.name;
+        case RISCVCRYPTO_SM4   : return rvc_sm4_bound    -> impl.name;
+        case RISCVCRYPTO_SHA256: return rvc_sha256_bound -> impl.name;
+        case RISCVCRYPTO_SHA512: return rvc_sha512_bound -> impl.name;
+        case RISCVCRYPTO_SHA3  : return rvc_sha3_bound   -> impl.name;
+        case RISCVCRYPTO_SM3   : return rvc_sm3_bound    -> impl.name;
+        default                : return NULL;
+    }
+}
+
+//! Entry of a table named name, whose extensions are all in caps, or NULL.
+static const void * rvc_find(
+    const void * table,
+    size_t       size ,
+    size_t       count,
+    const char * name ,
+    uint32_t     caps
+){
+    const uint8_t * entry = table;
+    for(size_t i = 0; i < count; i ++, entry += size) {
+        const rvc_impl * impl = (const rvc_impl*)entry;
+        if(strcmp(impl -> name, name) == 0) {
+            return (impl -> caps & caps) == impl -> caps ? entry : NULL;
+        }
+    }
+    return NULL;
+}
+
+#define RVC_COUNT(TABLE) (sizeof(TABLE)/sizeof(TABLE[0]))
+
+#define RVC_AT(TABLE) \
+    return i < RVC_COUNT(TABLE) ? TABLE[i].impl.name : NULL
+
+#define RVC_USE(TABLE, BOUND) {                                             \
+    const void * entry = rvc_find(TABLE, sizeof(TABLE[0]), RVC_COUNT(TABLE),\
+                                  name, rvc_caps);                          \
+    if(entry == NULL) {                                                     \
+        return -1;                                                          \
+    }                                                                       \
+    BOUND = entry;                                                          \
+    return 0;                                                               \
+}
+
+const char* riscvcrypto_impl_at(riscvcrypto_alg alg, size_t i) {
+    switch(alg) {
+        case RISCVCRYPTO_AES   : RVC_AT(rvc_aes_impls   );
+        case RISCVCRYPTO_SM4   : RVC_AT(rvc_sm4_impls   );
+        case RISCVCRYPTO_SHA256: RVC_AT(rvc_sha256_impls);
+        case RISCVCRYPTO_SHA512: RVC_AT(rvc_sha512_impls);
+        case RISCVCRYPTO_SHA3  : RVC_AT(rvc_sha3_impls  );
+        case RISCVCRYPTO_SM3   : RVC_AT(rvc_sm3_impls   );
+        default                : return NULL;
+    }
+}
+
+int riscvcrypto_use(riscvcrypto_alg alg, const char * name) {
+    rvc_init();
+    switch(alg) {
+        case RISCVCRYPTO_AES   : RVC_USE(rvc_aes_impls   , rvc_aes_bound   );
+        case RISCVCRYPTO_SM4   : RVC_USE(rvc_sm4_impls   , rvc_sm4_bound   );
+        case RISCVCRYPTO_SHA256: RVC_USE(rvc_sha256_impls, rvc_sha256_bound);
+        case RISCVCRYPTO_SHA512: RVC_USE(rvc_sha512_impls, rvc_sha512_bound);
+        case RISCVCRYPTO_SHA3  : RVC_USE(rvc_sha3_impls  , rvc_sha3_bound  );
+        case RISCVCRYPTO_SM3   : RVC_USE(rvc_sm3_impls   , rvc_sm3_bound   );
+        default                : return -1;
+    }
+}
+
+//
+// The public API of every algorithm.
+//
+
+void aes_128_enc_key_schedule(uint32_t * const rk, uint8_t * const ck) {
+    rvc_init(); rvc_aes_bound -> enc_ks[0](rk, ck);
+}
+
+void aes_192_enc_key_schedule(uint32_t * const rk, uint8_t * const ck) {
+    rvc_init(); rvc_aes_bound -> enc_ks[1](rk, ck);
+}
+
+void aes_256_enc_key_schedule(uint32_t * const rk, uint8_t * const ck) {
+    rvc_init(); rvc_aes_bound -> enc_ks[2](rk, ck);
+}
+
+void aes_128_dec_key_schedule(uint32_t * const rk, uint8_t * const ck) {
+    rvc_init(); rvc_aes_bound -> dec_ks[0](rk, ck);
+}
+
+void aes_192_dec_key_schedule(uint32_t * const rk, uint8_t * const ck) {
+    rvc_init(); rvc_aes_bound -> dec_ks[1](rk, ck);
+}
+
+void aes_256_dec_key_schedule(uint32_t * const rk, uint8_t * const ck) {
+    rvc_init(); rvc_aes_bound -> dec_ks[2](rk, ck);
+}
+
+void aes_128_ecb_encrypt(uint8_t ct[16], uint8_t pt[16], uint32_t * rk) {
+    rvc_init(); rvc_aes_bound -> encrypt[0](ct, pt, rk);
+}
+
+void aes_192_ecb_encrypt(uint8_t ct[16], uint8_t pt[16], uint32_t * rk) {
+    rvc_init(); rvc_aes_bound -> encrypt[1](ct, pt, rk);
+}
+
+void aes_256_ecb_encrypt(uint8_t ct[16], uint8_t pt[16], uint32_t * rk) {
+    rvc_init(); rvc_aes_bound -> encrypt[2](ct, pt, rk);
+}
+
+void aes_128_ecb_decrypt(uint8_t pt[16], uint8_t ct[16], uint32_t * rk) {
+    rvc_init(); rvc_aes_bound -> decrypt[0](pt, ct, rk);
+}
+
+void aes_192_ecb_decrypt(uint8_t pt[16], uint8_t ct[16], uint32_t * rk) {
+    rvc_init(); rvc_aes_bound -> decrypt[1](pt, ct, rk);
+}
+
+void aes_256_ecb_decrypt(uint8_t pt[16], uint8_t ct[16], uint32_t * rk) {
+    rvc_init(); rvc_aes_bound -> decrypt[2](pt, ct, rk);
+}
+
+//! Interleaved where the bound implementation has it, else two calls.
+void aes_128_ecb_encrypt_x2 (
+    uint8_t     ct0 [AES_BLOCK_BYTES],
+    uint8_t     pt0 [AES_BLOCK_BYTES],
+    uint8_t     ct1 [AES_BLOCK_BYTES],
+    uint8_t     pt1 [AES_BLOCK_BYTES],
+    uint32_t  * rk
+){
+    rvc_init();
+    if(rvc_aes_bound -> encrypt_x2 != NULL) {
+        rvc_aes_bound -> encrypt_x2(ct0, pt0, ct1, pt1, rk);
+    } else {
+        rvc_aes_bound -> encrypt[0](ct0, pt0, rk);
+        rvc_aes_bound -> encrypt[0](ct1, pt1, rk);
+    }
+}
+
+void sm4_key_schedule_enc(uint32_t rk[32], uint8_t mk[16]) {
+    rvc_init(); rvc_sm4_bound -> enc_ks(rk, mk);
+}
+
+void sm4_key_schedule_dec(uint32_t rk[32], uint8_t mk[16]) {
+    rvc_init(); rvc_sm4_bound -> dec_ks(rk, mk);
+}
+
+void sm4_block_enc_dec(uint8_t out[16], uint8_t in[16], uint32_t rk[32]) {
+    rvc_init(); rvc_sm4_bound -> enc_dec(out, in, rk);
+}
+
+void sha256_hash(uint32_t H[8], uint8_t * M, size_t len) {
+    rvc_init(); ((rvc_sha256_fn)rvc_sha256_bound -> hash)(H, M, len);
+}
+
+void sha512_hash(uint64_t H[8], uint8_t * M, size_t len) {
+    rvc_init(); ((rvc_sha512_fn)rvc_sha512_bound -> hash)(H, M, len);
+}
+
+void sm3_hash(uint8_t hash[32], const uint8_t * message, size_t len) {
+    rvc_init(); ((rvc_sm3_fn)rvc_sm3_bound -> hash)(hash, message, len);
+}
+
+void Keccak(
+    unsigned int rate,
+    unsigned int capacity,
+    const unsigned char *input,
+    unsigned long long int inputByteLen,
+    unsigned char delimitedSuffix,
+    unsigned char *output,
+    unsigned long long int outputByteLen
+){
+    rvc_init();
+    ((rvc_keccak_fn)rvc_sha3_bound -> hash)(rate, capacity, input,
+        inputByteLen, delimitedSuffix, output, outputByteLen);
+}
+
+//! @}
@@ -0,0 +1,217 @@
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+@defgroup parallel Parallel Engine
+@{
+@details Splits large cipher and hash jobs over a pool of POSIX threads,
+    for Linux hosts with many harts. The single block and single message
+    routines of the other libraries (or of libriscvcrypto) do the work;
+    this library only decides who does which part of it.
+
+    A job is a range of items (blocks, XTS data units or hash leaves),
+    cut into chunks of about PARALLEL_CHUNK_BYTES. Chunk i is queued on
+    worker i mod N. Each worker has its own deque: it takes its newest
+    chunk first, and when empty steals the oldest chunk of another
+    worker, trying those on its own NUMA node first.
+
+    Workers are pinned to the CPUs the process may run on, in order.
+    Buffers from parallel_alloc have each chunk's pages first touched by
+    the worker that chunk is queued on, so that under Linux's first touch
+    policy they are placed on that worker's node.
+
+    Only one thread should submit jobs to an engine at a time.
+*/
+
+#ifndef __API_PARALLEL_H__
+#define __API_PARALLEL_H__
+
+#ifndef PARALLEL_CHUNK_BYTES
+//! Default number of bytes of a job handed to a worker at once.
+#define PARALLEL_CHUNK_BYTES (256 * 1024)
+#endif
+
+#ifndef PARALLEL_LEAF_BYTES
+//! Default leaf length of the tree hashes.
+#define PARALLEL_LEAF_BYTES  (1024 * 1024)
+#endif
+
+typedef struct parallel_engine parallel_engine;
+
+//! How to build an engine. Zeroed fields take their defaults.
+typedef struct {
+    unsigned threads;       //!< Workers. Default: one per usable CPU.
+    size_t   chunk_bytes;   //!< Default: PARALLEL_CHUNK_BYTES.
+    int      no_pin;        //!< Set to leave workers unpinned.
+} parallel_config;
+
+/*!
+@brief Processes items [first, first + count) of a job.
+@param [in] job - Passed through from parallel_run.
+*/
+typedef void (*parallel_task_fn)(
+    void   * job  ,
+    size_t   first,
+    size_t   count
+);
+
+/*!
+@brief Starts an engine.
+@param [in] config - How to build it, or NULL for the defaults.
+@returns The engine, or NULL if it could not be allocated or a worker
+    could not be started.
+*/
+parallel_engine * parallel_engine_new(const parallel_config * config);
+
+//! Stops the workers of an engine, and frees it.
+void parallel_engine_free(parallel_engine * engine);
+
+//! Number of workers.
+unsigned parallel_engine_threads(const parallel_engine * engine);
+
+//! Number of distinct NUMA nodes the workers are pinned to.
+unsigned parallel_engine_nodes(const parallel_engine * engine);
+
+/*!
+@brief Runs fn over items [0, items) on the workers, chunk_items at a
+    time, and returns once every chunk is done.
+@param [in] chunk_items - Items per chunk, or 0 for PARALLEL_CHUNK_BYTES
+    worth, taking each item to be item_bytes long.
+*/
+void parallel_run(
+    parallel_engine  * engine     ,
+    parallel_task_fn   fn         ,
+    void             * job        ,
+    size_t             items      ,
+    size_t             chunk_items,
+    size_t             item_bytes
+);
+
+/*!
+@brief Allocates a page aligned buffer, each chunk of which is first
+    touched (zeroed) by the worker it will be queued on.
+@returns The buffer, or NULL. Free it with parallel_free.
+*/
+void * parallel_alloc(parallel_engine * engine, size_t len);
+
+//! Frees a buffer from parallel_alloc.
+void   parallel_free(void * buf, size_t len);
+
+//
+// Modes
+// ------------------------------------------------------------------
+
+/*!
+@brief A single block encrypt or decrypt, e.g. aes_128_ecb_encrypt or
+    sm4_block_enc_dec.
+*/
+typedef void (*parallel_block_fn)(
+    uint8_t    out[16],
+    uint8_t    in [16],
+    uint32_t * rk
+);
+
+/*!
+@brief CTR mode, as in NIST SP 800-38A, with a 128-bit big endian counter.
+@param [in,out] ctr - The first counter block. Advanced by the number of
+    blocks used, rounding up.
+@param [in] enc - Block encrypt function.
+@param [in] rk - Its expanded encrypt key.
+*/
+void parallel_ctr(
+    parallel_engine   * engine,
+    uint8_t           * out   ,
+    const uint8_t     * in    ,
+    size_t              len   ,
+    uint8_t             ctr[16],
+    parallel_block_fn   enc   ,
+    uint32_t          * rk
+);
+
+//! AES-128 CTR. Uses aes_128_ecb_encrypt_x2 for pairs of blocks.
+void parallel_aes_128_ctr(
+    parallel_engine * engine,
+    uint8_t         * out   ,
+    const uint8_t   * in    ,
+    size_t            len   ,
+    uint8_t           ctr[16],
+    uint32_t        * rk
+);
+
+//! SM4 CTR.
+void parallel_sm4_ctr(
+    parallel_engine * engine,
+    uint8_t         * out   ,
+    const uint8_t   * in    ,
+    size_t            len   ,
+    uint8_t           ctr[16],
+    uint32_t        * rk
+);
+
+/*!
+@brief XTS-AES-128 (IEEE 1619) over consecutive data units, e.g. the
+    sectors of a disk. Data unit j has tweak number sector + j. A short
+    last data unit uses ciphertext stealing.
+@param [in] data_rk - aes_128 encrypt key schedule of the data key.
+@param [in] tweak_rk - aes_128 encrypt key schedule of the tweak key.
+@param [in] unit_bytes - Data unit length, a multiple of 16.
+@returns 0, or -1 if unit_bytes is not a multiple of 16 or the last data
+    unit is shorter than 16 bytes.
+*/
+int parallel_aes_128_xts_encrypt(
+    parallel_engine * engine    ,
+    uint8_t         * out       ,
+    const uint8_t   * in        ,
+    size_t            len       ,
+    uint32_t        * data_rk   ,
+    uint32_t        * tweak_rk  ,
+    uint64_t          sector    ,
+    size_t            unit_bytes
+);
+
+/*!
+@brief Inverse of parallel_aes_128_xts_encrypt.
+@param [in] data_rk - aes_128 decrypt key schedule of the data key.
+@param [in] tweak_rk - aes_128 encrypt key schedule of the tweak key.
+*/
+int parallel_aes_128_xts_decrypt(
+    parallel_engine * engine    ,
+    uint8_t         * out       ,
+    const uint8_t   * in        ,
+    size_t            len       ,
+    uint32_t        * data_rk   ,
+    uint32_t        * tweak_rk  ,
+    uint64_t          sector    ,
+    size_t            unit_bytes
+);
+
+/*!
+@brief Two level tree hash with SHA-256: the SHA-256 of the concatenated
+    SHA-256 digests of each leaf_bytes long leaf of msg, the last leaf
+    possibly shorter. An empty message has one empty leaf.
+@details The result depends on leaf_bytes, but not on the number of
+    threads. It is not the SHA-256 of msg.
+@param [in] leaf_bytes - Leaf length, or 0 for PARALLEL_LEAF_BYTES.
+@returns 0, or -1 if the leaf digests could not be allocated.
+*/
+int parallel_sha256_tree(
+    parallel_engine * engine    ,
+    uint8_t           digest[32],
+    const uint8_t   * msg       ,
+    size_t            len       ,
+    size_t            leaf_bytes
+);
+
+//! As parallel_sha256_tree, with SM3.
+int parallel_sm3_tree(
+    parallel_engine * engine    ,
+    uint8_t           digest[32],
+    const uint8_t   * msg       ,
+    size_t            len       ,
+    size_t            leaf_bytes
+);
+
+#endif
+
+//! @}
@@ -0,0 +1,391 @@
+
+#define _GNU_SOURCE
+
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "riscvcrypto/parallel/api_parallel.h"
+
+/*!
+@addtogroup parallel
+@{
+*/
+
+//! One chunk of a job.
+typedef struct {
+    parallel_task_fn    fn;
+    struct parallel_job*job;
+    size_t              first;
+    size_t              count;
+} parallel_task;
+
+//! Progress of one parallel_run call.
+typedef struct parallel_job {
+    void              * arg;
+    size_t              pending;    //!< Chunks not yet finished.
+} parallel_job;
+
+/*!
+@brief A worker's deque of chunks, as a ring buffer. The owner pushes and
+    pops at the bottom, thieves take from the top. Chunks are large, so a
+    lock per deque costs little next to the work in each.
+*/
+typedef struct {
+    pthread_mutex_t     lock;
+    parallel_task     * tasks;
+    size_t              capacity;   //!< A power of two.
+    size_t              top;        //!< Oldest chunk.
+    size_t              bottom;     //!< One past the newest chunk.
+} parallel_deque;
+
+typedef struct {
+    struct parallel_engine * engine;
+    pthread_t           thread;
+    unsigned            index;
+    int                 cpu;        //!< Pinned to, or -1.
+    int                 node;       //!< NUMA node of cpu, or 0.
+    unsigned          * victims;    //!< Workers to steal from, in order.
+    parallel_deque      deque;
+} parallel_worker;
+
+struct parallel_engine {
+    parallel_worker   * workers;
+    unsigned            threads;
+    unsigned            nodes;
+    size_t              chunk_bytes;
+
+    pthread_mutex_t     lock;
+    pthread_cond_t      wake;       //!< Signalled when chunks are queued.
+    pthread_cond_t      done;       //!< Signalled when a job finishes.
+    unsigned            generation; //!< Bumped each time chunks are queued.
+    int                 stop;
+};
+
+//! NUMA node of a CPU, from sysfs. 0 where that says nothing.
+static int parallel_cpu_node(int cpu) {
+    char            path[64];
+    int             node = 0;
+    struct dirent * ent;
+
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    DIR * dir = opendir(path);
+    if(dir == NULL) {
+        return 0;
+    }
+    while((ent = readdir(dir)) != NULL) {
+        if(sscanf(ent -> d_name, "node%d", &node) == 1) {
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+}
+
+//! Queues a chunk. Returns 0, or -1 if the ring could not grow.
+static int parallel_deque_push(parallel_deque * d, parallel_task task) {
+    pthread_mutex_lock(&d -> lock);
+    if(d -> bottom - d -> top == d -> capacity) {
+        size_t          capacity = d -> capacity ? 2 * d -> capacity : 64;
+        parallel_task * tasks    = malloc(capacity * sizeof(parallel_task));
+        if(tasks == NULL) {
+            pthread_mutex_unlock(&d -> lock);
+            return -1;
+        }
+        for(size_t i = d -> top; i < d -> bottom; i ++) {
+            tasks[i & (capacity - 1)] = d -> tasks[i & (d -> capacity - 1)];
+        }
+        free(d -> tasks);
+        d -> tasks    = tasks;
+        d -> capacity = capacity;
+    }
+    d -> tasks[d -> bottom & (d -> capacity - 1)] = task;
+    d -> bottom ++;
+    pthread_mutex_unlock(&d -> lock);
+    return 0;
+}
+
+//! Takes the newest chunk (owner) or the oldest one (thief).
+static int parallel_deque_take(
+    parallel_deque * d,
+    parallel_task  * task,
+    int              steal
+){
+    int found = 0;
+    pthread_mutex_lock(&d -> lock);
+    if(d -> bottom != d -> top) {
+        if(steal) {
+            *task = d -> tasks[d -> top & (d -> capacity - 1)];
+            d -> top ++;
+        } else {
+            d -> bottom --;
+            *task = d -> tasks[d -> bottom & (d -> capacity - 1)];
+        }
+        found = 1;
+    }
+    pthread_mutex_unlock(&d -> lock);
+    return found;
+}
+
+static int parallel_find_task(parallel_worker * w, parallel_task * task) {
+    if(parallel_deque_take(&w -> deque, task, 0)) {
+        return 1;
+    }
+    for(unsigned i = 0; i < w -> engine -> threads - 1; i ++) {
+        parallel_worker * victim = &w -> engine -> workers[w -> victims[i]];
+        if(parallel_deque_take(&victim -> deque, task, 1)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void * parallel_worker_main(void * arg) {
+    parallel_worker * w = arg;
+    parallel_engine * e = w -> engine;
+    parallel_task     task;
+    unsigned          seen;
+
+    pthread_mutex_lock(&e -> lock);
+    seen = e -> generation;
+    pthread_mutex_unlock(&e -> lock);
+
+    for(;;) {
+        while(parallel_find_task(w, &task)) {
+            task.fn(task.job -> arg, task.first, task.count);
+            pthread_mutex_lock(&e -> lock);
+            if(-- task.job -> pending == 0) {
+                pthread_cond_broadcast(&e -> done);
+            }
+            pthread_mutex_unlock(&e -> lock);
+        }
+
+        pthread_mutex_lock(&e -> lock);
+        while(e -> generation == seen && !e -> stop) {
+            pthread_cond_wait(&e -> wake, &e -> lock);
+        }
+        seen = e -> generation;
+        int stop = e -> stop;
+        pthread_mutex_unlock(&e -> lock);
+
+        if(stop) {
+            return NULL;
+        }
+    }
+}
+
+/*!
+@brief Orders the other workers for w to steal from: those on its own
+    node first, then the rest, each starting after w.
+*/
+static void parallel_order_victims(parallel_engine * e, parallel_worker * w) {
+    unsigned n = 0;
+    for(int same = 1; same >= 0; same --) {
+        for(unsigned i = 1; i < e -> threads; i ++) {
+            unsigned v = (w -> index + i) % e -> threads;
+            if((e -> workers[v].node == w -> node) == same) {
+                w -> victims[n ++] = v;
+            }
+        }
+    }
+}
+
+parallel_engine * parallel_engine_new(const parallel_config * config) {
+    parallel_config   cfg = {0};
+    cpu_set_t         allowed;
+    int               cpus[CPU_SETSIZE];
+    int               ncpus = 0;
+    int               failed = 0;
+
+    if(config != NULL) {
+        cfg = *config;
+    }
+
+    if(sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for(int c = 0; c < CPU_SETSIZE; c ++) {
+            if(CPU_ISSET(c, &allowed)) {
+                cpus[ncpus ++] = c;
+            }
+        }
+    }
+
+    parallel_engine * e = calloc(1, sizeof(parallel_engine));
+    if(e == NULL) {
+        return NULL;
+    }
+    e -> threads     = cfg.threads ? cfg.threads : (ncpus ? ncpus : 1);
+    e -> chunk_bytes = cfg.chunk_bytes ? cfg.chunk_bytes : PARALLEL_CHUNK_BYTES;
+    e -> workers     = calloc(e -> threads, sizeof(parallel_worker));
+    if(e -> workers == NULL) {
+        free(e);
+        return NULL;
+    }
+
+    pthread_mutex_init(&e -> lock, NULL);
+    pthread_cond_init (&e -> wake, NULL);
+    pthread_cond_init (&e -> done, NULL);
+
+    for(unsigned i = 0; i < e -> threads; i ++) {
+        parallel_worker * w = &e -> workers[i];
+        w -> engine = e;
+        w -> index  = i;
+        w -> cpu    = ncpus && !cfg.no_pin ? cpus[i % ncpus] : -1;
+        w -> node   = w -> cpu >= 0 ? parallel_cpu_node(w -> cpu) : 0;
+        w -> victims= calloc(e -> threads, sizeof(unsigned));
+        pthread_mutex_init(&w -> deque.lock, NULL);
+
+        int seen = 0;
+        for(unsigned j = 0; j < i; j ++) {
+            seen |= e -> workers[j].node == w -> node;
+        }
+        e -> nodes += !seen;
+        failed |= w -> victims == NULL;
+    }
+
+    if(failed) {
+        for(unsigned i = 0; i < e -> threads; i ++) {
+            free(e -> workers[i].victims);
+            pthread_mutex_destroy(&e -> workers[i].deque.lock);
+        }
+        pthread_cond_destroy (&e -> done);
+        pthread_cond_destroy (&e -> wake);
+        pthread_mutex_destroy(&e -> lock);
+        free(e -> workers);
+        free(e);
+        return NULL;
+    }
+
+    for(unsigned i = 0; i < e -> threads; i ++) {
+        parallel_worker * w = &e -> workers[i];
+        parallel_order_victims(e, w);
+
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        if(w -> cpu >= 0) {
+            cpu_set_t one;
+            CPU_ZERO(&one);
+            CPU_SET(w -> cpu, &one);
+            pthread_attr_setaffinity_np(&attr, sizeof(one), &one);
+        }
+        int rc = pthread_create(&w -> thread, &attr, parallel_worker_main, w);
+        pthread_attr_destroy(&attr);
+
+        if(rc != 0) {
+            for(unsigned j = i; j < e -> threads; j ++) {
+                free(e -> workers[j].victims);
+                pthread_mutex_destroy(&e -> workers[j].deque.lock);
+            }
+            e -> threads = i;
+            parallel_engine_free(e);
+            return NULL;
+        }
+    }
+
+    return e;
+}
+
+void parallel_engine_free(parallel_engine * e) {
+    pthread_mutex_lock(&e -> lock);
+    e -> stop = 1;
+    pthread_cond_broadcast(&e -> wake);
+    pthread_mutex_unlock(&e -> lock);
+
+    for(unsigned i = 0; i < e -> threads; i ++) {
+        pthread_join(e -> workers[i].thread, NULL);
+        free(e -> workers[i].victims);
+        free(e -> workers[i].deque.tasks);
+        pthread_mutex_destroy(&e -> workers[i].deque.lock);
+    }
+
+    pthread_cond_destroy (&e -> done);
+    pthread_cond_destroy (&e -> wake);
+    pthread_mutex_destroy(&e -> lock);
+    free(e -> workers);
+    free(e);
+}
+
+unsigned parallel_engine_threads(const parallel_engine * e) {
+    return e -> threads;
+}
+
+unsigned parallel_engine_nodes(const parallel_engine * e) {
+    return e -> nodes;
+}
+
+void parallel_run(
+    parallel_engine  * e          ,
+    parallel_task_fn   fn         ,
+    void             * arg        ,
+    size_t             items      ,
+    size_t             chunk_items,
+    size_t             item_bytes
+){
+    if(items == 0) {
+        return;
+    }
+    if(chunk_items == 0) {
+        chunk_items = item_bytes ? e -> chunk_bytes / item_bytes : 1;
+        chunk_items = chunk_items ? chunk_items : 1;
+    }
+
+    parallel_job job;
+    job.arg     = arg;
+    job.pending = (items + chunk_items - 1) / chunk_items;
+
+    // Queued newest last, so that each worker's first chunk is its
+    // lowest, and a job walks through memory roughly in order.
+    size_t chunks = job.pending;
+    for(size_t c = chunks; c -- > 0;) {
+        parallel_task task;
+        task.fn    = fn;
+        task.job   = &job;
+        task.first = c * chunk_items;
+        task.count = items - task.first < chunk_items ?
+                     items - task.first : chunk_items;
+        // A chunk which cannot be queued is run here instead.
+        if(parallel_deque_push(&e -> workers[c % e -> threads].deque, task)) {
+            fn(arg, task.first, task.count);
+            pthread_mutex_lock(&e -> lock);
+            job.pending --;
+            pthread_mutex_unlock(&e -> lock);
+        }
+    }
+
+    pthread_mutex_lock(&e -> lock);
+    e -> generation ++;
+    pthread_cond_broadcast(&e -> wake);
+    while(job.pending != 0) {
+        pthread_cond_wait(&e -> done, &e -> lock);
+    }
+    pthread_mutex_unlock(&e -> lock);
+}
+
+//! Zeroes one chunk of a parallel_alloc buffer.
+static void parallel_touch(void * buf, size_t first, size_t count) {
+    memset((uint8_t*)buf + first, 0, count);
+}
+
+void * parallel_alloc(parallel_engine * e, size_t len) {
+    void * buf = mmap(NULL, len ? len : 1, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(buf == MAP_FAILED) {
+        return NULL;
+    }
+    // Items of one byte, so chunks line up with those of every job over
+    // the same buffer which uses the default chunk size.
+    parallel_run(e, parallel_touch, buf, len, e -> chunk_bytes, 1);
+    return buf;
+}
+
+void parallel_free(void * buf, size_t len) {
+    if(buf != NULL) {
+        munmap(buf, len ? len : 1);
+    }
+}
+
+//! @}
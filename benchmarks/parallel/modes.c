@@ -0,0 +1,378 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "riscvcrypto/aes/api_aes.h"
+#include "riscvcrypto/aes/api_aes_modes.h"
+#include "riscvcrypto/sm4/api_sm4.h"
+#include "riscvcrypto/sha256/api_sha256.h"
+#include "riscvcrypto/sm3/api_sm3.h"
+
+#include "riscvcrypto/parallel/api_parallel.h"
+
+/*!
+@addtogroup parallel
+@{
+*/
+
+//! Adds n to a 128-bit big endian counter.
+static void parallel_ctr_add(uint8_t ctr[16], uint64_t n) {
+    for(int i = 15; i >= 0 && n; i --) {
+        n      += ctr[i];
+        ctr[i]  = n & 0xFF;
+        n     >>= 8;
+    }
+}
+
+static void parallel_xor(uint8_t * out, const uint8_t * a, const uint8_t * b,
+                         size_t len) {
+    for(size_t i = 0; i < len; i ++) {
+        out[i] = a[i] ^ b[i];
+    }
+}
+
+//
+// CTR
+//
+
+typedef struct {
+    uint8_t           * out;
+    const uint8_t     * in;
+    size_t              len;
+    uint8_t             ctr[16];
+    parallel_block_fn   enc;
+    uint32_t          * rk;
+    int                 x2;     //!< Use aes_128_ecb_encrypt_x2 for pairs.
+} parallel_ctr_job;
+
+static void parallel_ctr_task(void * arg, size_t first, size_t count) {
+    parallel_ctr_job * job = arg;
+    uint8_t            ctr[2][16];
+    uint8_t            ks [2][16];
+    size_t             end = first + count;
+
+    memcpy(ctr[0], job -> ctr, 16);
+    parallel_ctr_add(ctr[0], first);
+
+    for(size_t b = first; b < end;) {
+        size_t off = 16 * b;
+        size_t n   = job -> len - off < 16 ? job -> len - off : 16;
+
+        if(job -> x2 && b + 1 < end && job -> len - off >= 32) {
+            memcpy(ctr[1], ctr[0], 16);
+            parallel_ctr_add(ctr[1], 1);
+            aes_128_ecb_encrypt_x2(ks[0], ctr[0], ks[1], ctr[1], job -> rk);
+            parallel_xor(job -> out + off     , job -> in + off     , ks[0], 16);
+            parallel_xor(job -> out + off + 16, job -> in + off + 16, ks[1], 16);
+            parallel_ctr_add(ctr[0], 2);
+            b += 2;
+        } else {
+            job -> enc(ks[0], ctr[0], job -> rk);
+            parallel_xor(job -> out + off, job -> in + off, ks[0], n);
+            parallel_ctr_add(ctr[0], 1);
+            b += 1;
+        }
+    }
+}
+
+static void parallel_ctr_common(
+    parallel_engine   * engine,
+    uint8_t           * out   ,
+    const uint8_t     * in    ,
+    size_t              len   ,
+    uint8_t             ctr[16],
+    parallel_block_fn   enc   ,
+    uint32_t          * rk    ,
+    int                 x2
+){
+    parallel_ctr_job job;
+    size_t           blocks = (len + 15) / 16;
+
+    job.out = out;
+    job.in  = in;
+    job.len = len;
+    job.enc = enc;
+    job.rk  = rk;
+    job.x2  = x2;
+    memcpy(job.ctr, ctr, 16);
+
+    parallel_run(engine, parallel_ctr_task, &job, blocks, 0, 16);
+    parallel_ctr_add(ctr, blocks);
+}
+
+void parallel_ctr(
+    parallel_engine   * engine,
+    uint8_t           * out   ,
+    const uint8_t     * in    ,
+    size_t              len   ,
+    uint8_t             ctr[16],
+    parallel_block_fn   enc   ,
+    uint32_t          * rk
+){
+    parallel_ctr_common(engine, out, in, len, ctr, enc, rk, 0);
+}
+
+void parallel_aes_128_ctr(
+    parallel_engine * engine,
+    uint8_t         * out   ,
+    const uint8_t   * in    ,
+    size_t            len   ,
+    uint8_t           ctr[16],
+    uint32_t        * rk
+){
+    parallel_ctr_common(engine, out, in, len, ctr, aes_128_ecb_encrypt, rk, 1);
+}
+
+void parallel_sm4_ctr(
+    parallel_engine * engine,
+    uint8_t         * out   ,
+    const uint8_t   * in    ,
+    size_t            len   ,
+    uint8_t           ctr[16],
+    uint32_t        * rk
+){
+    parallel_ctr_common(engine, out, in, len, ctr, sm4_block_enc_dec, rk, 0);
+}
+
+//
+// XTS
+//
+
+typedef struct {
+    uint8_t           * out;
+    const uint8_t     * in;
+    size_t              len;
+    uint32_t          * data_rk;
+    uint32_t          * tweak_rk;
+    uint64_t            sector;
+    size_t              unit_bytes;
+    parallel_block_fn   block;  //!< aes_128_ecb_encrypt or _decrypt.
+    int                 decrypt;
+} parallel_xts_job;
+
+//! Multiplies a tweak by x in GF(2^128), little endian as in IEEE 1619.
+static void parallel_xts_double(uint8_t t[16]) {
+    uint8_t carry = 0;
+    for(int i = 0; i < 16; i ++) {
+        uint8_t next = t[i] >> 7;
+        t[i]  = (t[i] << 1) | carry;
+        carry = next;
+    }
+    if(carry) {
+        t[0] ^= 0x87;
+    }
+}
+
+//! One block: out = block(in ^ t) ^ t.
+static void parallel_xts_block(
+    parallel_xts_job * job,
+    uint8_t            out[16],
+    const uint8_t      in [16],
+    const uint8_t      t  [16]
+){
+    uint8_t x[16];
+    parallel_xor(x, in, t, 16);
+    job -> block(x, x, job -> data_rk);
+    parallel_xor(out, x, t, 16);
+}
+
+//! One data unit of len bytes, len >= 16, with ciphertext stealing.
+static void parallel_xts_unit(
+    parallel_xts_job * job,
+    uint8_t          * out,
+    const uint8_t    * in ,
+    size_t             len,
+    uint64_t           sector
+){
+    uint8_t  t[16] = {0};
+    uint8_t  t_last[16];
+    uint8_t  cc[16];
+    size_t   full  = len / 16;
+    size_t   tail  = len % 16;
+
+    for(int i = 0; i < 8; i ++) {
+        t[i] = (sector >> (8 * i)) & 0xFF;
+    }
+    aes_128_ecb_encrypt(t, t, job -> tweak_rk);
+
+    size_t plain = tail ? full - 1 : full;
+    for(size_t b = 0; b < plain; b ++) {
+        parallel_xts_block(job, out + 16 * b, in + 16 * b, t);
+        parallel_xts_double(t);
+    }
+    if(!tail) {
+        return;
+    }
+
+    // Steal from the last full block. Decryption uses the two tweaks in
+    // the opposite order to encryption.
+    uint8_t       * o = out + 16 * plain;
+    const uint8_t * i = in  + 16 * plain;
+    memcpy(t_last, t, 16);
+    parallel_xts_double(t_last);
+
+    parallel_xts_block(job, cc, i, job -> decrypt ? t_last : t);
+    memcpy(o + 16, cc, tail);
+    memcpy(cc, i + 16, tail);
+    parallel_xts_block(job, o, cc, job -> decrypt ? t : t_last);
+}
+
+static void parallel_xts_task(void * arg, size_t first, size_t count) {
+    parallel_xts_job * job = arg;
+    for(size_t u = first; u < first + count; u ++) {
+        size_t off = u * job -> unit_bytes;
+        size_t len = job -> len - off < job -> unit_bytes ?
+                     job -> len - off : job -> unit_bytes;
+        parallel_xts_unit(job, job -> out + off, job -> in + off, len,
+            job -> sector + u);
+    }
+}
+
+static int parallel_xts(
+    parallel_engine * engine    ,
+    uint8_t         * out       ,
+    const uint8_t   * in        ,
+    size_t            len       ,
+    uint32_t        * data_rk   ,
+    uint32_t        * tweak_rk  ,
+    uint64_t          sector    ,
+    size_t            unit_bytes,
+    int               decrypt
+){
+    if(unit_bytes == 0 || unit_bytes % 16 || (len % unit_bytes &&
+       len % unit_bytes < 16)) {
+        return -1;
+    }
+
+    parallel_xts_job job;
+    job.out        = out;
+    job.in         = in;
+    job.len        = len;
+    job.data_rk    = data_rk;
+    job.tweak_rk   = tweak_rk;
+    job.sector     = sector;
+    job.unit_bytes = unit_bytes;
+    job.block      = decrypt ? aes_128_ecb_decrypt : aes_128_ecb_encrypt;
+    job.decrypt    = decrypt;
+
+    parallel_run(engine, parallel_xts_task, &job,
+        (len + unit_bytes - 1) / unit_bytes, 0, unit_bytes);
+    return 0;
+}
+
+int parallel_aes_128_xts_encrypt(
+    parallel_engine * engine    ,
+    uint8_t         * out       ,
+    const uint8_t   * in        ,
+    size_t            len       ,
+    uint32_t        * data_rk   ,
+    uint32_t        * tweak_rk  ,
+    uint64_t          sector    ,
+    size_t            unit_bytes
+){
+    return parallel_xts(engine, out, in, len, data_rk, tweak_rk, sector,
+        unit_bytes, 0);
+}
+
+int parallel_aes_128_xts_decrypt(
+    parallel_engine * engine    ,
+    uint8_t         * out       ,
+    const uint8_t   * in        ,
+    size_t            len       ,
+    uint32_t        * data_rk   ,
+    uint32_t        * tweak_rk  ,
+    uint64_t          sector    ,
+    size_t            unit_bytes
+){
+    return parallel_xts(engine, out, in, len, data_rk, tweak_rk, sector,
+        unit_bytes, 1);
+}
+
+//
+// Tree hashes
+//
+
+//! A hash with a 32 byte digest, e.g. sm3_hash.
+typedef void (*parallel_hash_fn)(
+    uint8_t         digest[32],
+    const uint8_t * msg,
+    size_t          len
+);
+
+typedef struct {
+    const uint8_t     * msg;
+    size_t              len;
+    size_t              leaf_bytes;
+    uint8_t           * digests;    //!< 32 bytes per leaf.
+    parallel_hash_fn    hash;
+} parallel_tree_job;
+
+static void parallel_tree_task(void * arg, size_t first, size_t count) {
+    parallel_tree_job * job = arg;
+    for(size_t l = first; l < first + count; l ++) {
+        size_t off = l * job -> leaf_bytes;
+        size_t len = job -> len - off < job -> leaf_bytes ?
+                     job -> len - off : job -> leaf_bytes;
+        job -> hash(job -> digests + 32 * l, job -> msg + off, len);
+    }
+}
+
+static int parallel_tree(
+    parallel_engine   * engine    ,
+    uint8_t             digest[32],
+    const uint8_t     * msg       ,
+    size_t              len       ,
+    size_t              leaf_bytes,
+    parallel_hash_fn    hash
+){
+    parallel_tree_job job;
+    leaf_bytes = leaf_bytes ? leaf_bytes : PARALLEL_LEAF_BYTES;
+
+    size_t leaves  = len ? (len + leaf_bytes - 1) / leaf_bytes : 1;
+    job.msg        = msg;
+    job.len        = len;
+    job.leaf_bytes = leaf_bytes;
+    job.hash       = hash;
+    job.digests    = malloc(32 * leaves);
+
+    if(job.digests == NULL) {
+        return -1;
+    }
+
+    parallel_run(engine, parallel_tree_task, &job, leaves, 0, leaf_bytes);
+    hash(digest, job.digests, 32 * leaves);
+
+    free(job.digests);
+    return 0;
+}
+
+//! sha256_hash, as a parallel_hash_fn.
+static void parallel_sha256(uint8_t digest[32], const uint8_t * msg,
+                            size_t len) {
+    uint32_t h[8];
+    sha256_hash(h, (uint8_t*)msg, len);
+    memcpy(digest, h, 32);
+}
+
+int parallel_sha256_tree(
+    parallel_engine * engine    ,
+    uint8_t           digest[32],
+    const uint8_t   * msg       ,
+    size_t            len       ,
+    size_t            leaf_bytes
+){
+    return parallel_tree(engine, digest, msg, len, leaf_bytes,
+        parallel_sha256);
+}
+
+int parallel_sm3_tree(
+    parallel_engine * engine    ,
+    uint8_t           digest[32],
+    const uint8_t   * msg       ,
+    size_t            len       ,
+    size_t            leaf_bytes
+){
+    return parallel_tree(engine, digest, msg, len, leaf_bytes, sm3_hash);
+}
+
+//! @}
@@ -8,7 +8,7 @@
 
 #include "permutation.h"
 
-#if __riscv_xlen == 64
+#if PERMUTATION_XLEN == 64
 typedef uint64_t uint_xlen_t;
 #else
 typedef uint32_t uint_xlen_t;
@@ -20,9 +20,9 @@ uint_xlen_t xperm(uint_xlen_t rs1, uint_xlen_t rs2, int sz_log2)
     uint_xlen_t r = 0;
     uint_xlen_t sz = 1LL << sz_log2;
     uint_xlen_t mask = (1LL << sz) - 1;
-    for (int i = 0; i < __riscv_xlen ; i += sz) {
+    for (int i = 0; i < PERMUTATION_XLEN ; i += sz) {
         uint_xlen_t pos = ((rs2 >> i) & mask) << sz_log2;
-        if (pos < __riscv_xlen) {
+        if (pos < PERMUTATION_XLEN) {
             r |= ((rs1 >> pos) & mask) << i;
         }
     }
@@ -49,7 +49,7 @@ uint64_t rv32_xpermb(uint64_t rs1, uint64_t rs2) {
 }
 
 
-#if __riscv_xlen == 64
+#if PERMUTATION_XLEN == 64
 
 /*
 @details 64-bit 4-bit SBox. Apply 4-bit SBox to each nibble in "in" and
@@ -59,7 +59,7 @@ uint64_t sbox_4bit(uint64_t sbox, uint64_t in) {
     return xperm4(sbox, in); // 1 instruction.
 }
 
-#elif __riscv_xlen == 32
+#elif PERMUTATION_XLEN == 32
 
 /*
 @details 32-bit 4-bit sbox. Functionally identical to 64-bit variant, but
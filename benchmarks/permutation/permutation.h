@@ -11,6 +11,16 @@
 #ifndef __PERMUTATION_H__
 #define __PERMUTATION_H__
 
+//! Register width the examples are written for. Builds for a non-RISC-V
+//! host (config/host.conf) use the host pointer width.
+#if defined(__riscv_xlen)
+#define PERMUTATION_XLEN __riscv_xlen
+#elif UINTPTR_MAX == UINT64_MAX
+#define PERMUTATION_XLEN 64
+#else
+#define PERMUTATION_XLEN 32
+#endif
+
 /*!
 @brief Implements 4 -> 4 bit SBox, applying the SBox to each nibble in a
     64-bit input word.
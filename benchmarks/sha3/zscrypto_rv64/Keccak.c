@@ -41,6 +41,8 @@ static const uint64_t KeccakP1600RoundConstants[24] =
     0x8000000080008008,
 };
 
+#if defined(__riscv_xlen)
+
 static inline uint64_t roli(uint64_t rs1, int i) {
     uint64_t rd;
     asm ("rori %0, %1, 64-%2" : "=r"(rd) :"r"(rs1),"i"(i));
@@ -53,6 +55,19 @@ static inline uint64_t andn(uint64_t rs1, uint64_t rs2) {
     return rd;
 }
 
+#else
+
+// Host build, see config/host.conf.
+static inline uint64_t roli(uint64_t rs1, int i) {
+    return (rs1 << i) | (rs1 >> ((64-i) & 63));
+}
+
+static inline uint64_t andn(uint64_t rs1, uint64_t rs2) {
+    return rs1 & ~rs2;
+}
+
+#endif
+
 #define ROL64(a, offset) roli(a,offset)
 #define ANDN(x,y) andn(y,x)
 
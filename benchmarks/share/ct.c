@@ -0,0 +1,180 @@
+
+/*! @addtogroup test_ct
+@{
+*/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "ct.h"
+#include "util.h"
+
+#ifndef TEST_NAME
+#define TEST_NAME unknown
+#endif
+
+//! Inputs, classes and timings of the current batch.
+static uint8_t  ct_inputs [TEST_CT_BATCH * TEST_CT_MAX_INPUT];
+static uint8_t  ct_classes[TEST_CT_BATCH];
+static uint64_t ct_cycles [TEST_CT_BATCH];
+
+//! Timings of the warm up runs, which the crop points are taken from.
+static uint64_t ct_warmup [TEST_CT_WARMUP];
+
+//! Picks a class for each run of a batch, and fills in its input.
+static void ct_fill_batch(const uint8_t * fixed, size_t len) {
+    for(size_t i = 0; i < TEST_CT_BATCH; i ++) {
+        uint8_t * in    = ct_inputs + i * len;
+        ct_classes[i]   = test_random64() & 0x1;
+        if(ct_classes[i] == 0) {
+            memcpy(in, fixed, len);
+        } else {
+            for(size_t j = 0; j < len; j += 8) {
+                uint64_t r = test_random64();
+                memcpy(in + j, &r, len - j < 8 ? len - j : 8);
+            }
+        }
+    }
+}
+
+//! Adds one sample to a class, with Welford's update.
+static void ct_welch_add(test_ct_welch * w, int cls, double x) {
+    w -> n   [cls] += 1;
+    double d        = x - w -> mean[cls];
+    w -> mean[cls] += d / w -> n[cls];
+    w -> m2  [cls] += d * (x - w -> mean[cls]);
+}
+
+//! Welch's t statistic, as an absolute value.
+static double ct_welch_t(const test_ct_welch * w) {
+    if(w -> n[0] < 2 || w -> n[1] < 2) {
+        return 0;
+    }
+    double diff = fabs(w -> mean[0] - w -> mean[1]);
+    double se   = w -> m2[0] / (w -> n[0] - 1) / w -> n[0] +
+                  w -> m2[1] / (w -> n[1] - 1) / w -> n[1];
+    if(se == 0) {
+        // Both classes take a constant time: equal, or plainly not.
+        return diff == 0 ? 0 : INFINITY;
+    }
+    return diff / sqrt(se);
+}
+
+//! Sorts an array of timings in place.
+static void ct_sort(uint64_t * s, size_t n) {
+    for(size_t i = 1; i < n; i ++) {
+        uint64_t v = s[i];
+        size_t   j = i;
+        for(; j > 0 && s[j-1] > v; j --) {
+            s[j] = s[j-1];
+        }
+        s[j] = v;
+    }
+}
+
+void test_ct_run(
+    test_ct_result * result,
+    test_ct_fn       fn    ,
+    void           * ctx   ,
+    const uint8_t  * fixed ,
+    size_t           len
+){
+    const int     pcts[TEST_CT_TESTS - 1] = TEST_CT_CROP_PERCENTILES;
+    uint64_t      crop[TEST_CT_TESTS - 1];
+    test_ct_welch tests[TEST_CT_TESTS];
+    uint8_t       out[TEST_CT_MAX_INPUT];
+
+    if(len > TEST_CT_MAX_INPUT) {
+        printf("print(\"Constant time check input too long: %lu\")\n",
+            (unsigned long)len);
+        exit(1);
+    }
+
+    memset(tests, 0, sizeof(tests));
+
+    for(size_t done = 0; done < TEST_CT_WARMUP + TEST_CT_SAMPLES;
+               done += TEST_CT_BATCH) {
+
+        ct_fill_batch(fixed, len);
+
+        for(size_t i = 0; i < TEST_CT_BATCH; i ++) {
+            const uint64_t start = test_rdcycle();
+            fn(out, ct_inputs + i * len, ctx);
+            const uint64_t end   = test_rdcycle();
+            ct_cycles[i] = end - start;
+        }
+
+        for(size_t i = 0; i < TEST_CT_BATCH; i ++) {
+            size_t n = done + i;
+            if(n < TEST_CT_WARMUP) {
+                ct_warmup[n] = ct_cycles[i];
+                continue;
+            }
+            if(n == TEST_CT_WARMUP) {
+                ct_sort(ct_warmup, TEST_CT_WARMUP);
+                for(int k = 0; k < TEST_CT_TESTS - 1; k ++) {
+                    crop[k] = ct_warmup[(pcts[k] * TEST_CT_WARMUP - 1) / 100];
+                }
+            }
+            if(n >= TEST_CT_WARMUP + TEST_CT_SAMPLES) {
+                break;
+            }
+            ct_welch_add(&tests[0], ct_classes[i], ct_cycles[i]);
+            for(int k = 0; k < TEST_CT_TESTS - 1; k ++) {
+                if(ct_cycles[i] <= crop[k]) {
+                    ct_welch_add(&tests[k + 1], ct_classes[i], ct_cycles[i]);
+                }
+            }
+        }
+    }
+
+    result -> samples   = tests[0].n[0] + tests[0].n[1];
+    result -> t         = 0;
+    result -> crop      = 100;
+    result -> cycles[0] = tests[0].mean[0];
+    result -> cycles[1] = tests[0].mean[1];
+
+    for(int k = 0; k < TEST_CT_TESTS; k ++) {
+        double t = ct_welch_t(&tests[k]);
+        if(t > result -> t) {
+            result -> t     = t;
+            result -> crop  = k == 0 ? 100 : pcts[k - 1];
+        }
+    }
+}
+
+void test_ct_print(
+    const char           * name  ,
+    const test_ct_result * result
+){
+    const int leaks = result -> t > TEST_CT_T_THRESHOLD;
+    printf("print(\"%-24s %-12s %8s %10s %5s %10s %10s  %s\")\n",
+        "test", "algorithm", "samples", "max |t|", "crop", "fixed cyc",
+        "random cyc", "verdict");
+    printf("print(\"%-24s %-12s %8lu %10.2f %5d %10lu %10lu  %s\")\n",
+        STR(TEST_NAME), name, (unsigned long)result -> samples,
+        result -> t, result -> crop,
+        (unsigned long)result -> cycles[0],
+        (unsigned long)result -> cycles[1],
+        leaks ? "LEAKS" : "flat");
+    printf("#!ct %s,%s,%lu,%.4f,%lu,%lu\n", STR(TEST_NAME), name,
+        (unsigned long)result -> samples, result -> t,
+        (unsigned long)result -> cycles[0],
+        (unsigned long)result -> cycles[1]);
+}
+
+void test_ct(
+    const char     * name ,
+    test_ct_fn       fn   ,
+    void           * ctx  ,
+    const uint8_t  * fixed,
+    size_t           len
+){
+    test_ct_result result;
+    test_ct_run(&result, fn, ctx, fixed, len);
+    test_ct_print(name, &result);
+}
+
+//! @}
@@ -0,0 +1,130 @@
+
+/*!
+@defgroup test_ct Constant Time Checks
+@{
+@details A dudect style check for data dependent timing. A routine is run
+    over inputs of two classes: one fixed input, and fresh random inputs.
+    The classes are interleaved at random, so that drift in the machine
+    state affects both equally, and each run is timed with test_rdcycle.
+    Welch's t-test then asks whether the two classes come from timing
+    distributions with the same mean.
+
+    The test is made on all the samples, and again on only those below
+    each of TEST_CT_CROP_PERCENTILES, which keeps interrupts and other
+    long tails from hiding a small difference. The largest |t| of these
+    is reported. Above TEST_CT_T_THRESHOLD, the routine is taken to leak.
+
+    Under Spike rdcycle counts instructions, so only data dependent
+    control flow shows up there. Data dependent memory accesses (e.g.
+    table lookups) only show on hardware or a model with caches.
+
+    The TEST_CT_* parameters may be overridden from CFLAGS.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef __SHARE_CT_H__
+#define __SHARE_CT_H__
+
+#ifndef TEST_CT_SAMPLES
+//! Number of measured runs of each routine, over both classes.
+#define TEST_CT_SAMPLES 10000
+#endif
+
+#ifndef TEST_CT_BATCH
+//! Inputs are generated this many at a time, outside of the measurements.
+#define TEST_CT_BATCH 100
+#endif
+
+#ifndef TEST_CT_WARMUP
+//! Unmeasured runs before sampling. Their timings set the crop points.
+#define TEST_CT_WARMUP 1000
+#endif
+
+#ifndef TEST_CT_T_THRESHOLD
+//! |t| above which a routine is reported as leaking.
+#define TEST_CT_T_THRESHOLD 4.5
+#endif
+
+//! Longest input a routine may take, in bytes.
+#define TEST_CT_MAX_INPUT 64
+
+//! Percentiles of the warm up timings to crop the samples at.
+#define TEST_CT_CROP_PERCENTILES {50, 75, 90, 95, 99}
+
+//! Number of t-tests made: one uncropped, plus one per crop point.
+#define TEST_CT_TESTS 6
+
+/*!
+@brief A routine being checked. It reads len bytes from in (len being
+    the length given to test_ct_run), and may write up to
+    TEST_CT_MAX_INPUT bytes to out.
+@param [out] out - Output buffer.
+@param [in] in - Input, of the fixed or the random class.
+@param [in] ctx - Routine specific context (keys etc).
+*/
+typedef void (*test_ct_fn)(
+    uint8_t       * out,
+    const uint8_t * in ,
+    void          * ctx
+);
+
+//! Running statistics of the two classes, for Welch's t-test.
+typedef struct {
+    uint64_t n   [2];   //!< Samples in each class.
+    double   mean[2];   //!< Mean cycles of each class.
+    double   m2  [2];   //!< Sum of squared differences from the mean.
+} test_ct_welch;
+
+//! Outcome of checking one routine.
+typedef struct {
+    size_t   samples;   //!< Number of measured runs.
+    double   t;         //!< Largest |t| over the tests.
+    int      crop;      //!< Percentile that test cropped at, or 100.
+    uint64_t cycles[2]; //!< Mean cycles of the fixed and random class.
+} test_ct_result;
+
+/*!
+@brief Runs fn over TEST_CT_SAMPLES interleaved inputs of the fixed and
+    random classes, and tests whether their timings differ.
+@param [out] result - Where to put the outcome.
+@param [in] fn - The routine to check.
+@param [in] ctx - Passed to fn.
+@param [in] fixed - The input of the fixed class, len bytes.
+@param [in] len - Input length in bytes, at most TEST_CT_MAX_INPUT.
+*/
+void test_ct_run(
+    test_ct_result * result,
+    test_ct_fn       fn    ,
+    void           * ctx   ,
+    const uint8_t  * fixed ,
+    size_t           len
+);
+
+/*!
+@brief Prints the outcome as a python3 print statement, and records it
+    as a python comment of the form
+    `#!ct <test>,<algorithm>,<samples>,<t>,<fixed cycles>,<random cycles>`,
+    which benchmarks/tools/results.py collects.
+@param [in] name - The routine checked, e.g. "aes_128_enc".
+*/
+void test_ct_print(
+    const char           * name  ,
+    const test_ct_result * result
+);
+
+/*!
+@brief Runs test_ct_run, then test_ct_print.
+*/
+void test_ct(
+    const char     * name ,
+    test_ct_fn       fn   ,
+    void           * ctx  ,
+    const uint8_t  * fixed,
+    size_t           len
+);
+
+#endif
+
+//! @}
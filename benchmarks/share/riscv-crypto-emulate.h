@@ -0,0 +1,305 @@
+
+/*
+ * Portable C emulation of the scalar cryptography intrinsics in
+ * riscv-crypto-intrinsics.h, used when building for a non-RISC-V host.
+ * See config/host.conf.
+ *
+ * Each function follows the Sail model of its instruction in
+ * doc/scalar/insns/, including sign-extension of 32-bit results on RV64.
+ * When compiled with -maes, the RV64 AES round instructions use AES-NI
+ * instead, see riscv-crypto-x86.h.
+ *
+ * This header is only included by riscv-crypto-intrinsics.h, which
+ * defines uint_xlen_t and RISCV_CRYPTO_RV32 / RISCV_CRYPTO_RV64 first.
+ */
+
+#ifndef __RISCV_CRYPTO_EMULATE__
+#define __RISCV_CRYPTO_EMULATE__
+
+#include <stdlib.h>
+
+//
+// Helpers
+//
+
+//! Sign-extend a 32-bit result to XLEN bits.
+#define _RVC_EXTS32(X) ((uint_xlen_t)(int32_t)(uint32_t)(X))
+
+static inline uint32_t _rvc_ror32(uint32_t x, int n) {
+    n &= 31; return n ? (x >> n) | (x << (32-n)) : x;
+}
+
+static inline uint32_t _rvc_rol32(uint32_t x, int n) {
+    return _rvc_ror32(x, 32-(n&31));
+}
+
+static inline uint64_t _rvc_ror64(uint64_t x, int n) {
+    n &= 63; return n ? (x >> n) | (x << (64-n)) : x;
+}
+
+static const uint8_t _rvc_aes_fwd_sbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b,
+    0xfe, 0xd7, 0xab, 0x76, 0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0,
+    0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0, 0xb7, 0xfd, 0x93, 0x26,
+    0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2,
+    0xeb, 0x27, 0xb2, 0x75, 0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0,
+    0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84, 0x53, 0xd1, 0x00, 0xed,
+    0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f,
+    0x50, 0x3c, 0x9f, 0xa8, 0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5,
+    0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2, 0xcd, 0x0c, 0x13, 0xec,
+    0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14,
+    0xde, 0x5e, 0x0b, 0xdb, 0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c,
+    0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79, 0xe7, 0xc8, 0x37, 0x6d,
+    0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f,
+    0x4b, 0xbd, 0x8b, 0x8a, 0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e,
+    0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e, 0xe1, 0xf8, 0x98, 0x11,
+    0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f,
+    0xb0, 0x54, 0xbb, 0x16
+};
+
+static const uint8_t _rvc_aes_inv_sbox[256] = {
+    0x52, 0x09, 0x6a, 0xd5, 0x30, 0x36, 0xa5, 0x38, 0xbf, 0x40, 0xa3, 0x9e,
+    0x81, 0xf3, 0xd7, 0xfb, 0x7c, 0xe3, 0x39, 0x82, 0x9b, 0x2f, 0xff, 0x87,
+    0x34, 0x8e, 0x43, 0x44, 0xc4, 0xde, 0xe9, 0xcb, 0x54, 0x7b, 0x94, 0x32,
+    0xa6, 0xc2, 0x23, 0x3d, 0xee, 0x4c, 0x95, 0x0b, 0x42, 0xfa, 0xc3, 0x4e,
+    0x08, 0x2e, 0xa1, 0x66, 0x28, 0xd9, 0x24, 0xb2, 0x76, 0x5b, 0xa2, 0x49,
+    0x6d, 0x8b, 0xd1, 0x25, 0x72, 0xf8, 0xf6, 0x64, 0x86, 0x68, 0x98, 0x16,
+    0xd4, 0xa4, 0x5c, 0xcc, 0x5d, 0x65, 0xb6, 0x92, 0x6c, 0x70, 0x48, 0x50,
+    0xfd, 0xed, 0xb9, 0xda, 0x5e, 0x15, 0x46, 0x57, 0xa7, 0x8d, 0x9d, 0x84,
+    0x90, 0xd8, 0xab, 0x00, 0x8c, 0xbc, 0xd3, 0x0a, 0xf7, 0xe4, 0x58, 0x05,
+    0xb8, 0xb3, 0x45, 0x06, 0xd0, 0x2c, 0x1e, 0x8f, 0xca, 0x3f, 0x0f, 0x02,
+    0xc1, 0xaf, 0xbd, 0x03, 0x01, 0x13, 0x8a, 0x6b, 0x3a, 0x91, 0x11, 0x41,
+    0x4f, 0x67, 0xdc, 0xea, 0x97, 0xf2, 0xcf, 0xce, 0xf0, 0xb4, 0xe6, 0x73,
+    0x96, 0xac, 0x74, 0x22, 0xe7, 0xad, 0x35, 0x85, 0xe2, 0xf9, 0x37, 0xe8,
+    0x1c, 0x75, 0xdf, 0x6e, 0x47, 0xf1, 0x1a, 0x71, 0x1d, 0x29, 0xc5, 0x89,
+    0x6f, 0xb7, 0x62, 0x0e, 0xaa, 0x18, 0xbe, 0x1b, 0xfc, 0x56, 0x3e, 0x4b,
+    0xc6, 0xd2, 0x79, 0x20, 0x9a, 0xdb, 0xc0, 0xfe, 0x78, 0xcd, 0x5a, 0xf4,
+    0x1f, 0xdd, 0xa8, 0x33, 0x88, 0x07, 0xc7, 0x31, 0xb1, 0x12, 0x10, 0x59,
+    0x27, 0x80, 0xec, 0x5f, 0x60, 0x51, 0x7f, 0xa9, 0x19, 0xb5, 0x4a, 0x0d,
+    0x2d, 0xe5, 0x7a, 0x9f, 0x93, 0xc9, 0x9c, 0xef, 0xa0, 0xe0, 0x3b, 0x4d,
+    0xae, 0x2a, 0xf5, 0xb0, 0xc8, 0xeb, 0xbb, 0x3c, 0x83, 0x53, 0x99, 0x61,
+    0x17, 0x2b, 0x04, 0x7e, 0xba, 0x77, 0xd6, 0x26, 0xe1, 0x69, 0x14, 0x63,
+    0x55, 0x21, 0x0c, 0x7d
+};
+
+static const uint8_t _rvc_sm4_sbox[256] = {
+    0xd6, 0x90, 0xe9, 0xfe, 0xcc, 0xe1, 0x3d, 0xb7, 0x16, 0xb6, 0x14, 0xc2,
+    0x28, 0xfb, 0x2c, 0x05, 0x2b, 0x67, 0x9a, 0x76, 0x2a, 0xbe, 0x04, 0xc3,
+    0xaa, 0x44, 0x13, 0x26, 0x49, 0x86, 0x06, 0x99, 0x9c, 0x42, 0x50, 0xf4,
+    0x91, 0xef, 0x98, 0x7a, 0x33, 0x54, 0x0b, 0x43, 0xed, 0xcf, 0xac, 0x62,
+    0xe4, 0xb3, 0x1c, 0xa9, 0xc9, 0x08, 0xe8, 0x95, 0x80, 0xdf, 0x94, 0xfa,
+    0x75, 0x8f, 0x3f, 0xa6, 0x47, 0x07, 0xa7, 0xfc, 0xf3, 0x73, 0x17, 0xba,
+    0x83, 0x59, 0x3c, 0x19, 0xe6, 0x85, 0x4f, 0xa8, 0x68, 0x6b, 0x81, 0xb2,
+    0x71, 0x64, 0xda, 0x8b, 0xf8, 0xeb, 0x0f, 0x4b, 0x70, 0x56, 0x9d, 0x35,
+    0x1e, 0x24, 0x0e, 0x5e, 0x63, 0x58, 0xd1, 0xa2, 0x25, 0x22, 0x7c, 0x3b,
+    0x01, 0x21, 0x78, 0x87, 0xd4, 0x00, 0x46, 0x57, 0x9f, 0xd3, 0x27, 0x52,
+    0x4c, 0x36, 0x02, 0xe7, 0xa0, 0xc4, 0xc8, 0x9e, 0xea, 0xbf, 0x8a, 0xd2,
+    0x40, 0xc7, 0x38, 0xb5, 0xa3, 0xf7, 0xf2, 0xce, 0xf9, 0x61, 0x15, 0xa1,
+    0xe0, 0xae, 0x5d, 0xa4, 0x9b, 0x34, 0x1a, 0x55, 0xad, 0x93, 0x32, 0x30,
+    0xf5, 0x8c, 0xb1, 0xe3, 0x1d, 0xf6, 0xe2, 0x2e, 0x82, 0x66, 0xca, 0x60,
+    0xc0, 0x29, 0x23, 0xab, 0x0d, 0x53, 0x4e, 0x6f, 0xd5, 0xdb, 0x37, 0x45,
+    0xde, 0xfd, 0x8e, 0x2f, 0x03, 0xff, 0x6a, 0x72, 0x6d, 0x6c, 0x5b, 0x51,
+    0x8d, 0x1b, 0xaf, 0x92, 0xbb, 0xdd, 0xbc, 0x7f, 0x11, 0xd9, 0x5c, 0x41,
+    0x1f, 0x10, 0x5a, 0xd8, 0x0a, 0xc1, 0x31, 0x88, 0xa5, 0xcd, 0x7b, 0xbd,
+    0x2d, 0x74, 0xd0, 0x12, 0xb8, 0xe5, 0xb4, 0xb0, 0x89, 0x69, 0x97, 0x4a,
+    0x0c, 0x96, 0x77, 0x7e, 0x65, 0xb9, 0xf1, 0x09, 0xc5, 0x6e, 0xc6, 0x84,
+    0x18, 0xf0, 0x7d, 0xec, 0x3a, 0xdc, 0x4d, 0x20, 0x79, 0xee, 0x5f, 0x3e,
+    0xd7, 0xcb, 0x39, 0x48
+};
+
+//! Multiply by x in GF(2^8) modulo the AES polynomial.
+static inline uint8_t _rvc_xtime(uint8_t a) {
+    return (a << 1) ^ ((a & 0x80) ? 0x1b : 0x00);
+}
+
+static inline uint8_t _rvc_gfmul(uint8_t a, uint8_t b) {
+    uint8_t r = 0;
+    while(b) {
+        if(b & 1) r ^= a;
+        a   = _rvc_xtime(a);
+        b >>= 1;
+    }
+    return r;
+}
+
+//! AES MixColumns of one column, row 0 in the least significant byte.
+static inline uint32_t _rvc_aes_mixcolumn_fwd(uint32_t col) {
+    uint8_t a0 = col, a1 = col >> 8, a2 = col >> 16, a3 = col >> 24;
+    uint8_t b0 = _rvc_gfmul(a0,2) ^ _rvc_gfmul(a1,3) ^ a2 ^ a3;
+    uint8_t b1 = a0 ^ _rvc_gfmul(a1,2) ^ _rvc_gfmul(a2,3) ^ a3;
+    uint8_t b2 = a0 ^ a1 ^ _rvc_gfmul(a2,2) ^ _rvc_gfmul(a3,3);
+    uint8_t b3 = _rvc_gfmul(a0,3) ^ a1 ^ a2 ^ _rvc_gfmul(a3,2);
+    return ((uint32_t)b3 << 24) | ((uint32_t)b2 << 16) |
+           ((uint32_t)b1 <<  8) | b0;
+}
+
+//! AES InvMixColumns of one column, row 0 in the least significant byte.
+static inline uint32_t _rvc_aes_mixcolumn_inv(uint32_t col) {
+    uint8_t a0 = col, a1 = col >> 8, a2 = col >> 16, a3 = col >> 24;
+    uint8_t b0 = _rvc_gfmul(a0,14)^_rvc_gfmul(a1,11)^_rvc_gfmul(a2,13)^_rvc_gfmul(a3, 9);
+    uint8_t b1 = _rvc_gfmul(a0, 9)^_rvc_gfmul(a1,14)^_rvc_gfmul(a2,11)^_rvc_gfmul(a3,13);
+    uint8_t b2 = _rvc_gfmul(a0,13)^_rvc_gfmul(a1, 9)^_rvc_gfmul(a2,14)^_rvc_gfmul(a3,11);
+    uint8_t b3 = _rvc_gfmul(a0,11)^_rvc_gfmul(a1,13)^_rvc_gfmul(a2, 9)^_rvc_gfmul(a3,14);
+    return ((uint32_t)b3 << 24) | ((uint32_t)b2 << 16) |
+           ((uint32_t)b1 <<  8) | b0;
+}
+
+static inline uint32_t _rvc_aes_subword_fwd(uint32_t x) {
+    return ((uint32_t)_rvc_aes_fwd_sbox[(x >> 24) & 0xFF] << 24) |
+           ((uint32_t)_rvc_aes_fwd_sbox[(x >> 16) & 0xFF] << 16) |
+           ((uint32_t)_rvc_aes_fwd_sbox[(x >>  8) & 0xFF] <<  8) |
+           ((uint32_t)_rvc_aes_fwd_sbox[(x      ) & 0xFF]      ) ;
+}
+
+/*
+@details Low 64 bits of (Inv)ShiftRows then (Inv)SubBytes of the state
+    rs2:rs1, where rs1 holds columns 0 and 1. inv selects the inverse
+    transforms.
+*/
+static inline uint64_t _rvc_aes64_sr_sb(uint64_t rs1, uint64_t rs2, int inv) {
+    uint64_t rd = 0;
+    for(int k = 0; k < 8; k ++) {
+        int      c   = k / 4, r = k % 4;
+        int      src = ((inv ? c + 4 - r : c + r) % 4) * 4 + r;
+        uint8_t  b   = (src < 8 ? rs1 : rs2) >> (8 * (src % 8));
+        b            = inv ? _rvc_aes_inv_sbox[b] : _rvc_aes_fwd_sbox[b];
+        rd          |= (uint64_t)b << (8 * k);
+    }
+    return rd;
+}
+
+static inline uint64_t _rvc_aes64_mix(uint64_t x, int inv) {
+    uint32_t lo = x, hi = x >> 32;
+    lo = inv ? _rvc_aes_mixcolumn_inv(lo) : _rvc_aes_mixcolumn_fwd(lo);
+    hi = inv ? _rvc_aes_mixcolumn_inv(hi) : _rvc_aes_mixcolumn_fwd(hi);
+    return ((uint64_t)hi << 32) | lo;
+}
+
+//
+// SHA256
+//
+
+static inline uint_xlen_t _sha256sig0 (uint_xlen_t rs1) {uint32_t a = rs1; return _RVC_EXTS32(_rvc_ror32(a, 7) ^ _rvc_ror32(a,18) ^ (a >>  3));}
+static inline uint_xlen_t _sha256sig1 (uint_xlen_t rs1) {uint32_t a = rs1; return _RVC_EXTS32(_rvc_ror32(a,17) ^ _rvc_ror32(a,19) ^ (a >> 10));}
+static inline uint_xlen_t _sha256sum0 (uint_xlen_t rs1) {uint32_t a = rs1; return _RVC_EXTS32(_rvc_ror32(a, 2) ^ _rvc_ror32(a,13) ^ _rvc_ror32(a,22));}
+static inline uint_xlen_t _sha256sum1 (uint_xlen_t rs1) {uint32_t a = rs1; return _RVC_EXTS32(_rvc_ror32(a, 6) ^ _rvc_ror32(a,11) ^ _rvc_ror32(a,25));}
+
+//
+// SHA512
+//
+
+#if defined(RISCV_CRYPTO_RV32)
+static inline uint_xlen_t _sha512sig0l(uint_xlen_t rs1, uint_xlen_t rs2) {return (rs1 >>  1) ^ (rs1 >>  7) ^ (rs1 >>  8) ^ (rs2 << 31) ^ (rs2 << 25) ^ (rs2 << 24);}
+static inline uint_xlen_t _sha512sig0h(uint_xlen_t rs1, uint_xlen_t rs2) {return (rs1 >>  1) ^ (rs1 >>  7) ^ (rs1 >>  8) ^ (rs2 << 31)               ^ (rs2 << 24);}
+static inline uint_xlen_t _sha512sig1l(uint_xlen_t rs1, uint_xlen_t rs2) {return (rs1 <<  3) ^ (rs1 >>  6) ^ (rs1 >> 19) ^ (rs2 >> 29) ^ (rs2 << 26) ^ (rs2 << 13);}
+static inline uint_xlen_t _sha512sig1h(uint_xlen_t rs1, uint_xlen_t rs2) {return (rs1 <<  3) ^ (rs1 >>  6) ^ (rs1 >> 19) ^ (rs2 >> 29)               ^ (rs2 << 13);}
+static inline uint_xlen_t _sha512sum0r(uint_xlen_t rs1, uint_xlen_t rs2) {return (rs1 << 25) ^ (rs1 << 30) ^ (rs1 >> 28) ^ (rs2 >>  7) ^ (rs2 >>  2) ^ (rs2 <<  4);}
+static inline uint_xlen_t _sha512sum1r(uint_xlen_t rs1, uint_xlen_t rs2) {return (rs1 << 23) ^ (rs1 >> 14) ^ (rs1 >> 18) ^ (rs2 >>  9) ^ (rs2 << 18) ^ (rs2 << 14);}
+#elif defined(RISCV_CRYPTO_RV64)
+static inline uint_xlen_t _sha512sig0 (uint_xlen_t rs1) {return _rvc_ror64(rs1, 1) ^ _rvc_ror64(rs1, 8) ^ (rs1 >> 7);}
+static inline uint_xlen_t _sha512sig1 (uint_xlen_t rs1) {return _rvc_ror64(rs1,19) ^ _rvc_ror64(rs1,61) ^ (rs1 >> 6);}
+static inline uint_xlen_t _sha512sum0 (uint_xlen_t rs1) {return _rvc_ror64(rs1,28) ^ _rvc_ror64(rs1,34) ^ _rvc_ror64(rs1,39);}
+static inline uint_xlen_t _sha512sum1 (uint_xlen_t rs1) {return _rvc_ror64(rs1,14) ^ _rvc_ror64(rs1,18) ^ _rvc_ror64(rs1,41);}
+#endif
+
+//
+// AES
+//
+
+#if defined(RISCV_CRYPTO_RV32)
+static inline uint_xlen_t _aes32esi (uint_xlen_t rs1, uint_xlen_t rs2, int bs) {
+    uint8_t  so = _rvc_aes_fwd_sbox[(rs2 >> (8*bs)) & 0xFF];
+    return rs1 ^ _rvc_rol32(so, 8*bs);
+}
+static inline uint_xlen_t _aes32esmi(uint_xlen_t rs1, uint_xlen_t rs2, int bs) {
+    uint8_t  so = _rvc_aes_fwd_sbox[(rs2 >> (8*bs)) & 0xFF];
+    uint32_t mx = ((uint32_t)_rvc_gfmul(so, 3) << 24) | ((uint32_t)so << 16) |
+                  ((uint32_t)so << 8) | _rvc_gfmul(so, 2);
+    return rs1 ^ _rvc_rol32(mx, 8*bs);
+}
+static inline uint_xlen_t _aes32dsi (uint_xlen_t rs1, uint_xlen_t rs2, int bs) {
+    uint8_t  so = _rvc_aes_inv_sbox[(rs2 >> (8*bs)) & 0xFF];
+    return rs1 ^ _rvc_rol32(so, 8*bs);
+}
+static inline uint_xlen_t _aes32dsmi(uint_xlen_t rs1, uint_xlen_t rs2, int bs) {
+    uint8_t  so = _rvc_aes_inv_sbox[(rs2 >> (8*bs)) & 0xFF];
+    uint32_t mx = ((uint32_t)_rvc_gfmul(so,11) << 24) |
+                  ((uint32_t)_rvc_gfmul(so,13) << 16) |
+                  ((uint32_t)_rvc_gfmul(so, 9) <<  8) | _rvc_gfmul(so,14);
+    return rs1 ^ _rvc_rol32(mx, 8*bs);
+}
+#endif
+
+#if defined(RISCV_CRYPTO_RV64)
+static inline uint_xlen_t _aes64ks1i  (uint_xlen_t rs1, int      rnum) {
+    static const uint8_t rcon[11] = {
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36, 0x00};
+    uint32_t t = rs1 >> 32;
+    t = rnum == 0xA ? t : _rvc_ror32(t, 8);
+    t = _rvc_aes_subword_fwd(t) ^ rcon[rnum];
+    return ((uint64_t)t << 32) | t;
+}
+static inline uint_xlen_t _aes64ks2   (uint_xlen_t rs1, uint_xlen_t rs2 ) {
+    uint32_t w0 = (rs1 >> 32) ^ (uint32_t)rs2;
+    uint32_t w1 = w0 ^ (rs2 >> 32);
+    return ((uint64_t)w1 << 32) | w0;
+}
+#if defined(__AES__)
+#include "riscv-crypto-x86.h"
+#else
+static inline uint_xlen_t _aes64im    (uint_xlen_t rs1               ) {return _rvc_aes64_mix(rs1, 1);}
+static inline uint_xlen_t _aes64esm   (uint_xlen_t rs1, uint_xlen_t rs2 ) {return _rvc_aes64_mix(_rvc_aes64_sr_sb(rs1, rs2, 0), 0);}
+static inline uint_xlen_t _aes64es    (uint_xlen_t rs1, uint_xlen_t rs2 ) {return _rvc_aes64_sr_sb(rs1, rs2, 0);}
+static inline uint_xlen_t _aes64dsm   (uint_xlen_t rs1, uint_xlen_t rs2 ) {return _rvc_aes64_mix(_rvc_aes64_sr_sb(rs1, rs2, 1), 1);}
+static inline uint_xlen_t _aes64ds    (uint_xlen_t rs1, uint_xlen_t rs2 ) {return _rvc_aes64_sr_sb(rs1, rs2, 1);}
+#endif
+#endif
+
+//
+// SM4
+//
+
+static inline uint_xlen_t _sm4ks (uint_xlen_t rs1, uint_xlen_t rs2, int bs) {
+    uint32_t x = _rvc_sm4_sbox[((uint32_t)rs2 >> (8*bs)) & 0xFF];
+    uint32_t y = x ^ ((x & 0x07) << 29) ^ ((x & 0xFE) <<  7) ^
+                     ((x & 0x01) << 23) ^ ((x & 0xF8) << 13) ;
+    return _RVC_EXTS32((uint32_t)rs1 ^ _rvc_rol32(y, 8*bs));
+}
+static inline uint_xlen_t _sm4ed (uint_xlen_t rs1, uint_xlen_t rs2, int bs) {
+    uint32_t x = _rvc_sm4_sbox[((uint32_t)rs2 >> (8*bs)) & 0xFF];
+    uint32_t y = x ^ (x <<  8) ^ (x << 2) ^ (x << 18) ^
+                 ((x & 0x3F) << 26) ^ ((x & 0xC0) << 10);
+    return _RVC_EXTS32((uint32_t)rs1 ^ _rvc_rol32(y, 8*bs));
+}
+
+//
+// SM3
+//
+
+static inline uint_xlen_t _sm3p0 (uint_xlen_t rs1) {uint32_t a = rs1; return _RVC_EXTS32(a ^ _rvc_rol32(a, 9) ^ _rvc_rol32(a,17));}
+static inline uint_xlen_t _sm3p1 (uint_xlen_t rs1) {uint32_t a = rs1; return _RVC_EXTS32(a ^ _rvc_rol32(a,15) ^ _rvc_rol32(a,23));}
+
+//
+// pollentropy / getnoise
+//
+
+//! Always reports ES16, with 16 bits from rand(). Not a real entropy source.
+static inline uint_xlen_t _pollentropy() {return (2 << 30) | (rand() & 0xFFFF);}
+static inline uint_xlen_t _getnoise()    {return 0;}
+
+//
+// Bitmanip Instruction Intrinsics
+//
+
+#define _RVC_HALF (4 * sizeof(uint_xlen_t))
+
+static inline uint_xlen_t _pack  (uint_xlen_t rs1, uint_xlen_t rs2) {return (rs1 << _RVC_HALF >> _RVC_HALF) | (rs2 << _RVC_HALF);}
+static inline uint_xlen_t _packu (uint_xlen_t rs1, uint_xlen_t rs2) {return (rs1 >> _RVC_HALF) | (rs2 >> _RVC_HALF << _RVC_HALF);}
+static inline uint_xlen_t _packh (uint_xlen_t rs1, uint_xlen_t rs2) {return (rs1 & 0xFF) | ((rs2 & 0xFF) << 8);}
+
+#endif // __RISCV_CRYPTO_EMULATE__
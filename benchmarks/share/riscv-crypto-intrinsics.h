@@ -5,10 +5,31 @@
 #ifndef __RISCV_CRYPTO_INTRINSICS__
 #define __RISCV_CRYPTO_INTRINSICS__
 
-#ifdef __ZSCRYPTO
-#define EMULATE_ZSCRYPTO
+//
+// When not targeting RISC-V (e.g. config/host.conf), the intrinsics are
+// emulated in portable C by riscv-crypto-emulate.h, with XLEN taken from
+// the host pointer width. -DRISCV_CRYPTO_XLEN=32 emulates RV32 on a 64-bit
+// host instead (see config/host-rv32.conf).
+//
+
+#if !defined(__riscv_xlen) && !defined(RISCV_CRYPTO_EMULATE)
+#define RISCV_CRYPTO_EMULATE
 #endif
 
+#if defined(RISCV_CRYPTO_EMULATE)
+
+#if UINTPTR_MAX == UINT64_MAX && RISCV_CRYPTO_XLEN != 32
+#define RISCV_CRYPTO_RV64
+typedef uint64_t uint_xlen_t;
+#else
+#define RISCV_CRYPTO_RV32
+typedef uint32_t uint_xlen_t;
+#endif
+
+#include "riscv-crypto-emulate.h"
+
+#else
+
 #if __riscv_xlen == 32
 #define RISCV_CRYPTO_RV32
 typedef uint32_t uint_xlen_t;
@@ -106,5 +127,7 @@ static inline uint_xlen_t _packu (uint_xlen_t rs1, uint_xlen_t rs2) {uint_xlen_t
 static inline uint_xlen_t _packh (uint_xlen_t rs1, uint_xlen_t rs2) {uint_xlen_t rd; __asm__("packh %0, %1, %2" : "=r"(rd) : "r"(rs1), "r"(rs2)); return rd;}
 #endif
 
+#endif // RISCV_CRYPTO_EMULATE
+
 #endif // __RISCV_CRYPTO_INTRINSICS__
 
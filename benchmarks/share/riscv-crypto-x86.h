@@ -0,0 +1,35 @@
+
+/*
+ * x86 implementations of some of the emulated RV64 AES intrinsics, used by
+ * riscv-crypto-emulate.h when compiling for a host with AES-NI (-maes).
+ * See config/host-x86.conf.
+ *
+ * The two 64-bit halves rs1 (columns 0, 1) and rs2 (columns 2, 3) are
+ * packed into one 128-bit AES state. AES-NI then does a whole round, of
+ * which the low 64 bits are the aes64* result. The round key inputs are
+ * zero, since the RISC-V instructions do not do AddRoundKey.
+ *
+ * aes64ks1i is left to the portable C version, since aeskeygenassist
+ * needs its round constant as an immediate.
+ */
+
+#ifndef __RISCV_CRYPTO_X86__
+#define __RISCV_CRYPTO_X86__
+
+#include <wmmintrin.h>
+
+static inline __m128i _rvc_x86_state(uint64_t rs1, uint64_t rs2) {
+    return _mm_set_epi64x(rs2, rs1);
+}
+
+static inline uint64_t _rvc_x86_low(__m128i x) {
+    return _mm_cvtsi128_si64(x);
+}
+
+static inline uint_xlen_t _aes64esm   (uint_xlen_t rs1, uint_xlen_t rs2 ) {return _rvc_x86_low(_mm_aesenc_si128    (_rvc_x86_state(rs1, rs2), _mm_setzero_si128()));}
+static inline uint_xlen_t _aes64es    (uint_xlen_t rs1, uint_xlen_t rs2 ) {return _rvc_x86_low(_mm_aesenclast_si128(_rvc_x86_state(rs1, rs2), _mm_setzero_si128()));}
+static inline uint_xlen_t _aes64dsm   (uint_xlen_t rs1, uint_xlen_t rs2 ) {return _rvc_x86_low(_mm_aesdec_si128    (_rvc_x86_state(rs1, rs2), _mm_setzero_si128()));}
+static inline uint_xlen_t _aes64ds    (uint_xlen_t rs1, uint_xlen_t rs2 ) {return _rvc_x86_low(_mm_aesdeclast_si128(_rvc_x86_state(rs1, rs2), _mm_setzero_si128()));}
+static inline uint_xlen_t _aes64im    (uint_xlen_t rs1               ) {return _rvc_x86_low(_mm_aesimc_si128    (_rvc_x86_state(rs1, 0  )));}
+
+#endif // __RISCV_CRYPTO_X86__
@@ -605,6 +605,27 @@ static inline int64_t _rv64_bdep(int64_t rs1, int64_t rs2)
 	return c;
 }
 
+#ifdef __PCLMUL__
+// Carry-less multiply with x86 PCLMULQDQ, used by benchmarks/config/host-x86.conf.
+#include <wmmintrin.h>
+
+static inline __m128i _rvintrin_pclmul(uint64_t a, uint64_t b)
+{
+	return _mm_clmulepi64_si128(_mm_cvtsi64_si128(a), _mm_cvtsi64_si128(b), 0x00);
+}
+
+static inline int32_t _rv32_clmul (int32_t rs1, int32_t rs2) { return (uint64_t)_mm_cvtsi128_si64(_rvintrin_pclmul((uint32_t)rs1, (uint32_t)rs2)); }
+static inline int32_t _rv32_clmulh(int32_t rs1, int32_t rs2) { return (uint64_t)_mm_cvtsi128_si64(_rvintrin_pclmul((uint32_t)rs1, (uint32_t)rs2)) >> 32; }
+static inline int32_t _rv32_clmulr(int32_t rs1, int32_t rs2) { return (uint64_t)_mm_cvtsi128_si64(_rvintrin_pclmul((uint32_t)rs1, (uint32_t)rs2)) >> 31; }
+
+static inline int64_t _rv64_clmul (int64_t rs1, int64_t rs2) { return _mm_cvtsi128_si64(_rvintrin_pclmul(rs1, rs2)); }
+static inline int64_t _rv64_clmulh(int64_t rs1, int64_t rs2) { return _mm_cvtsi128_si64(_mm_unpackhi_epi64(_rvintrin_pclmul(rs1, rs2), _mm_setzero_si128())); }
+static inline int64_t _rv64_clmulr(int64_t rs1, int64_t rs2)
+{
+	__m128i x = _rvintrin_pclmul(rs1, rs2);
+	return ((uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(x, x)) << 1) | ((uint64_t)_mm_cvtsi128_si64(x) >> 63);
+}
+#else
 static inline int32_t _rv32_clmul(int32_t rs1, int32_t rs2)
 {
 	uint32_t a = rs1, b = rs2, x = 0;
@@ -658,6 +679,7 @@ static inline int64_t _rv64_clmulr(int64_t rs1, int64_t rs2)
 			x ^= a >> (63-i);
 	return x;
 }
+#endif
 
 static inline uint32_t _rvintrin_xperm32(uint32_t rs1, uint32_t rs2, int sz_log2)
 {
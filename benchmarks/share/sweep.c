@@ -0,0 +1,156 @@
+
+/*! @addtogroup test_sweep
+@{
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "sweep.h"
+#include "util.h"
+
+#ifndef TEST_NAME
+#define TEST_NAME unknown
+#endif
+
+//! Input and output buffers, shared by every sweep of a program.
+static uint8_t * sweep_in  = NULL;
+static uint8_t * sweep_out = NULL;
+
+//! Longest input length, see test_sweep_max_bytes.
+static size_t    sweep_max = 0;
+
+size_t test_sweep_max_bytes() {
+    if(sweep_max == 0) {
+        const char * env = getenv("TEST_SWEEP_MAX_BYTES");
+        sweep_max = TEST_SWEEP_MAX_BYTES;
+        if(env != NULL) {
+            size_t len = strtoul(env, NULL, 0);
+            if(len >= TEST_SWEEP_MIN_BYTES) {
+                sweep_max = len;
+            }
+        }
+    }
+    return sweep_max;
+}
+
+//! Sorts a (short) array of samples in place.
+static void sweep_sort(uint64_t * s, size_t n) {
+    for(size_t i = 1; i < n; i ++) {
+        uint64_t v = s[i];
+        size_t   j = i;
+        for(; j > 0 && s[j-1] > v; j --) {
+            s[j] = s[j-1];
+        }
+        s[j] = v;
+    }
+}
+
+//! Nearest rank percentile of sorted samples, pct in [1, 100].
+static uint64_t sweep_percentile(const uint64_t * s, size_t n, size_t pct) {
+    size_t rank = (pct * n + 99) / 100;
+    return s[rank > 0 ? rank - 1 : 0];
+}
+
+size_t test_sweep_run(
+    test_sweep_point * points ,
+    test_sweep_fn      fn     ,
+    void             * ctx    ,
+    size_t             granule
+){
+    uint64_t cycles [TEST_SWEEP_MAX_SAMPLES];
+    uint64_t instret[TEST_SWEEP_MAX_SAMPLES];
+    size_t   npoints = 0;
+    size_t   max_len = test_sweep_max_bytes();
+
+    if(sweep_in == NULL) {
+        sweep_in  = test_pool(max_len);
+        sweep_out = test_pool_alloc(max_len);
+    }
+
+    for(size_t len  = TEST_SWEEP_MIN_BYTES;
+               len <= max_len && npoints < TEST_SWEEP_MAX_POINTS;
+               len *= 2) {
+
+        size_t run_len = len - (len % granule);
+        if(run_len == 0) {
+            continue;
+        }
+
+        size_t samples = TEST_SWEEP_BYTE_BUDGET / run_len;
+        if(samples < TEST_SWEEP_MIN_SAMPLES) {
+            samples = TEST_SWEEP_MIN_SAMPLES;
+        }
+        if(run_len <= TEST_SWEEP_TAIL_BYTES &&
+           samples <  TEST_SWEEP_TAIL_SAMPLES) {
+            samples = TEST_SWEEP_TAIL_SAMPLES;
+        }
+        if(samples > TEST_SWEEP_MAX_SAMPLES) {
+            samples = TEST_SWEEP_MAX_SAMPLES;
+        }
+
+        for(size_t i = 0; i < TEST_SWEEP_WARMUP; i ++) {
+            fn(sweep_out, sweep_in, run_len, ctx);
+        }
+
+        for(size_t i = 0; i < samples; i ++) {
+            const uint64_t start_cycles = test_rdcycle();
+            const uint64_t start_instrs = test_rdinstret();
+            fn(sweep_out, sweep_in, run_len, ctx);
+            const uint64_t end_instrs   = test_rdinstret();
+            const uint64_t end_cycles   = test_rdcycle();
+            instret[i] = end_instrs - start_instrs;
+            cycles [i] = end_cycles - start_cycles;
+        }
+
+        sweep_sort(instret, samples);
+        sweep_sort(cycles , samples);
+
+        test_sweep_point * p = &points[npoints ++];
+        p -> len            = run_len;
+        p -> samples        = samples;
+        p -> instret_median = sweep_percentile(instret, samples, 50);
+        p -> cycles_median  = sweep_percentile(cycles , samples, 50);
+        p -> cycles_tail    = samples >= TEST_SWEEP_TAIL_SAMPLES
+                            ? sweep_percentile(cycles, samples, 99)
+                            : cycles[samples - 1];
+    }
+
+    return npoints;
+}
+
+void test_sweep_print(
+    const char             * name   ,
+    const test_sweep_point * points ,
+    size_t                   npoints
+){
+    printf("print(\"%-16s %-16s %8s %7s %10s %12s %16s\")\n",
+        STR(TEST_NAME), name,
+        "bytes", "samples", "instr/B", "cyc/B (med)", "cyc/B (tail)");
+    for(size_t i = 0; i < npoints; i ++) {
+        const test_sweep_point * p = &points[i];
+        const double len = (double)p -> len;
+        printf("print(\"%-16s %-16s %8lu %7lu %10.2f %12.2f %12.2f %3s\")\n",
+            STR(TEST_NAME), name,
+            (unsigned long)p -> len, (unsigned long)p -> samples,
+            p -> instret_median / len,
+            p -> cycles_median  / len,
+            p -> cycles_tail    / len,
+            p -> samples >= TEST_SWEEP_TAIL_SAMPLES ? "p99" : "max");
+        test_result(name, p -> len, p -> instret_median, p -> cycles_median);
+    }
+}
+
+void test_sweep(
+    const char   * name   ,
+    test_sweep_fn  fn     ,
+    void         * ctx    ,
+    size_t         granule
+){
+    test_sweep_point points[TEST_SWEEP_MAX_POINTS];
+    size_t npoints = test_sweep_run(points, fn, ctx, granule);
+    test_sweep_print(name, points, npoints);
+}
+
+//! @}
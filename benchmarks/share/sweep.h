@@ -0,0 +1,147 @@
+
+/*!
+@defgroup test_sweep Throughput Sweep
+@{
+@details Runs a transform over a geometric ladder of input lengths, from
+    TEST_SWEEP_MIN_BYTES to TEST_SWEEP_MAX_BYTES doubling at each step,
+    and reports instructions and cycles per byte for each length.
+    Each length is first run TEST_SWEEP_WARMUP times without being
+    measured, then sampled a number of times which shrinks as the length
+    grows. Lengths up to TEST_SWEEP_TAIL_BYTES get at least
+    TEST_SWEEP_TAIL_SAMPLES samples, enough for the 99th percentile to
+    be reported next to the median. Longer lengths get fewer samples,
+    and report their slowest sample instead, labelled "max".
+    All of the TEST_SWEEP_* parameters may be overridden from CFLAGS.
+    The longest length may also be set at run time, see
+    test_sweep_max_bytes.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef __SHARE_SWEEP_H__
+#define __SHARE_SWEEP_H__
+
+#ifndef TEST_SWEEP_MIN_BYTES
+//! Shortest input length of a sweep, in bytes.
+#define TEST_SWEEP_MIN_BYTES 16
+#endif
+
+#ifndef TEST_SWEEP_MAX_BYTES
+//! Longest input length of a sweep, in bytes.
+#define TEST_SWEEP_MAX_BYTES (1 << 20)
+#endif
+
+#ifndef TEST_SWEEP_WARMUP
+//! Number of unmeasured runs before sampling each length.
+#define TEST_SWEEP_WARMUP 2
+#endif
+
+#ifndef TEST_SWEEP_MIN_SAMPLES
+//! Least number of samples taken for any length.
+#define TEST_SWEEP_MIN_SAMPLES 5
+#endif
+
+#ifndef TEST_SWEEP_MAX_SAMPLES
+//! Most number of samples taken for any length.
+#define TEST_SWEEP_MAX_SAMPLES 128
+#endif
+
+#ifndef TEST_SWEEP_TAIL_SAMPLES
+//! Least number of samples from which the 99th percentile is reported.
+#define TEST_SWEEP_TAIL_SAMPLES 100
+#endif
+
+#ifndef TEST_SWEEP_TAIL_BYTES
+//! Longest length given TEST_SWEEP_TAIL_SAMPLES samples, whatever the
+//! byte budget.
+#define TEST_SWEEP_TAIL_BYTES 4096
+#endif
+
+#ifndef TEST_SWEEP_BYTE_BUDGET
+//! Bytes processed while sampling one length, before clamping the
+//! number of samples to [TEST_SWEEP_MIN_SAMPLES, TEST_SWEEP_MAX_SAMPLES]
+//! (or [TEST_SWEEP_TAIL_SAMPLES, ...] up to TEST_SWEEP_TAIL_BYTES).
+#define TEST_SWEEP_BYTE_BUDGET (1 << 18)
+#endif
+
+//! Most number of lengths in a sweep.
+#define TEST_SWEEP_MAX_POINTS 32
+
+/*!
+@brief A transform being measured. It reads len bytes from in, and may
+    write up to len bytes to out.
+@param [out] out - Output buffer, test_sweep_max_bytes() long.
+@param [in] in - Input buffer, filled with random bytes.
+@param [in] len - Number of bytes to process.
+@param [in] ctx - Transform specific context (keys etc).
+*/
+typedef void (*test_sweep_fn)(
+    uint8_t       * out,
+    const uint8_t * in ,
+    size_t          len,
+    void          * ctx
+);
+
+//! Measurements for one input length of a sweep.
+typedef struct {
+    size_t   len;            //!< Input length in bytes.
+    size_t   samples;        //!< Number of measured runs.
+    uint64_t instret_median; //!< Median instructions retired per run.
+    uint64_t cycles_median;  //!< Median cycles per run.
+    uint64_t cycles_tail;    //!< 99th percentile cycles per run, or the
+                             //!< most cycles of any run if there are
+                             //!< fewer than TEST_SWEEP_TAIL_SAMPLES.
+} test_sweep_point;
+
+/*!
+@brief Longest input length of a sweep, in bytes.
+@details TEST_SWEEP_MAX_BYTES, unless the TEST_SWEEP_MAX_BYTES environment
+    variable holds a length of at least TEST_SWEEP_MIN_BYTES. pk does not
+    pass the host environment on, so only runners which do (e.g. QEMU user
+    mode) can change it.
+*/
+size_t test_sweep_max_bytes();
+
+/*!
+@brief Runs fn over the length ladder, storing one point per length.
+@param [out] points - TEST_SWEEP_MAX_POINTS entries.
+@param [in] fn - The transform to measure.
+@param [in] ctx - Passed to fn.
+@param [in] granule - Lengths are rounded down to a multiple of this
+    (e.g. the block size of a block cipher) and lengths rounding to zero
+    are skipped.
+@returns The number of points written.
+*/
+size_t test_sweep_run(
+    test_sweep_point * points ,
+    test_sweep_fn      fn     ,
+    void             * ctx    ,
+    size_t             granule
+);
+
+/*!
+@brief Prints the points of a sweep as python3 print statements, so the
+    output can be appended to that of a test program, and records each
+    point (median instret and cycles) with test_result.
+@param [in] name - The algorithm measured, e.g. "aes_128_enc".
+*/
+void test_sweep_print(
+    const char             * name   ,
+    const test_sweep_point * points ,
+    size_t                   npoints
+);
+
+/*!
+@brief Runs test_sweep_run, then test_sweep_print.
+*/
+void test_sweep(
+    const char   * name   ,
+    test_sweep_fn  fn     ,
+    void         * ctx    ,
+    size_t         granule
+);
+
+#endif
+
+//! @}
@@ -9,6 +9,11 @@
 #include <string.h>
 
 #include "test.h"
+#include "util.h"
+
+#ifndef TEST_NAME
+#define TEST_NAME unknown
+#endif
 
 //
 // Misc IO
@@ -38,18 +43,190 @@ void puthex_py(unsigned char * in, size_t len){
 }
 
 
+//
+// Random inputs, see test.h
+// ----------------------------------------------------------------------
+
+//! xoshiro256** state. Seeded from TEST_SEED_DEFAULT on first use.
+static uint64_t test_rng[4];
+static int      test_rng_seeded = 0;
+static uint64_t test_rng_seed   = TEST_SEED_DEFAULT;
+
+static uint64_t test_rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+void test_seed(uint64_t seed) {
+    // splitmix64 spreads the seed over the state, which must not be all 0.
+    uint64_t z = seed;
+    for(int i = 0; i < 4; i ++) {
+        z += 0x9E3779B97F4A7C15ULL;
+        uint64_t x = z;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        test_rng[i] = x ^ (x >> 31);
+    }
+    test_rng_seed   = seed;
+    test_rng_seeded = 1;
+}
+
+uint64_t test_random64() {
+    if(!test_rng_seeded) {
+        test_seed(test_rng_seed);
+    }
+    uint64_t * s      = test_rng;
+    uint64_t   result = test_rotl(s[1] * 5, 7) * 9;
+    uint64_t   t      = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3]  = test_rotl(s[3], 45);
+    return result;
+}
+
 size_t test_rdrandom(unsigned char * dest, size_t len) {
-    
-    // Dumb random seed generation. Originally used to read
-    // /dev/random, but this caused hangs on some machines.
-    srand(time(NULL));
+    for(size_t i = 0; i < len; i += 8) {
+        uint64_t r = test_random64();
+        memcpy(dest + i, &r, len - i < 8 ? len - i : 8);
+    }
+    return len;
+}
+
+void test_init(int argc, char ** argv) {
+    for(int i = 1; i < argc; i ++) {
+        const char * arg = argv[i];
+        if(!strcmp(arg, "--seed") && i + 1 < argc) {
+            test_seed(strtoull(argv[++i], NULL, 0));
+        } else if(!strncmp(arg, "--seed=", 7)) {
+            test_seed(strtoull(arg + 7, NULL, 0));
+        }
+    }
+    printf("# test seed: %llu\n", (unsigned long long)test_rng_seed);
+}
 
-    for(size_t i =0; i < len; i ++) {
-        dest[i] = (unsigned char)rand();
+//! One malloc'd chunk of the pool arena. Allocations follow the header.
+typedef struct test_arena_chunk {
+    struct test_arena_chunk * next;
+    size_t                    used;
+    size_t                    size;
+} test_arena_chunk;
+
+static test_arena_chunk * test_arena = NULL;
+
+void * test_pool_alloc(size_t len) {
+    size_t need = (len + TEST_POOL_ALIGN - 1) & ~(size_t)(TEST_POOL_ALIGN - 1);
+
+    if(test_arena == NULL || test_arena -> size - test_arena -> used < need) {
+        size_t size = need > TEST_ARENA_CHUNK ? need : TEST_ARENA_CHUNK;
+        test_arena_chunk * c = malloc(sizeof(test_arena_chunk) +
+                                      TEST_POOL_ALIGN + size);
+        if(c == NULL) {
+            printf("print(\"Test pool allocation of %lu bytes failed.\")\n",
+                (unsigned long)len);
+            exit(1);
+        }
+        // Start the chunk at the first cache line after its header.
+        uintptr_t base  = (uintptr_t)(c + 1);
+        uintptr_t first = (base + TEST_POOL_ALIGN - 1) &
+                          ~(uintptr_t)(TEST_POOL_ALIGN - 1);
+        c -> next  = test_arena;
+        c -> used  = first - base;
+        c -> size  = c -> used + size;
+        test_arena = c;
     }
-    
-    return len      ;
 
+    uint8_t * p = (uint8_t*)(test_arena + 1) + test_arena -> used;
+    test_arena -> used += need;
+    memset(p, 0, len);
+    return p;
+}
+
+uint8_t * test_pool(size_t len) {
+    uint8_t * p = test_pool_alloc(len);
+    test_rdrandom(p, len);
+    return p;
+}
+
+void test_pool_free() {
+    while(test_arena != NULL) {
+        test_arena_chunk * next = test_arena -> next;
+        free(test_arena);
+        test_arena = next;
+    }
+}
+
+
+#if !defined(__riscv_xlen)
+
+//
+// Host counters, see test.h
+// ----------------------------------------------------------------------
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+uint64_t test_host_rdinstret() {
+#if defined(__linux__)
+    static int fd = -2;
+
+    if(fd == -2) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.size           = sizeof(attr);
+        attr.config         = PERF_COUNT_HW_INSTRUCTIONS;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if(fd < 0) {
+            printf("# test_rdinstret: no perf_event counter, reads as 0\n");
+        }
+    }
+
+    uint64_t count = 0;
+    if(fd >= 0 && read(fd, &count, sizeof(count)) == sizeof(count)) {
+        return count;
+    }
+#endif
+    return 0;
+}
+
+uint64_t test_host_rdtime() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+uint64_t test_host_rdcycle() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return test_host_rdtime();
+#endif
+}
+
+#endif
+
+
+void test_result(
+    const char * algorithm,
+    size_t       bytes    ,
+    uint64_t     instret  ,
+    uint64_t     cycles
+){
+    printf("#!result %s,%s,%lu,%llu,%llu\n", STR(TEST_NAME), algorithm,
+        (unsigned long)bytes, (unsigned long long)instret,
+        (unsigned long long)cycles);
 }
 
 
@@ -43,17 +43,108 @@ void puthex(unsigned char * in, size_t len);
 void puthex_py(unsigned char * in, size_t len);
 
 
+//
+// Random inputs
+// ----------------------------------------------------------------------
+
+//! Seed of the input generator unless test_init is given --seed.
+#define TEST_SEED_DEFAULT 1
+
+//! Alignment of test_pool buffers: one cache line.
+#define TEST_POOL_ALIGN 64
+
+//! test_pool buffers are carved out of malloc'd chunks of this many bytes.
+#define TEST_ARENA_CHUNK (1 << 20)
+
+/*!
+@brief Parses the options common to every test program.
+@details `--seed <n>` (or `--seed=<n>`) re-seeds the input generator, so
+    that a failing or slow run can be replayed exactly. Other arguments
+    are ignored. Prints the seed used as a python comment.
+*/
+void test_init(int argc, char ** argv);
+
+
+/*!
+@brief Re-seeds the input generator with seed.
+@details The generator is xoshiro256**, its state filled from seed by
+    splitmix64. The same seed always gives the same inputs.
+*/
+void test_seed(uint64_t seed);
+
+
+//! Next 64 random bits from the input generator.
+uint64_t test_random64();
+
+
 /*!
 @brief Read len random bytes into dest.
+@details Drawn from the input generator, so deterministic for a seed.
+    Not suitable for real keys.
 */
 size_t test_rdrandom(unsigned char * dest, size_t len);
 
 
+/*!
+@brief Allocates len zeroed bytes, aligned to TEST_POOL_ALIGN.
+@details Buffers come from an arena which is only released by
+    test_pool_free, so allocating all inputs up front keeps malloc and
+    page faults out of the timed loops. Exits if memory runs out.
+*/
+void * test_pool_alloc(size_t len);
+
+
+//! As test_pool_alloc, but filled with len bytes of test_rdrandom.
+uint8_t * test_pool(size_t len);
+
+
+//! Releases every test_pool and test_pool_alloc buffer.
+void test_pool_free();
+
+
+
+/*!
+@brief Records one measurement for the structured results mode.
+@details Printed as a python comment of the form
+    `#!result <test>,<algorithm>,<bytes>,<instret>,<cycles>`, so it does
+    not change what the generated script does. `<test>` is the TEST_NAME
+    the program was built with. benchmarks/tools/results.py collects
+    these lines from the run logs.
+@param [in] algorithm - What was measured, e.g. "aes_128_enc".
+@param [in] bytes - Input length in bytes.
+@param [in] instret - Instructions retired.
+@param [in] cycles - Cycles elapsed.
+*/
+void test_result(
+    const char * algorithm,
+    size_t       bytes    ,
+    uint64_t     instret  ,
+    uint64_t     cycles
+);
+
+
 
 //
 // Low level register access.
 // ------------------------------------------------------------------
 
+#if !defined(__riscv_xlen)
+
+/*
+@brief Host stand-ins for the counters below, used by config/host.conf.
+@details
+- test_host_rdinstret counts user mode instructions with a Linux
+  perf_event counter. It reads as 0 where that is not available.
+- test_host_rdcycle reads the x86 time stamp counter, or
+  CLOCK_MONOTONIC nanoseconds elsewhere.
+- test_host_rdtime reads CLOCK_MONOTONIC nanoseconds.
+*/
+uint64_t test_host_rdinstret();
+uint64_t test_host_rdcycle();
+uint64_t test_host_rdtime();
+
+#endif
+
 inline volatile uint64_t test_rdinstret() {
     uint64_t result = 0;
 
@@ -79,6 +170,10 @@ inline volatile uint64_t test_rdinstret() {
         : "=r"(result)
     );
 
+#elif !defined(__riscv_xlen)
+
+    result = test_host_rdinstret();
+
 #else
     #error "Unsupported RISC-V XLEN: __riscv_xlen, expected 32 or 64"
 #endif
@@ -114,6 +209,10 @@ inline volatile uint64_t test_rdcycle() {
         : 
     );
 
+#elif !defined(__riscv_xlen)
+
+    result = test_host_rdcycle();
+
 #else
     #error "Unsupported RISC-V XLEN: __riscv_xlen, expected 32 or 64"
 #endif
@@ -148,6 +247,10 @@ inline volatile uint64_t test_rdtime() {
         : 
     );
 
+#elif !defined(__riscv_xlen)
+
+    result = test_host_rdtime();
+
 #else
     #error "Unsupported RISC-V XLEN: __riscv_xlen, expected 32 or 64"
 #endif
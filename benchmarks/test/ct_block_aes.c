@@ -0,0 +1,49 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "riscvcrypto/share/test.h"
+#include "riscvcrypto/share/ct.h"
+#include "riscvcrypto/share/util.h"
+
+#include "riscvcrypto/aes/api_aes.h"
+
+static void ct_aes_128_enc(uint8_t * out, const uint8_t * in, void * rk) {
+    aes_128_ecb_encrypt(out, (uint8_t*)in, (uint32_t*)rk);
+}
+
+static void ct_aes_128_dec(uint8_t * out, const uint8_t * in, void * rk) {
+    aes_128_ecb_decrypt(out, (uint8_t*)in, (uint32_t*)rk);
+}
+
+//! The input is the cipher key, the round keys go to ctx.
+static void ct_aes_128_kse(uint8_t * out, const uint8_t * in, void * rk) {
+    aes_128_enc_key_schedule((uint32_t*)rk, (uint8_t*)in);
+}
+
+int main(int argc, char ** argv) {
+
+    test_init(argc, argv);
+
+    printf("import sys\n");
+    printf("benchmark_name = \"" STR(TEST_NAME)"\"\n");
+
+    // The fixed class is all zeros, as in the dudect AES example.
+    uint8_t  fixed[AES_128_KEY_BYTES] = {0};
+    uint8_t  key  [AES_128_KEY_BYTES];
+    uint32_t erk  [AES_128_RK_WORDS ];
+    uint32_t drk  [AES_128_RK_WORDS ];
+    uint32_t krk  [AES_128_RK_WORDS ];
+
+    test_rdrandom(key, AES_128_KEY_BYTES);
+
+    aes_128_enc_key_schedule(erk, key);
+    aes_128_dec_key_schedule(drk, key);
+
+    test_ct("aes_128_enc", ct_aes_128_enc, erk, fixed, AES_BLOCK_BYTES);
+    test_ct("aes_128_dec", ct_aes_128_dec, drk, fixed, AES_BLOCK_BYTES);
+    test_ct("aes_128_kse", ct_aes_128_kse, krk, fixed, AES_128_KEY_BYTES);
+
+    return 0;
+
+}
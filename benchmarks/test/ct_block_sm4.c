@@ -0,0 +1,44 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "riscvcrypto/share/test.h"
+#include "riscvcrypto/share/ct.h"
+#include "riscvcrypto/share/util.h"
+
+#include "riscvcrypto/sm4/api_sm4.h"
+
+static void ct_sm4_block(uint8_t * out, const uint8_t * in, void * rk) {
+    sm4_block_enc_dec(out, (uint8_t*)in, (uint32_t*)rk);
+}
+
+//! The input is the cipher key, the round keys go to ctx.
+static void ct_sm4_kse(uint8_t * out, const uint8_t * in, void * rk) {
+    sm4_key_schedule_enc((uint32_t*)rk, (uint8_t*)in);
+}
+
+int main(int argc, char ** argv) {
+
+    test_init(argc, argv);
+
+    printf("import sys\n");
+    printf("benchmark_name = \"" STR(TEST_NAME)"\"\n");
+
+    uint8_t  fixed[16] = {0};
+    uint8_t  key  [16];
+    uint32_t erk  [32];
+    uint32_t drk  [32];
+    uint32_t krk  [32];
+
+    test_rdrandom(key, 16);
+
+    sm4_key_schedule_enc(erk, key);
+    sm4_key_schedule_dec(drk, key);
+
+    test_ct("sm4_enc", ct_sm4_block, erk, fixed, 16);
+    test_ct("sm4_dec", ct_sm4_block, drk, fixed, 16);
+    test_ct("sm4_kse", ct_sm4_kse  , krk, fixed, 16);
+
+    return 0;
+
+}
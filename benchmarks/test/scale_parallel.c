@@ -0,0 +1,215 @@
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "riscvcrypto/share/test.h"
+#include "riscvcrypto/share/util.h"
+
+#include "riscvcrypto/aes/api_aes.h"
+#include "riscvcrypto/sm4/api_sm4.h"
+
+#include "riscvcrypto/parallel/api_parallel.h"
+
+//
+// Thread scaling of the parallel engine. Runs each mode over one buffer
+// with 1, 2, 4 ... threads (or those given on the command line), and
+// prints the throughput, speedup over one thread, and parallel
+// efficiency (speedup / threads) of each. Every result is also printed as
+//
+//   #!scale <op>,<threads>,<bytes>,<nanoseconds>
+//
+// for scripts. The output of each thread count is checked against that of
+// one thread.
+//
+// PARALLEL_SCALE_BYTES sets the buffer length, 64 MiB by default.
+//
+
+#define SCALE_BYTES_DEFAULT (64 * 1024 * 1024)
+
+//! Timed runs of each mode and thread count. The fastest is reported.
+#define SCALE_REPEATS 3
+
+//! Most thread counts tried.
+#define SCALE_MAX_COUNTS 32
+
+#define SCALE_OPS 5
+
+static const char * op_names[SCALE_OPS] = {
+    "aes_128_ctr", "aes_128_xts", "sm4_ctr", "sha256_tree", "sm3_tree"
+};
+
+typedef struct {
+    uint8_t  * in;
+    uint8_t  * out;
+    size_t     len;
+    uint32_t   rk [AES_128_RK_WORDS];
+    uint32_t   trk[AES_128_RK_WORDS];
+    uint32_t   srk[32];
+    uint8_t    digest[32];
+} scale_ctx;
+
+static uint64_t scale_now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void scale_op(parallel_engine * e, int op, scale_ctx * ctx) {
+    uint8_t ctr[16] = {0};
+    switch(op) {
+        case 0:
+            parallel_aes_128_ctr(e, ctx -> out, ctx -> in, ctx -> len, ctr,
+                ctx -> rk);
+            break;
+        case 1:
+            parallel_aes_128_xts_encrypt(e, ctx -> out, ctx -> in, ctx -> len,
+                ctx -> rk, ctx -> trk, 0, 4096);
+            break;
+        case 2:
+            parallel_sm4_ctr(e, ctx -> out, ctx -> in, ctx -> len, ctr,
+                ctx -> srk);
+            break;
+        case 3:
+            parallel_sha256_tree(e, ctx -> digest, ctx -> in, ctx -> len, 0);
+            break;
+        case 4:
+            parallel_sm3_tree(e, ctx -> digest, ctx -> in, ctx -> len, 0);
+            break;
+    }
+}
+
+//! What an op produced, to compare across thread counts.
+static const uint8_t * scale_result(int op, scale_ctx * ctx, size_t * len) {
+    if(op >= 3) {
+        *len = 32;
+        return ctx -> digest;
+    }
+    *len = ctx -> len;
+    return ctx -> out;
+}
+
+int main(int argc, char ** argv) {
+
+    test_init(argc, argv);
+
+    printf("import sys\n");
+    printf("benchmark_name = \"" STR(TEST_NAME)"\"\n");
+
+    unsigned counts[SCALE_MAX_COUNTS];
+    size_t   ncounts = 0;
+
+    for(int i = 1; i < argc && ncounts < SCALE_MAX_COUNTS; i ++) {
+        if(!strncmp(argv[i], "--seed", 6)) {
+            i += argv[i][6] == 0;       // test_init's, not a thread count.
+            continue;
+        }
+        unsigned t = strtoul(argv[i], NULL, 0);
+        if(t > 0) {
+            counts[ncounts ++] = t;
+        }
+    }
+    if(ncounts == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        cpus = cpus > 0 ? cpus : 1;
+        for(unsigned t = 1; t < (unsigned)cpus && ncounts < SCALE_MAX_COUNTS;
+            t *= 2) {
+            counts[ncounts ++] = t;
+        }
+        counts[ncounts ++] = cpus;
+    }
+
+    size_t       len = SCALE_BYTES_DEFAULT;
+    const char * env = getenv("PARALLEL_SCALE_BYTES");
+    if(env != NULL && strtoul(env, NULL, 0) >= 4096) {
+        len = strtoul(env, NULL, 0) & ~(size_t)15;
+    }
+
+    scale_ctx ctx;
+    uint8_t   key[32];
+    uint8_t * first[SCALE_OPS] = {NULL};
+    uint64_t  base [SCALE_OPS];
+    int       tr = 0;
+
+    test_rdrandom(key, sizeof(key));
+    aes_128_enc_key_schedule(ctx.rk , key);
+    aes_128_enc_key_schedule(ctx.trk, key + 16);
+    sm4_key_schedule_enc(ctx.srk, key);
+    ctx.len = len;
+
+    printf("print(\"%-16s %-12s %7s %10s %10s %8s %6s\")\n", STR(TEST_NAME),
+        "op", "threads", "bytes", "MiB/s", "speedup", "eff");
+
+    for(size_t c = 0; c < ncounts; c ++) {
+        parallel_config cfg = {counts[c], 0, 0};
+        parallel_engine * e = parallel_engine_new(&cfg);
+        if(e == NULL) {
+            printf("print(\"Could not start %u threads\")\n", counts[c]);
+            tr |= 1;
+            break;
+        }
+
+        // Fresh buffers per engine, so their pages are placed for it.
+        ctx.in  = parallel_alloc(e, len);
+        ctx.out = parallel_alloc(e, len);
+        if(ctx.in == NULL || ctx.out == NULL) {
+            printf("print(\"Could not allocate %lu bytes\")\n",
+                (unsigned long)len);
+            tr |= 1;
+            parallel_engine_free(e);
+            break;
+        }
+        memset(ctx.in, 0x5A, len);
+
+        for(int op = 0; op < SCALE_OPS; op ++) {
+            uint64_t best = UINT64_MAX;
+            for(int r = 0; r < SCALE_REPEATS; r ++) {
+                uint64_t start = scale_now_ns();
+                scale_op(e, op, &ctx);
+                uint64_t ns    = scale_now_ns() - start;
+                best = ns < best ? ns : best;
+            }
+            best = best ? best : 1;
+
+            size_t          rlen;
+            const uint8_t * res = scale_result(op, &ctx, &rlen);
+            if(c == 0) {
+                first[op] = malloc(rlen);
+                memcpy(first[op], res, rlen);
+                base [op] = best;
+            } else if(memcmp(first[op], res, rlen)) {
+                printf("print(\"%s with %u threads disagrees with %u\")\n",
+                    op_names[op], counts[c], counts[0]);
+                tr |= 2;
+            }
+
+            double speedup = (double)base[op] / best;
+            printf("print(\"%-16s %-12s %7u %10lu %10.1f %8.2f %6.2f\")\n",
+                STR(TEST_NAME), op_names[op], counts[c], (unsigned long)len,
+                (len / (1024.0 * 1024.0)) / (best / 1e9),
+                speedup, speedup * counts[0] / counts[c]);
+            printf("#!scale %s,%u,%lu,%llu\n", op_names[op], counts[c],
+                (unsigned long)len, (unsigned long long)best);
+        }
+
+        parallel_free(ctx.in , len);
+        parallel_free(ctx.out, len);
+        parallel_engine_free(e);
+    }
+
+    for(int op = 0; op < SCALE_OPS; op ++) {
+        free(first[op]);
+    }
+
+    if(tr) {
+        printf("print('"STR(TEST_NAME)" Scaling Failed with code: %d')\n", tr);
+        printf("sys.exit(1)\n");
+        return tr;
+    }
+
+    return 0;
+}
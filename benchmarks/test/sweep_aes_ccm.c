@@ -0,0 +1,48 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "riscvcrypto/share/test.h"
+#include "riscvcrypto/share/sweep.h"
+#include "riscvcrypto/share/util.h"
+
+#include "riscvcrypto/aes/api_aes.h"
+#include "riscvcrypto/aes/api_aes_modes.h"
+
+//! 12 byte nonce (payloads up to 16 MiB) and 16 bytes of additional data,
+//! as in test_aes_ccm.c
+static uint8_t sweep_nonce[12];
+static uint8_t sweep_aad  [16];
+
+static void sweep_ccm(uint8_t * out, const uint8_t * in, size_t len, void * rk) {
+    uint8_t tag[AES_CCM_TAG_MAX_BYTES];
+    aes_128_ccm_encrypt(out, tag, (uint8_t*)in, len, sweep_aad,
+        sizeof(sweep_aad), sweep_nonce, sizeof(sweep_nonce),
+        AES_CCM_TAG_MAX_BYTES, (uint32_t*)rk);
+}
+
+static void sweep_cmac(uint8_t * out, const uint8_t * in, size_t len, void * rk) {
+    aes_128_cmac(out, (uint8_t*)in, len, (uint32_t*)rk);
+}
+
+int main(int argc, char ** argv) {
+
+    test_init(argc, argv);
+
+    printf("import sys\n");
+    printf("benchmark_name = \"" STR(TEST_NAME)"\"\n");
+
+    uint8_t  key[AES_128_KEY_BYTES];
+    uint32_t rk [AES_128_RK_WORDS ];
+
+    test_rdrandom(key        , sizeof(key        ));
+    test_rdrandom(sweep_nonce, sizeof(sweep_nonce));
+    test_rdrandom(sweep_aad  , sizeof(sweep_aad  ));
+    aes_128_enc_key_schedule(rk, key);
+
+    test_sweep("aes_128_ccm_enc", sweep_ccm , rk, 1);
+    test_sweep("aes_128_cmac"   , sweep_cmac, rk, 1);
+
+    return 0;
+
+}
@@ -0,0 +1,54 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "riscvcrypto/share/test.h"
+#include "riscvcrypto/share/sweep.h"
+#include "riscvcrypto/share/util.h"
+
+#include "riscvcrypto/aes/api_aes.h"
+
+//! ECB encryption / decryption of len bytes, one block at a time.
+#define SWEEP_AES_ECB(NAME, FN)                                             \
+static void NAME(uint8_t * out, const uint8_t * in, size_t len, void * rk) {\
+    for(size_t i = 0; i < len; i += AES_BLOCK_BYTES) {                      \
+        FN(out + i, (uint8_t*)in + i, (uint32_t*)rk);                       \
+    }                                                                       \
+}
+
+SWEEP_AES_ECB(sweep_aes_128_enc, aes_128_ecb_encrypt)
+SWEEP_AES_ECB(sweep_aes_128_dec, aes_128_ecb_decrypt)
+SWEEP_AES_ECB(sweep_aes_192_enc, aes_192_ecb_encrypt)
+SWEEP_AES_ECB(sweep_aes_256_enc, aes_256_ecb_encrypt)
+
+int main(int argc, char ** argv) {
+
+    test_init(argc, argv);
+
+    printf("import sys\n");
+    printf("benchmark_name = \"" STR(TEST_NAME)"\"\n");
+
+    uint8_t  key[AES_256_KEY_BYTES];
+    uint32_t rk [AES_256_RK_WORDS ];
+
+    test_rdrandom(key, AES_256_KEY_BYTES);
+
+    aes_128_enc_key_schedule(rk, key);
+    test_sweep("aes_128_enc", sweep_aes_128_enc, rk,
+        AES_BLOCK_BYTES);
+
+    aes_128_dec_key_schedule(rk, key);
+    test_sweep("aes_128_dec", sweep_aes_128_dec, rk,
+        AES_BLOCK_BYTES);
+
+    aes_192_enc_key_schedule(rk, key);
+    test_sweep("aes_192_enc", sweep_aes_192_enc, rk,
+        AES_BLOCK_BYTES);
+
+    aes_256_enc_key_schedule(rk, key);
+    test_sweep("aes_256_enc", sweep_aes_256_enc, rk,
+        AES_BLOCK_BYTES);
+
+    return 0;
+
+}
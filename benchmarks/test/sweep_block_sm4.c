@@ -0,0 +1,35 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "riscvcrypto/share/test.h"
+#include "riscvcrypto/share/sweep.h"
+#include "riscvcrypto/share/util.h"
+
+#include "riscvcrypto/sm4/api_sm4.h"
+
+//! ECB encryption of len bytes, one block at a time.
+static void sweep_sm4(uint8_t * out, const uint8_t * in, size_t len, void * rk) {
+    for(size_t i = 0; i < len; i += 16) {
+        sm4_block_enc_dec(out + i, (uint8_t*)in + i, (uint32_t*)rk);
+    }
+}
+
+int main(int argc, char ** argv) {
+
+    test_init(argc, argv);
+
+    printf("import sys\n");
+    printf("benchmark_name = \"" STR(TEST_NAME)"\"\n");
+
+    uint8_t  key[16];
+    uint32_t rk [32];
+
+    test_rdrandom(key, 16);
+    sm4_key_schedule_enc(rk, key);
+
+    test_sweep("sm4_enc", sweep_sm4, rk, 16);
+
+    return 0;
+
+}
@@ -0,0 +1,26 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "riscvcrypto/share/test.h"
+#include "riscvcrypto/share/sweep.h"
+#include "riscvcrypto/share/util.h"
+
+#include "riscvcrypto/sha256/api_sha256.h"
+
+static void sweep_sha256(uint8_t * out, const uint8_t * in, size_t len, void * ctx) {
+    sha256_hash((uint32_t*)out, (uint8_t*)in, len);
+}
+
+int main(int argc, char ** argv) {
+
+    test_init(argc, argv);
+
+    printf("import sys\n");
+    printf("benchmark_name = \"" STR(TEST_NAME)"\"\n");
+
+    test_sweep("sha256", sweep_sha256, NULL, 1);
+
+    return 0;
+
+}
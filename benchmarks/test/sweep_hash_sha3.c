@@ -0,0 +1,31 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "riscvcrypto/share/test.h"
+#include "riscvcrypto/share/sweep.h"
+#include "riscvcrypto/share/util.h"
+
+#include "riscvcrypto/sha3/fips202.h"
+
+static void sweep_sha3_256(uint8_t * out, const uint8_t * in, size_t len, void * ctx) {
+    FIPS202_SHA3_256(in, len, out);
+}
+
+static void sweep_sha3_512(uint8_t * out, const uint8_t * in, size_t len, void * ctx) {
+    FIPS202_SHA3_512(in, len, out);
+}
+
+int main(int argc, char ** argv) {
+
+    test_init(argc, argv);
+
+    printf("import sys\n");
+    printf("benchmark_name = \"" STR(TEST_NAME)"\"\n");
+
+    test_sweep("sha3_256", sweep_sha3_256, NULL, 1);
+    test_sweep("sha3_512", sweep_sha3_512, NULL, 1);
+
+    return 0;
+
+}
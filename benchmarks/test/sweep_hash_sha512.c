@@ -0,0 +1,26 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "riscvcrypto/share/test.h"
+#include "riscvcrypto/share/sweep.h"
+#include "riscvcrypto/share/util.h"
+
+#include "riscvcrypto/sha512/api_sha512.h"
+
+static void sweep_sha512(uint8_t * out, const uint8_t * in, size_t len, void * ctx) {
+    sha512_hash((uint64_t*)out, (uint8_t*)in, len);
+}
+
+int main(int argc, char ** argv) {
+
+    test_init(argc, argv);
+
+    printf("import sys\n");
+    printf("benchmark_name = \"" STR(TEST_NAME)"\"\n");
+
+    test_sweep("sha512", sweep_sha512, NULL, 1);
+
+    return 0;
+
+}
@@ -0,0 +1,26 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "riscvcrypto/share/test.h"
+#include "riscvcrypto/share/sweep.h"
+#include "riscvcrypto/share/util.h"
+
+#include "riscvcrypto/sm3/api_sm3.h"
+
+static void sweep_sm3(uint8_t * out, const uint8_t * in, size_t len, void * ctx) {
+    sm3_hash(out, in, len);
+}
+
+int main(int argc, char ** argv) {
+
+    test_init(argc, argv);
+
+    printf("import sys\n");
+    printf("benchmark_name = \"" STR(TEST_NAME)"\"\n");
+
+    test_sweep("sm3", sweep_sm3, NULL, 1);
+
+    return 0;
+
+}
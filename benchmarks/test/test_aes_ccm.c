@@ -0,0 +1,278 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "riscvcrypto/share/test.h"
+#include "riscvcrypto/share/util.h"
+
+#include "riscvcrypto/aes/api_aes.h"
+#include "riscvcrypto/aes/api_aes_modes.h"
+
+//! Largest payload used by the benchmark sweep.
+#define CCM_BENCH_MAX_BYTES 4096
+
+static uint8_t  buf_pt  [CCM_BENCH_MAX_BYTES];
+static uint8_t  buf_ct  [CCM_BENCH_MAX_BYTES];
+static uint8_t  buf_pt2 [CCM_BENCH_MAX_BYTES];
+
+//! NIST SP 800-38C Appendix C example key. Also used by the benchmark.
+static uint8_t  ccm_key [AES_128_KEY_BYTES] = {
+    0x40,0x41,0x42,0x43,0x44,0x45,0x46,0x47,
+    0x48,0x49,0x4a,0x4b,0x4c,0x4d,0x4e,0x4f
+};
+
+//! NIST SP 800-38C Appendix C examples 1-3: nonce, aad and payload are
+//  prefixes of the byte sequences 0x10.., 0x00.. and 0x20.. respectively.
+static const struct {
+    size_t      noncelen;
+    size_t      aadlen;
+    size_t      len;
+    size_t      taglen;
+    const char* expected;               // C || T, hex
+} ccm_examples[] = {
+    { 7,  8,  4, 4, "7162015b4dac255d"},
+    { 8, 16, 16, 6, "d2a1f0e051ea5f62081a7792073d593d1fc64fbfaccd"},
+    {12, 20, 24, 8, "e3b201a9f5b71a7a9b1ceaeccd97e70b6176aad9a4428aa5"
+                    "484392fbc1b09951"},
+};
+
+//! Prints the python check of one CCM encrypt/decrypt round trip.
+static void print_ccm_check(
+    const char * what,
+    uint8_t * key, uint8_t * nonce, size_t noncelen,
+    uint8_t * aad, size_t aadlen, uint8_t * pt, uint8_t * ct, uint8_t * pt2,
+    size_t len, uint8_t * tag, size_t taglen, int dec_rc
+) {
+    printf("key  =");puthex_py(key  , AES_128_KEY_BYTES); printf("\n");
+    printf("nonce=");puthex_py(nonce, noncelen        ); printf("\n");
+    printf("aad  =");puthex_py(aad  , aadlen          ); printf("\n");
+    printf("pt   =");puthex_py(pt   , len             ); printf("\n");
+    printf("pt2  =");puthex_py(pt2  , len             ); printf("\n");
+    printf("ct   =");puthex_py(ct   , len             ); printf("\n");
+    printf("tag  =");puthex_py(tag  , taglen          ); printf("\n");
+    printf("dec_rc = %d\n", dec_rc);
+    printf("ref  = AES.new(key,AES.MODE_CCM,nonce=nonce,mac_len=%d)\n",
+        (int)taglen);
+    printf("ref.update(aad)\n");
+    printf("ref_ct, ref_tag = ref.encrypt_and_digest(pt)\n");
+    printf("if( ref_ct != ct or ref_tag != tag ):\n");
+    printf("    print(\"%s encrypt failed.\")\n", what);
+    printf("    print( 'ct  == %%s' %% ( binascii.b2a_hex( ct      )))\n");
+    printf("    print( '    != %%s' %% ( binascii.b2a_hex( ref_ct  )))\n");
+    printf("    print( 'tag == %%s' %% ( binascii.b2a_hex( tag     )))\n");
+    printf("    print( '    != %%s' %% ( binascii.b2a_hex( ref_tag )))\n");
+    printf("    sys.exit(1)\n");
+    printf("if( pt2 != pt or dec_rc != 0 ):\n");
+    printf("    print(\"%s decrypt failed.\")\n", what);
+    printf("    sys.exit(1)\n");
+}
+
+void test_aes_ccm_nist() {
+
+    uint8_t  nonce [AES_CCM_NONCE_MAX_BYTES];
+    uint8_t  aad   [32];
+    uint8_t  tag   [AES_CCM_TAG_MAX_BYTES];
+    uint32_t erk   [AES_128_RK_WORDS];
+
+    for(size_t i = 0; i < sizeof(nonce); i ++) {nonce  [i] = 0x10 + i;}
+    for(size_t i = 0; i < sizeof(aad  ); i ++) {aad    [i] = 0x00 + i;}
+    for(size_t i = 0; i < 32           ; i ++) {buf_pt [i] = 0x20 + i;}
+
+    aes_128_enc_key_schedule(erk, ccm_key);
+
+    for(size_t e = 0; e < sizeof(ccm_examples)/sizeof(ccm_examples[0]); e++){
+        size_t len      = ccm_examples[e].len;
+        size_t taglen   = ccm_examples[e].taglen;
+
+        aes_128_ccm_encrypt(buf_ct, tag, buf_pt, len, aad,
+            ccm_examples[e].aadlen, nonce, ccm_examples[e].noncelen,
+            taglen, erk);
+
+        int dec_rc = aes_128_ccm_decrypt(buf_pt2, buf_ct, len, aad,
+            ccm_examples[e].aadlen, nonce, ccm_examples[e].noncelen,
+            tag, taglen, erk);
+
+        printf("#\n# AES CCM SP 800-38C example %d\n", (int)e + 1);
+        print_ccm_check("AES CCM NIST example", ccm_key, nonce,
+            ccm_examples[e].noncelen, aad, ccm_examples[e].aadlen,
+            buf_pt, buf_ct, buf_pt2, len, tag, taglen, dec_rc);
+
+        printf("if( ct + tag != binascii.a2b_hex(\"%s\") ):\n",
+            ccm_examples[e].expected);
+        printf("    print(\"AES CCM NIST example %d: KAT mismatch.\")\n",
+            (int)e + 1);
+        printf("    sys.exit(1)\n");
+
+        // A corrupted tag must be rejected.
+        tag[0] ^= 1;
+        int bad_rc = aes_128_ccm_decrypt(buf_pt2, buf_ct, len, aad,
+            ccm_examples[e].aadlen, nonce, ccm_examples[e].noncelen,
+            tag, taglen, erk);
+        printf("if( %d == 0 ):\n", bad_rc);
+        printf("    print(\"AES CCM NIST example %d: bad tag accepted.\")\n",
+            (int)e + 1);
+        printf("    sys.exit(1)\n");
+        printf("print(\""STR(TEST_NAME)" AES CCM NIST example %d passed.\")\n",
+            (int)e + 1);
+    }
+}
+
+void test_aes_ccm_random(int num_tests) {
+
+    uint8_t  key   [AES_128_KEY_BYTES];
+    uint8_t  nonce [AES_CCM_NONCE_MAX_BYTES];
+    uint8_t  aad   [64];
+    uint8_t  tag   [AES_CCM_TAG_MAX_BYTES];
+    uint8_t  lens  [4];
+    uint32_t erk   [AES_128_RK_WORDS];
+
+    for(int i = 0; i < num_tests; i ++) {
+
+        test_rdrandom(key   , AES_128_KEY_BYTES);
+        test_rdrandom(nonce , sizeof(nonce));
+        test_rdrandom(aad   , sizeof(aad));
+        test_rdrandom(buf_pt, 128);
+        test_rdrandom(lens  , sizeof(lens));
+
+        size_t noncelen = AES_CCM_NONCE_MIN_BYTES + lens[0] % 7;
+        size_t taglen   = AES_CCM_TAG_MIN_BYTES   + 2 * (lens[1] % 7);
+        size_t aadlen   = lens[2] % sizeof(aad);
+        size_t len      = lens[3] % 128;
+
+        aes_128_enc_key_schedule(erk, key);
+
+        aes_128_ccm_encrypt(buf_ct, tag, buf_pt, len, aad, aadlen,
+            nonce, noncelen, taglen, erk);
+
+        int dec_rc = aes_128_ccm_decrypt(buf_pt2, buf_ct, len, aad, aadlen,
+            nonce, noncelen, tag, taglen, erk);
+
+        printf("#\n# AES CCM random test %d/%d\n", i, num_tests);
+        print_ccm_check("AES CCM random test", key, nonce, noncelen,
+            aad, aadlen, buf_pt, buf_ct, buf_pt2, len, tag, taglen, dec_rc);
+        printf("print(\""STR(TEST_NAME)" AES CCM random test %d passed.\")\n",
+            i);
+    }
+}
+
+void test_aes_cmac() {
+
+    // RFC 4493 section 4 examples: prefixes of one 64 byte message.
+    uint8_t  key [AES_128_KEY_BYTES ] = {0x2b ,0x7e ,0x15 ,0x16 ,0x28 ,0xae ,0xd2 ,0xa6 ,0xab ,0xf7 ,0x15 ,0x88 ,0x09 ,0xcf ,0x4f ,0x3c};
+    uint8_t  msg [64] = {
+        0x6b,0xc1,0xbe,0xe2,0x2e,0x40,0x9f,0x96,0xe9,0x3d,0x7e,0x11,0x73,0x93,0x17,0x2a,
+        0xae,0x2d,0x8a,0x57,0x1e,0x03,0xac,0x9c,0x9e,0xb7,0x6f,0xac,0x45,0xaf,0x8e,0x51,
+        0x30,0xc8,0x1c,0x46,0xa3,0x5c,0xe4,0x11,0xe5,0xfb,0xc1,0x19,0x1a,0x0a,0x52,0xef,
+        0xf6,0x9f,0x24,0x45,0xdf,0x4f,0x9b,0x17,0xad,0x2b,0x41,0x7b,0xe6,0x6c,0x37,0x10
+    };
+    size_t   lens[4] = {0, 16, 40, 64};
+    const char * expected[4] = {
+        "bb1d6929e95937287fa37d129b756746",
+        "070a16b46b4d4144f79bdd9dd04a287c",
+        "dfa66747de9ae63030ca32611497c827",
+        "51f0bebf7e3b9d92fc49741779363cfe"
+    };
+    uint8_t  mac [AES_BLOCK_BYTES];
+    uint32_t erk [AES_128_RK_WORDS];
+
+    aes_128_enc_key_schedule(erk, key);
+
+    for(int i = 0; i < 4; i ++) {
+        aes_128_cmac(mac, msg, lens[i], erk);
+
+        printf("#\n# AES CMAC RFC 4493 example %d\n", i + 1);
+        printf("key  =");puthex_py(key, AES_128_KEY_BYTES); printf("\n");
+        printf("msg  =");puthex_py(msg, lens[i]          ); printf("\n");
+        printf("mac  =");puthex_py(mac, AES_BLOCK_BYTES  ); printf("\n");
+        printf("ref  = CMAC.new(key,ciphermod=AES).update(msg).digest()\n");
+        printf("if( ref != mac or mac != binascii.a2b_hex(\"%s\") ):\n",
+            expected[i]);
+        printf("    print(\"AES CMAC RFC 4493 example %d failed.\")\n", i+1);
+        printf("    print( 'mac == %%s' %% ( binascii.b2a_hex( mac )))\n");
+        printf("    print( '    != %%s' %% ( binascii.b2a_hex( ref )))\n");
+        printf("    sys.exit(1)\n");
+        printf("print(\""STR(TEST_NAME)" AES CMAC example %d passed.\")\n",
+            i + 1);
+    }
+}
+
+void bench_aes_ccm() {
+
+    uint8_t  nonce [12];
+    uint8_t  aad   [16];
+    uint8_t  tag   [AES_CCM_TAG_MAX_BYTES];
+    uint8_t  mac   [AES_BLOCK_BYTES];
+    uint32_t erk   [AES_128_RK_WORDS];
+
+    test_rdrandom(nonce , sizeof(nonce));
+    test_rdrandom(aad   , sizeof(aad));
+    test_rdrandom(buf_pt, CCM_BENCH_MAX_BYTES);
+
+    aes_128_enc_key_schedule(erk, ccm_key);
+
+    printf("#\n# AES CCM / CMAC benchmark, 16 byte aad, 16 byte tag\n");
+    printf("print(\"%%6s %%12s %%12s %%12s %%12s %%12s %%12s\" %% ("
+        "'bytes','ccm_enc_ir','ccm_enc_cyc','ccm_dec_ir','ccm_dec_cyc',"
+        "'cmac_ir','cmac_cyc'))\n");
+
+    for(size_t len = 64; len <= CCM_BENCH_MAX_BYTES; len *= 4) {
+
+        uint64_t i0 = test_rdinstret();
+        uint64_t c0 = test_rdcycle();
+        aes_128_ccm_encrypt(buf_ct, tag, buf_pt, len, aad, sizeof(aad),
+            nonce, sizeof(nonce), AES_CCM_TAG_MAX_BYTES, erk);
+        uint64_t enc_cycles = test_rdcycle()   - c0;
+        uint64_t enc_icount = test_rdinstret() - i0;
+
+        i0 = test_rdinstret();
+        c0 = test_rdcycle();
+        int dec_rc = aes_128_ccm_decrypt(buf_pt2, buf_ct, len, aad,
+            sizeof(aad), nonce, sizeof(nonce), tag, AES_CCM_TAG_MAX_BYTES,
+            erk);
+        uint64_t dec_cycles = test_rdcycle()   - c0;
+        uint64_t dec_icount = test_rdinstret() - i0;
+
+        i0 = test_rdinstret();
+        c0 = test_rdcycle();
+        aes_128_cmac(mac, buf_pt, len, erk);
+        uint64_t mac_cycles = test_rdcycle()   - c0;
+        uint64_t mac_icount = test_rdinstret() - i0;
+
+        printf("if( %d != 0 or %d != 0 ):\n", dec_rc,
+            memcmp(buf_pt, buf_pt2, len) != 0);
+        printf("    print(\"AES CCM benchmark round trip failed at %d bytes.\")\n",
+            (int)len);
+        printf("    sys.exit(1)\n");
+        printf("print(\"%%6d %%12d %%12d %%12d %%12d %%12d %%12d\" %% ("
+            "%d, 0x", (int)len);
+        puthex64(enc_icount); printf(", 0x");
+        puthex64(enc_cycles); printf(", 0x");
+        puthex64(dec_icount); printf(", 0x");
+        puthex64(dec_cycles); printf(", 0x");
+        puthex64(mac_icount); printf(", 0x");
+        puthex64(mac_cycles); printf("))\n");
+
+        test_result("aes_128_ccm_enc", len, enc_icount, enc_cycles);
+        test_result("aes_128_ccm_dec", len, dec_icount, dec_cycles);
+        test_result("aes_128_cmac"   , len, mac_icount, mac_cycles);
+    }
+}
+
+
+int main(int argc, char ** argv) {
+
+    test_init(argc, argv);
+
+    printf("import sys, binascii\n");
+    printf("import Crypto.Cipher.AES as AES\n");
+    printf("from Crypto.Hash import CMAC\n");
+    printf("benchmark_name = \"" STR(TEST_NAME)"\"\n");
+
+    test_aes_ccm_nist();
+    test_aes_cmac();
+    test_aes_ccm_random(10);
+    bench_aes_ccm();
+
+    return 0;
+
+}
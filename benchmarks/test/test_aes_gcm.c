@@ -0,0 +1,316 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "riscvcrypto/share/test.h"
+#include "riscvcrypto/share/util.h"
+
+#include "riscvcrypto/aes/api_aes.h"
+#include "riscvcrypto/aes/api_aes_modes.h"
+
+//! Largest payload used by the benchmark sweep.
+#define GCM_BENCH_MAX_BYTES 4096
+
+static uint8_t  buf_pt  [GCM_BENCH_MAX_BYTES];
+static uint8_t  buf_ct  [GCM_BENCH_MAX_BYTES];
+static uint8_t  buf_pt2 [GCM_BENCH_MAX_BYTES];
+
+//! Reads a hex string into out, returning the number of bytes.
+static size_t gcm_unhex(uint8_t * out, const char * hex) {
+    size_t n = 0;
+    for(; hex[0] && hex[1]; hex += 2) {
+        char b[3] = {hex[0], hex[1], 0};
+        out[n ++] = (uint8_t)strtoul(b, NULL, 16);
+    }
+    return n;
+}
+
+//! McGrew and Viega, "The Galois/Counter Mode of Operation", test cases
+//  1-6: the AES-128 ones. Cases 5 and 6 have 64 and 480 bit IVs.
+static const struct {
+    const char * key;
+    const char * iv;
+    const char * aad;
+    const char * pt;
+    const char * expected;              // C || T, hex
+} gcm_examples[] = {
+    {"00000000000000000000000000000000", "000000000000000000000000", "",
+     "", "58e2fccefa7e3061367f1d57a4e7455a"},
+    {"00000000000000000000000000000000", "000000000000000000000000", "",
+     "00000000000000000000000000000000",
+     "0388dace60b6a392f328c2b971b2fe78ab6e47d42cec13bdf53a67b21257bddf"},
+    {"feffe9928665731c6d6a8f9467308308", "cafebabefacedbaddecaf888", "",
+     "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+     "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b391aafd255",
+     "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"
+     "21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091473f5985"
+     "4d5c2af327cd64a62cf35abd2ba6fab4"},
+    {"feffe9928665731c6d6a8f9467308308", "cafebabefacedbaddecaf888",
+     "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+     "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+     "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+     "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"
+     "21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091"
+     "5bc94fbc3221a5db94fae95ae7121a47"},
+    {"feffe9928665731c6d6a8f9467308308", "cafebabefacedbad",
+     "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+     "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+     "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+     "61353b4c2806934a777ff51fa22a4755699b2a714fcdc6f83766e5f97b6c7423"
+     "73806900e49f24b22b097544d4896b424989b5e1ebac0f07c23f4598"
+     "3612d2e79e3b0785561be14aaca2fccb"},
+    {"feffe9928665731c6d6a8f9467308308",
+     "9313225df88406e555909c5aff5269aa6a7a9538534f7da1e4c303d2a318a728"
+     "c3c0c95156809539fcf0e2429a6b525416aedbf5a0de6a57a637b39b",
+     "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+     "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+     "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+     "8ce24998625615b603a033aca13fb894be9112a5c3a211a8ba262a3cca7e2ca7"
+     "01e4a9a4fba43c90ccdcb281d48c7c6fd62875d2aca417034c34aee5"
+     "619cc5aefffe0bfa462af43c1699d050"},
+};
+
+void test_aes_gcm_examples() {
+
+    uint8_t  key [AES_128_KEY_BYTES];
+    uint8_t  iv  [64];
+    uint8_t  aad [32];
+    uint8_t  tag [AES_GCM_TAG_BYTES];
+    uint32_t erk [AES_128_RK_WORDS];
+
+    for(size_t e = 0; e < sizeof(gcm_examples)/sizeof(gcm_examples[0]); e++){
+        gcm_unhex(key, gcm_examples[e].key);
+        size_t ivlen  = gcm_unhex(iv    , gcm_examples[e].iv );
+        size_t aadlen = gcm_unhex(aad   , gcm_examples[e].aad);
+        size_t len    = gcm_unhex(buf_pt, gcm_examples[e].pt );
+
+        aes_128_enc_key_schedule(erk, key);
+
+        aes_128_gcm_encrypt(buf_ct, tag, buf_pt, len, aad, aadlen, iv, ivlen,
+            AES_GCM_TAG_BYTES, erk);
+
+        int dec_rc = aes_128_gcm_decrypt(buf_pt2, buf_ct, len, aad, aadlen,
+            iv, ivlen, tag, AES_GCM_TAG_BYTES, erk);
+
+        // A corrupted tag must be rejected.
+        tag[AES_GCM_TAG_BYTES - 1] ^= 0x80;
+        int bad_rc = aes_128_gcm_decrypt(buf_pt2, buf_ct, len, aad, aadlen,
+            iv, ivlen, tag, AES_GCM_TAG_BYTES, erk);
+        tag[AES_GCM_TAG_BYTES - 1] ^= 0x80;
+
+        printf("#\n# AES GCM test case %d\n", (int)e + 1);
+        printf("pt   =");puthex_py(buf_pt , len              ); printf("\n");
+        printf("pt2  =");puthex_py(buf_pt2, len              ); printf("\n");
+        printf("ct   =");puthex_py(buf_ct , len              ); printf("\n");
+        printf("tag  =");puthex_py(tag    , AES_GCM_TAG_BYTES); printf("\n");
+        printf("if( ct + tag != binascii.a2b_hex(\"%s\") ):\n",
+            gcm_examples[e].expected);
+        printf("    print(\"AES GCM test case %d: KAT mismatch.\")\n",
+            (int)e + 1);
+        printf("    print( 'ct  == %%s' %% ( binascii.b2a_hex( ct  )))\n");
+        printf("    print( 'tag == %%s' %% ( binascii.b2a_hex( tag )))\n");
+        printf("    sys.exit(1)\n");
+        printf("if( pt2 != pt or %d != 0 or %d == 0 ):\n", dec_rc, bad_rc);
+        printf("    print(\"AES GCM test case %d: decrypt failed.\")\n",
+            (int)e + 1);
+        printf("    sys.exit(1)\n");
+        printf("print(\""STR(TEST_NAME)" AES GCM test case %d passed.\")\n",
+            (int)e + 1);
+    }
+}
+
+/*!
+@brief Random messages, each also run as a stream of random length pieces,
+    which must give the same cipher text and tag.
+*/
+void test_aes_gcm_random(int num_tests) {
+
+    uint8_t  key   [AES_128_KEY_BYTES];
+    uint8_t  iv    [12];
+    uint8_t  aad   [64];
+    uint8_t  tag   [AES_GCM_TAG_BYTES];
+    uint8_t  tag2  [AES_GCM_TAG_BYTES];
+    uint8_t  lens  [2];
+    uint8_t  cuts  [64];
+    uint32_t erk   [AES_128_RK_WORDS];
+
+    for(int i = 0; i < num_tests; i ++) {
+
+        test_rdrandom(key   , AES_128_KEY_BYTES);
+        test_rdrandom(iv    , sizeof(iv));
+        test_rdrandom(aad   , sizeof(aad));
+        test_rdrandom(buf_pt, 256);
+        test_rdrandom(lens  , sizeof(lens));
+        test_rdrandom(cuts  , sizeof(cuts));
+
+        size_t aadlen = lens[0] % sizeof(aad);
+        size_t len    = lens[1];
+
+        aes_128_enc_key_schedule(erk, key);
+
+        aes_128_gcm_encrypt(buf_ct, tag, buf_pt, len, aad, aadlen,
+            iv, sizeof(iv), AES_GCM_TAG_BYTES, erk);
+
+        aes_128_gcm_ctx ctx;
+        size_t          off = 0;
+        aes_128_gcm_init(&ctx, iv, sizeof(iv), aad, aadlen, erk);
+        for(int c = 0; off < len; c = (c + 1) % sizeof(cuts)) {
+            size_t n = cuts[c] % 40;
+            n = n < len - off ? n : len - off;
+            aes_128_gcm_decrypt_update(&ctx, buf_pt2 + off, buf_ct + off, n);
+            off += n;
+        }
+        aes_128_gcm_final(&ctx, tag2);
+
+        printf("#\n# AES GCM random test %d/%d\n", i, num_tests);
+        printf("key  =");puthex_py(key   , AES_128_KEY_BYTES); printf("\n");
+        printf("iv   =");puthex_py(iv    , sizeof(iv)       ); printf("\n");
+        printf("aad  =");puthex_py(aad   , aadlen           ); printf("\n");
+        printf("pt   =");puthex_py(buf_pt, len              ); printf("\n");
+        printf("pt2  =");puthex_py(buf_pt2,len              ); printf("\n");
+        printf("ct   =");puthex_py(buf_ct, len              ); printf("\n");
+        printf("tag  =");puthex_py(tag   , AES_GCM_TAG_BYTES); printf("\n");
+        printf("tag2 =");puthex_py(tag2  , AES_GCM_TAG_BYTES); printf("\n");
+        printf("ref  = AES.new(key,AES.MODE_GCM,nonce=iv,mac_len=16)\n");
+        printf("ref.update(aad)\n");
+        printf("ref_ct, ref_tag = ref.encrypt_and_digest(pt)\n");
+        printf("if( ref_ct != ct or ref_tag != tag ):\n");
+        printf("    print(\"AES GCM random test encrypt failed.\")\n");
+        printf("    print( 'ct  == %%s' %% ( binascii.b2a_hex( ct      )))\n");
+        printf("    print( '    != %%s' %% ( binascii.b2a_hex( ref_ct  )))\n");
+        printf("    print( 'tag == %%s' %% ( binascii.b2a_hex( tag     )))\n");
+        printf("    print( '    != %%s' %% ( binascii.b2a_hex( ref_tag )))\n");
+        printf("    sys.exit(1)\n");
+        printf("if( pt2 != pt or tag2 != tag ):\n");
+        printf("    print(\"AES GCM random test stream decrypt failed.\")\n");
+        printf("    sys.exit(1)\n");
+        printf("print(\""STR(TEST_NAME)" AES GCM random test %d passed.\")\n",
+            i);
+    }
+}
+
+void test_aes_ctr() {
+
+    // NIST SP 800-38A F.5.1 CTR-AES128.Encrypt. The counter carries out of
+    // its last byte after the first block.
+    uint8_t  key [AES_128_KEY_BYTES];
+    uint8_t  ctr [AES_BLOCK_BYTES];
+    uint8_t  ctr2[AES_BLOCK_BYTES];
+    uint8_t  ct2 [64];
+    uint32_t erk [AES_128_RK_WORDS];
+
+    gcm_unhex(key, "2b7e151628aed2a6abf7158809cf4f3c");
+    gcm_unhex(ctr, "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+    gcm_unhex(buf_pt,
+        "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+        "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710");
+    memcpy(ctr2, ctr, AES_BLOCK_BYTES);
+
+    aes_128_enc_key_schedule(erk, key);
+
+    aes_128_ctr(buf_ct, buf_pt, 64, ctr, erk);
+
+    // The same, as a stream of a 16 and a 48 byte piece.
+    aes_128_ctr(ct2     , buf_pt     , 16, ctr2, erk);
+    aes_128_ctr(ct2 + 16, buf_pt + 16, 48, ctr2, erk);
+
+    printf("#\n# AES CTR SP 800-38A F.5.1\n");
+    printf("ct   =");puthex_py(buf_ct, 64             ); printf("\n");
+    printf("ct2  =");puthex_py(ct2   , 64             ); printf("\n");
+    printf("ctr  =");puthex_py(ctr   , AES_BLOCK_BYTES); printf("\n");
+    printf("ctr2 =");puthex_py(ctr2  , AES_BLOCK_BYTES); printf("\n");
+    printf("if( ct != binascii.a2b_hex(\""
+        "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+        "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee"
+        "\") ):\n");
+    printf("    print(\"AES CTR SP 800-38A F.5.1 failed.\")\n");
+    printf("    print( 'ct  == %%s' %% ( binascii.b2a_hex( ct )))\n");
+    printf("    sys.exit(1)\n");
+    printf("if( ct2 != ct or ctr != ctr2 or ctr != binascii.a2b_hex(\""
+        "f0f1f2f3f4f5f6f7f8f9fafbfcfdff03\") ):\n");
+    printf("    print(\"AES CTR stream or counter update failed.\")\n");
+    printf("    sys.exit(1)\n");
+    printf("print(\""STR(TEST_NAME)" AES CTR SP 800-38A F.5.1 passed.\")\n");
+}
+
+void bench_aes_gcm() {
+
+    uint8_t  key   [AES_128_KEY_BYTES];
+    uint8_t  iv    [12];
+    uint8_t  aad   [16];
+    uint8_t  ctr   [AES_BLOCK_BYTES];
+    uint8_t  tag   [AES_GCM_TAG_BYTES];
+    uint32_t erk   [AES_128_RK_WORDS];
+
+    test_rdrandom(key   , sizeof(key));
+    test_rdrandom(iv    , sizeof(iv));
+    test_rdrandom(aad   , sizeof(aad));
+    test_rdrandom(ctr   , sizeof(ctr));
+    test_rdrandom(buf_pt, GCM_BENCH_MAX_BYTES);
+
+    aes_128_enc_key_schedule(erk, key);
+
+    printf("#\n# AES GCM / CTR benchmark, 16 byte aad, 16 byte tag\n");
+    printf("print(\"%%6s %%12s %%12s %%12s %%12s %%12s %%12s\" %% ("
+        "'bytes','gcm_enc_ir','gcm_enc_cyc','gcm_dec_ir','gcm_dec_cyc',"
+        "'ctr_ir','ctr_cyc'))\n");
+
+    for(size_t len = 64; len <= GCM_BENCH_MAX_BYTES; len *= 4) {
+
+        uint64_t i0 = test_rdinstret();
+        uint64_t c0 = test_rdcycle();
+        aes_128_gcm_encrypt(buf_ct, tag, buf_pt, len, aad, sizeof(aad),
+            iv, sizeof(iv), AES_GCM_TAG_BYTES, erk);
+        uint64_t enc_cycles = test_rdcycle()   - c0;
+        uint64_t enc_icount = test_rdinstret() - i0;
+
+        i0 = test_rdinstret();
+        c0 = test_rdcycle();
+        int dec_rc = aes_128_gcm_decrypt(buf_pt2, buf_ct, len, aad,
+            sizeof(aad), iv, sizeof(iv), tag, AES_GCM_TAG_BYTES, erk);
+        uint64_t dec_cycles = test_rdcycle()   - c0;
+        uint64_t dec_icount = test_rdinstret() - i0;
+
+        i0 = test_rdinstret();
+        c0 = test_rdcycle();
+        aes_128_ctr(buf_ct, buf_pt, len, ctr, erk);
+        uint64_t ctr_cycles = test_rdcycle()   - c0;
+        uint64_t ctr_icount = test_rdinstret() - i0;
+
+        printf("if( %d != 0 or %d != 0 ):\n", dec_rc,
+            memcmp(buf_pt, buf_pt2, len) != 0);
+        printf("    print(\"AES GCM benchmark round trip failed at %d bytes.\")\n",
+            (int)len);
+        printf("    sys.exit(1)\n");
+        printf("print(\"%%6d %%12d %%12d %%12d %%12d %%12d %%12d\" %% ("
+            "%d, 0x", (int)len);
+        puthex64(enc_icount); printf(", 0x");
+        puthex64(enc_cycles); printf(", 0x");
+        puthex64(dec_icount); printf(", 0x");
+        puthex64(dec_cycles); printf(", 0x");
+        puthex64(ctr_icount); printf(", 0x");
+        puthex64(ctr_cycles); printf("))\n");
+
+        test_result("aes_128_gcm_enc", len, enc_icount, enc_cycles);
+        test_result("aes_128_gcm_dec", len, dec_icount, dec_cycles);
+        test_result("aes_128_ctr"    , len, ctr_icount, ctr_cycles);
+    }
+}
+
+
+int main(int argc, char ** argv) {
+
+    test_init(argc, argv);
+
+    printf("import sys, binascii\n");
+    printf("import Crypto.Cipher.AES as AES\n");
+    printf("benchmark_name = \"" STR(TEST_NAME)"\"\n");
+
+    test_aes_gcm_examples();
+    test_aes_gcm_random(10);
+    test_aes_ctr();
+    bench_aes_gcm();
+
+    return 0;
+
+}
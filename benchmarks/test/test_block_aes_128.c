@@ -17,24 +17,33 @@ void test_aes_128(int num_tests) {
     uint8_t  ct  [AES_BLOCK_BYTES   ];
     uint8_t  pt2 [AES_BLOCK_BYTES   ];
     uint64_t start_instrs;
+    uint64_t start_cycles;
 
     for(int i = 0; i < num_tests; i ++) {
 
+        start_cycles        = test_rdcycle();
         start_instrs        = test_rdinstret();
         aes_128_enc_key_schedule(erk, key    );
         uint64_t kse_icount = test_rdinstret() - start_instrs;
+        uint64_t kse_cycles = test_rdcycle()   - start_cycles;
 
+        start_cycles        = test_rdcycle();
         start_instrs        = test_rdinstret();
         aes_128_ecb_encrypt     (ct , pt, erk);
         uint64_t enc_icount = test_rdinstret() - start_instrs;
+        uint64_t enc_cycles = test_rdcycle()   - start_cycles;
         
+        start_cycles        = test_rdcycle();
         start_instrs        = test_rdinstret();
         aes_128_dec_key_schedule(drk, key    );
         uint64_t ksd_icount   = test_rdinstret() - start_instrs;
+        uint64_t ksd_cycles   = test_rdcycle()   - start_cycles;
 
+        start_cycles        = test_rdcycle();
         start_instrs        = test_rdinstret();
         aes_128_ecb_decrypt     (pt2, ct, drk);
         uint64_t dec_icount = test_rdinstret() - start_instrs;
+        uint64_t dec_cycles = test_rdcycle()   - start_cycles;
         
         printf("#\n# AES 128 test %d/%d\n",i , num_tests);
 
@@ -50,6 +59,11 @@ void test_aes_128(int num_tests) {
         printf("enc_icount = 0x"); puthex64(enc_icount); printf("\n");
         printf("dec_icount = 0x"); puthex64(dec_icount); printf("\n");
 
+        test_result("aes_128_enc", AES_BLOCK_BYTES  , enc_icount, enc_cycles);
+        test_result("aes_128_dec", AES_BLOCK_BYTES  , dec_icount, dec_cycles);
+        test_result("aes_128_kse", AES_128_KEY_BYTES, kse_icount, kse_cycles);
+        test_result("aes_128_ksd", AES_128_KEY_BYTES, ksd_icount, ksd_cycles);
+
         printf("testnum         = %d\n",i);
 
         printf("ref_ct          = AES.new(key,AES.MODE_ECB).encrypt(pt    )\n");
@@ -89,6 +103,8 @@ void test_aes_128(int num_tests) {
 
 int main(int argc, char ** argv) {
 
+    test_init(argc, argv);
+
     printf("import sys, binascii, Crypto.Cipher.AES as AES\n");
     printf("benchmark_name = \"" STR(TEST_NAME)"\"\n");
 
@@ -32,6 +32,7 @@ void test_aes_256(int num_tests) {
     uint8_t  ct  [AES_BLOCK_BYTES   ];
     uint8_t  pt2 [AES_BLOCK_BYTES   ];
     uint64_t start_instrs;
+    uint64_t start_cycles;
 
     for(int i = 0; i < num_tests; i ++) {
 
@@ -40,21 +41,29 @@ void test_aes_256(int num_tests) {
             drk[i] = 0;
         }
 
+        start_cycles = test_rdcycle();
         start_instrs = test_rdinstret();
         aes_256_enc_key_schedule(erk, key    );
         uint64_t kse_icount   = test_rdinstret() - start_instrs;
+        uint64_t kse_cycles   = test_rdcycle()   - start_cycles;
 
+        start_cycles = test_rdcycle();
         start_instrs = test_rdinstret();
         aes_256_ecb_encrypt     (ct , pt, erk);
         uint64_t enc_icount   = test_rdinstret() - start_instrs;
+        uint64_t enc_cycles   = test_rdcycle()   - start_cycles;
         
+        start_cycles        = test_rdcycle();
         start_instrs        = test_rdinstret();
         aes_256_dec_key_schedule(drk, key    );
         uint64_t ksd_icount   = test_rdinstret() - start_instrs;
+        uint64_t ksd_cycles   = test_rdcycle()   - start_cycles;
         
+        start_cycles        = test_rdcycle();
         start_instrs        = test_rdinstret();
         aes_256_ecb_decrypt     (pt2, ct, drk);
         uint64_t dec_icount = test_rdinstret() - start_instrs;
+        uint64_t dec_cycles = test_rdcycle()   - start_cycles;
         
         printf("#\n# AES 256 test %d/%d\n",i , num_tests);
 
@@ -70,6 +79,11 @@ void test_aes_256(int num_tests) {
         printf("enc_icount = 0x"); puthex64(enc_icount); printf("\n");
         printf("dec_icount = 0x"); puthex64(dec_icount); printf("\n");
 
+        test_result("aes_256_enc", AES_BLOCK_BYTES  , enc_icount, enc_cycles);
+        test_result("aes_256_dec", AES_BLOCK_BYTES  , dec_icount, dec_cycles);
+        test_result("aes_256_kse", AES_256_KEY_BYTES, kse_icount, kse_cycles);
+        test_result("aes_256_ksd", AES_256_KEY_BYTES, ksd_icount, ksd_cycles);
+
         printf("testnum         = %d\n",i);
 
         printf("ref_ct          = AES.new(key,AES.MODE_ECB).encrypt(pt    )\n");
@@ -109,6 +123,8 @@ void test_aes_256(int num_tests) {
 
 int main(int argc, char ** argv) {
 
+    test_init(argc, argv);
+
     printf("import sys, binascii, Crypto.Cipher.AES as AES\n");
     printf("benchmark_name = \"" STR(TEST_NAME)"\"\n");
 
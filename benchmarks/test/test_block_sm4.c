@@ -24,11 +24,14 @@ uint8_t cts [1][16] = {
 };
 
 int main(int argc, char ** argv) {
-    
+
+    test_init(argc, argv);
+
     printf("import sys, binascii, Crypto.Cipher.AES as AES\n");
     printf("benchmark_name = \"" STR(TEST_NAME)"\"\n");
     
     uint64_t start_instrs;
+    uint64_t start_cycles;
 
     for(int test = 0; test < 1; test ++) {
 
@@ -40,21 +43,29 @@ int main(int argc, char ** argv) {
         uint32_t  erk[32];
         uint32_t  drk[32];
 
+        start_cycles        = test_rdcycle();
         start_instrs        = test_rdinstret();
         sm4_key_schedule_enc(erk, mk);
         uint64_t kse_icount = test_rdinstret() - start_instrs;
+        uint64_t kse_cycles = test_rdcycle()   - start_cycles;
 
+        start_cycles        = test_rdcycle();
         start_instrs        = test_rdinstret();
         sm4_key_schedule_dec(drk, mk);
         uint64_t ksd_icount = test_rdinstret() - start_instrs;
+        uint64_t ksd_cycles = test_rdcycle()   - start_cycles;
 
+        start_cycles        = test_rdcycle();
         start_instrs        = test_rdinstret();
         sm4_block_enc_dec   (ct,pt,erk);
         uint64_t enc_icount = test_rdinstret() - start_instrs;
+        uint64_t enc_cycles = test_rdcycle()   - start_cycles;
 
+        start_cycles        = test_rdcycle();
         start_instrs        = test_rdinstret();
         sm4_block_enc_dec   (fi,ct,drk);
         uint64_t dec_icount = test_rdinstret() - start_instrs;
+        uint64_t dec_cycles = test_rdcycle()   - start_cycles;
         
         printf("pt  = "); puthex_py(pt, 16); printf("\n");
         printf("mk  = "); puthex_py(mk, 16); printf("\n");
@@ -68,6 +79,11 @@ int main(int argc, char ** argv) {
         printf("enc_icount = 0x"); puthex64(enc_icount); printf("\n");
         printf("dec_icount = 0x"); puthex64(dec_icount); printf("\n");
 
+        test_result("sm4_enc", 16, enc_icount, enc_cycles);
+        test_result("sm4_dec", 16, dec_icount, dec_cycles);
+        test_result("sm4_kse", 16, kse_icount, kse_cycles);
+        test_result("sm4_ksd", 16, ksd_icount, ksd_cycles);
+
         int tr = 0;
         for(int i = 0; i < 16; i ++) {
 
@@ -9,6 +9,8 @@
 
 int main(int argc, char ** argv) {
 
+    test_init(argc, argv);
+
     printf("import sys, binascii, Crypto.Hash.SHA256 as SHA2_256\n");
     printf("benchmark_name = \"" STR(TEST_NAME)"\"\n");
 
@@ -18,12 +20,17 @@ int main(int argc, char ** argv) {
     uint8_t  * message      ;
     uint32_t   digest    [8];
 
+    // Messages are generated up front, so only the hash is in the loop.
+    uint8_t  * messages  [num_tests];
     for(int i = 0; i < num_tests; i ++) {
+        messages[i] = test_pool(message_len + i * TEST_HASH_INPUT_LENGTH / 2);
+    }
 
-        message  = calloc(message_len, sizeof(unsigned char));
+    for(int i = 0; i < num_tests; i ++) {
 
-        test_rdrandom(message, message_len);
+        message  = messages[i];
 
+        const uint64_t start_cycles   = test_rdcycle();
         const uint64_t start_instrs   = test_rdinstret();
 
         sha256_hash (
@@ -33,9 +40,14 @@ int main(int argc, char ** argv) {
         );
         
         const uint64_t end_instrs     = test_rdinstret();
+        const uint64_t end_cycles     = test_rdcycle();
 
         const uint64_t final_instrs   = end_instrs - start_instrs;
 
+        const uint64_t final_cycles   = end_cycles - start_cycles;
+
+        test_result("sha256", message_len, final_instrs, final_cycles);
+
         printf("#\n# test %d/%d\n",i , num_tests);
 
         printf("input_len       = %u\n", message_len);
@@ -69,9 +81,9 @@ int main(int argc, char ** argv) {
 
         message_len += TEST_HASH_INPUT_LENGTH / 2;
 
-        free(message);
-
     }
 
+    test_pool_free();
+
     return 0;
 }
@@ -7,6 +7,8 @@
 
 int main(int argc, char **argv) {
 
+  test_init(argc, argv);
+
   printf("import sys, binascii\n");
   printf("benchmark_name = \"" STR(TEST_NAME) "\"\n");
 
@@ -143,14 +145,19 @@ int main(int argc, char **argv) {
 
   for (int i = 0; i < TEST_COUNT; i++) {
 
+    const uint64_t start_cycles = test_rdcycle();
     const uint64_t start_instrs = test_rdinstret();
 
     uint8_t actual_digest[32];
     sm3_hash(actual_digest, messages[i], message_lengths[i]);
 
     const uint64_t end_instrs = test_rdinstret();
+    const uint64_t end_cycles = test_rdcycle();
 
     const uint64_t final_instrs = end_instrs - start_instrs;
+    const uint64_t final_cycles = end_cycles - start_cycles;
+
+    test_result("sm3", message_lengths[i], final_instrs, final_cycles);
 
     printf("#\n# test %d/%d\n", i, TEST_COUNT);
 
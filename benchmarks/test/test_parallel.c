@@ -0,0 +1,276 @@
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "riscvcrypto/share/test.h"
+#include "riscvcrypto/share/util.h"
+
+#include "riscvcrypto/aes/api_aes.h"
+#include "riscvcrypto/sm4/api_sm4.h"
+#include "riscvcrypto/sha256/api_sha256.h"
+#include "riscvcrypto/sm3/api_sm3.h"
+
+#include "riscvcrypto/parallel/api_parallel.h"
+
+//
+// Checks the parallel engine against plain sequential versions of each
+// mode, and two IEEE 1619 XTS-AES-128 vectors, for several thread counts
+// and chunk sizes small enough that every worker gets (and steals) work.
+//
+
+//! Message length, chosen to leave a partial block, leaf and data unit.
+#define MSG_BYTES (64 * 1024 + 37)
+
+//! XTS data unit length used by the sequential checks.
+#define UNIT_BYTES 512
+
+//! IEEE 1619 vector 1: zero keys, sector 0, 32 zero bytes.
+static const uint8_t xts_1_ct[32] = {
+    0x91, 0x7c, 0xf6, 0x9e, 0xbd, 0x68, 0xb2, 0xec,
+    0x9b, 0x9f, 0xe9, 0xa3, 0xea, 0xdd, 0xa6, 0x92,
+    0xcd, 0x43, 0xd2, 0xf5, 0x95, 0x98, 0xed, 0x85,
+    0x8c, 0x02, 0xc2, 0x65, 0x2f, 0xbf, 0x92, 0x2e
+};
+
+//! IEEE 1619 vector 15: 17 bytes, so one block of ciphertext stealing.
+static uint8_t xts_15_key1[16] = {
+    0xff, 0xfe, 0xfd, 0xfc, 0xfb, 0xfa, 0xf9, 0xf8,
+    0xf7, 0xf6, 0xf5, 0xf4, 0xf3, 0xf2, 0xf1, 0xf0
+};
+static uint8_t xts_15_key2[16] = {
+    0xbf, 0xbe, 0xbd, 0xbc, 0xbb, 0xba, 0xb9, 0xb8,
+    0xb7, 0xb6, 0xb5, 0xb4, 0xb3, 0xb2, 0xb1, 0xb0
+};
+static const uint8_t xts_15_ct[17] = {
+    0x6c, 0x16, 0x25, 0xdb, 0x46, 0x71, 0x52, 0x2d,
+    0x3d, 0x75, 0x99, 0x60, 0x1d, 0xe7, 0xca, 0x09,
+    0xed
+};
+
+//! Sequential CTR, one block at a time.
+static void ref_ctr(uint8_t * out, uint8_t * in, size_t len, uint8_t ctr[16],
+                    parallel_block_fn enc, uint32_t * rk) {
+    uint8_t c[16], ks[16];
+    memcpy(c, ctr, 16);
+    for(size_t off = 0; off < len; off += 16) {
+        enc(ks, c, rk);
+        for(size_t i = 0; i < 16 && off + i < len; i ++) {
+            out[off + i] = in[off + i] ^ ks[i];
+        }
+        for(int i = 15; i >= 0 && ++ c[i] == 0; i --);
+    }
+}
+
+//! Sequential two level tree hash.
+static void ref_tree(uint8_t digest[32], uint8_t * msg, size_t len,
+                     size_t leaf, int sm3) {
+    size_t    leaves = len ? (len + leaf - 1) / leaf : 1;
+    uint8_t * hashes = malloc(32 * leaves);
+    uint32_t  h[8];
+    for(size_t l = 0; l < leaves; l ++) {
+        size_t n = len - l * leaf < leaf ? len - l * leaf : leaf;
+        if(sm3) {
+            sm3_hash(hashes + 32 * l, msg + l * leaf, n);
+        } else {
+            sha256_hash(h, msg + l * leaf, n);
+            memcpy(hashes + 32 * l, h, 32);
+        }
+    }
+    if(sm3) {
+        sm3_hash(digest, hashes, 32 * leaves);
+    } else {
+        sha256_hash(h, hashes, 32 * leaves);
+        memcpy(digest, h, 32);
+    }
+    free(hashes);
+}
+
+//! Runs every mode on one engine. Returns non-zero on a mismatch.
+static int check_engine(parallel_engine * e, uint8_t * msg, uint8_t key[32]) {
+    int       tr     = 0;
+    uint8_t * expect = malloc(MSG_BYTES);
+    uint8_t * got    = malloc(MSG_BYTES);
+    uint8_t * back   = malloc(MSG_BYTES);
+    uint8_t   ctr[16], ctr_p[16];
+    uint8_t   d_ref[32], d_par[32];
+    uint32_t  rk [AES_128_RK_WORDS];
+    uint32_t  drk[AES_128_RK_WORDS];
+    uint32_t  trk[AES_128_RK_WORDS];
+    uint32_t  srk[32];
+
+    aes_128_enc_key_schedule(rk , key);
+    aes_128_dec_key_schedule(drk, key);
+    aes_128_enc_key_schedule(trk, key + 16);
+    sm4_key_schedule_enc(srk, key);
+
+    // A counter about to carry out of its low 64 bits.
+    memset(ctr, 0xFF, 16);
+    ctr[0] = 0x12;
+    ctr[8] = 0xFE;
+
+    memcpy(ctr_p, ctr, 16);
+    ref_ctr(expect, msg, MSG_BYTES, ctr, aes_128_ecb_encrypt, rk);
+    parallel_aes_128_ctr(e, got, msg, MSG_BYTES, ctr_p, rk);
+    if(memcmp(got, expect, MSG_BYTES)) {
+        printf("print(\"aes_128_ctr disagrees\")\n");
+        tr |= 1;
+    }
+    ref_ctr(expect, msg, MSG_BYTES, ctr, sm4_block_enc_dec, srk);
+    memcpy(ctr_p, ctr, 16);
+    parallel_sm4_ctr(e, got, msg, MSG_BYTES, ctr_p, srk);
+    if(memcmp(got, expect, MSG_BYTES)) {
+        printf("print(\"sm4_ctr disagrees\")\n");
+        tr |= 2;
+    }
+
+    // XTS: each data unit on its own must match the whole, and decrypt
+    // must undo encrypt.
+    for(size_t off = 0; off < MSG_BYTES; off += UNIT_BYTES) {
+        size_t n = MSG_BYTES - off < UNIT_BYTES ? MSG_BYTES - off : UNIT_BYTES;
+        parallel_aes_128_xts_encrypt(e, expect + off, msg + off, n, rk, trk,
+            7 + off / UNIT_BYTES, UNIT_BYTES);
+    }
+    if(parallel_aes_128_xts_encrypt(e, got, msg, MSG_BYTES, rk, trk, 7,
+                                    UNIT_BYTES) ||
+       parallel_aes_128_xts_decrypt(e, back, got, MSG_BYTES, drk, trk, 7,
+                                    UNIT_BYTES)) {
+        printf("print(\"aes_128_xts rejected a valid length\")\n");
+        tr |= 4;
+    }
+    if(memcmp(got, expect, MSG_BYTES) || memcmp(back, msg, MSG_BYTES)) {
+        printf("print(\"aes_128_xts disagrees\")\n");
+        tr |= 4;
+    }
+    if(!parallel_aes_128_xts_encrypt(e, got, msg, UNIT_BYTES + 15, rk, trk,
+                                     0, UNIT_BYTES) ||
+       !parallel_aes_128_xts_encrypt(e, got, msg, UNIT_BYTES, rk, trk, 0,
+                                     UNIT_BYTES + 1)) {
+        printf("print(\"aes_128_xts accepted an invalid length\")\n");
+        tr |= 4;
+    }
+
+    size_t leaves[] = {4096, 1000, MSG_BYTES, 2 * MSG_BYTES};
+    for(size_t l = 0; l < sizeof(leaves) / sizeof(leaves[0]); l ++) {
+        ref_tree(d_ref, msg, MSG_BYTES, leaves[l], 0);
+        parallel_sha256_tree(e, d_par, msg, MSG_BYTES, leaves[l]);
+        if(memcmp(d_ref, d_par, 32)) {
+            printf("print(\"sha256_tree disagrees, leaf %lu\")\n",
+                (unsigned long)leaves[l]);
+            tr |= 8;
+        }
+        ref_tree(d_ref, msg, MSG_BYTES, leaves[l], 1);
+        parallel_sm3_tree(e, d_par, msg, MSG_BYTES, leaves[l]);
+        if(memcmp(d_ref, d_par, 32)) {
+            printf("print(\"sm3_tree disagrees, leaf %lu\")\n",
+                (unsigned long)leaves[l]);
+            tr |= 8;
+        }
+    }
+    ref_tree(d_ref, msg, 0, 64, 0);
+    parallel_sha256_tree(e, d_par, msg, 0, 64);
+    if(memcmp(d_ref, d_par, 32)) {
+        printf("print(\"sha256_tree disagrees on the empty message\")\n");
+        tr |= 8;
+    }
+
+    free(expect);
+    free(got);
+    free(back);
+    return tr;
+}
+
+//! The IEEE 1619 vectors, which do not depend on the engine much.
+static int check_xts_vectors(parallel_engine * e) {
+    int      tr = 0;
+    uint8_t  zero[32] = {0};
+    uint8_t  out [32];
+    uint8_t  pt  [17];
+    uint32_t rk [AES_128_RK_WORDS];
+    uint32_t trk[AES_128_RK_WORDS];
+
+    aes_128_enc_key_schedule(rk , zero);
+    aes_128_enc_key_schedule(trk, zero);
+    parallel_aes_128_xts_encrypt(e, out, zero, 32, rk, trk, 0, 32);
+    if(memcmp(out, xts_1_ct, 32)) {
+        printf("print(\"IEEE 1619 vector 1 failed\")\n");
+        tr |= 16;
+    }
+
+    for(int i = 0; i < 17; i ++) {
+        pt[i] = i;
+    }
+    aes_128_enc_key_schedule(rk , xts_15_key1);
+    aes_128_enc_key_schedule(trk, xts_15_key2);
+    parallel_aes_128_xts_encrypt(e, out, pt, 17, rk, trk, 0x123456789aULL, 32);
+    if(memcmp(out, xts_15_ct, 17)) {
+        printf("print(\"IEEE 1619 vector 15 failed\")\n");
+        tr |= 16;
+    }
+    aes_128_dec_key_schedule(rk , xts_15_key1);
+    parallel_aes_128_xts_decrypt(e, out, xts_15_ct, 17, rk, trk,
+        0x123456789aULL, 32);
+    if(memcmp(out, pt, 17)) {
+        printf("print(\"IEEE 1619 vector 15 did not decrypt\")\n");
+        tr |= 16;
+    }
+    return tr;
+}
+
+int main(int argc, char ** argv) {
+
+    test_init(argc, argv);
+
+    printf("import sys\n");
+    printf("benchmark_name = \"" STR(TEST_NAME)"\"\n");
+
+    int      tr  = 0;
+    uint8_t  key[32];
+    uint8_t *msg = malloc(MSG_BYTES);
+
+    test_rdrandom(key, sizeof(key));
+    test_rdrandom(msg, MSG_BYTES);
+
+    const parallel_config configs[] = {
+        {1, 0   , 0},
+        {2, 4096, 0},
+        {3, 1024, 1},
+        {8, 512 , 0},
+    };
+
+    for(size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c ++) {
+        parallel_engine * e = parallel_engine_new(&configs[c]);
+        if(e == NULL) {
+            printf("print(\"Could not start %u threads\")\n",
+                configs[c].threads);
+            tr |= 32;
+            continue;
+        }
+        printf("print(\"threads=%u chunk=%lu nodes=%u\")\n",
+            parallel_engine_threads(e), (unsigned long)configs[c].chunk_bytes,
+            parallel_engine_nodes(e));
+
+        tr |= check_engine(e, msg, key);
+        tr |= check_xts_vectors(e);
+
+        uint8_t * buf = parallel_alloc(e, 3 * 4096 + 5);
+        if(buf == NULL || buf[0] || buf[3 * 4096 + 4]) {
+            printf("print(\"parallel_alloc failed\")\n");
+            tr |= 32;
+        }
+        parallel_free(buf, 3 * 4096 + 5);
+
+        parallel_engine_free(e);
+    }
+
+    free(msg);
+
+    if(tr) {
+        printf("print('"STR(TEST_NAME)" Test Failed with code: %d')\n", tr);
+        printf("sys.exit(1)\n");
+        return tr;
+    }
+
+    printf("print(\""STR(TEST_NAME)" Test passed.\")\n");
+    return 0;
+}
@@ -84,7 +84,7 @@ int main(int argc, char ** argv) {
 
     demo_prince_sbox();
 
-#if __riscv_xlen == 64
+#if PERMUTATION_XLEN == 64
     demo_aes_sbox();
 #endif
 
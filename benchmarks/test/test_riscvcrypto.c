@@ -0,0 +1,157 @@
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "riscvcrypto/share/test.h"
+#include "riscvcrypto/share/util.h"
+
+#include "riscvcrypto/aes/api_aes.h"
+#include "riscvcrypto/sm4/api_sm4.h"
+#include "riscvcrypto/sha256/api_sha256.h"
+#include "riscvcrypto/sha512/api_sha512.h"
+#include "riscvcrypto/sha3/fips202.h"
+#include "riscvcrypto/sm3/api_sm3.h"
+
+#include "riscvcrypto/libriscvcrypto/api_riscvcrypto.h"
+
+//
+// Checks that libriscvcrypto gives the same answers whichever
+// implementations it binds to. Every algorithm is run with only the
+// portable kernels, then with each suite of extensions the hart has.
+//
+
+static const char * alg_names[RISCVCRYPTO_ALGS] = {
+    "aes", "sm4", "sha256", "sha512", "sha3", "sm3"
+};
+
+//! ISA strings and the extensions they should parse to.
+static const struct {
+    const char * isa;
+    uint32_t     caps;
+} isa_tests[] = {
+    {"rv64imafdc"                       , 0                                },
+    {"rv64imafdc_zicsr_zkn"             , RISCVCRYPTO_ZKN                  },
+    {"rv32i_zks"                        , RISCVCRYPTO_ZKS                  },
+    {"RV64GC_ZKNE_ZKND\n"               , RISCVCRYPTO_ZKNE|RISCVCRYPTO_ZKND},
+    {"zbkb_zksh"                        , RISCVCRYPTO_ZBKB|RISCVCRYPTO_ZKSH},
+    {"none"                             , 0                                },
+};
+
+#define OUT_BYTES (16 + 16 + 16 + 16 + 32 + 64 + 32 + 32)
+
+//! Runs every algorithm once over fixed inputs, concatenating the outputs.
+static void run_all(uint8_t out[OUT_BYTES], uint8_t key[32], uint8_t * msg,
+                    size_t len) {
+    uint32_t rk [AES_256_RK_WORDS];
+    uint32_t srk[32];
+    uint32_t h32[8] = {0};
+    uint64_t h64[8] = {0};
+
+    aes_128_enc_key_schedule(rk, key);
+    aes_128_ecb_encrypt(out, msg, rk);
+    aes_128_dec_key_schedule(rk, key);
+    aes_128_ecb_decrypt(out + 16, msg, rk);
+    out += 32;
+
+    sm4_key_schedule_enc(srk, key);
+    sm4_block_enc_dec(out, msg, srk);
+    sm4_key_schedule_dec(srk, key);
+    sm4_block_enc_dec(out + 16, msg, srk);
+    out += 32;
+
+    sha256_hash(h32, msg, len);
+    memcpy(out, h32, 32);
+    out += 32;
+
+    sha512_hash(h64, msg, len);
+    memcpy(out, h64, 64);
+    out += 64;
+
+    FIPS202_SHA3_256(msg, len, out);
+    out += 32;
+
+    sm3_hash(out, msg, len);
+}
+
+int main(int argc, char ** argv) {
+
+    test_init(argc, argv);
+
+    printf("import sys\n");
+    printf("benchmark_name = \"" STR(TEST_NAME)"\"\n");
+
+    int      tr     = 0;
+    uint32_t probed = riscvcrypto_caps();
+
+    for(size_t i = 0; i < sizeof(isa_tests) / sizeof(isa_tests[0]); i ++) {
+        if(riscvcrypto_parse_isa(isa_tests[i].isa) != isa_tests[i].caps) {
+            printf("print(\"ISA string %lu parsed wrongly\")\n",
+                (unsigned long)i);
+            tr |= 1;
+        }
+    }
+
+    uint8_t key [32];
+    uint8_t msg [TEST_HASH_INPUT_LENGTH];
+    uint8_t expect[OUT_BYTES];
+    uint8_t got   [OUT_BYTES];
+
+    test_rdrandom(key, sizeof(key));
+    test_rdrandom(msg, sizeof(msg));
+
+    riscvcrypto_set_caps(0);
+    run_all(expect, key, msg, sizeof(msg));
+
+    const uint32_t levels[] = {
+        probed & RISCVCRYPTO_ZKN, probed & RISCVCRYPTO_ZKS, probed
+    };
+
+    for(size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l ++) {
+        riscvcrypto_set_caps(levels[l]);
+        run_all(got, key, msg, sizeof(msg));
+
+        printf("print(\"caps 0x%02x:", (unsigned)levels[l]);
+        for(int a = 0; a < RISCVCRYPTO_ALGS; a ++) {
+            printf(" %s=%s", alg_names[a], riscvcrypto_impl(a));
+        }
+        printf("\")\n");
+
+        if(memcmp(got, expect, OUT_BYTES) != 0) {
+            printf("print(\"caps 0x%02x disagree with the portable kernels\")\n",
+                (unsigned)levels[l]);
+            tr |= 2;
+        }
+    }
+
+    // Each implementation the hart supports, bound by name.
+    riscvcrypto_set_caps(probed);
+    for(int a = 0; a < RISCVCRYPTO_ALGS; a ++) {
+        const char * name;
+        for(size_t i = 0; (name = riscvcrypto_impl_at(a, i)) != NULL; i ++) {
+            if(riscvcrypto_use(a, name) != 0) {
+                continue;
+            }
+            run_all(got, key, msg, sizeof(msg));
+            if(strcmp(riscvcrypto_impl(a), name) != 0 ||
+               memcmp(got, expect, OUT_BYTES) != 0) {
+                printf("print(\"%s disagrees with the portable kernels\")\n",
+                    name);
+                tr |= 4;
+            }
+        }
+        if(riscvcrypto_use(a, "no_such_impl") == 0) {
+            tr |= 4;
+        }
+        riscvcrypto_set_caps(probed);
+    }
+
+    if(tr) {
+        printf("print('"STR(TEST_NAME)" Test Failed with code: %d')\n", tr);
+        printf("sys.exit(1)\n");
+        return tr;
+    }
+
+    printf("print(\""STR(TEST_NAME)" Test passed.\")\n");
+    return 0;
+}
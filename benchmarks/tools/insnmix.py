@@ -0,0 +1,384 @@
+#!/usr/bin/env python3
+
+"""
+Instruction mix profiler for benchmark runs under Spike.
+
+Reads a Spike instruction trace ("spike -l", optionally with
+--log-commits) and classifies every retired instruction as one of
+
+    crypto, bitmanip, load, store, branch, alu, muldiv, vector, system
+
+Crypto instructions are recognised by their encodings, using the opcode
+tables in $REPO_HOME/tools/opcodes-crypto-*. Everything else is
+classified from its major opcode, or its mnemonic where that is needed to
+tell bitmanip apart from the base ISA.
+
+Given the symbol table of the traced program (objdump -t), instructions
+are attributed to functions, and only those inside the program are
+counted. This leaves out the proxy kernel. The report lists:
+
+- The overall histogram of instruction classes.
+- The same histogram for each of the hottest functions.
+- The hottest loops, found from taken backward branches and jumps, with
+  their trip counts and instruction mix.
+"""
+
+import os
+import re
+import sys
+import glob
+import bisect
+import argparse
+
+CLASSES = ["crypto", "bitmanip", "load", "store", "branch", "alu",
+           "muldiv", "vector", "system"]
+
+#: Matches "core   0: 0x0000000080001000 (0x00000297) auipc t0, 0x0" and
+#: "core   0: 3 0x0000000080001000 (0x00000297) x5 0x80001000"
+TRACE_RE = re.compile(
+    r"^core\s+\d+:\s+(?:(\d)\s+)?0x([0-9a-fA-F]+)\s+\(0x([0-9a-fA-F]+)\)\s*(.*)$")
+
+#: objdump -t: "0000000000010116 g     F .text  000000000000002a name"
+SYMBOL_RE = re.compile(
+    r"^([0-9a-fA-F]+)\s+.*\s(\.text\S*)\s+([0-9a-fA-F]+)\s+(\S+)$")
+
+#: Vector crypto mnemonics, for those not (yet) in opcodes-crypto-vector.
+VECTOR_CRYPTO_PREFIXES = ("vaes", "vsha2", "vsm4", "vsm3", "vghsh", "vgmul",
+                          "vclmul", "vbrev8", "vrev8", "vandn", "vrol",
+                          "vror", "vwsll")
+
+BITMANIP_MNEMONICS = set("""
+    andn orn xnor rol rolw ror rori rorw roriw rev8 brev8 rev.b rev8.w
+    grev grevi grevw greviw gorc gorci gorcw gorciw shfl shfli unshfl
+    unshfli shflw unshflw zip unzip pack packh packu packw packuw
+    clmul clmulh clmulr clmulw clmulhw clmulrw xperm4 xperm8 xperm.n
+    xperm.b xperm.h xperm.w clz ctz cpop pcnt clzw ctzw cpopw pcntw
+    sext.b sext.h zext.h zext.w min minu max maxu bset bclr binv bext
+    bseti bclri binvi bexti sbset sbclr sbinv sbext sbseti sbclri sbinvi
+    sbexti sh1add sh2add sh3add sh1add.uw sh2add.uw sh3add.uw add.uw
+    slli.uw slo sro sloi sroi bfp bfpw cmix cmov fsl fsr fsri fslw fsrw
+    fsriw bmatflip bmator bmatxor bdep bext bdepw bextw
+""".split())
+
+
+def parse_opcode_file(path):
+    """
+    Parse one of the tools/opcodes-crypto-* tables into a list of
+    (name, mask, match, operands) tuples. The mask and match come from the
+    "hi..lo=value" and "bit=value" fields of each line, and operands lists
+    the operand fields (rd, rs1, ...). Constraints are ignored.
+    """
+    insns = []
+    with open(path, "r") as fh:
+        for line in fh:
+            line = line.split("#")[0].strip()
+            if(not line):
+                continue
+            fields  = line.split()
+            name    = fields[0].lstrip("@$")
+            mask    = 0
+            match   = 0
+            operands= []
+            for field in fields[1:]:
+                if(":" in field):
+                    continue
+                if("=" not in field):
+                    operands.append(field)
+                    continue
+                bits, value = field.split("=")
+                if(".." in bits):
+                    hi, lo  = [int(b) for b in bits.split("..")]
+                else:
+                    hi = lo = int(bits)
+                width   = hi - lo + 1
+                fmask   = ((1 << width) - 1) << lo
+                mask   |= fmask
+                match  |= (int(value, 0) << lo) & fmask
+            insns.append((name, mask, match, operands))
+    return insns
+
+
+def load_crypto_opcodes(tools_dir):
+    insns = []
+    for path in sorted(glob.glob(os.path.join(tools_dir, "opcodes-crypto-*"))):
+        insns += parse_opcode_file(path)
+    return insns
+
+
+def classify_base32(insn):
+    """
+    Classify a non-crypto 32-bit instruction by its major opcode.
+    """
+    op = insn & 0x7F
+    if(op in (0x03, 0x07)):
+        # LOAD, LOAD-FP. Vector loads share LOAD-FP.
+        return "load"
+    if(op in (0x23, 0x27, 0x2F)):
+        return "store"
+    if(op in (0x63, 0x67, 0x6F)):
+        return "branch"
+    if(op in (0x33, 0x3B) and (insn >> 25) == 0x01):
+        return "muldiv"
+    if(op in (0x13, 0x1B, 0x33, 0x3B, 0x37, 0x17)):
+        return "alu"
+    if(op == 0x57):
+        return "vector"
+    return "system"
+
+
+def classify_base16(insn, xlen):
+    """
+    Classify a compressed instruction by its quadrant and funct3.
+    """
+    quadrant = insn & 0x3
+    funct3   = (insn >> 13) & 0x7
+    if(quadrant == 0):
+        if(funct3 == 0):
+            return "alu"                            # c.addi4spn
+        return "load" if funct3 < 4 else "store"
+    if(quadrant == 1):
+        if(funct3 == 1 and xlen == 32):
+            return "branch"                         # c.jal
+        if(funct3 >= 5):
+            return "branch"                         # c.j, c.beqz, c.bnez
+        return "alu"
+    # quadrant 2
+    if(funct3 == 4):
+        # c.jr, c.jalr, c.mv, c.add, c.ebreak
+        rs2 = (insn >> 2) & 0x1F
+        rs1 = (insn >> 7) & 0x1F
+        if(rs2 == 0):
+            return "branch" if rs1 != 0 else "system"
+        return "alu"
+    if(funct3 == 0):
+        return "alu"                                # c.slli
+    return "load" if funct3 < 4 else "store"
+
+
+class Classifier(object):
+
+    def __init__(self, crypto_opcodes, xlen):
+        self.crypto = crypto_opcodes
+        self.xlen   = xlen
+        self.cache  = {}
+
+    def __call__(self, insn, mnemonic):
+        key = (insn, mnemonic)
+        if(key not in self.cache):
+            self.cache[key] = self.classify(insn, mnemonic)
+        return self.cache[key]
+
+    def classify(self, insn, mnemonic):
+        if(insn & 0x3 == 0x3):
+            for name, mask, match, operands in self.crypto:
+                if(insn & mask == match):
+                    return "crypto"
+        mnemonic = mnemonic.lower()
+        if(mnemonic.startswith(VECTOR_CRYPTO_PREFIXES)):
+            return "crypto"
+        if(mnemonic in BITMANIP_MNEMONICS):
+            return "bitmanip"
+        if(insn & 0x3 != 0x3):
+            return classify_base16(insn, self.xlen)
+        return classify_base32(insn)
+
+
+class Symbols(object):
+    """
+    Function address ranges from an objdump -t symbol table.
+    """
+
+    def __init__(self, path=None):
+        self.starts = []
+        self.ranges = []
+        if(path is None):
+            return
+        funcs = []
+        with open(path, "r") as fh:
+            for line in fh:
+                m = SYMBOL_RE.match(line.strip())
+                if(m and " F " in line):
+                    start = int(m.group(1), 16)
+                    size  = int(m.group(3), 16)
+                    funcs.append((start, start + max(size, 1), m.group(4)))
+        funcs.sort()
+        self.starts = [f[0] for f in funcs]
+        self.ranges = funcs
+
+    def __bool__(self):
+        return len(self.ranges) > 0
+
+    def lookup(self, pc):
+        i = bisect.bisect_right(self.starts, pc) - 1
+        if(i >= 0 and pc < self.ranges[i][1]):
+            return self.ranges[i][2]
+        return None
+
+
+class Profile(object):
+
+    def __init__(self):
+        self.pc_count   = {}            # pc -> executions
+        self.pc_info    = {}            # pc -> (class, mnemonic, function)
+        self.back_edges = {}            # (target, source) -> taken count
+        self.total      = 0
+
+    def add(self, pc, cls, mnemonic, func):
+        self.pc_count[pc] = self.pc_count.get(pc, 0) + 1
+        if(pc not in self.pc_info):
+            self.pc_info[pc] = (cls, mnemonic, func)
+        self.total += 1
+
+    def add_back_edge(self, target, source):
+        key = (target, source)
+        self.back_edges[key] = self.back_edges.get(key, 0) + 1
+
+    def histogram(self, pcs=None):
+        hist = {c: 0 for c in CLASSES}
+        for pc in (self.pc_count if pcs is None else pcs):
+            hist[self.pc_info[pc][0]] += self.pc_count[pc]
+        return hist
+
+
+def read_trace(fh, classify, symbols):
+    """
+    Build a Profile from a Spike trace. Commit log lines following the
+    trace line of the same instruction are skipped, so that "-l" with
+    "--log-commits" counts each instruction once.
+    """
+    profile     = Profile()
+    last_pc     = None
+    last_cls    = None
+    last_trace  = None
+
+    for line in fh:
+        m = TRACE_RE.match(line)
+        if(not m):
+            continue
+        priv, pc, insn, rest = m.groups()
+        pc      = int(pc, 16)
+        insn    = int(insn, 16)
+
+        if(priv is not None and last_trace == pc):
+            last_trace = None
+            continue
+        last_trace = pc if priv is None else None
+
+        mnemonic = rest.split()[0] if (priv is None and rest) else ""
+
+        func = symbols.lookup(pc) if symbols else "-"
+        if(func is None):
+            last_pc = None
+            continue
+
+        cls = classify(insn, mnemonic)
+
+        if(last_pc is not None and last_cls == "branch" and pc <= last_pc):
+            profile.add_back_edge(pc, last_pc)
+
+        profile.add(pc, cls, mnemonic, func)
+        last_pc  = pc
+        last_cls = cls
+
+    return profile
+
+
+def format_hist(hist, total):
+    return "  ".join("%s %5.1f%%" % (c, 100.0 * hist[c] / total if total else 0)
+                     for c in CLASSES if hist[c])
+
+
+def report(profile, name, top_funcs, top_loops, fh):
+    total = profile.total
+    fh.write("# Instruction mix: %s\n" % name)
+    fh.write("# %d instructions retired\n\n" % total)
+
+    hist = profile.histogram()
+    fh.write("%-10s %12s %7s\n" % ("class", "count", "share"))
+    for c in CLASSES:
+        fh.write("%-10s %12d %6.1f%%\n" % (c, hist[c],
+            100.0 * hist[c] / total if total else 0))
+
+    funcs = {}
+    for pc, (cls, mnemonic, func) in profile.pc_info.items():
+        funcs.setdefault(func, []).append(pc)
+    ranked = sorted(funcs.items(), key=lambda f: -sum(
+        profile.pc_count[pc] for pc in f[1]))
+
+    fh.write("\n# Hottest functions\n")
+    for func, pcs in ranked[:top_funcs]:
+        fhist = profile.histogram(pcs)
+        count = sum(fhist.values())
+        fh.write("%-32s %12d %6.1f%%  %s\n" % (func, count,
+            100.0 * count / total, format_hist(fhist, count)))
+
+    loops = []
+    for (target, source), taken in profile.back_edges.items():
+        pcs     = [pc for pc in profile.pc_count if target <= pc <= source]
+        count   = sum(profile.pc_count[pc] for pc in pcs)
+        loops.append((count, target, source, taken, pcs))
+    loops.sort(reverse=True)
+
+    fh.write("\n# Hottest loops (taken backward branches)\n")
+    fh.write("%-18s %-18s %-24s %10s %12s %7s %8s\n" % (
+        "start", "end", "function", "trips", "insns", "share", "body"))
+    for count, target, source, taken, pcs in loops[:top_loops]:
+        lhist = profile.histogram(pcs)
+        fh.write("0x%016x 0x%016x %-24s %10d %12d %6.1f%% %8d\n" % (
+            target, source, profile.pc_info[source][2], taken, count,
+            100.0 * count / total, len(pcs)))
+        fh.write("    %s\n" % format_hist(lhist, count))
+
+
+def build_arg_parser():
+    parser  = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("trace", nargs="?", default="-",
+        help="Spike trace file, or - for stdin (default).")
+    parser.add_argument("--symbols", default=None,
+        help="objdump -t output for the traced program. Only instructions inside its functions are counted.")
+    parser.add_argument("--opcodes", default=None,
+        help="Directory holding the opcodes-crypto-* tables. Default: $REPO_HOME/tools")
+    parser.add_argument("--xlen", type=int, choices=[32, 64], default=64)
+    parser.add_argument("--name", default="-", help="Benchmark name for the report header.")
+    parser.add_argument("--top-functions", type=int, default=10)
+    parser.add_argument("--top-loops", type=int, default=10)
+    parser.add_argument("--output", "-o", default=None)
+    return parser
+
+
+def main():
+    parser  = build_arg_parser()
+    args    = parser.parse_args()
+
+    opcodes = args.opcodes
+    if(opcodes is None):
+        opcodes = os.path.join(os.environ.get("REPO_HOME",
+            os.path.join(os.path.dirname(__file__), "..", "..")), "tools")
+
+    crypto  = load_crypto_opcodes(opcodes)
+    if(not crypto):
+        sys.stderr.write("insnmix.py: no opcodes-crypto-* tables in %s\n" %
+            opcodes)
+        sys.exit(1)
+
+    classify= Classifier(crypto, args.xlen)
+    symbols = Symbols(args.symbols)
+
+    if(args.trace == "-"):
+        profile = read_trace(sys.stdin, classify, symbols)
+    else:
+        with open(args.trace, "r") as fh:
+            profile = read_trace(fh, classify, symbols)
+
+    if(args.output):
+        with open(args.output, "w") as fh:
+            report(profile, args.name, args.top_functions, args.top_loops, fh)
+    else:
+        report(profile, args.name, args.top_functions, args.top_loops,
+            sys.stdout)
+
+    sys.exit(0 if profile.total else 1)
+
+if(__name__ == "__main__"):
+    main()
@@ -0,0 +1,269 @@
+#!/usr/bin/env python3
+
+"""
+Builds and runs every test of several configs at once, and merges their
+results into one report.
+
+1. Each config is built with "make all", the configs in parallel.
+2. Every <config> x <run target> pair is run in a pool of --jobs workers,
+   each one a "make CONFIG=<config> run-test-<name>".
+3. The test_result() rows of all the configs are merged into one CSV
+   file, and the report of "results.py report" is printed.
+
+A run is skipped when its ELF and config file hash to the same value as
+they did for its last passing run, and its log is still there. So a
+rebuild which does not change an ELF does not re-run it. Hashes are kept
+in $REPO_BUILD/benchmarks/<config>/matrix-cache.json, with the duration of
+each run. Runs are started longest first.
+
+--shard i/n runs only the i'th of n slices of the matrix, so that it can
+be spread over several machines.
+"""
+
+import os
+import sys
+import json
+import time
+import hashlib
+import argparse
+import subprocess
+import concurrent.futures
+
+import results
+
+CACHE_FILE  = "matrix-cache.json"
+
+
+class Run(object):
+    """
+    One <config> x <run target> pair.
+    """
+
+    def __init__(self, config, target, elf, log):
+        self.config = config
+        self.target = target
+        self.elf    = elf
+        self.log    = log
+        self.key    = None
+        self.status = None
+        self.seconds= 0.0
+        self.output = ""
+
+    @property
+    def name(self):
+        return "%s:%s" % (self.config, self.target)
+
+
+def make_command(args, config, targets, jobs=None):
+    cmd = ["make", "--no-print-directory",
+           "-C", os.path.join(args.repo_home, "benchmarks"),
+           "CONFIG=%s" % config,
+           "REPO_HOME=%s" % args.repo_home,
+           "REPO_BUILD=%s" % args.repo_build]
+    if(jobs):
+        cmd += ["-k", "-j%d" % jobs]
+    return cmd + targets
+
+
+def build_dir(args, config):
+    return os.path.join(args.repo_build, "benchmarks", config)
+
+
+def build_config(args, config, jobs):
+    """
+    Build everything for one config, logging make's output to
+    $REPO_BUILD/benchmarks/<config>/matrix-build.log.
+    """
+    os.makedirs(build_dir(args, config), exist_ok=True)
+    logpath = os.path.join(build_dir(args, config), "matrix-build.log")
+    with open(logpath, "w") as fh:
+        rc = subprocess.call(make_command(args, config, ["all"], jobs),
+                             stdout=fh, stderr=subprocess.STDOUT)
+    return config, rc, logpath
+
+
+def list_runs(args, config):
+    out = subprocess.run(make_command(args, config, ["print-run-matrix"]),
+                         stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                         universal_newlines=True)
+    runs = []
+    for line in out.stdout.split():
+        target, elf, log = line.split(",")
+        runs.append(Run(config, target, elf, log))
+    return runs
+
+
+def in_shard(run, shard):
+    index, count = shard
+    digest = hashlib.sha256(run.name.encode()).digest()
+    return int.from_bytes(digest[:4], "little") % count == index
+
+
+def file_hash(paths):
+    h = hashlib.sha256()
+    for path in paths:
+        with open(path, "rb") as fh:
+            for chunk in iter(lambda: fh.read(1 << 20), b""):
+                h.update(chunk)
+    return h.hexdigest()
+
+
+def read_cache(args, config):
+    path = os.path.join(build_dir(args, config), CACHE_FILE)
+    if(os.path.exists(path)):
+        with open(path, "r") as fh:
+            return json.load(fh)
+    return {}
+
+
+def write_cache(args, config, cache):
+    path = os.path.join(build_dir(args, config), CACHE_FILE)
+    with open(path, "w") as fh:
+        json.dump(cache, fh, indent=1, sort_keys=True)
+
+
+def prepare(run, conf, cache):
+    """
+    Decide whether a run can be skipped. If so, the log is made newer than
+    the ELF, so that make does not run it again. If not, any old log is
+    removed, so that make does.
+    """
+    if(not os.path.exists(run.elf)):
+        run.status = "NO-ELF"
+        return
+    run.key = file_hash([run.elf, conf])
+    entry   = cache.get(run.log)
+    if(entry and entry["key"] == run.key and os.path.exists(run.log)):
+        os.utime(run.log)
+        run.seconds = entry["seconds"]
+        run.status  = "cached"
+    elif(os.path.exists(run.log)):
+        os.remove(run.log)
+
+
+def execute(args, run):
+    start   = time.time()
+    proc    = subprocess.run(make_command(args, run.config, [run.target]),
+                             stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                             universal_newlines=True)
+    run.seconds = time.time() - start
+    run.output  = proc.stdout
+    run.status  = "PASS" if proc.returncode == 0 else "FAIL"
+    return run
+
+
+def parse_shard(text):
+    try:
+        index, count = [int(x) for x in text.split("/")]
+    except ValueError:
+        raise argparse.ArgumentTypeError("expected i/n, got %s" % text)
+    if(count < 1 or not 0 <= index < count):
+        raise argparse.ArgumentTypeError("expected 0 <= i < n, got %s" % text)
+    return index, count
+
+
+def build_arg_parser():
+    parser  = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--configs", nargs="+", default=None,
+        help="Configs to run. Default: all of benchmarks/config/*.conf")
+    parser.add_argument("--jobs", "-j", type=int, default=os.cpu_count(),
+        help="Number of runs at once. Default: one per host core.")
+    parser.add_argument("--shard", type=parse_shard, default=(0, 1),
+        help="Only run slice i of n (0 <= i < n) of the matrix.")
+    parser.add_argument("--no-build", action="store_true",
+        help="Skip the build step.")
+    parser.add_argument("--metric", choices=["instret", "cycles"],
+        default="instret")
+    parser.add_argument("--repo-home", default=os.environ.get("REPO_HOME"))
+    parser.add_argument("--repo-build", default=os.environ.get("REPO_BUILD"))
+    parser.add_argument("--output", "-o", default=None,
+        help="Merged CSV. Default: $REPO_BUILD/benchmarks/matrix-results.csv")
+    return parser
+
+
+def main():
+    parser  = build_arg_parser()
+    args    = parser.parse_args()
+
+    if(not args.repo_home or not args.repo_build):
+        sys.stderr.write("matrix.py: REPO_HOME and REPO_BUILD must be set, "
+            "or given with --repo-home/--repo-build\n")
+        sys.exit(1)
+
+    confdir = os.path.join(args.repo_home, "benchmarks", "config")
+    configs = args.configs or sorted(
+        f[:-len(".conf")] for f in os.listdir(confdir) if f.endswith(".conf"))
+
+    for config in configs:
+        if(not os.path.exists(os.path.join(confdir, config + ".conf"))):
+            sys.stderr.write("matrix.py: no config %s\n" % config)
+            sys.exit(1)
+
+    start = time.time()
+
+    if(not args.no_build):
+        jobs = max(1, args.jobs // len(configs))
+        with concurrent.futures.ThreadPoolExecutor(len(configs)) as pool:
+            for config, rc, logpath in pool.map(
+                    lambda c: build_config(args, c, jobs), configs):
+                if(rc != 0):
+                    print("%s: build failed, see %s" % (config, logpath))
+
+    runs    = []
+    caches  = {}
+    for config in configs:
+        caches[config] = read_cache(args, config)
+        conf = os.path.join(confdir, config + ".conf")
+        for run in list_runs(args, config):
+            if(in_shard(run, args.shard)):
+                prepare(run, conf, caches[config])
+                runs.append(run)
+
+    todo = [r for r in runs if r.status is None]
+    todo.sort(key=lambda r: -caches[r.config].get(r.log, {}).get("seconds", 0))
+
+    print("%d runs: %d cached, %d to run on %d workers" % (len(runs),
+        len([r for r in runs if r.status == "cached"]), len(todo), args.jobs))
+
+    with concurrent.futures.ThreadPoolExecutor(args.jobs) as pool:
+        futures = [pool.submit(execute, args, r) for r in todo]
+        for future in concurrent.futures.as_completed(futures):
+            run = future.result()
+            print("%-6s %-40s %7.1fs" % (run.status, run.name, run.seconds))
+            if(run.status == "PASS"):
+                caches[run.config][run.log] = {"key": run.key,
+                                               "seconds": run.seconds}
+            else:
+                caches[run.config].pop(run.log, None)
+                sys.stdout.write(run.output)
+
+    for config in configs:
+        write_cache(args, config, caches[config])
+
+    rows = []
+    for config in configs:
+        logs = [r.log for r in runs if r.config == config and
+                r.status in ("PASS", "cached")]
+        rows += results.parse_logs(logs, config)
+
+    output = args.output or os.path.join(args.repo_build, "benchmarks",
+                                         "matrix-results.csv")
+    with open(output, "w") as fh:
+        results.write_rows(rows, fh, "csv")
+
+    failed = [r for r in runs if r.status not in ("PASS", "cached")]
+
+    print()
+    results.cmd_report(argparse.Namespace(results=[output],
+        metric=args.metric, zscrypto_only=False))
+    print()
+    print("%d results from %d runs in %.1fs, written to %s" % (len(rows),
+        len(runs), time.time() - start, output))
+    for run in failed:
+        print("%-6s %s" % (run.status, run.name))
+
+    sys.exit(1 if failed else 0)
+
+if(__name__ == "__main__"):
+    main()
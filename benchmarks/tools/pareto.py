@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+
+"""
+Code size against speed, for every implementation and build variant of a
+config.
+
+For each test, the size of the libraries it links is summed by section
+group with "size -A". The groups are .text, .rodata and .data; the T-tables
+of aes/ttable live in .data. The total of all three is what the code needs
+in flash. Whole libraries are counted, including functions a test does
+not call.
+
+Speed is instructions retired per byte. It is taken from the test's
+largest input length, as the median over repeats of its test_result rows.
+For block ciphers that length is one block.
+
+Within each algorithm, the implementation and variant pairs that no other
+pair beats on both size and speed are marked as Pareto optimal.
+
+Variants are the VARIANT builds of common.mk (default, os, unroll). Each
+is read from $REPO_BUILD/benchmarks/<config>[-<variant>]. "make pareto"
+builds and runs them first.
+"""
+
+import os
+import sys
+import csv
+import argparse
+import subprocess
+
+import results
+
+SECTION_GROUPS  = [
+    ("text"  , (".text",)),
+    ("rodata", (".rodata", ".srodata")),
+    ("data"  , (".data", ".sdata")),
+]
+
+FIELDS          = ["algorithm", "config", "variant", "test", "implementation",
+                   "text", "rodata", "data", "total", "bytes", "instret",
+                   "ipb", "pareto"]
+
+
+def section_group(section):
+    for group, prefixes in SECTION_GROUPS:
+        for prefix in prefixes:
+            if(section == prefix or section.startswith(prefix + ".")):
+                return group
+    return None
+
+
+def library_sizes(size_cmd, libs, cache):
+    """
+    Return {group: bytes} summed over the given libraries.
+    """
+    total = {g: 0 for g, _ in SECTION_GROUPS}
+    for lib in libs:
+        if(lib not in cache):
+            sizes = {g: 0 for g, _ in SECTION_GROUPS}
+            out = subprocess.run(size_cmd + ["-A", "-d", lib],
+                stdout=subprocess.PIPE, universal_newlines=True, check=True)
+            for line in out.stdout.splitlines():
+                fields = line.split()
+                if(len(fields) == 3 and fields[1].isdigit()):
+                    group = section_group(fields[0])
+                    if(group):
+                        sizes[group] += int(fields[1])
+            cache[lib] = sizes
+        for g in total:
+            total[g] += cache[lib][g]
+    return total
+
+
+def test_libraries(args, variant):
+    cmd = ["make", "--no-print-directory",
+           "-C", os.path.join(args.repo_home, "benchmarks"),
+           "CONFIG=%s" % args.config, "VARIANT=%s" % variant,
+           "REPO_HOME=%s" % args.repo_home,
+           "REPO_BUILD=%s" % args.repo_build, "print-test-libs"]
+    out = subprocess.run(cmd, stdout=subprocess.PIPE,
+        stderr=subprocess.DEVNULL, universal_newlines=True)
+    libs = {}
+    for line in out.stdout.split():
+        test, paths = line.split(",")
+        libs[test] = [p for p in paths.split(":") if p]
+    return libs
+
+
+def variant_build_dir(args, variant):
+    name = args.config if variant == "default" else \
+           "%s-%s" % (args.config, variant)
+    return name, os.path.join(args.repo_build, "benchmarks", name)
+
+
+def collect(args):
+    points      = []
+    size_cache  = {}
+
+    for variant in args.variants:
+        name, bdir  = variant_build_dir(args, variant)
+        logdir      = os.path.join(bdir, "log")
+        if(not os.path.isdir(logdir)):
+            sys.stderr.write("pareto.py: no run logs for %s in %s\n" %
+                (name, logdir))
+            continue
+
+        libs    = test_libraries(args, variant)
+        rows    = results.parse_logs([logdir], name)
+        medians = results.median_by(rows, lambda r: (
+            r["test"], r["algorithm"], r["bytes"]), "instret")
+
+        longest = {}
+        for test, algorithm, nbytes in medians:
+            if(nbytes > longest.get((test, algorithm), 0)):
+                longest[(test, algorithm)] = nbytes
+
+        for (test, algorithm), nbytes in sorted(longest.items()):
+            if(test not in libs):
+                continue
+            missing = [l for l in libs[test] if not os.path.exists(l)]
+            if(missing):
+                sys.stderr.write("pareto.py: %s: missing %s\n" % (
+                    test, " ".join(missing)))
+                continue
+            sizes   = library_sizes(args.size, libs[test], size_cache)
+            instret = medians[(test, algorithm, nbytes)]
+            point   = {
+                "algorithm"     : algorithm,
+                "config"        : args.config,
+                "variant"       : variant,
+                "test"          : test,
+                "implementation": results.test_implementation(test),
+                "total"         : sum(sizes.values()),
+                "bytes"         : nbytes,
+                "instret"       : instret,
+                "ipb"           : instret / nbytes,
+                "pareto"        : False,
+            }
+            point.update(sizes)
+            points.append(point)
+
+    return points
+
+
+def mark_pareto(points):
+    """
+    Mark the points of each algorithm which no other point of the same
+    algorithm is at least as good as on both size and speed, and better on
+    one.
+    """
+    for p in points:
+        p["pareto"] = not any(
+            q["algorithm"] == p["algorithm"] and
+            q["total"] <= p["total"] and q["ipb"] <= p["ipb"] and
+            (q["total"] < p["total"] or q["ipb"] < p["ipb"])
+            for q in points)
+
+
+def build_arg_parser():
+    parser  = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--config", required=True)
+    parser.add_argument("--variants", nargs="+",
+        default=["default", "os", "unroll"])
+    parser.add_argument("--size", default="size",
+        help="The size command of the config's toolchain.")
+    parser.add_argument("--repo-home", default=os.environ.get("REPO_HOME"))
+    parser.add_argument("--repo-build", default=os.environ.get("REPO_BUILD"))
+    parser.add_argument("--pareto-only", action="store_true",
+        help="Only list the Pareto optimal points.")
+    parser.add_argument("--output", "-o", default=None,
+        help="Also write every point to this CSV file.")
+    return parser
+
+
+def main():
+    parser  = build_arg_parser()
+    args    = parser.parse_args()
+    args.size = args.size.split()
+
+    if(not args.repo_home or not args.repo_build):
+        sys.stderr.write("pareto.py: REPO_HOME and REPO_BUILD must be set, "
+            "or given with --repo-home/--repo-build\n")
+        sys.exit(1)
+
+    points  = collect(args)
+    if(not points):
+        sys.stderr.write("pareto.py: no results found\n")
+        sys.exit(1)
+
+    mark_pareto(points)
+    points.sort(key=lambda p: (p["algorithm"], p["total"], p["ipb"]))
+
+    header  = "%-16s %-8s %-24s %8s %8s %8s %8s %8s %10s  %s" % (
+        "algorithm", "variant", "test", "text", "rodata", "data", "total",
+        "bytes", "instr/B", "pareto")
+    print("Code size (bytes) and instructions per byte for %s" % args.config)
+    print(header)
+    print("-" * len(header))
+
+    last = None
+    for p in points:
+        if(args.pareto_only and not p["pareto"]):
+            continue
+        if(last is not None and p["algorithm"] != last):
+            print()
+        last = p["algorithm"]
+        print("%-16s %-8s %-24s %8d %8d %8d %8d %8d %10.2f  %s" % (
+            p["algorithm"], p["variant"], p["test"], p["text"], p["rodata"],
+            p["data"], p["total"], p["bytes"], p["ipb"],
+            "*" if p["pareto"] else ""))
+
+    if(args.output):
+        with open(args.output, "w") as fh:
+            writer = csv.DictWriter(fh, fieldnames=FIELDS)
+            writer.writeheader()
+            writer.writerows(points)
+
+    sys.exit(0)
+
+if(__name__ == "__main__"):
+    main()
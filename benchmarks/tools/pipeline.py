@@ -0,0 +1,507 @@
+#!/usr/bin/env python3
+
+"""
+Trace driven in-order pipeline model for benchmark runs under Spike.
+
+Replays a Spike instruction trace ("spike -l", optionally with
+--log-commits) through a simple in-order core. The core issues up to
+issue_width instructions per cycle, in program order. An instruction
+waits until all of its source registers have been written. Each
+instruction has a latency, taken from a config file
+(benchmarks/pipeline/*.cfg). There, crypto instructions are given the
+logic depths of their functional units in rtl/README.md. Taken branches
+and jumps add a fixed bubble.
+
+This gives an estimated cycle count, which shows how multi-cycle crypto
+instructions stall the code that depends on them. Use it to compare
+scheduling choices, e.g. interleaved or serial AES rounds, before there
+is hardware to measure them on. It is a model, not a cycle accurate
+simulation: there are no caches, structural hazards or branch
+prediction.
+
+The estimate command models one trace. The summary command tabulates
+the reports of several.
+"""
+
+import os
+import re
+import sys
+import math
+import argparse
+
+import insnmix
+
+#: Register numbering used by the scoreboard.
+XREG, FREG, VREG = 0, 32, 64
+
+
+class PipelineConfig(object):
+    """
+    Issue width, branch penalty and latencies read from a .cfg file.
+    """
+
+    def __init__(self, path):
+        self.path                   = path
+        self.issue_width            = 1
+        self.taken_branch_penalty   = 0
+        self.depth_per_cycle        = None
+        self.class_latency          = {c: 1 for c in insnmix.CLASSES}
+        self.insn_latency           = {}
+
+        with open(path, "r") as fh:
+            for lineno, line in enumerate(fh, 1):
+                fields = line.split("#")[0].split()
+                if(not fields):
+                    continue
+                try:
+                    self.parse_line(fields)
+                except (ValueError, IndexError) as e:
+                    raise ValueError("%s:%d: bad line '%s'" % (
+                        path, lineno, line.strip()))
+
+    def parse_line(self, fields):
+        key = fields[0]
+        if(key == "issue_width"):
+            self.issue_width = int(fields[1])
+        elif(key == "taken_branch_penalty"):
+            self.taken_branch_penalty = int(fields[1])
+        elif(key == "depth_per_cycle"):
+            self.depth_per_cycle = int(fields[1])
+        elif(key == "latency"):
+            self.set_latency(int(fields[1]), fields[2:])
+        elif(key == "depth"):
+            if(self.depth_per_cycle is None):
+                raise ValueError("depth before depth_per_cycle")
+            self.set_latency(
+                max(1, math.ceil(int(fields[1]) / self.depth_per_cycle)),
+                fields[2:])
+        else:
+            raise ValueError("unknown key %s" % key)
+
+    def set_latency(self, cycles, names):
+        if(not names):
+            raise ValueError("no classes or mnemonics")
+        for name in names:
+            if(name in self.class_latency):
+                self.class_latency[name] = cycles
+            else:
+                self.insn_latency[name] = cycles
+
+    def latency(self, mnemonic, cls):
+        if(mnemonic in self.insn_latency):
+            return self.insn_latency[mnemonic]
+        return self.class_latency[cls]
+
+
+def crypto_entry(crypto, insn):
+    for entry in crypto:
+        if(insn & entry[1] == entry[2]):
+            return entry
+    return None
+
+
+def crypto_registers(insn, operands):
+    """
+    Destination and source registers of a crypto instruction, from the
+    operand fields of its opcode table entry.
+    """
+    rd  = (insn >>  7) & 0x1F
+    rs1 = (insn >> 15) & 0x1F
+    rs2 = (insn >> 20) & 0x1F
+    dst = []
+    src = []
+    for op in operands:
+        if(op == "rd"):
+            dst.append(XREG + rd)
+        elif(op == "rs1"):
+            src.append(XREG + rs1)
+        elif(op == "rs2"):
+            src.append(XREG + rs2)
+        elif(op == "rt"):
+            # Old style aes32*/sm4* encodings: rs1 is also the destination.
+            dst.append(XREG + rs1)
+            src.append(XREG + rs1)
+        elif(op == "vd"):
+            dst.append(VREG + rd)
+        elif(op == "vt"):
+            dst.append(VREG + rd)
+            src.append(VREG + rd)
+        elif(op == "vs1"):
+            src.append(VREG + rs1)
+        elif(op == "vs2"):
+            src.append(VREG + rs2)
+    return dst, src
+
+
+def base32_registers(insn):
+    """
+    Destination and source registers of a 32-bit base ISA instruction,
+    decoded from its major opcode.
+    """
+    op  = insn & 0x7F
+    rd  = (insn >>  7) & 0x1F
+    rs1 = (insn >> 15) & 0x1F
+    rs2 = (insn >> 20) & 0x1F
+    if(op in (0x37, 0x17, 0x6F)):                   # lui, auipc, jal
+        return [rd], []
+    if(op in (0x03, 0x13, 0x1B, 0x67)):             # load, op-imm, jalr
+        return [rd], [rs1]
+    if(op in (0x33, 0x3B, 0x2F)):                   # op, op-32, amo
+        return [rd], [rs1, rs2]
+    if(op in (0x23, 0x63)):                         # store, branch
+        return [], [rs1, rs2]
+    if(op == 0x07):                                 # load-fp
+        return [FREG + rd], [rs1]
+    if(op == 0x27):                                 # store-fp
+        return [], [rs1, FREG + rs2]
+    if(op == 0x53):                                 # op-fp
+        return [FREG + rd], [FREG + rs1, FREG + rs2]
+    if(op == 0x57):                                 # op-v
+        return [VREG + rd], [VREG + rs1, VREG + rs2]
+    if(op == 0x73):                                 # system, csr*
+        return [rd], [rs1]
+    return [], []
+
+
+def base16_registers(insn, xlen):
+    """
+    Destination and source registers of a compressed instruction.
+    """
+    quadrant = insn & 0x3
+    funct3   = (insn >> 13) & 0x7
+    r_hi     = (insn >>  7) & 0x1F              # rd / rs1
+    r_lo     = (insn >>  2) & 0x1F              # rs2
+    rp_hi    = ((insn >> 7) & 0x7) + 8          # rd' / rs1'
+    rp_lo    = ((insn >> 2) & 0x7) + 8          # rd' / rs2'
+    sp       = 2
+
+    if(quadrant == 0):
+        if(funct3 == 0):                            # c.addi4spn
+            return [rp_lo], [sp]
+        if(funct3 == 1):                            # c.fld
+            return [FREG + rp_lo], [rp_hi]
+        if(funct3 == 2 or (funct3 == 3 and xlen == 64)):
+            return [rp_lo], [rp_hi]                 # c.lw, c.ld
+        if(funct3 == 3):                            # c.flw
+            return [FREG + rp_lo], [rp_hi]
+        if(funct3 == 5 or (funct3 == 7 and xlen == 32)):
+            return [], [rp_hi, FREG + rp_lo]        # c.fsd, c.fsw
+        return [], [rp_hi, rp_lo]                   # c.sw, c.sd
+
+    if(quadrant == 1):
+        if(funct3 == 0 or (funct3 == 1 and xlen == 64)):
+            return [r_hi], [r_hi]                   # c.addi, c.addiw
+        if(funct3 == 1):                            # c.jal
+            return [1], []
+        if(funct3 == 2):                            # c.li
+            return [r_hi], []
+        if(funct3 == 3):                            # c.addi16sp, c.lui
+            return [r_hi], ([sp] if r_hi == sp else [])
+        if(funct3 == 4):
+            if((insn >> 10) & 0x3 == 0x3):          # c.sub, c.xor, ...
+                return [rp_hi], [rp_hi, rp_lo]
+            return [rp_hi], [rp_hi]                 # c.srli, c.srai, c.andi
+        if(funct3 == 5):                            # c.j
+            return [], []
+        return [], [rp_hi]                          # c.beqz, c.bnez
+
+    if(funct3 == 0):                                # c.slli
+        return [r_hi], [r_hi]
+    if(funct3 == 1):                                # c.fldsp
+        return [FREG + r_hi], [sp]
+    if(funct3 == 2 or (funct3 == 3 and xlen == 64)):
+        return [r_hi], [sp]                         # c.lwsp, c.ldsp
+    if(funct3 == 3):                                # c.flwsp
+        return [FREG + r_hi], [sp]
+    if(funct3 == 4):
+        bit12 = (insn >> 12) & 0x1
+        if(r_lo == 0):
+            if(r_hi == 0):                          # c.ebreak
+                return [], []
+            return ([1] if bit12 else []), [r_hi]   # c.jalr, c.jr
+        if(bit12):                                  # c.add
+            return [r_hi], [r_hi, r_lo]
+        return [r_hi], [r_lo]                       # c.mv
+    if(funct3 == 5 or (funct3 == 7 and xlen == 32)):
+        return [], [sp, FREG + r_lo]                # c.fsdsp, c.fswsp
+    return [], [sp, r_lo]                           # c.swsp, c.sdsp
+
+
+class Decoder(object):
+    """
+    Maps an instruction to its class, latency and registers, caching the
+    result per encoding.
+    """
+
+    def __init__(self, crypto, xlen, config):
+        self.crypto   = crypto
+        self.xlen     = xlen
+        self.config   = config
+        self.classify = insnmix.Classifier(crypto, xlen)
+        self.cache    = {}
+
+    def __call__(self, insn, mnemonic):
+        key = (insn, mnemonic)
+        if(key not in self.cache):
+            self.cache[key] = self.decode(insn, mnemonic)
+        return self.cache[key]
+
+    def decode(self, insn, mnemonic):
+        cls     = self.classify(insn, mnemonic)
+        entry   = crypto_entry(self.crypto, insn) if insn & 0x3 == 0x3 \
+                  else None
+        if(entry):
+            mnemonic = mnemonic or entry[0]
+            dst, src = crypto_registers(insn, entry[3])
+        elif(insn & 0x3 == 0x3):
+            dst, src = base32_registers(insn)
+        else:
+            dst, src = base16_registers(insn, self.xlen)
+        # x0 is never written, and never waited on.
+        dst     = tuple(r for r in dst if r != XREG)
+        src     = tuple(r for r in src if r != XREG)
+        length  = 4 if insn & 0x3 == 0x3 else 2
+        return (cls, mnemonic or "?", self.config.latency(mnemonic, cls),
+                dst, src, length)
+
+
+class Pipeline(object):
+    """
+    Scoreboard of an in-order core, advanced one instruction at a time.
+    """
+
+    def __init__(self, config):
+        self.config         = config
+        self.cycle          = 0     # Cycle the next instruction may issue.
+        self.slots          = 0     # Instructions issued in that cycle.
+        self.ready          = {}    # register -> cycle its value is ready
+        self.producer       = {}    # register -> mnemonic which wrote it
+        self.instructions   = 0
+        self.data_stalls    = 0
+        self.branch_stalls  = 0
+        self.stalls_by      = {}    # producer mnemonic -> stall cycles
+        self.last_issue     = 0
+        self.last_ready     = 0
+        self.prev           = None  # (pc, length, cls) of the last insn.
+
+    def issue(self, pc, decoded):
+        cls, mnemonic, latency, dst, src, length = decoded
+        config  = self.config
+
+        if(self.prev is not None):
+            ppc, plen, pcls = self.prev
+            if(pcls == "branch" and pc != ppc + plen):
+                bubble              = 1 + config.taken_branch_penalty
+                self.branch_stalls += config.taken_branch_penalty
+                self.cycle          = self.last_issue + bubble
+                self.slots          = 0
+
+        if(self.slots >= config.issue_width):
+            self.cycle += 1
+            self.slots  = 0
+
+        wait    = self.cycle
+        blocker = None
+        for r in src:
+            if(self.ready.get(r, 0) > wait):
+                wait    = self.ready[r]
+                blocker = self.producer[r]
+
+        if(wait > self.cycle):
+            stall                   = wait - self.cycle
+            self.data_stalls       += stall
+            self.stalls_by[blocker] = self.stalls_by.get(blocker, 0) + stall
+            self.cycle              = wait
+            self.slots              = 0
+
+        issued          = self.cycle
+        self.slots     += 1
+        for r in dst:
+            self.ready[r]    = issued + latency
+            self.producer[r] = mnemonic
+
+        self.last_issue = issued
+        self.last_ready = max(self.last_ready, issued + latency)
+        self.prev       = (pc, length, cls)
+        self.instructions += 1
+        return issued
+
+    @property
+    def cycles(self):
+        if(not self.instructions):
+            return 0
+        return max(self.last_issue + 1, self.last_ready)
+
+
+def run_trace(fh, decode, symbols, config):
+    """
+    Replay a Spike trace through the pipeline. Returns the pipeline and
+    {function: [instructions, cycles]}. Instructions outside the program's
+    functions (i.e. the proxy kernel) are skipped, as in insnmix.py.
+    """
+    pipe        = Pipeline(config)
+    functions   = {}
+    last_trace  = None
+    last_issue  = None
+
+    for line in fh:
+        m = insnmix.TRACE_RE.match(line)
+        if(not m):
+            continue
+        priv, pc, insn, rest = m.groups()
+        pc      = int(pc, 16)
+        insn    = int(insn, 16)
+
+        if(priv is not None and last_trace == pc):
+            last_trace = None
+            continue
+        last_trace = pc if priv is None else None
+
+        func = symbols.lookup(pc) if symbols else "-"
+        if(func is None):
+            continue
+
+        mnemonic = rest.split()[0] if (priv is None and rest) else ""
+        issued   = pipe.issue(pc, decode(insn, mnemonic))
+
+        counts   = functions.setdefault(func, [0, 0])
+        counts[0] += 1
+        counts[1] += issued - last_issue if last_issue is not None else 1
+        last_issue = issued
+
+    return pipe, functions
+
+
+def report(pipe, functions, config, name, top, fh):
+    cycles  = pipe.cycles
+    insns   = pipe.instructions
+    fh.write("# Pipeline estimate: %s\n" % name)
+    fh.write("# %s: issue width %d, taken branch penalty %d\n" % (
+        config.path, config.issue_width, config.taken_branch_penalty))
+    fh.write("#!pipeline %s,%d,%d\n\n" % (name, insns, cycles))
+
+    fh.write("%-16s %12d\n" % ("instructions", insns))
+    fh.write("%-16s %12d\n" % ("cycles", cycles))
+    fh.write("%-16s %12.3f\n" % ("IPC", insns / cycles if cycles else 0))
+    fh.write("%-16s %12d\n" % ("data stalls", pipe.data_stalls))
+    fh.write("%-16s %12d\n" % ("branch stalls", pipe.branch_stalls))
+
+    fh.write("\n# Data stall cycles by producing instruction\n")
+    for mnemonic, stall in sorted(pipe.stalls_by.items(),
+                                  key=lambda s: -s[1])[:top]:
+        fh.write("%-16s %12d %6.1f%%\n" % (mnemonic, stall,
+            100.0 * stall / cycles))
+
+    fh.write("\n# Hottest functions\n")
+    fh.write("%-32s %12s %12s %7s\n" % ("function", "instructions",
+        "cycles", "IPC"))
+    for func, (n, c) in sorted(functions.items(),
+                               key=lambda f: -f[1][1])[:top]:
+        fh.write("%-32s %12d %12d %7.3f\n" % (func, n, c, n / c if c else 0))
+
+
+PIPELINE_PREFIX = "#!pipeline "
+
+
+def cmd_estimate(args):
+    opcodes = args.opcodes
+    if(opcodes is None):
+        opcodes = os.path.join(os.environ.get("REPO_HOME",
+            os.path.join(os.path.dirname(__file__), "..", "..")), "tools")
+
+    crypto  = insnmix.load_crypto_opcodes(opcodes)
+    if(not crypto):
+        sys.stderr.write("pipeline.py: no opcodes-crypto-* tables in %s\n" %
+            opcodes)
+        return False
+
+    try:
+        config  = PipelineConfig(args.config)
+    except (IOError, ValueError) as e:
+        sys.stderr.write("pipeline.py: %s\n" % e)
+        return False
+
+    decode  = Decoder(crypto, args.xlen, config)
+    symbols = insnmix.Symbols(args.symbols)
+
+    if(args.trace == "-"):
+        pipe, functions = run_trace(sys.stdin, decode, symbols, config)
+    else:
+        with open(args.trace, "r") as fh:
+            pipe, functions = run_trace(fh, decode, symbols, config)
+
+    if(args.output):
+        with open(args.output, "w") as fh:
+            report(pipe, functions, config, args.name, args.top, fh)
+    else:
+        report(pipe, functions, config, args.name, args.top, sys.stdout)
+
+    return pipe.instructions > 0
+
+
+def cmd_summary(args):
+    rows = []
+    for path in args.reports:
+        if(not os.path.exists(path)):
+            sys.stderr.write("pipeline.py: skipping missing %s\n" % path)
+            continue
+        with open(path, "r") as fh:
+            for line in fh:
+                if(line.startswith(PIPELINE_PREFIX)):
+                    name, insns, cycles = \
+                        line[len(PIPELINE_PREFIX):].strip().split(",")
+                    rows.append((name, int(insns), int(cycles)))
+
+    header = "%-32s %12s %12s %7s" % ("test", "instructions", "cycles", "IPC")
+    print(header)
+    print("-" * len(header))
+    for name, insns, cycles in sorted(rows):
+        print("%-32s %12d %12d %7.3f" % (name, insns, cycles,
+            insns / cycles if cycles else 0))
+    return len(rows) > 0
+
+
+def build_arg_parser():
+    parser  = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    subs    = parser.add_subparsers()
+
+    sub_est = subs.add_parser("estimate", help="Estimate the cycles of one Spike trace.")
+    sub_est.set_defaults(func=cmd_estimate)
+    sub_est.add_argument("trace", nargs="?", default="-",
+        help="Spike trace file, or - for stdin (default).")
+    sub_est.add_argument("--config", required=True,
+        help="Pipeline model parameters, e.g. benchmarks/pipeline/rtl-inorder.cfg")
+    sub_est.add_argument("--symbols", default=None,
+        help="objdump -t output for the traced program. Only instructions inside its functions are modelled.")
+    sub_est.add_argument("--opcodes", default=None,
+        help="Directory holding the opcodes-crypto-* tables. Default: $REPO_HOME/tools")
+    sub_est.add_argument("--xlen", type=int, choices=[32, 64], default=64)
+    sub_est.add_argument("--name", default="-", help="Benchmark name for the report.")
+    sub_est.add_argument("--top", type=int, default=10)
+    sub_est.add_argument("--output", "-o", default=None)
+
+    sub_sum = subs.add_parser("summary", help="Tabulate the estimates of several reports.")
+    sub_sum.set_defaults(func=cmd_summary)
+    sub_sum.add_argument("reports", nargs="+")
+
+    return parser
+
+
+def main():
+    parser  = build_arg_parser()
+    args    = parser.parse_args()
+
+    if(not hasattr(args, "func")):
+        parser.print_help()
+        sys.exit(1)
+
+    retval  = args.func(args)
+
+    if(retval):
+        sys.exit(0)
+    else:
+        sys.exit(1)
+
+if(__name__ == "__main__"):
+    main()
@@ -0,0 +1,242 @@
+
+/*!
+@brief QEMU TCG plugin which makes rdinstret count guest instructions.
+@details
+    QEMU user mode answers rdinstret/rdinstreth with host timer ticks,
+    so the test_rdinstret measurements in share/test.h mean nothing there.
+    This plugin counts the instructions the guest executes. After every
+    rdinstret or rdinstreth executes, it overwrites the destination
+    register with that count, or its high half. The count is taken
+    before the CSR read, as on Spike.
+
+    That way each region of interest delimited by a pair of
+    test_rdinstret calls measures its instruction count, and the test
+    programs, the sweep harness and test_result work unchanged.
+
+    Counting is done with inline per-TB adds. Callbacks run only on the
+    CSR reads and on the instruction following each one. The first
+    instruction of each TB also gets an inline check. So the cost is close
+    to that of plain TCG.
+
+    Needs a QEMU with the register write plugin API (10.1 or later).
+    Build with "make qemu-plugin" (see common.mk) and run as:
+
+        qemu-riscv64 -cpu max -plugin libroi.so prog.elf
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <glib.h>
+#include <qemu-plugin.h>
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_version = QEMU_PLUGIN_VERSION;
+
+//! csrrs rd, instret, x0 / csrrs rd, instreth, x0 with rd masked out.
+#define ROI_RDINSTRET_MASK  0xFFFFF07F
+#define ROI_RDINSTRET       0xC0202073
+#define ROI_RDINSTRETH      0xC8202073
+
+//! Per vCPU state, in a scoreboard.
+typedef struct {
+    uint64_t insns  ;   //!< Instructions executed, counted per TB.
+    uint64_t pending;   //!< Non-zero while a register write is due.
+    uint64_t value  ;   //!< Value to write.
+    uint64_t rd     ;   //!< Register to write it to.
+    uint64_t markers;   //!< Number of rdinstret(h) executed.
+} roi_vcpu;
+
+static struct qemu_plugin_scoreboard * roi_state;
+static qemu_plugin_u64                 roi_insns;
+static qemu_plugin_u64                 roi_pending;
+
+//! Register handles of x0..x31, found at the first vCPU init.
+static struct qemu_plugin_register   * roi_xreg[32];
+static gboolean                        roi_have_regs = FALSE;
+
+//! Names QEMU's gdb register description uses for x0..x31.
+static const char * roi_abi_names[32] = {
+    "zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2",
+    "fp"  , "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+    "a6"  , "a7", "s2", "s3", "s4", "s5", "s6", "s7",
+    "s8"  , "s9", "s10","s11","t3", "t4", "t5", "t6"
+};
+
+//! Userdata of a CSR read callback: register, position and which half.
+#define ROI_UD(rd, behind, high) \
+    ((void*)(uintptr_t)(((uint64_t)(behind) << 8) | ((high) << 5) | (rd)))
+#define ROI_UD_RD(ud)      ((unsigned)((uintptr_t)(ud) & 0x1F))
+#define ROI_UD_HIGH(ud)    ((unsigned)(((uintptr_t)(ud) >> 5) & 0x1))
+#define ROI_UD_BEHIND(ud)  ((uint64_t)((uintptr_t)(ud) >> 8))
+
+
+static void roi_vcpu_init(qemu_plugin_id_t id, unsigned int vcpu_index) {
+    if(roi_have_regs) {
+        return;
+    }
+
+    GArray * regs = qemu_plugin_get_registers();
+
+    for(guint i = 0; i < regs -> len; i ++) {
+        qemu_plugin_reg_descriptor * r =
+            &g_array_index(regs, qemu_plugin_reg_descriptor, i);
+        for(int x = 1; x < 32; x ++) {
+            char xname[4];
+            snprintf(xname, sizeof(xname), "x%d", x);
+            if(!strcmp(r -> name, roi_abi_names[x]) ||
+               !strcmp(r -> name, xname) ||
+               (x == 8 && !strcmp(r -> name, "s0"))) {
+                roi_xreg[x] = r -> handle;
+            }
+        }
+    }
+
+    g_array_free(regs, TRUE);
+
+    // Without them every rdinstret would silently keep its host ticks.
+    for(int x = 1; x < 32; x ++) {
+        if(roi_xreg[x] == NULL) {
+            fprintf(stderr, "roi: no register handle for x%d (%s)\n",
+                x, roi_abi_names[x]);
+            exit(1);
+        }
+    }
+
+    roi_have_regs = TRUE;
+}
+
+
+//! Writes a due count to its register.
+static void roi_flush(roi_vcpu * s) {
+    GByteArray * buf= g_byte_array_new();
+    struct qemu_plugin_register * reg = roi_xreg[s -> rd];
+
+    s -> pending    = 0;
+
+    if(reg != NULL && qemu_plugin_read_register(reg, buf) > 0) {
+        // Little endian, truncated to the register width.
+        for(guint i = 0; i < buf -> len; i ++) {
+            buf -> data[i] = i < 8 ? (s -> value >> (8 * i)) & 0xFF : 0;
+        }
+        qemu_plugin_write_register(reg, buf);
+    }
+
+    g_byte_array_free(buf, TRUE);
+}
+
+
+/*!
+@brief Runs before an rdinstret(h): latches the count it should read.
+@details The per-TB add has already counted the whole TB, so the
+    instructions from this one to the end of the TB are taken off.
+*/
+static void roi_csr_read(unsigned int vcpu_index, void * ud) {
+    roi_vcpu * s    = qemu_plugin_scoreboard_find(roi_state, vcpu_index);
+    uint64_t   n    = s -> insns - ROI_UD_BEHIND(ud);
+
+    // Back to back reads, e.g. the rdinstreth/rdinstret/rdinstreth of RV32.
+    if(s -> pending) {
+        roi_flush(s);
+    }
+
+    s -> value      = ROI_UD_HIGH(ud) ? n >> 32 : n;
+    s -> rd         = ROI_UD_RD(ud);
+    s -> pending    = 1;
+    s -> markers   += 1;
+}
+
+
+//! Runs before the instruction after an rdinstret(h), if a write is due.
+static void roi_write_back(unsigned int vcpu_index, void * ud) {
+    roi_vcpu * s    = qemu_plugin_scoreboard_find(roi_state, vcpu_index);
+    if(s -> pending) {
+        roi_flush(s);
+    }
+}
+
+
+static void roi_tb_trans(qemu_plugin_id_t id, struct qemu_plugin_tb * tb) {
+    size_t n = qemu_plugin_tb_n_insns(tb);
+
+    qemu_plugin_register_vcpu_tb_exec_inline_per_vcpu(
+        tb, QEMU_PLUGIN_INLINE_ADD_U64, roi_insns, n);
+
+    // A CSR read may have been the last instruction of the previous TB.
+    qemu_plugin_register_vcpu_insn_exec_cond_cb(
+        qemu_plugin_tb_get_insn(tb, 0), roi_write_back,
+        QEMU_PLUGIN_CB_RW_REGS, QEMU_PLUGIN_COND_NE, roi_pending, 0, NULL);
+
+    for(size_t i = 0; i < n; i ++) {
+        struct qemu_plugin_insn * insn = qemu_plugin_tb_get_insn(tb, i);
+        uint32_t word = 0;
+
+        if(qemu_plugin_insn_size(insn) != 4) {
+            continue;
+        }
+
+        qemu_plugin_insn_data(insn, &word, sizeof(word));
+
+        uint32_t csr = word & ROI_RDINSTRET_MASK;
+        uint32_t rd  = (word >> 7) & 0x1F;
+
+        if((csr != ROI_RDINSTRET && csr != ROI_RDINSTRETH) || rd == 0) {
+            continue;
+        }
+
+        qemu_plugin_register_vcpu_insn_exec_cb(insn, roi_csr_read,
+            QEMU_PLUGIN_CB_RW_REGS,
+            ROI_UD(rd, n - i, csr == ROI_RDINSTRETH));
+
+        if(i + 1 < n) {
+            qemu_plugin_register_vcpu_insn_exec_cond_cb(
+                qemu_plugin_tb_get_insn(tb, i + 1), roi_write_back,
+                QEMU_PLUGIN_CB_RW_REGS, QEMU_PLUGIN_COND_NE, roi_pending, 0,
+                NULL);
+        }
+    }
+}
+
+
+static void roi_exit(qemu_plugin_id_t id, void * p) {
+    uint64_t markers = 0;
+    for(int i = 0; i < qemu_plugin_num_vcpus(); i ++) {
+        roi_vcpu * s = qemu_plugin_scoreboard_find(roi_state, i);
+        markers     += s -> markers;
+    }
+
+    g_autofree gchar * out = g_strdup_printf(
+        "roi: %" PRIu64 " instructions, %" PRIu64 " rdinstret reads\n",
+        qemu_plugin_u64_sum(roi_insns), markers);
+    qemu_plugin_outs(out);
+
+    qemu_plugin_scoreboard_free(roi_state);
+}
+
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_install(
+    qemu_plugin_id_t   id  ,
+    const qemu_info_t * info,
+    int                argc,
+    char            ** argv
+) {
+    if(strncmp(info -> target_name, "riscv", 5)) {
+        fprintf(stderr, "roi: riscv32/riscv64 targets only, not %s\n",
+            info -> target_name);
+        return -1;
+    }
+
+    roi_state   = qemu_plugin_scoreboard_new(sizeof(roi_vcpu));
+    roi_insns   = qemu_plugin_scoreboard_u64_in_struct(
+        roi_state, roi_vcpu, insns);
+    roi_pending = qemu_plugin_scoreboard_u64_in_struct(
+        roi_state, roi_vcpu, pending);
+
+    qemu_plugin_register_vcpu_init_cb(id, roi_vcpu_init);
+    qemu_plugin_register_vcpu_tb_trans_cb(id, roi_tb_trans);
+    qemu_plugin_register_atexit_cb(id, roi_exit, NULL);
+
+    return 0;
+}
@@ -0,0 +1,491 @@
+#!/usr/bin/env python3
+
+"""
+Collects the structured results of benchmark runs, and compares them
+across implementations and configs.
+
+Test programs record measurements with test_result() (share/test.h),
+which prints lines of the form
+
+    #!result <test>,<algorithm>,<bytes>,<instret>,<cycles>
+
+into the python3 script they generate. Those scripts are kept under
+$REPO_BUILD/benchmarks/<config>/log/ by the run-test-* and run-sweep-*
+targets, which is where this script finds them.
+
+The baseline and check commands keep per-config instret baselines under
+benchmarks/baseline/, and fail a run which regresses against them.
+
+The cache command reads the logs of the cache-test-* targets, which run a
+test once per cache geometry with Spike's --ic/--dc cache models, and
+reports the miss counts with an estimated cycle cost.
+
+The ct command reads the logs of the run-ct-* targets (share/ct.h), and
+lists which routines have data dependent timing.
+"""
+
+import os
+import re
+import sys
+import csv
+import json
+import argparse
+import statistics
+
+RESULT_PREFIX   = "#!result "
+
+FIELDS          = ["config", "test", "algorithm", "implementation",
+                   "bytes", "instret", "cycles"]
+
+IMPL_RE         = re.compile(r"_(reference|ttable|zscrypto(?:_rv32|_rv64)?(?:_c)?)$")
+
+#: Implementation families shown in the report, zscrypto_rv32/64 being
+#: folded into zscrypto.
+REPORT_IMPLS    = ["reference", "ttable", "zscrypto"]
+
+
+def test_implementation(test):
+    """
+    Return the implementation a test name was built against, e.g.
+    "aes_128_zscrypto_rv64" -> "zscrypto_rv64", or "-" if it is not
+    one of the known implementations.
+    """
+    m = IMPL_RE.search(test)
+    return m.group(1) if m else "-"
+
+
+def implementation_family(impl):
+    return "zscrypto" if impl.startswith("zscrypto") else impl
+
+
+def path_config(path):
+    """
+    Infer the config from a log path: $REPO_BUILD/benchmarks/<config>/log/..
+    """
+    parts = os.path.abspath(path).split(os.sep)
+    if("log" in parts):
+        i = len(parts) - 1 - parts[::-1].index("log")
+        if(i > 0):
+            return parts[i-1]
+    return "-"
+
+
+def find_logs(paths):
+    """
+    Expand directories into the *.py run logs they contain.
+    """
+    for path in paths:
+        if(not os.path.exists(path)):
+            sys.stderr.write("results.py: skipping missing %s\n" % path)
+        elif(os.path.isdir(path)):
+            for root, dirs, files in sorted(os.walk(path)):
+                for f in sorted(files):
+                    if(f.endswith(".py")):
+                        yield os.path.join(root, f)
+        else:
+            yield path
+
+
+def parse_logs(paths, config=None):
+    """
+    Return the result rows, as dicts keyed by FIELDS, of the given logs.
+    """
+    rows = []
+    for path in find_logs(paths):
+        with open(path, "r") as fh:
+            for line in fh:
+                if(not line.startswith(RESULT_PREFIX)):
+                    continue
+                test, algorithm, nbytes, instret, cycles = \
+                    line[len(RESULT_PREFIX):].strip().split(",")
+                rows.append({
+                    "config"        : config or path_config(path),
+                    "test"          : test,
+                    "algorithm"     : algorithm,
+                    "implementation": test_implementation(test),
+                    "bytes"         : int(nbytes),
+                    "instret"       : int(instret),
+                    "cycles"        : int(cycles),
+                })
+    return rows
+
+
+def read_rows(paths):
+    """
+    Read rows back from CSV or JSON files written by the "csv" command.
+    """
+    rows = []
+    for path in paths:
+        if(not os.path.exists(path)):
+            sys.stderr.write("results.py: skipping missing %s\n" % path)
+            continue
+        with open(path, "r") as fh:
+            if(path.endswith(".json")):
+                rows += json.load(fh)
+            else:
+                rows += list(csv.DictReader(fh))
+    for row in rows:
+        for field in ["bytes", "instret", "cycles"]:
+            row[field] = int(row[field])
+    return rows
+
+
+def write_rows(rows, fh, fmt):
+    if(fmt == "json"):
+        json.dump(rows, fh, indent=1)
+        fh.write("\n")
+    else:
+        writer = csv.DictWriter(fh, fieldnames=FIELDS)
+        writer.writeheader()
+        writer.writerows(rows)
+
+
+def median_by(rows, key, metric):
+    """
+    Group rows by key(row) and return the median metric of each group.
+    Tests repeated with random inputs measure the same thing several
+    times.
+    """
+    groups = {}
+    for row in rows:
+        groups.setdefault(key(row), []).append(row[metric])
+    return {k: statistics.median_low(v) for k, v in groups.items()}
+
+
+BASELINE_FIELDS = ["test", "algorithm", "bytes", "instret"]
+
+
+def read_baseline(path):
+    """
+    Return {(test, algorithm, bytes): instret} from a baseline file.
+    Lines starting with "#" are comments.
+    """
+    baseline = {}
+    with open(path, "r") as fh:
+        lines   = [l for l in fh if not l.startswith("#")]
+    for row in csv.DictReader(lines):
+        key = (row["test"], row["algorithm"], int(row["bytes"]))
+        baseline[key] = int(row["instret"])
+    return baseline
+
+
+def cmd_baseline(args):
+    rows    = parse_logs(args.logs)
+    if(not rows):
+        sys.stderr.write("results.py: no results found, not writing %s\n" %
+            args.output)
+        return False
+
+    medians = median_by(rows, lambda r: (r["test"], r["algorithm"],
+        r["bytes"]), "instret")
+
+    with open(args.output, "w") as fh:
+        fh.write("# instret baseline for config %s, written by\n" %
+            rows[0]["config"])
+        fh.write("# 'make CONFIG=%s baseline'. Checked by 'make check'.\n" %
+            rows[0]["config"])
+        writer = csv.writer(fh, lineterminator="\n")
+        writer.writerow(BASELINE_FIELDS)
+        for key in sorted(medians):
+            writer.writerow(list(key) + [medians[key]])
+
+    print("Wrote %d baseline entries to %s" % (len(medians), args.output))
+    return True
+
+
+def cmd_check(args):
+    if(not os.path.exists(args.baseline)):
+        sys.stderr.write("results.py: no baseline %s\n" % args.baseline)
+        return False
+
+    baseline = read_baseline(args.baseline)
+    rows     = parse_logs(args.logs)
+    if(args.test):
+        baseline = {k: v for k, v in baseline.items() if k[0] == args.test}
+        rows     = [r for r in rows if r["test"] == args.test]
+
+    medians  = median_by(rows, lambda r: (r["test"], r["algorithm"],
+        r["bytes"]), "instret")
+
+    # A check against an empty baseline compares nothing, so must not pass.
+    if(not baseline and not args.allow_new):
+        sys.stderr.write("results.py: %s has no entries%s, so nothing was "
+            "checked. Record them with 'make baseline', or pass --allow-new."
+            "\n" % (args.baseline, " for " + args.test if args.test else ""))
+        return False
+
+    failed   = False
+    added    = 0
+    for key in sorted(set(baseline) | set(medians)):
+        test, algorithm, nbytes = key
+        name = "%-24s %-18s %8d" % (test, algorithm, nbytes)
+        if(key not in baseline):
+            print("NEW        %s %10d" % (name, medians[key]))
+            added += 1
+            continue
+        if(key not in medians):
+            print("MISSING    %s %10d" % (name, baseline[key]))
+            failed = True
+            continue
+
+        base    = baseline[key]
+        new     = medians[key]
+        change  = 100.0 * (new - base) / base if base else 0.0
+
+        if(change > args.threshold):
+            status  = "REGRESSED"
+            failed  = True
+        elif(change < -args.threshold):
+            status  = "IMPROVED"
+        else:
+            status  = "ok"
+
+        if(status != "ok" or args.verbose):
+            print("%-10s %s %10d -> %10d %+7.2f%%" % (
+                status, name, base, new, change))
+
+    if(failed):
+        print("%s: regressions beyond %.2f%% against %s" % (
+            args.test or "check", args.threshold, args.baseline))
+    if(added and not args.allow_new):
+        print("%s: %d results have no entry in %s" % (
+            args.test or "check", added, args.baseline))
+        failed = True
+    return not failed
+
+
+CACHE_GEOMETRY_PREFIX = "#!cache-geometry "
+
+#: Spike cache model statistics, e.g. "D$ Read Misses:           1234"
+CACHE_STAT_RE   = re.compile(r"^(I|D|L2)\$ ([A-Za-z ]+):\s+([0-9.]+)")
+
+
+def parse_cache_log(path):
+    """
+    Return one dict per cache geometry in a cache-test-* log, holding the
+    summed instret of its test results and the Spike cache statistics,
+    keyed like "D$ Read Misses".
+    """
+    runs = []
+    with open(path, "r") as fh:
+        for line in fh:
+            if(line.startswith(CACHE_GEOMETRY_PREFIX)):
+                runs.append({"geometry": line[len(CACHE_GEOMETRY_PREFIX):].strip(),
+                             "instret" : 0})
+            elif(not runs):
+                continue
+            elif(line.startswith(RESULT_PREFIX)):
+                runs[-1]["instret"] += int(line.strip().split(",")[3])
+            else:
+                m = CACHE_STAT_RE.match(line)
+                if(m):
+                    key = "%s$ %s" % (m.group(1), m.group(2).strip())
+                    runs[-1][key] = float(m.group(3))
+    return runs
+
+
+def geometry_bytes(geometry):
+    """
+    Capacity of a Spike <sets>:<ways>:<block bytes> cache geometry.
+    """
+    sets, ways, block = [int(x) for x in geometry.split(":")]
+    return sets * ways * block
+
+
+def cmd_cache(args):
+    paths = []
+    for path in args.logs:
+        if(os.path.isdir(path)):
+            for root, dirs, files in sorted(os.walk(path)):
+                paths += [os.path.join(root, f) for f in sorted(files)
+                          if f.endswith(".log")]
+        elif(os.path.exists(path)):
+            paths.append(path)
+        else:
+            sys.stderr.write("results.py: skipping missing %s\n" % path)
+
+    header  = "%-28s %-12s %7s %12s %12s %10s %12s %10s %12s %6s" % (
+        "test", "geometry", "KiB", "instret", "fetches", "I$ miss",
+        "D$ access", "D$ miss", "est cycles", "CPI")
+    print("Whole program cache statistics, including the proxy kernel. "
+          "Miss penalty %d cycles." % args.miss_penalty)
+    print("instret is the sum over the test's own measurements.")
+    print(header)
+    print("-" * len(header))
+
+    found = False
+    for path in paths:
+        test = os.path.basename(path)[:-len(".log")].split("--")[-1]
+        for run in parse_cache_log(path):
+            found   = True
+            fetches = run.get("I$ Read Accesses", 0)
+            imiss   = run.get("I$ Read Misses", 0)
+            daccess = run.get("D$ Read Accesses", 0) + \
+                      run.get("D$ Write Accesses", 0)
+            dmiss   = run.get("D$ Read Misses", 0) + \
+                      run.get("D$ Write Misses", 0)
+            wbacks  = run.get("D$ Writebacks", 0)
+            # One cycle per fetched instruction, plus a refill for every
+            # miss and a write-back for every dirty eviction.
+            cycles  = fetches + args.miss_penalty * (imiss + dmiss + wbacks)
+            print("%-28s %-12s %7.1f %12d %12d %10d %12d %10d %12d %6.2f" % (
+                test, run["geometry"], geometry_bytes(run["geometry"]) / 1024,
+                run["instret"], fetches, imiss, daccess, dmiss, cycles,
+                cycles / fetches if fetches else 0))
+
+    if(not found):
+        sys.stderr.write("results.py: no cache logs found\n")
+    return found
+
+
+CT_PREFIX       = "#!ct "
+
+
+def cmd_ct(args):
+    flat    = re.compile(args.expect_flat) if args.expect_flat else None
+    header  = "%-18s %-24s %-12s %8s %10s %10s %10s  %s" % (
+        "config", "test", "algorithm", "samples", "max |t|", "fixed cyc",
+        "random cyc", "verdict")
+    print("Welch's t-test of fixed against random inputs. "
+          "|t| > %.1f leaks." % args.threshold)
+    print(header)
+    print("-" * len(header))
+
+    found   = False
+    failed  = []
+    for path in find_logs(args.logs):
+        with open(path, "r") as fh:
+            for line in fh:
+                if(not line.startswith(CT_PREFIX)):
+                    continue
+                found = True
+                test, algorithm, samples, t, fixed, rand = \
+                    line[len(CT_PREFIX):].strip().split(",")
+                t       = float(t)
+                leaks   = t > args.threshold
+                expect  = flat is not None and flat.search(test)
+                verdict = "LEAKS" if leaks else "flat"
+                if(leaks and expect):
+                    verdict += " (expected flat)"
+                    failed.append("%s %s" % (test, algorithm))
+                print("%-18s %-24s %-12s %8s %10.2f %10s %10s  %s" % (
+                    path_config(path), test, algorithm, samples, t, fixed,
+                    rand, verdict))
+
+    if(not found):
+        sys.stderr.write("results.py: no constant time logs found\n")
+        return False
+
+    for name in failed:
+        sys.stderr.write("results.py: %s is not constant time\n" % name)
+
+    return not failed
+
+
+def cmd_csv(args):
+    rows = parse_logs(args.logs, args.config)
+    if(args.output):
+        with open(args.output, "w") as fh:
+            write_rows(rows, fh, args.format)
+    else:
+        write_rows(rows, sys.stdout, args.format)
+    return True
+
+
+def cmd_report(args):
+    rows    = read_rows(args.results)
+    medians = median_by(rows, lambda r: (
+        r["config"], r["algorithm"], r["bytes"],
+        implementation_family(r["implementation"])), args.metric)
+
+    points  = sorted(set(k[:3] for k in medians))
+
+    header  = "%-18s %-18s %8s %12s %12s %12s %9s %9s" % (
+        "config", "algorithm", "bytes", "reference", "ttable", "zscrypto",
+        "ref/zs", "ttable/zs")
+    print("%s per operation, median over repeats" % args.metric)
+    print(header)
+    print("-" * len(header))
+
+    for config, algorithm, nbytes in points:
+        impl = {i: medians.get((config, algorithm, nbytes, i))
+                for i in REPORT_IMPLS}
+        if(args.zscrypto_only and impl["zscrypto"] is None):
+            continue
+
+        def speedup(base):
+            if(impl[base] is None or not impl["zscrypto"]):
+                return "-"
+            return "%.2fx" % (impl[base] / impl["zscrypto"])
+
+        print("%-18s %-18s %8d %12s %12s %12s %9s %9s" % (
+            config, algorithm, nbytes,
+            *["-" if impl[i] is None else str(impl[i]) for i in REPORT_IMPLS],
+            speedup("reference"), speedup("ttable")))
+
+    return True
+
+
+def build_arg_parser():
+    parser  = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    subs    = parser.add_subparsers()
+
+    sub_csv = subs.add_parser("csv", help="Collect the results of run logs (or directories of them) as CSV or JSON.")
+    sub_csv.set_defaults(func=cmd_csv)
+    sub_csv.add_argument("logs", nargs="+")
+    sub_csv.add_argument("--config", default=None, help="Config name to record. Inferred from the log path by default.")
+    sub_csv.add_argument("--format", choices=["csv", "json"], default="csv")
+    sub_csv.add_argument("--output", "-o", default=None)
+
+    sub_report = subs.add_parser("report", help="Compare implementations across the configs of CSV/JSON results files.")
+    sub_report.set_defaults(func=cmd_report)
+    sub_report.add_argument("results", nargs="+")
+    sub_report.add_argument("--metric", choices=["instret", "cycles"], default="instret")
+    sub_report.add_argument("--zscrypto-only", action="store_true", help="Only show rows with a zscrypto measurement.")
+
+    sub_base = subs.add_parser("baseline", help="Write the median instret of each test, algorithm and length in run logs to a baseline file.")
+    sub_base.set_defaults(func=cmd_baseline)
+    sub_base.add_argument("logs", nargs="+")
+    sub_base.add_argument("--output", "-o", required=True)
+
+    sub_check = subs.add_parser("check", help="Compare run logs against a baseline file. Fails if any instret count is more than --threshold percent above its baseline, missing, or has no baseline entry.")
+    sub_check.set_defaults(func=cmd_check)
+    sub_check.add_argument("logs", nargs="+")
+    sub_check.add_argument("--baseline", required=True)
+    sub_check.add_argument("--threshold", type=float, default=1.0, help="Allowed regression, in percent.")
+    sub_check.add_argument("--test", default=None, help="Only check the results of this test.")
+    sub_check.add_argument("--verbose", "-v", action="store_true", help="Also list results within the threshold.")
+    sub_check.add_argument("--allow-new", action="store_true", help="Pass results with no baseline entry, and an empty baseline, e.g. before the first recording.")
+
+    sub_cache = subs.add_parser("cache", help="Report the cache misses and estimated cycles of cache-test-* logs (or directories of them).")
+    sub_cache.set_defaults(func=cmd_cache)
+    sub_cache.add_argument("logs", nargs="+")
+    sub_cache.add_argument("--miss-penalty", type=int, default=20, help="Cycles charged per cache miss or write-back.")
+
+    sub_ct = subs.add_parser("ct", help="Report the t-tests of run-ct-* logs (or directories of them). Fails if a test matching --expect-flat leaks.")
+    sub_ct.set_defaults(func=cmd_ct)
+    sub_ct.add_argument("logs", nargs="+")
+    sub_ct.add_argument("--threshold", type=float, default=4.5, help="|t| above which a routine leaks.")
+    sub_ct.add_argument("--expect-flat", default="zscrypto", help="Regex of the test names which must not leak.")
+
+    return parser
+
+
+def main():
+    parser  = build_arg_parser()
+    args    = parser.parse_args()
+
+    if(not hasattr(args, "func")):
+        parser.print_help()
+        sys.exit(1)
+
+    retval  = args.func(args)
+
+    if(retval):
+        sys.exit(0)
+    else:
+        sys.exit(1)
+
+if(__name__ == "__main__"):
+    main()
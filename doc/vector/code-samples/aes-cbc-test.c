@@ -19,7 +19,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "bench.h"
 #include "log.h"
+#include "routines.h"
 #include "vlen-bits.h"
 #include "zvkned.h"
 
@@ -28,167 +30,6 @@
 // 'aes-cbc-vectors.h' is auto-generated by `make test-vectors`.
 #include "test-vectors/aes-cbc-vectors.h"
 
-// Function pointer type for AES encode/decode routines.
-//
-// Functions of that type have this signature
-//   extern uint64_t
-//   function_name_here(
-//     void* dest,
-//     const void* src,
-//     uint64_t n,
-//     const uint8_t* expanded_key
-//  );
-//
-typedef uint64_t (aes_transform_t)(
-   void* dest,
-   const void* src,
-   uint64_t n,
-   const uint32_t* expanded_key
-);
-
-enum TransformDirection {
-    kEncode,
-    kDecode,
-};
-
-struct aes_routine {
-    const char* name;
-    const char* descr;
-    aes_transform_t* fn;
-    size_t keylen;
-    // Minimum VLEN (in bits) required to.
-    size_t min_vlen;
-    enum TransformDirection direction;
-};
-
-#define NUM_ROUTINES (14)
-
-static const struct aes_routine kAESRoutines[NUM_ROUTINES] = {
-    // AES-128 encode
-    {
-        .name = "zvkned_aes128_encode_vs_lmul1",
-        .descr = "AES-128 encode, vs variant, LMUL=1",
-        .fn = &zvkned_aes128_encode_vs_lmul1,
-        .keylen = 128,
-        .min_vlen = 128,
-        .direction = kEncode,
-    },
-    {
-        .name = "zvkned_aes128_encode_vs_lmul2",
-        .descr = "AES-128 encode, vs variant, LMUL=2",
-        .fn = &zvkned_aes128_encode_vs_lmul2,
-        .keylen = 128,
-        .min_vlen = 64,
-        .direction = kEncode,
-    },
-    {
-        .name = "zvkned_aes128_encode_vs_lmul4",
-        .descr = "AES-128 encode, vs variant, LMUL=4",
-        .fn = &zvkned_aes128_encode_vs_lmul4,
-        .keylen = 128,
-        .min_vlen = 32,
-        .direction = kEncode,
-    },
-
-    {
-        .name = "zvkned_aes128_encode_vv_lmul1",
-        .descr = "AES-128 encode, vv variant, LMUL=1",
-        .fn = &zvkned_aes128_encode_vv_lmul1,
-        .keylen = 128,
-        .min_vlen = 128,
-        .direction = kEncode,
-    },
-
-    // AES-128 decode
-    {
-        .name = "zvkned_aes128_decode_vs_lmul1",
-        .descr = "AES-128 decode, vs variant, LMUL=1",
-        .fn = &zvkned_aes128_decode_vs_lmul1,
-        .keylen = 128,
-        .min_vlen = 128,
-        .direction = kDecode,
-    },
-    {
-        .name = "zvkned_aes128_decode_vs_lmul2",
-        .descr = "AES-128 decode, vs variant, LMUL=2",
-        .fn = &zvkned_aes128_decode_vs_lmul2,
-        .keylen = 128,
-        .min_vlen = 64,
-        .direction = kDecode,
-    },
-
-    {
-        .name = "zvkned_aes128_decode_vv_lmul1",
-        .descr = "AES-128 decode, vv variant, LMUL=1",
-        .fn = &zvkned_aes128_decode_vv_lmul1,
-        .keylen = 128,
-        .min_vlen = 128,
-        .direction = kDecode,
-    },
-
-    // AES-256 encode
-    {
-        .name = "zvkned_aes256_encode_vs_lmul1",
-        .descr = "AES-256 encode, vs variant, LMUL=1",
-        .fn = &zvkned_aes256_encode_vs_lmul1,
-        .keylen = 256,
-        .min_vlen = 128,
-        .direction = kEncode,
-    },
-    {
-        .name = "zvkned_aes256_encode_vs_lmul2",
-        .descr = "AES-256 encode, vs variant, LMUL=2",
-        .fn = &zvkned_aes256_encode_vs_lmul2,
-        .keylen = 256,
-        .min_vlen = 64,
-        .direction = kEncode,
-    },
-    {
-        .name = "zvkned_aes256_encode_vs_lmul4",
-        .descr = "AES-256 encode, vs variant, LMUL=4",
-        .fn = &zvkned_aes256_encode_vs_lmul4,
-        .keylen = 256,
-        .min_vlen = 32,
-        .direction = kEncode,
-    },
-
-    {
-        .name = "zvkned_aes256_encode_vv_lmul1",
-        .descr = "AES-256 encode, vv variant, LMUL=1",
-        .fn = &zvkned_aes256_encode_vv_lmul1,
-        .keylen = 256,
-        .min_vlen = 128,
-        .direction = kEncode,
-    },
-
-    // AES-256 decode
-    {
-        .name = "zvkned_aes256_decode_vs_lmul1",
-        .descr = "AES-256 decode, vs variant, LMUL=1",
-        .fn = &zvkned_aes256_decode_vs_lmul1,
-        .keylen = 256,
-        .min_vlen = 128,
-        .direction = kDecode,
-    },
-    {
-        .name = "zvkned_aes256_decode_vs_lmul2",
-        .descr = "AES-256 decode, vs variant, LMUL=2",
-        .fn = &zvkned_aes256_decode_vs_lmul2,
-        .keylen = 256,
-        .min_vlen = 64,
-        .direction = kDecode,
-    },
-
-    {
-        .name = "zvkned_aes256_decode_vv_lmul1",
-        .descr = "AES-256 decode, vv variant, LMUL=1",
-        .fn = &zvkned_aes256_decode_vv_lmul1,
-        .keylen = 256,
-        .min_vlen = 128,
-        .direction = kDecode,
-    },
-};
-
 struct expanded_key {
     // 240 bytes for AES-256, less needed for AES-128.
     // Using uint32_t guarantees alignment.
@@ -245,7 +86,7 @@ run_test(const struct aes_cbc_test* const test, const size_t keylen)
 
     size_t routines_tested = 0;
 
-    for (size_t routine_idx = 0; routine_idx < NUM_ROUTINES; ++routine_idx) {
+    for (size_t routine_idx = 0; routine_idx < NUM_AES_ROUTINES; ++routine_idx) {
         const struct aes_routine* const routine = &kAESRoutines[routine_idx];
 
         if (test->encrypt != (routine->direction == kEncode)) {
@@ -301,7 +142,7 @@ run_test(const struct aes_cbc_test* const test, const size_t keylen)
         }
     }
 
-    const size_t num_skipped = NUM_ROUTINES - routines_tested;
+    const size_t num_skipped = NUM_AES_ROUTINES - routines_tested;
     LOG(" # routines passed: %zu, skipped: %zu", routines_tested, num_skipped);
     return (routines_tested > 0 ? 0 : 1);
 }
@@ -323,14 +164,50 @@ run_test_suite(const struct aes_cbc_test_suite* const suite) {
     LOG("Success, %d tests were run.", suite->count);
 }
 
+struct bench_ctx {
+    const struct aes_routine* routine;
+    struct expanded_key key;
+};
+
+// ECB over the whole buffer, in place.
+static void
+bench_transform(const void* ctx, uint8_t* buf, size_t len)
+{
+    const struct bench_ctx* const bench = ctx;
+    bench->routine->fn(buf, buf, len, &bench->key.expanded[0]);
+}
+
+static void
+run_benchmarks(void)
+{
+    static const uint8_t kKey[32] = { 0 };
+    const uint64_t vlen = vlen_bits();
+
+    for (size_t i = 0; i < NUM_AES_ROUTINES; ++i) {
+        struct bench_ctx ctx = { .routine = &kAESRoutines[i] };
+        if (vlen < ctx.routine->min_vlen) {
+            LOG("- Skipping '%s' due to VLEN being too small (%zu < %zu)",
+                ctx.routine->name, vlen, ctx.routine->min_vlen);
+            continue;
+        }
+        expand_key(&ctx.key, kKey, ctx.routine->keylen);
+        bench_sweep(ctx.routine->name, bench_transform, &ctx, 16);
+    }
+}
+
 int
-main()
+main(int argc, char** argv)
 {
     const int n = sizeof(cbc_suites) / sizeof(*cbc_suites);
 
     const uint64_t vlen = vlen_bits();
     LOG("vlen: %" PRIu64 " bits", vlen);
 
+    if (bench_requested(argc, argv)) {
+        run_benchmarks();
+        return 0;
+    }
+
     for (int i = 0; i < n; i++) {
         const struct aes_cbc_test_suite* const suite = &cbc_suites[i];
         if (suite->keylen != 128 && suite->keylen != 256) {
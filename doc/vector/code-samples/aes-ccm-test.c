@@ -0,0 +1,384 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// AES-128-CCM and AES-128-CMAC using the Zvkned (AES) extension.
+//
+// CCM uses the cipher agnostic driver from ccm.c, which encodes one
+// CBC-MAC block and one counter block per cipher call so that the serial
+// MAC chain and the parallel keystream run in different element groups.
+// CMAC (cmac.c) is a purely serial chain. Both are validated against the
+// examples from NIST SP 800-38C and RFC 4493, then benchmarked over
+// 64 B - 4 KiB payloads next to AES-128-GCM.
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "block-cipher.h"
+#include "ccm.h"
+#include "cmac.h"
+#include "gcm.h"
+#include "log.h"
+#include "vlen-bits.h"
+#include "zvkned.h"
+
+// ----------------------------------------------------------------------
+// NIST SP 800-38C, Appendix C, examples 1 to 3.
+//
+// All examples share one key. The nonce, associated data and payload are
+// prefixes of the byte sequences 10 11 .., 00 01 .. and 20 21 ..
+
+__attribute__((aligned(16)))
+static const uint8_t kCcmKey[16] = {
+    0x40,0x41,0x42,0x43,0x44,0x45,0x46,0x47,
+    0x48,0x49,0x4a,0x4b,0x4c,0x4d,0x4e,0x4f,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kCcmNonce[13] = {
+    0x10,0x11,0x12,0x13,0x14,0x15,0x16,0x17,
+    0x18,0x19,0x1a,0x1b,0x1c,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kCcmAad[20] = {
+    0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,
+    0x08,0x09,0x0a,0x0b,0x0c,0x0d,0x0e,0x0f,
+    0x10,0x11,0x12,0x13,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kCcmPt[24] = {
+    0x20,0x21,0x22,0x23,0x24,0x25,0x26,0x27,
+    0x28,0x29,0x2a,0x2b,0x2c,0x2d,0x2e,0x2f,
+    0x30,0x31,0x32,0x33,0x34,0x35,0x36,0x37,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kCcmExample1[] = {
+    // C
+    0x71,0x62,0x01,0x5b,
+    // T
+    0x4d,0xac,0x25,0x5d,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kCcmExample2[] = {
+    // C
+    0xd2,0xa1,0xf0,0xe0,0x51,0xea,0x5f,0x62,
+    0x08,0x1a,0x77,0x92,0x07,0x3d,0x59,0x3d,
+    // T
+    0x1f,0xc6,0x4f,0xbf,0xac,0xcd,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kCcmExample3[] = {
+    // C
+    0xe3,0xb2,0x01,0xa9,0xf5,0xb7,0x1a,0x7a,
+    0x9b,0x1c,0xea,0xec,0xcd,0x97,0xe7,0x0b,
+    0x61,0x76,0xaa,0xd9,0xa4,0x42,0x8a,0xa5,
+    // T
+    0x48,0x43,0x92,0xfb,0xc1,0xb0,0x99,0x51,
+};
+
+struct ccm_test {
+    const char* name;
+    // Lengths are in bytes.
+    size_t noncelen;
+    size_t aadlen;
+    size_t len;
+    size_t taglen;
+    // Cipher text followed by the tag.
+    const uint8_t* expected;
+};
+
+static const struct ccm_test kCcmTests[] = {
+    {
+        .name = "SP 800-38C Example 1",
+        .noncelen = 7, .aadlen = 8, .len = 4, .taglen = 4,
+        .expected = kCcmExample1,
+    },
+    {
+        .name = "SP 800-38C Example 2",
+        .noncelen = 8, .aadlen = 16, .len = 16, .taglen = 6,
+        .expected = kCcmExample2,
+    },
+    {
+        .name = "SP 800-38C Example 3",
+        .noncelen = 12, .aadlen = 20, .len = 24, .taglen = 8,
+        .expected = kCcmExample3,
+    },
+};
+
+// ----------------------------------------------------------------------
+// RFC 4493, Section 4. The messages are prefixes of a 64 byte message.
+
+__attribute__((aligned(16)))
+static const uint8_t kCmacKey[16] = {
+    0x2b,0x7e,0x15,0x16,0x28,0xae,0xd2,0xa6,
+    0xab,0xf7,0x15,0x88,0x09,0xcf,0x4f,0x3c,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kCmacMsg[64] = {
+    0x6b,0xc1,0xbe,0xe2,0x2e,0x40,0x9f,0x96,
+    0xe9,0x3d,0x7e,0x11,0x73,0x93,0x17,0x2a,
+    0xae,0x2d,0x8a,0x57,0x1e,0x03,0xac,0x9c,
+    0x9e,0xb7,0x6f,0xac,0x45,0xaf,0x8e,0x51,
+    0x30,0xc8,0x1c,0x46,0xa3,0x5c,0xe4,0x11,
+    0xe5,0xfb,0xc1,0x19,0x1a,0x0a,0x52,0xef,
+    0xf6,0x9f,0x24,0x45,0xdf,0x4f,0x9b,0x17,
+    0xad,0x2b,0x41,0x7b,0xe6,0x6c,0x37,0x10,
+};
+
+struct cmac_test {
+    size_t len;
+    uint8_t mac[16];
+};
+
+static const struct cmac_test kCmacTests[] = {
+    {
+        .len = 0,
+        .mac = { 0xbb,0x1d,0x69,0x29,0xe9,0x59,0x37,0x28,
+                 0x7f,0xa3,0x7d,0x12,0x9b,0x75,0x67,0x46, },
+    },
+    {
+        .len = 16,
+        .mac = { 0x07,0x0a,0x16,0xb4,0x6b,0x4d,0x41,0x44,
+                 0xf7,0x9b,0xdd,0x9d,0xd0,0x4a,0x28,0x7c, },
+    },
+    {
+        .len = 40,
+        .mac = { 0xdf,0xa6,0x67,0x47,0xde,0x9a,0xe6,0x30,
+                 0x30,0xca,0x32,0x61,0x14,0x97,0xc8,0x27, },
+    },
+    {
+        .len = 64,
+        .mac = { 0x51,0xf0,0xbe,0xbf,0x7e,0x3b,0x9d,0x92,
+                 0xfc,0x49,0x74,0x17,0x79,0x36,0x3c,0xfe, },
+    },
+};
+
+#define BUF_SIZE (4096)
+
+struct aes_key {
+    uint32_t expanded[44];
+};
+
+static struct block_cipher
+aes_cipher(struct aes_key* key, const uint8_t* raw_key)
+{
+    zvkned_aes128_expand_key(key->expanded, raw_key);
+    const struct block_cipher cipher = {
+        .name = "AES-128",
+        .encode = &zvkned_aes128_encode_vs_lmul4,
+        .expanded_key = key->expanded,
+    };
+    return cipher;
+}
+
+static void
+print_mismatch(const char* what, const uint8_t* output,
+               const uint8_t* expected, size_t len)
+{
+    printf("\n%s mismatch", what);
+    printf("\noutput:   0x");
+    for (size_t i = 0; i < len; i++) {
+        printf("%02x", output[i]);
+    }
+    printf("\nexpected: 0x");
+    for (size_t i = 0; i < len; i++) {
+        printf("%02x", expected[i]);
+    }
+    printf("\n");
+}
+
+static int
+run_ccm_test(const struct ccm_test* test)
+{
+    __attribute__((aligned(16)))
+    uint8_t buf[BUF_SIZE];
+    __attribute__((aligned(16)))
+    uint8_t tag[16];
+
+    assert(test->len <= sizeof(buf));
+
+    struct aes_key key;
+    const struct block_cipher cipher = aes_cipher(&key, kCcmKey);
+    const uint8_t* const expected_tag = &test->expected[test->len];
+
+    ccm_encrypt(&cipher, buf, kCcmPt, test->len, kCcmNonce, test->noncelen,
+                kCcmAad, test->aadlen, tag, test->taglen);
+    if (memcmp(buf, test->expected, test->len) != 0) {
+        print_mismatch("Cipher text", buf, test->expected, test->len);
+        return 1;
+    }
+    if (memcmp(tag, expected_tag, test->taglen) != 0) {
+        print_mismatch("Encryption tag", tag, expected_tag, test->taglen);
+        return 1;
+    }
+
+    // In place decryption.
+    ccm_decrypt(&cipher, buf, buf, test->len, kCcmNonce, test->noncelen,
+                kCcmAad, test->aadlen, tag, test->taglen);
+    if (memcmp(buf, kCcmPt, test->len) != 0) {
+        print_mismatch("Plain text", buf, kCcmPt, test->len);
+        return 1;
+    }
+    if (memcmp(tag, expected_tag, test->taglen) != 0) {
+        print_mismatch("Decryption tag", tag, expected_tag, test->taglen);
+        return 1;
+    }
+
+    // A corrupted cipher text must not authenticate.
+    memcpy(buf, test->expected, test->len);
+    buf[0] ^= 0x01;
+    ccm_decrypt(&cipher, buf, buf, test->len, kCcmNonce, test->noncelen,
+                kCcmAad, test->aadlen, tag, test->taglen);
+    if (memcmp(tag, expected_tag, test->taglen) == 0) {
+        printf("\nCorrupted cipher text was authenticated\n");
+        return 1;
+    }
+    return 0;
+}
+
+static int
+run_cmac_test(const struct cmac_test* test)
+{
+    __attribute__((aligned(16)))
+    uint8_t mac[CMAC_TAG_SIZE];
+
+    struct aes_key key;
+    const struct block_cipher cipher = aes_cipher(&key, kCmacKey);
+
+    cmac(&cipher, kCmacMsg, test->len, mac);
+    if (memcmp(mac, test->mac, sizeof(mac)) != 0) {
+        print_mismatch("MAC", mac, test->mac, sizeof(mac));
+        return 1;
+    }
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+// Throughput comparison
+//
+// The benefit of running the MAC and CTR blocks side by side only shows
+// in the cycle counts of hardware (or timing model) runs.
+
+enum BenchMode {
+    kBenchCcm,
+    kBenchCmac,
+    kBenchGcm,
+};
+
+static void
+bench_transform(enum BenchMode mode, const struct block_cipher* cipher,
+                uint8_t* buf, size_t len)
+{
+    __attribute__((aligned(16)))
+    uint8_t tag[16];
+
+    switch (mode) {
+      case kBenchCcm:
+        ccm_encrypt(cipher, buf, buf, len, kCcmNonce, 12, kCcmAad, 16,
+                    tag, 16);
+        break;
+      case kBenchCmac:
+        cmac(cipher, buf, len, tag);
+        break;
+      case kBenchGcm:
+        gcm_encrypt(cipher, buf, buf, len, kCcmNonce, 12, kCcmAad, 16, tag);
+        break;
+    }
+}
+
+static void
+bench(const char* name, enum BenchMode mode,
+      const struct block_cipher* cipher, size_t len)
+{
+    __attribute__((aligned(16)))
+    static uint8_t buf[BUF_SIZE];
+
+    assert(len <= sizeof(buf));
+    memset(buf, 0x5a, len);
+
+    // Warm up.
+    bench_transform(mode, cipher, buf, len);
+
+    const uint64_t cycle_start = bench_read_cycle();
+    const uint64_t instret_start = bench_read_instret();
+    for (size_t i = 0; i < BENCH_ITERATIONS; i++) {
+        bench_transform(mode, cipher, buf, len);
+    }
+    const uint64_t instret = bench_read_instret() - instret_start;
+    const uint64_t cycles = bench_read_cycle() - cycle_start;
+
+    const uint64_t bytes = BENCH_ITERATIONS * len;
+    LOG("%-12s %5zu B: %8" PRIu64 " instret/op, %6.2f instret/B,"
+        " %6.2f cycles/B",
+        name, len, instret / BENCH_ITERATIONS,
+        (double)instret / bytes, (double)cycles / bytes);
+}
+
+static void
+run_benchmarks(void)
+{
+    static const size_t kSizes[] = { 64, 256, 1024, 4096 };
+
+    struct aes_key key;
+    const struct block_cipher aes = aes_cipher(&key, kCcmKey);
+
+    for (size_t i = 0; i < sizeof(kSizes) / sizeof(*kSizes); i++) {
+        bench("AES-128-CCM", kBenchCcm, &aes, kSizes[i]);
+        bench("AES-128-CMAC", kBenchCmac, &aes, kSizes[i]);
+        bench("AES-128-GCM", kBenchGcm, &aes, kSizes[i]);
+    }
+}
+
+int
+main()
+{
+    const uint64_t vlen = vlen_bits();
+    LOG("VLEN = %" PRIu64, vlen);
+
+    const size_t num_ccm = sizeof(kCcmTests) / sizeof(*kCcmTests);
+    for (size_t i = 0; i < num_ccm; i++) {
+        LOG("--- Running AES-128-CCM '%s' test...", kCcmTests[i].name);
+        if (run_ccm_test(&kCcmTests[i]) != 0) {
+            printf("Test '%s' failed\n", kCcmTests[i].name);
+            exit(1);
+        }
+    }
+
+    const size_t num_cmac = sizeof(kCmacTests) / sizeof(*kCmacTests);
+    for (size_t i = 0; i < num_cmac; i++) {
+        LOG("--- Running AES-128-CMAC RFC 4493 test #%zu (%zu bytes)...",
+            i + 1, kCmacTests[i].len);
+        if (run_cmac_test(&kCmacTests[i]) != 0) {
+            printf("AES-128-CMAC test #%zu failed\n", i + 1);
+            exit(1);
+        }
+    }
+    LOG("Success, %zu AES-128-CCM and %zu AES-128-CMAC tests run.",
+        num_ccm, num_cmac);
+
+    LOG("------ Throughput (VLEN = %" PRIu64 ")", vlen);
+    run_benchmarks();
+    return 0;
+}
@@ -0,0 +1,497 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// AES-GCM-SIV (RFC 8452) using the Zvkned and Zvkg extensions.
+//
+// POLYVAL (polyval.c) is computed with vghsh over batches of blocks, each
+// block of a batch being multiplied by its own power of H so that a single
+// reduction is needed per batch. The key derivation, tag and CTR32
+// encryption are in gcm-siv.c. The implementation is validated against the
+// test vectors of RFC 8452, Appendix C, then benchmarked against the AES-GCM
+// path used by aes-gcm-test.c (gcm.c).
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "block-cipher.h"
+#include "gcm-siv.h"
+#include "gcm.h"
+#include "log.h"
+#include "polyval.h"
+#include "vlen-bits.h"
+#include "zvkg.h"
+#include "zvkned.h"
+
+#define BUF_SIZE (4096)
+
+// ----------------------------------------------------------------------
+// RFC 8452, Appendix A: POLYVAL(H, X_1, X_2)
+
+__attribute__((aligned(16)))
+static const uint8_t kPolyvalH[16] = {
+    0x25,0x62,0x93,0x47,0x58,0x92,0x42,0x76,
+    0x1d,0x31,0xf8,0x26,0xba,0x4b,0x75,0x7b,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kPolyvalX[32] = {
+    0x4f,0x4f,0x95,0x66,0x8c,0x83,0xdf,0xb6,
+    0x40,0x17,0x62,0xbb,0x2d,0x01,0xa2,0x62,
+    0xd1,0xa2,0x4d,0xdd,0x27,0x21,0xd0,0x06,
+    0xbb,0xe4,0x5f,0x20,0xd3,0xc9,0xf3,0x62,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kPolyvalResult[16] = {
+    0xf7,0xa3,0xb4,0x7b,0x84,0x61,0x19,0xfa,
+    0xe5,0xb7,0x86,0x6c,0xf5,0xe5,0xb7,0x7e,
+};
+
+// ----------------------------------------------------------------------
+// RFC 8452, Appendix C.1 (AES-128) and C.2 (AES-256), nonce 03 00 .. 00.
+//
+// In these vectors the key is 01 00 .. 00 and the AAD and plain text are
+// sequences of 16 byte blocks whose first byte is a counter (01, 02, ..)
+// and the other bytes are zero, truncated to the given length. When AAD is
+// present it uses the first counter values and the plain text the next
+// ones.
+
+struct siv_test {
+    const char* name;
+    size_t keylen;
+    size_t aadlen;
+    size_t len;
+    // Cipher text followed by the tag, in hex.
+    const char* result;
+};
+
+static const struct siv_test kTests[] = {
+    { "C.1 #1", 128, 0, 0,
+      "dc20e2d83f25705bb49e439eca56de25" },
+    { "C.1 #2", 128, 0, 8,
+      "b5d839330ac7b786578782fff6013b815b287c22493a364c" },
+    { "C.1 #3", 128, 0, 12,
+      "7323ea61d05932260047d942a4978db357391a0bc4fdec8b0d106639" },
+    { "C.1 #4", 128, 0, 16,
+      "743f7c8077ab25f8624e2e948579cf77303aaf90f6fe21199c6068577437a0c4" },
+    { "C.1 #5", 128, 0, 32,
+      "84e07e62ba83a6585417245d7ec413a9fe427d6315c09b57ce45f2e3936a9445"
+      "1a8e45dcd4578c667cd86847bf6155ff" },
+    { "C.1 #6", 128, 0, 48,
+      "3fd24ce1f5a67b75bf2351f181a475c7b800a5b4d3dcf70106b1eea82fa1d64d"
+      "f42bf7226122fa92e17a40eeaac1201b5e6e311dbf395d35b0fe39c2714388f8" },
+    { "C.1 #7", 128, 0, 64,
+      "2433668f1058190f6d43e360f4f35cd8e475127cfca7028ea8ab5c20f7ab2af0"
+      "2516a2bdcbc08d521be37ff28c152bba36697f25b4cd169c6590d1dd39566d3f"
+      "8a263dd317aa88d56bdf3936dba75bb8" },
+    { "C.1 #8", 128, 1, 8,
+      "1e6daba35669f4273b0a1a2560969cdf790d99759abd1508" },
+    { "C.1 #9", 128, 1, 12,
+      "296c7889fd99f41917f4462008299c5102745aaa3a0c469fad9e075a" },
+    { "C.1 #10", 128, 1, 16,
+      "e2b0c5da79a901c1745f700525cb335b8f8936ec039e4e4bb97ebd8c4457441f" },
+    { "C.2 #1", 256, 0, 0,
+      "07f5f4169bbf55a8400cd47ea6fd400f" },
+    { "C.2 #2", 256, 0, 8,
+      "c2ef328e5c71c83b843122130f7364b761e0b97427e3df28" },
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kKey[32] = { 0x01 };
+
+__attribute__((aligned(16)))
+static const uint8_t kNonce[GCM_SIV_NONCE_SIZE] = { 0x03 };
+
+// Fills 'len' bytes of 'dest' with blocks first, first + 1, .. as
+// described above. Returns the next counter value.
+static uint8_t
+fill_blocks(uint8_t* dest, size_t len, uint8_t first)
+{
+    memset(dest, 0, len);
+    for (size_t i = 0; i < len; i += 16) {
+        dest[i] = first++;
+    }
+    return first;
+}
+
+static void
+from_hex(uint8_t* dest, const char* hex, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        unsigned int byte;
+        sscanf(&hex[2 * i], "%2x", &byte);
+        dest[i] = (uint8_t)byte;
+    }
+}
+
+static void
+print_mismatch(const char* what, const uint8_t* output,
+               const uint8_t* expected, size_t len)
+{
+    printf("\n%s mismatch", what);
+    printf("\noutput:   0x");
+    for (size_t i = 0; i < len; i++) {
+        printf("%02x", output[i]);
+    }
+    printf("\nexpected: 0x");
+    for (size_t i = 0; i < len; i++) {
+        printf("%02x", expected[i]);
+    }
+    printf("\n");
+}
+
+static int
+run_polyval_test(void)
+{
+    __attribute__((aligned(16)))
+    uint8_t S[16] = {};
+    struct polyval_key key;
+
+    polyval_init(&key, kPolyvalH);
+    polyval_update(&key, S, kPolyvalX, sizeof(kPolyvalX));
+    if (memcmp(S, kPolyvalResult, sizeof(S)) != 0) {
+        print_mismatch("POLYVAL", S, kPolyvalResult, sizeof(S));
+        return 1;
+    }
+    return 0;
+}
+
+static int
+run_test(const struct siv_test* test)
+{
+    __attribute__((aligned(16)))
+    uint8_t aad[16];
+    __attribute__((aligned(16)))
+    uint8_t pt[64];
+    __attribute__((aligned(16)))
+    uint8_t buf[64];
+    __attribute__((aligned(16)))
+    uint8_t tag[GCM_SIV_TAG_SIZE];
+    uint8_t expected[64 + GCM_SIV_TAG_SIZE];
+
+    assert(test->aadlen <= sizeof(aad) && test->len <= sizeof(pt));
+    from_hex(expected, test->result, test->len + GCM_SIV_TAG_SIZE);
+    const uint8_t* const expected_tag = &expected[test->len];
+
+    const uint8_t next = fill_blocks(aad, test->aadlen, 1);
+    fill_blocks(pt, test->len, next);
+
+    struct aes_gcm_siv_key key;
+    aes_gcm_siv_init(&key, kKey, test->keylen);
+
+    aes_gcm_siv_encrypt(&key, buf, pt, test->len, kNonce,
+                        aad, test->aadlen, tag);
+    if (memcmp(buf, expected, test->len) != 0) {
+        print_mismatch("Cipher text", buf, expected, test->len);
+        return 1;
+    }
+    if (memcmp(tag, expected_tag, sizeof(tag)) != 0) {
+        print_mismatch("Tag", tag, expected_tag, sizeof(tag));
+        return 1;
+    }
+
+    // In place decryption.
+    if (aes_gcm_siv_decrypt(&key, buf, buf, test->len, kNonce,
+                            aad, test->aadlen, tag) != 0 ||
+        memcmp(buf, pt, test->len) != 0) {
+        printf("\nDecryption failed\n");
+        return 1;
+    }
+
+    // A corrupted tag must not authenticate.
+    memcpy(buf, expected, test->len);
+    tag[0] ^= 0x01;
+    if (aes_gcm_siv_decrypt(&key, buf, buf, test->len, kNonce,
+                            aad, test->aadlen, tag) == 0) {
+        printf("\nCorrupted tag was authenticated\n");
+        return 1;
+    }
+    return 0;
+}
+
+// Block by block POLYVAL in plain C, from RFC 8452, Appendix A:
+//
+//   POLYVAL(H, X_1, ..., X_n) = ByteReverse(GHASH(mulX_GHASH(ByteReverse(H)),
+//                                   ByteReverse(X_1), ..., ByteReverse(X_n)))
+//
+// with the GHASH multiplication of NIST SP 800-38D, Algorithm 1. It is slow,
+// but shares nothing with polyval.c.
+
+// x <- x * x in the GHASH bit order: a right shift of the 128 bit big-endian
+// value, reduced by xoring 0xe1 into the first byte.
+static void
+ghash_mulx(uint8_t x[16])
+{
+    const uint8_t carry = x[15] & 1;
+    for (size_t i = 15; i > 0; i--) {
+        x[i] = (x[i] >> 1) | (x[i - 1] << 7);
+    }
+    x[0] = (x[0] >> 1) ^ (carry ? 0xe1 : 0);
+}
+
+// x <- x * y in GF(2^128), in the GHASH bit order.
+static void
+ghash_mul(uint8_t x[16], const uint8_t y[16])
+{
+    uint8_t z[16] = {};
+    uint8_t v[16];
+
+    memcpy(v, y, sizeof(v));
+    for (size_t i = 0; i < 128; i++) {
+        if (x[i / 8] & (0x80 >> (i % 8))) {
+            for (size_t j = 0; j < 16; j++) {
+                z[j] ^= v[j];
+            }
+        }
+        ghash_mulx(v);
+    }
+    memcpy(x, z, sizeof(z));
+}
+
+// As polyval_update, one zero padded 16 byte block at a time.
+static void
+polyval_reference(uint8_t S[16], const uint8_t H[16], const uint8_t* data,
+                  size_t len)
+{
+    uint8_t h[16];
+    uint8_t y[16];
+
+    for (size_t i = 0; i < 16; i++) {
+        h[i] = H[15 - i];
+        y[i] = S[15 - i];
+    }
+    ghash_mulx(h);
+
+    for (size_t i = 0; i < len; i += 16) {
+        for (size_t j = 0; j < 16 && i + j < len; j++) {
+            y[15 - j] ^= data[i + j];
+        }
+        ghash_mul(y, h);
+    }
+
+    for (size_t i = 0; i < 16; i++) {
+        S[i] = y[15 - i];
+    }
+}
+
+// polyval_update over at least 4 KiB, against polyval_reference. The
+// lengths are not a multiple of the POLYVAL_NUM_POWERS blocks of a batch,
+// nor of the (VLEN dependent) blocks of a vector pass, so each ends in a
+// partial batch, and some in a partial block.
+static int
+run_long_polyval_test(void)
+{
+    static const size_t kLengths[] = {
+        BUF_SIZE + 5,
+        BUF_SIZE + 16 * 3,
+        BUF_SIZE + 16 * (POLYVAL_NUM_POWERS - 1),
+        BUF_SIZE + 16 * (POLYVAL_NUM_POWERS + 1) + 9,
+    };
+    __attribute__((aligned(16)))
+    static uint8_t data[BUF_SIZE + 16 * (POLYVAL_NUM_POWERS + 2)];
+    struct polyval_key key;
+
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 13 + 5);
+    }
+    polyval_init(&key, kPolyvalH);
+
+    for (size_t i = 0; i < sizeof(kLengths) / sizeof(*kLengths); i++) {
+        assert(kLengths[i] <= sizeof(data));
+        __attribute__((aligned(16)))
+        uint8_t S[16] = {};
+        uint8_t expected[16] = {};
+
+        polyval_update(&key, S, data, kLengths[i]);
+        polyval_reference(expected, kPolyvalH, data, kLengths[i]);
+        if (memcmp(S, expected, sizeof(S)) != 0) {
+            printf("\nLength %zu:", kLengths[i]);
+            print_mismatch("POLYVAL", S, expected, sizeof(S));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Round trip over a buffer long enough to span several POLYVAL batches
+// and CTR32 batches at any VLEN.
+static int
+run_round_trip_test(size_t keylen)
+{
+    __attribute__((aligned(16)))
+    static uint8_t pt[BUF_SIZE + 5];
+    __attribute__((aligned(16)))
+    static uint8_t buf[BUF_SIZE + 5];
+    __attribute__((aligned(16)))
+    uint8_t tag[GCM_SIV_TAG_SIZE];
+
+    for (size_t i = 0; i < sizeof(pt); i++) {
+        pt[i] = (uint8_t)(i * 7 + 1);
+    }
+
+    struct aes_gcm_siv_key key;
+    aes_gcm_siv_init(&key, kKey, keylen);
+
+    aes_gcm_siv_encrypt(&key, buf, pt, sizeof(pt), kNonce, pt, 37, tag);
+    if (aes_gcm_siv_decrypt(&key, buf, buf, sizeof(buf), kNonce,
+                            pt, 37, tag) != 0 ||
+        memcmp(buf, pt, sizeof(pt)) != 0) {
+        printf("\nRound trip failed\n");
+        return 1;
+    }
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+// Throughput comparison
+//
+// AES-128-GCM-SIV against AES-128-GCM as used in aes-gcm-test.c (gcm.c,
+// with the serial zvkg_ghash chain), and POLYVAL alone against GHASH alone.
+// GCM-SIV is two-pass and derives its keys per nonce, which shows on short
+// messages.
+
+enum BenchMode {
+    kBenchGcm,
+    kBenchGcmSiv,
+    kBenchGhash,
+    kBenchPolyval,
+};
+
+struct bench_keys {
+    struct aes_gcm_siv_key siv;
+    uint32_t gcm_expanded[44];
+    struct block_cipher gcm;
+    struct polyval_key polyval;
+    uint32_t ghash_H[4];
+};
+
+static void
+bench_transform(enum BenchMode mode, const struct bench_keys* keys,
+                uint8_t* buf, size_t len)
+{
+    __attribute__((aligned(16)))
+    uint8_t tag[16] = {};
+
+    switch (mode) {
+      case kBenchGcm:
+        gcm_encrypt(&keys->gcm, buf, buf, len, kNonce, sizeof(kNonce),
+                    kKey, 16, tag);
+        break;
+      case kBenchGcmSiv:
+        aes_gcm_siv_encrypt(&keys->siv, buf, buf, len, kNonce,
+                            kKey, 16, tag);
+        break;
+      case kBenchGhash:
+        zvkg_ghash(tag, buf, keys->ghash_H, len / 16);
+        break;
+      case kBenchPolyval:
+        polyval_update(&keys->polyval, tag, buf, len);
+        break;
+    }
+}
+
+static void
+bench(const char* name, enum BenchMode mode, const struct bench_keys* keys,
+      size_t len)
+{
+    __attribute__((aligned(16)))
+    static uint8_t buf[BUF_SIZE];
+
+    assert(len <= sizeof(buf));
+    memset(buf, 0x5a, len);
+
+    // Warm up.
+    bench_transform(mode, keys, buf, len);
+
+    const uint64_t cycle_start = bench_read_cycle();
+    const uint64_t instret_start = bench_read_instret();
+    for (size_t i = 0; i < BENCH_ITERATIONS; i++) {
+        bench_transform(mode, keys, buf, len);
+    }
+    const uint64_t instret = bench_read_instret() - instret_start;
+    const uint64_t cycles = bench_read_cycle() - cycle_start;
+
+    const uint64_t bytes = BENCH_ITERATIONS * len;
+    LOG("%-16s %5zu B: %8" PRIu64 " instret/op, %6.2f instret/B,"
+        " %6.2f cycles/B",
+        name, len, instret / BENCH_ITERATIONS,
+        (double)instret / bytes, (double)cycles / bytes);
+}
+
+static void
+run_benchmarks(void)
+{
+    static const size_t kSizes[] = { 64, 256, 1024, 4096 };
+
+    static struct bench_keys keys;
+    aes_gcm_siv_init(&keys.siv, kKey, 128);
+    zvkned_aes128_expand_key(keys.gcm_expanded, kKey);
+    keys.gcm.name = "AES-128";
+    keys.gcm.encode = &zvkned_aes128_encode_vs_lmul4;
+    keys.gcm.expanded_key = keys.gcm_expanded;
+    polyval_init(&keys.polyval, kPolyvalH);
+    memcpy(keys.ghash_H, kPolyvalH, sizeof(keys.ghash_H));
+
+    for (size_t i = 0; i < sizeof(kSizes) / sizeof(*kSizes); i++) {
+        bench("AES-128-GCM", kBenchGcm, &keys, kSizes[i]);
+        bench("AES-128-GCM-SIV", kBenchGcmSiv, &keys, kSizes[i]);
+        bench("GHASH", kBenchGhash, &keys, kSizes[i]);
+        bench("POLYVAL", kBenchPolyval, &keys, kSizes[i]);
+    }
+}
+
+int
+main()
+{
+    const uint64_t vlen = vlen_bits();
+    LOG("VLEN = %" PRIu64, vlen);
+
+    LOG("--- Running POLYVAL test...");
+    if (run_polyval_test() != 0) {
+        printf("POLYVAL test failed\n");
+        exit(1);
+    }
+
+    const size_t num_tests = sizeof(kTests) / sizeof(*kTests);
+    for (size_t i = 0; i < num_tests; i++) {
+        LOG("--- Running RFC 8452 '%s' test...", kTests[i].name);
+        if (run_test(&kTests[i]) != 0) {
+            printf("Test '%s' failed\n", kTests[i].name);
+            exit(1);
+        }
+    }
+
+    LOG("--- Running long POLYVAL test...");
+    if (run_long_polyval_test() != 0) {
+        printf("Long POLYVAL test failed\n");
+        exit(1);
+    }
+
+    LOG("--- Running round trip tests...");
+    if (run_round_trip_test(128) != 0 || run_round_trip_test(256) != 0) {
+        printf("Round trip test failed\n");
+        exit(1);
+    }
+    LOG("Success, %zu AES-GCM-SIV tests run.", num_tests + 3);
+
+    LOG("------ Throughput (VLEN = %" PRIu64 ")", vlen);
+    run_benchmarks();
+    return 0;
+}
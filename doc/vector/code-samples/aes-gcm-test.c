@@ -19,10 +19,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "block-cipher.h"
+#include "gcm.h"
 #include "log.h"
 #include "vlen-bits.h"
 #include "zvb-ghash.h"
-#include "zvkg.h"
 #include "zvkned.h"
 
 #include "aes-gcm-test.h"
@@ -534,72 +535,32 @@ run_test_zvb(const struct aes_gcm_test* test, int keylen)
 //
 // Zvkg Implementation
 //
+// The GCM logic itself lives in gcm.c, which works for any 128 bit block
+// cipher. It is instantiated here with the Zvkned AES routines.
 
-// Returns (Y ^ X) o H
-//
-// Taking the arguments by value and returning a new value
-// is done for clarity. A performance oriented implementation
-// may want to use a signature reducing extra copies, e.g.,
-//  static void vghsh(uint128* Y, const uint128* H, const uint128* X);
-//
-static uint128
-vghsh(uint128 Y, uint128 X, uint128 H) {
-    uint128 res = Y;
-    zvkg_vghsh(&res, &X, &H);
-    return res;
-}
-
-// Compute the Initial Counter Block (ICB, a.k.a. Y0, a.k.a. J0)
-//
-// The logic is written for clarity and staying fairly close to the GCM
-// specification.
-static uint128
-zvkg_initial_counter_block(const uint128 H, const uint8_t* iv, const size_t ivlen)
+static struct block_cipher
+aes_cipher(const struct expanded_key* key)
 {
-    if (ivlen == 12) {
-        // Easy case, len(IV) == 96 bits
-        // ICB = IV || 0...0  || 1   (round# starts at 1)
-        uint128 icb;
-
-        memcpy(&icb, iv, 12);
-        icb.words[3] = 0;
-        icb.bytes[15] = 1;
-        return icb;
-    }
-
-    // Hard case, ICB is GHASH on 128b blocks, with iv padded with 0s
-    // to fill full blocks, then a trailing block consisting of
-    // 0_64 || len(iv)_64
-    assert(ivlen > 0);  // Logic is unclear if ivlen == 0
-
-    size_t remaining_bytes = ivlen;
-
-    uint128 icb = {};
-
-    // Full blocks, including padding 0s if any.
-    while (remaining_bytes > 0) {
-        uint128 X = {};
-        const size_t len = MIN(16, remaining_bytes);
-        memcpy(&X, iv, len);
-        iv += len;
-        remaining_bytes -= len;
-
-        icb = vghsh(icb, X, H);
-    }
-    // Trailing block containing the IV bit length.
-    {
-        uint128 X = {};
-        X.dwords[1] = __builtin_bswap64(8 * ivlen);
-        icb = vghsh(icb, X, H);
+    struct block_cipher cipher = {
+        .expanded_key = key->expanded,
+    };
+    switch (key->keylen) {
+      case 128:
+        cipher.name = "AES-128";
+        cipher.encode = &zvkned_aes128_encode_vs_lmul4;
+        break;
+      case 256:
+        cipher.name = "AES-256";
+        cipher.encode = &zvkned_aes256_encode_vs_lmul4;
+        break;
+      default:
+        LOG("Invalid keylen %zu", key->keylen);
+        assert(false);
     }
-    return icb;
+    return cipher;
 }
 
 // Runs the given AES GCM test, using the Zvkg instructions.
-//
-// The logic is written for clarity and staying fairly close to the GCM
-// specification. A performance-focused implementation would reduce
-// unnecessary copies.
 static int
 run_test_zvkg(const struct aes_gcm_test* test, int keylen)
 {
@@ -613,108 +574,18 @@ run_test_zvkg(const struct aes_gcm_test* test, int keylen)
 
     struct expanded_key key;
     expand_key(&key, test->key, keylen);
-
-    // H = ENC_K(0)
-    const uint128 H = compute_h(&key);
-    dlog_u128("H", H);
-
-    // The ICB is kept constant, used later to construct the authentication
-    // tag. The counter_block used in encryption does not use this ICB value
-    // but its increments.
-    const uint128 ICB = zvkg_initial_counter_block(H, test->iv, test->ivlen);
-    dlog_u128("Y0", ICB);
-
-    uint128 X = {};
-    dlog_u128("X0", X);
-
-    // Start with the Additional Authenticated Data (AAD)
-    {
-        size_t remaining_bytes = test->aadlen;
-        const uint8_t* aad = test->aad;
-
-        // Full blocks, including padding 0s if any.
-        while (remaining_bytes > 0) {
-            uint128 block = {};
-            const size_t len = MIN(16, remaining_bytes);
-            memcpy(&block, aad, len);
-            aad += len;
-            remaining_bytes -= len;
-
-            dlog_u128("AAD block", block);
-            X = vghsh(X, block, H);
-            dlog_u128("AAD Xi+1", X);
-        }
-    }
-
-    // Process the Text (Plain or Cipher)
-    {
-        const uint8_t* xordata = test->encrypt ? test->pt : test->ct;
-
-        uint128 counter_block = ICB;
-        for (size_t i = 0; i < test->ctlen / 16; i++) {
-            increment_counter_block(&counter_block);
-            dlog_u128("Y: ", counter_block);
-
-            encrypt_block(&buf[16 * i], &counter_block, &key);
-            dlog_b16("E(K,Y) _0: ", &buf[16*i]);
-
-            if (!test->encrypt) {
-                X = vghsh(X, *(uint128*)(&xordata[16 * i]), H);
-            }
-            for (size_t j = 0; j < 16; j++) {
-                buf[16 * i + j] ^= xordata[16 * i + j];
-            }
-            if (test->encrypt) {
-                X = vghsh(X, *(uint128*)(&buf[16 * i]), H);
-            }
-            dlog_u128("Tf Xi+1", X);
-        }
-
-        const size_t remaining_bytes = test->ctlen % 16;
-        DLOG("remaining_bytes: %zu", remaining_bytes);
-        if (remaining_bytes != 0) {
-            const size_t buf_offset = test->ctlen - remaining_bytes;
-
-            // buf shall have enough space to fit the extra bytes.
-            increment_counter_block(&counter_block);
-            encrypt_block(&buf[buf_offset], &counter_block, &key);
-
-            uint128 temp = {};
-            if (!test->encrypt) {
-                memcpy(&temp, &xordata[buf_offset], remaining_bytes);
-                X = vghsh(X, temp, H);
-            }
-            for (size_t i = 0; i < remaining_bytes; i++) {
-                buf[buf_offset + i] ^= xordata[buf_offset + i];
-            }
-            if (test->encrypt) {
-                memcpy(&temp, &buf[buf_offset], remaining_bytes);
-                X = vghsh(X, temp, H);
-            }
-            dlog_u128("Tt Xi+1", X);
-        }
-    }
-
-    // "Lengths block", len(AA)_64 || len(C)_64
-    if (test->aadlen != 0 || test->ctlen != 0) {
-        uint128 lengths;
-
-        lengths.dwords[0] = __builtin_bswap64(8 * test->aadlen);
-        lengths.dwords[1] = __builtin_bswap64(8 * test->ctlen);
-        dlog_u128("lengths", lengths);
-        X = vghsh(X, lengths, H);
-        dlog_u128("Len Xi+1", X);
-    }
-
-    // Compute the authentication tag.
-    //  T = MSB(GHASH(H,A,C) xor E(K,Y0))
-    dlog_u128("GHASH(H,A,C)", X);
+    const struct block_cipher cipher = aes_cipher(&key);
 
     uint128 tag;
-    encrypt_block(&tag, &ICB, &key);
-    dlog_u128("E(K,Y0)", tag);
-    tag.dwords[0] ^= X.dwords[0];
-    tag.dwords[1] ^= X.dwords[1];
+    if (test->encrypt) {
+        gcm_encrypt(&cipher, buf, test->pt, test->ctlen,
+                    test->iv, test->ivlen, test->aad, test->aadlen,
+                    tag.bytes);
+    } else {
+        gcm_decrypt(&cipher, buf, test->ct, test->ctlen,
+                    test->iv, test->ivlen, test->aad, test->aadlen,
+                    tag.bytes);
+    }
     dlog_u128("T (full 128b)", tag);
 
     // Verify the results against expectations
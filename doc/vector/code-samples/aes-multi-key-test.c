@@ -0,0 +1,267 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// AES-128 with a distinct key per block using the Zvkned extension.
+//
+// zvkned_aes128_encode_multi_key gathers one expanded key per element group
+// and encodes n blocks under n keys in one pass with the ".vv" AES
+// instructions. This program checks it against the FIPS-197 example and
+// against zvkned_aes128_encode_vs_lmul1 called once per key, then compares
+// the throughput of both approaches for many sessions of one or two blocks
+// each.
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "log.h"
+#include "vlen-bits.h"
+#include "zvkned.h"
+
+#define MAX_SESSIONS (1024)
+#define MAX_BLOCKS_PER_SESSION (2)
+#define MAX_BLOCKS (MAX_SESSIONS * MAX_BLOCKS_PER_SESSION)
+
+#define AES128_EXPANDED_KEY_WORDS (44)
+
+// Expanded keys of the sessions.
+__attribute__((aligned(16)))
+static uint32_t gExpandedKeys[MAX_SESSIONS][AES128_EXPANDED_KEY_WORDS];
+
+// Key of each block, as passed to zvkned_aes128_encode_multi_key.
+static const uint32_t* gBlockKeys[MAX_BLOCKS];
+
+__attribute__((aligned(16)))
+static uint8_t gSrc[16 * MAX_BLOCKS];
+__attribute__((aligned(16)))
+static uint8_t gDest[16 * MAX_BLOCKS];
+__attribute__((aligned(16)))
+static uint8_t gExpected[16 * MAX_BLOCKS];
+
+// ----------------------------------------------------------------------
+// FIPS-197, Appendix C.1
+
+__attribute__((aligned(16)))
+static const uint8_t kFipsKey[16] = {
+    0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,
+    0x08,0x09,0x0a,0x0b,0x0c,0x0d,0x0e,0x0f,
+};
+
+static const uint8_t kFipsPt[16] = {
+    0x00,0x11,0x22,0x33,0x44,0x55,0x66,0x77,
+    0x88,0x99,0xaa,0xbb,0xcc,0xdd,0xee,0xff,
+};
+
+static const uint8_t kFipsCt[16] = {
+    0x69,0xc4,0xe0,0xd8,0x6a,0x7b,0x04,0x30,
+    0xd8,0xcd,0xb7,0x80,0x70,0xb4,0xc5,0x5a,
+};
+
+static uint8_t
+rand8()
+{
+    return rand() / ((RAND_MAX + 1u) / 256);
+}
+
+static void
+rand_bytes(uint8_t* dest, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        dest[i] = rand8();
+    }
+}
+
+// Expands a random key for each of the first 'num_sessions' sessions,
+// and assigns 'blocks_per_session' consecutive blocks to each session.
+static void
+setup_sessions(size_t num_sessions, size_t blocks_per_session)
+{
+    assert(num_sessions <= MAX_SESSIONS);
+    assert(blocks_per_session <= MAX_BLOCKS_PER_SESSION);
+
+    __attribute__((aligned(16)))
+    uint8_t key[16];
+    for (size_t i = 0; i < num_sessions; i++) {
+        rand_bytes(key, sizeof(key));
+        zvkned_aes128_expand_key(gExpandedKeys[i], key);
+        for (size_t j = 0; j < blocks_per_session; j++) {
+            gBlockKeys[i * blocks_per_session + j] = gExpandedKeys[i];
+        }
+    }
+}
+
+// Encodes the blocks of each session with one call per session.
+static void
+encode_per_session(uint8_t* dest, const uint8_t* src, size_t num_sessions,
+                   size_t blocks_per_session)
+{
+    const size_t len = 16 * blocks_per_session;
+    for (size_t i = 0; i < num_sessions; i++) {
+        zvkned_aes128_encode_vs_lmul1(dest + i * len, src + i * len, len,
+                                      gExpandedKeys[i]);
+    }
+}
+
+static void
+print_mismatch(const uint8_t* output, const uint8_t* expected, size_t len)
+{
+    printf("\noutput:   0x");
+    for (size_t i = 0; i < len; i++) {
+        printf("%02x", output[i]);
+    }
+    printf("\nexpected: 0x");
+    for (size_t i = 0; i < len; i++) {
+        printf("%02x", expected[i]);
+    }
+    printf("\n");
+}
+
+// Encodes the FIPS-197 example as one block of a batch using other
+// (random) keys.
+static int
+run_fips_test(size_t position, size_t num_blocks)
+{
+    setup_sessions(num_blocks, 1);
+    zvkned_aes128_expand_key(gExpandedKeys[position], kFipsKey);
+    rand_bytes(gSrc, 16 * num_blocks);
+    memcpy(&gSrc[16 * position], kFipsPt, sizeof(kFipsPt));
+
+    zvkned_aes128_encode_multi_key(gDest, gSrc, gBlockKeys, num_blocks);
+    if (memcmp(&gDest[16 * position], kFipsCt, sizeof(kFipsCt)) != 0) {
+        print_mismatch(&gDest[16 * position], kFipsCt, sizeof(kFipsCt));
+        return 1;
+    }
+    return 0;
+}
+
+// Compares the multi key routine against per session calls.
+static int
+run_random_test(size_t num_sessions, size_t blocks_per_session)
+{
+    const size_t num_blocks = num_sessions * blocks_per_session;
+    setup_sessions(num_sessions, blocks_per_session);
+    rand_bytes(gSrc, 16 * num_blocks);
+
+    encode_per_session(gExpected, gSrc, num_sessions, blocks_per_session);
+    zvkned_aes128_encode_multi_key(gDest, gSrc, gBlockKeys, num_blocks);
+    if (memcmp(gDest, gExpected, 16 * num_blocks) != 0) {
+        print_mismatch(gDest, gExpected, 16 * num_blocks);
+        return 1;
+    }
+
+    // In place.
+    zvkned_aes128_encode_multi_key(gSrc, gSrc, gBlockKeys, num_blocks);
+    if (memcmp(gSrc, gExpected, 16 * num_blocks) != 0) {
+        print_mismatch(gSrc, gExpected, 16 * num_blocks);
+        return 1;
+    }
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+// Throughput comparison
+
+static void
+bench(bool multi_key, size_t num_sessions, size_t blocks_per_session)
+{
+    const size_t num_blocks = num_sessions * blocks_per_session;
+    setup_sessions(num_sessions, blocks_per_session);
+    rand_bytes(gSrc, 16 * num_blocks);
+
+    const uint64_t cycle_start = bench_read_cycle();
+    const uint64_t instret_start = bench_read_instret();
+    for (size_t i = 0; i < BENCH_ITERATIONS; i++) {
+        if (multi_key) {
+            zvkned_aes128_encode_multi_key(gDest, gSrc, gBlockKeys,
+                                           num_blocks);
+        } else {
+            encode_per_session(gDest, gSrc, num_sessions,
+                               blocks_per_session);
+        }
+    }
+    const uint64_t instret = bench_read_instret() - instret_start;
+    const uint64_t cycles = bench_read_cycle() - cycle_start;
+
+    const uint64_t blocks = BENCH_ITERATIONS * num_blocks;
+    LOG("%-10s %4zu sessions x %zu blocks: %8" PRIu64 " instret/op,"
+        " %6.2f instret/block, %6.2f cycles/block",
+        multi_key ? "multi-key" : "vs/session",
+        num_sessions, blocks_per_session, instret / BENCH_ITERATIONS,
+        (double)instret / blocks, (double)cycles / blocks);
+}
+
+static void
+run_benchmarks(void)
+{
+    static const size_t kSessions[] = { 1, 4, 16, 64, 256, 1024 };
+
+    for (size_t bps = 1; bps <= MAX_BLOCKS_PER_SESSION; bps++) {
+        for (size_t i = 0; i < sizeof(kSessions) / sizeof(*kSessions); i++) {
+            bench(false, kSessions[i], bps);
+            bench(true, kSessions[i], bps);
+        }
+    }
+}
+
+int
+main()
+{
+    const uint64_t vlen = vlen_bits();
+    LOG("VLEN = %" PRIu64, vlen);
+
+    size_t num_tests = 0;
+
+    LOG("--- Running FIPS-197 tests...");
+    static const size_t kFipsBatches[][2] = {
+        // { position, num_blocks }
+        { 0, 1 }, { 0, 7 }, { 6, 7 }, { 33, 64 },
+    };
+    for (size_t i = 0; i < sizeof(kFipsBatches) / sizeof(*kFipsBatches);
+         i++) {
+        if (run_fips_test(kFipsBatches[i][0], kFipsBatches[i][1]) != 0) {
+            printf("FIPS-197 test failed (block %zu of %zu)\n",
+                   kFipsBatches[i][0], kFipsBatches[i][1]);
+            exit(1);
+        }
+        num_tests++;
+    }
+
+    LOG("--- Running random tests...");
+    for (size_t bps = 1; bps <= MAX_BLOCKS_PER_SESSION; bps++) {
+        for (size_t sessions = 1; sessions <= 40; sessions++) {
+            if (run_random_test(sessions, bps) != 0) {
+                printf("Random test failed (%zu sessions x %zu blocks)\n",
+                       sessions, bps);
+                exit(1);
+            }
+            num_tests++;
+        }
+        if (run_random_test(MAX_SESSIONS, bps) != 0) {
+            printf("Random test failed (%d sessions x %zu blocks)\n",
+                   MAX_SESSIONS, bps);
+            exit(1);
+        }
+        num_tests++;
+    }
+    LOG("Success, %zu AES-128 multi key tests run.", num_tests);
+
+    LOG("------ Throughput (VLEN = %" PRIu64 ")", vlen);
+    run_benchmarks();
+    return 0;
+}
@@ -0,0 +1,141 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "routines.h"
+
+#include "zvkned.h"
+
+// There is no LMUL=4 decode variant.
+const struct aes_routine kAESRoutines[NUM_AES_ROUTINES] = {
+    // AES-128 encode
+    {
+        .name = "zvkned_aes128_encode_vs_lmul4",
+        .descr = "AES-128 encode, vs variant, LMUL=4",
+        .fn = &zvkned_aes128_encode_vs_lmul4,
+        .keylen = 128,
+        .min_vlen = 32,
+        .direction = kEncode,
+    },
+    {
+        .name = "zvkned_aes128_encode_vs_lmul2",
+        .descr = "AES-128 encode, vs variant, LMUL=2",
+        .fn = &zvkned_aes128_encode_vs_lmul2,
+        .keylen = 128,
+        .min_vlen = 64,
+        .direction = kEncode,
+    },
+    {
+        .name = "zvkned_aes128_encode_vs_lmul1",
+        .descr = "AES-128 encode, vs variant, LMUL=1",
+        .fn = &zvkned_aes128_encode_vs_lmul1,
+        .keylen = 128,
+        .min_vlen = 128,
+        .direction = kEncode,
+    },
+    {
+        .name = "zvkned_aes128_encode_vv_lmul1",
+        .descr = "AES-128 encode, vv variant, LMUL=1",
+        .fn = &zvkned_aes128_encode_vv_lmul1,
+        .keylen = 128,
+        .min_vlen = 128,
+        .direction = kEncode,
+    },
+
+    // AES-128 decode
+    {
+        .name = "zvkned_aes128_decode_vs_lmul2",
+        .descr = "AES-128 decode, vs variant, LMUL=2",
+        .fn = &zvkned_aes128_decode_vs_lmul2,
+        .keylen = 128,
+        .min_vlen = 64,
+        .direction = kDecode,
+    },
+    {
+        .name = "zvkned_aes128_decode_vs_lmul1",
+        .descr = "AES-128 decode, vs variant, LMUL=1",
+        .fn = &zvkned_aes128_decode_vs_lmul1,
+        .keylen = 128,
+        .min_vlen = 128,
+        .direction = kDecode,
+    },
+    {
+        .name = "zvkned_aes128_decode_vv_lmul1",
+        .descr = "AES-128 decode, vv variant, LMUL=1",
+        .fn = &zvkned_aes128_decode_vv_lmul1,
+        .keylen = 128,
+        .min_vlen = 128,
+        .direction = kDecode,
+    },
+
+    // AES-256 encode
+    {
+        .name = "zvkned_aes256_encode_vs_lmul4",
+        .descr = "AES-256 encode, vs variant, LMUL=4",
+        .fn = &zvkned_aes256_encode_vs_lmul4,
+        .keylen = 256,
+        .min_vlen = 32,
+        .direction = kEncode,
+    },
+    {
+        .name = "zvkned_aes256_encode_vs_lmul2",
+        .descr = "AES-256 encode, vs variant, LMUL=2",
+        .fn = &zvkned_aes256_encode_vs_lmul2,
+        .keylen = 256,
+        .min_vlen = 64,
+        .direction = kEncode,
+    },
+    {
+        .name = "zvkned_aes256_encode_vs_lmul1",
+        .descr = "AES-256 encode, vs variant, LMUL=1",
+        .fn = &zvkned_aes256_encode_vs_lmul1,
+        .keylen = 256,
+        .min_vlen = 128,
+        .direction = kEncode,
+    },
+    {
+        .name = "zvkned_aes256_encode_vv_lmul1",
+        .descr = "AES-256 encode, vv variant, LMUL=1",
+        .fn = &zvkned_aes256_encode_vv_lmul1,
+        .keylen = 256,
+        .min_vlen = 128,
+        .direction = kEncode,
+    },
+
+    // AES-256 decode
+    {
+        .name = "zvkned_aes256_decode_vs_lmul2",
+        .descr = "AES-256 decode, vs variant, LMUL=2",
+        .fn = &zvkned_aes256_decode_vs_lmul2,
+        .keylen = 256,
+        .min_vlen = 64,
+        .direction = kDecode,
+    },
+    {
+        .name = "zvkned_aes256_decode_vs_lmul1",
+        .descr = "AES-256 decode, vs variant, LMUL=1",
+        .fn = &zvkned_aes256_decode_vs_lmul1,
+        .keylen = 256,
+        .min_vlen = 128,
+        .direction = kDecode,
+    },
+    {
+        .name = "zvkned_aes256_decode_vv_lmul1",
+        .descr = "AES-256 decode, vv variant, LMUL=1",
+        .fn = &zvkned_aes256_decode_vv_lmul1,
+        .keylen = 256,
+        .min_vlen = 128,
+        .direction = kDecode,
+    },
+};
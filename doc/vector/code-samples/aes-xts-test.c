@@ -0,0 +1,468 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// AES-XTS using the Zvkned (AES) and Zvkg (tweak generation) extensions.
+//
+// The XTS logic is in xts.c. This program validates it against test
+// vectors from IEEE 1619-2007, checks 4 KiB sectors against a serial
+// implementation of the tweak chain, then benchmarks both on 4 KiB sectors.
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "block-cipher.h"
+#include "log.h"
+#include "vlen-bits.h"
+#include "xts.h"
+#include "zvkned.h"
+
+// ----------------------------------------------------------------------
+// Test vectors from IEEE 1619-2007, Annex B (XTS-AES-128).
+
+struct aes_xts_test {
+    const char* name;
+    uint8_t key1[16];
+    uint8_t key2[16];
+    // Data unit sequence number, little-endian.
+    uint8_t iv[16];
+    const uint8_t* pt;
+    const uint8_t* ct;
+    size_t len;
+};
+
+static const uint8_t kVector1Pt[32] = { 0 };
+
+static const uint8_t kVector1Ct[32] = {
+    0x91,0x7c,0xf6,0x9e,0xbd,0x68,0xb2,0xec,
+    0x9b,0x9f,0xe9,0xa3,0xea,0xdd,0xa6,0x92,
+    0xcd,0x43,0xd2,0xf5,0x95,0x98,0xed,0x85,
+    0x8c,0x02,0xc2,0x65,0x2f,0xbf,0x92,0x2e,
+};
+
+static const uint8_t kVector2Pt[32] = {
+    0x44,0x44,0x44,0x44,0x44,0x44,0x44,0x44,
+    0x44,0x44,0x44,0x44,0x44,0x44,0x44,0x44,
+    0x44,0x44,0x44,0x44,0x44,0x44,0x44,0x44,
+    0x44,0x44,0x44,0x44,0x44,0x44,0x44,0x44,
+};
+
+static const uint8_t kVector2Ct[32] = {
+    0xc4,0x54,0x18,0x5e,0x6a,0x16,0x93,0x6e,
+    0x39,0x33,0x40,0x38,0xac,0xef,0x83,0x8b,
+    0xfb,0x18,0x6f,0xff,0x74,0x80,0xad,0xc4,
+    0x28,0x93,0x82,0xec,0xd6,0xd3,0x94,0xf0,
+};
+
+// Vectors 15 to 18 exercise ciphertext stealing, their plain text
+// is a prefix of 00 01 02 ...
+static const uint8_t kStealingPt[20] = {
+    0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,
+    0x08,0x09,0x0a,0x0b,0x0c,0x0d,0x0e,0x0f,
+    0x10,0x11,0x12,0x13,
+};
+
+static const uint8_t kVector15Ct[17] = {
+    0x6c,0x16,0x25,0xdb,0x46,0x71,0x52,0x2d,
+    0x3d,0x75,0x99,0x60,0x1d,0xe7,0xca,0x09,
+    0xed,
+};
+
+static const uint8_t kVector16Ct[18] = {
+    0xd0,0x69,0x44,0x4b,0x7a,0x7e,0x0c,0xab,
+    0x09,0xe2,0x44,0x47,0xd2,0x4d,0xeb,0x1f,
+    0xed,0xbf,
+};
+
+static const uint8_t kVector17Ct[19] = {
+    0xe5,0xdf,0x13,0x51,0xc0,0x54,0x4b,0xa1,
+    0x35,0x0b,0x33,0x63,0xcd,0x8e,0xf4,0xbe,
+    0xed,0xbf,0x9d,
+};
+
+static const uint8_t kVector18Ct[20] = {
+    0x9d,0x84,0xc8,0x13,0xf7,0x19,0xaa,0x2c,
+    0x7b,0xe3,0xf6,0x61,0x71,0xc7,0xc5,0xc2,
+    0xed,0xbf,0x9d,0xac,
+};
+
+#define STEALING_KEYS \
+    .key1 = { 0xff,0xfe,0xfd,0xfc,0xfb,0xfa,0xf9,0xf8, \
+              0xf7,0xf6,0xf5,0xf4,0xf3,0xf2,0xf1,0xf0 }, \
+    .key2 = { 0xbf,0xbe,0xbd,0xbc,0xbb,0xba,0xb9,0xb8, \
+              0xb7,0xb6,0xb5,0xb4,0xb3,0xb2,0xb1,0xb0 }, \
+    .iv = { 0x9a,0x78,0x56,0x34,0x12 }
+
+__attribute__((aligned(16)))
+static const struct aes_xts_test kTests[] = {
+    {
+        .name = "IEEE 1619 Vector 1",
+        .key1 = { 0 },
+        .key2 = { 0 },
+        .iv = { 0 },
+        .pt = kVector1Pt,
+        .ct = kVector1Ct,
+        .len = sizeof(kVector1Ct),
+    },
+    {
+        .name = "IEEE 1619 Vector 2",
+        .key1 = { 0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,
+                  0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11 },
+        .key2 = { 0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,
+                  0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22 },
+        .iv = { 0x33,0x33,0x33,0x33,0x33 },
+        .pt = kVector2Pt,
+        .ct = kVector2Ct,
+        .len = sizeof(kVector2Ct),
+    },
+    {
+        .name = "IEEE 1619 Vector 15",
+        STEALING_KEYS,
+        .pt = kStealingPt,
+        .ct = kVector15Ct,
+        .len = sizeof(kVector15Ct),
+    },
+    {
+        .name = "IEEE 1619 Vector 16",
+        STEALING_KEYS,
+        .pt = kStealingPt,
+        .ct = kVector16Ct,
+        .len = sizeof(kVector16Ct),
+    },
+    {
+        .name = "IEEE 1619 Vector 17",
+        STEALING_KEYS,
+        .pt = kStealingPt,
+        .ct = kVector17Ct,
+        .len = sizeof(kVector17Ct),
+    },
+    {
+        .name = "IEEE 1619 Vector 18",
+        STEALING_KEYS,
+        .pt = kStealingPt,
+        .ct = kVector18Ct,
+        .len = sizeof(kVector18Ct),
+    },
+};
+
+// ----------------------------------------------------------------------
+
+#define SECTOR_SIZE (4096)
+
+typedef union uint128 {
+    uint64_t dwords[2];
+    uint32_t words[4];
+    uint8_t bytes[16];
+} uint128;
+
+// Keys for both halves of an XTS key, expanded for AES-128 or AES-256.
+struct xts_keys {
+    // 240 bytes for AES-256, less needed for AES-128.
+    uint32_t expanded1[60];
+    uint32_t expanded2[60];
+    struct block_cipher data;
+    struct block_cipher tweak;
+};
+
+static void
+init_keys(struct xts_keys* keys, const uint8_t* key1, const uint8_t* key2,
+          size_t keylen)
+{
+    struct block_cipher cipher = {};
+    switch (keylen) {
+      case 128:
+        zvkned_aes128_expand_key(keys->expanded1, key1);
+        zvkned_aes128_expand_key(keys->expanded2, key2);
+        cipher.name = "AES-128";
+        cipher.encode = &zvkned_aes128_encode_vs_lmul4;
+        cipher.decode = &zvkned_aes128_decode_vs_lmul2;
+        break;
+      case 256:
+        zvkned_aes256_expand_key(keys->expanded1, key1);
+        zvkned_aes256_expand_key(keys->expanded2, key2);
+        cipher.name = "AES-256";
+        cipher.encode = &zvkned_aes256_encode_vs_lmul4;
+        cipher.decode = &zvkned_aes256_decode_vs_lmul2;
+        break;
+      default:
+        LOG("Invalid keylen %zu", keylen);
+        assert(false);
+    }
+    keys->data = cipher;
+    keys->data.expanded_key = keys->expanded1;
+    keys->tweak = cipher;
+    keys->tweak.expanded_key = keys->expanded2;
+}
+
+// Reference XTS encryption of a data unit made of full blocks, with the
+// tweaks computed by a serial chain of multiplications by alpha.
+// Like xts_encrypt the whole data unit goes through a single call to
+// the block cipher, only the tweak generation differs.
+static void
+xts_serial_encrypt(
+    const struct xts_keys* keys,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t iv[16]
+)
+{
+    __attribute__((aligned(16)))
+    static uint128 tweaks[SECTOR_SIZE / 16];
+    __attribute__((aligned(16)))
+    static uint128 buf[SECTOR_SIZE / 16];
+
+    assert(len % 16 == 0 && len <= SECTOR_SIZE);
+    const size_t nblocks = len / 16;
+
+    uint128 T;
+    memcpy(&T, iv, 16);
+    keys->tweak.encode(&T, &T, 16, keys->tweak.expanded_key);
+    for (size_t i = 0; i < nblocks; i++) {
+        tweaks[i] = T;
+        const uint64_t carry = T.dwords[1] >> 63;
+        T.dwords[1] = (T.dwords[1] << 1) | (T.dwords[0] >> 63);
+        T.dwords[0] = (T.dwords[0] << 1) ^ (carry * 0x87);
+    }
+
+    memcpy(buf, src, len);
+    for (size_t i = 0; i < nblocks; i++) {
+        buf[i].dwords[0] ^= tweaks[i].dwords[0];
+        buf[i].dwords[1] ^= tweaks[i].dwords[1];
+    }
+    keys->data.encode(buf, buf, len, keys->data.expanded_key);
+    for (size_t i = 0; i < nblocks; i++) {
+        buf[i].dwords[0] ^= tweaks[i].dwords[0];
+        buf[i].dwords[1] ^= tweaks[i].dwords[1];
+    }
+    memcpy(dest, buf, len);
+}
+
+static void
+print_mismatch(const uint8_t* output, const uint8_t* expected, size_t len)
+{
+    printf("\nText mismatch");
+    printf("\noutput:   0x");
+    for (size_t i = 0; i < len; i++) {
+        printf("%02x", output[i]);
+    }
+    printf("\nexpected: 0x");
+    for (size_t i = 0; i < len; i++) {
+        printf("%02x", expected[i]);
+    }
+    printf("\n");
+}
+
+static int
+run_test(const struct aes_xts_test* test)
+{
+    __attribute__((aligned(16)))
+    uint8_t buf[64];
+
+    assert(test->len <= sizeof(buf));
+
+    struct xts_keys keys;
+    init_keys(&keys, test->key1, test->key2, 128);
+    struct xts_context ctx;
+    if (xts_init(&ctx, &keys.data, &keys.tweak) != 0) {
+        printf("\nxts_init failed\n");
+        return 1;
+    }
+
+    int rc = 0;
+    xts_encrypt(&ctx, buf, test->pt, test->len, test->iv);
+    if (memcmp(buf, test->ct, test->len) != 0) {
+        print_mismatch(buf, test->ct, test->len);
+        rc = 1;
+    }
+    xts_decrypt(&ctx, buf, test->ct, test->len, test->iv);
+    if (memcmp(buf, test->pt, test->len) != 0) {
+        print_mismatch(buf, test->pt, test->len);
+        rc = 1;
+    }
+
+    xts_destroy(&ctx);
+    return rc;
+}
+
+__attribute__((aligned(16)))
+static uint8_t gSector[SECTOR_SIZE + 16];
+__attribute__((aligned(16)))
+static uint8_t gExpected[SECTOR_SIZE + 16];
+__attribute__((aligned(16)))
+static uint8_t gOutput[SECTOR_SIZE + 16];
+
+// Encrypts 4 KiB sectors with both tweak generation strategies and
+// checks that they agree, and that decryption round trips, including
+// for sizes requiring ciphertext stealing.
+static int
+run_sector_test(size_t keylen)
+{
+    static const uint8_t kKeys[64] = {
+        0x27,0x18,0x28,0x18,0x28,0x45,0x90,0x45,
+        0x23,0x53,0x60,0x28,0x74,0x71,0x35,0x26,
+        0x62,0x49,0x77,0x57,0x24,0x70,0x93,0x69,
+        0x99,0x59,0x57,0x49,0x66,0x96,0x76,0x27,
+        0x31,0x41,0x59,0x26,0x53,0x58,0x97,0x93,
+        0x23,0x84,0x62,0x64,0x33,0x83,0x27,0x95,
+        0x02,0x88,0x41,0x97,0x16,0x93,0x99,0x37,
+        0x51,0x05,0x82,0x09,0x74,0x94,0x45,0x92,
+    };
+
+    for (size_t i = 0; i < sizeof(gSector); i++) {
+        gSector[i] = (uint8_t)i;
+    }
+
+    struct xts_keys keys;
+    init_keys(&keys, &kKeys[0], &kKeys[32], keylen);
+    struct xts_context ctx;
+    if (xts_init(&ctx, &keys.data, &keys.tweak) != 0) {
+        printf("\nxts_init failed\n");
+        return 1;
+    }
+
+    int rc = 0;
+    for (uint64_t sector = 0; sector < 4 && rc == 0; sector++) {
+        uint128 iv = { .dwords = { 0x1234567800 + sector, 0 } };
+
+        xts_serial_encrypt(&keys, gExpected, gSector, SECTOR_SIZE, iv.bytes);
+        xts_encrypt(&ctx, gOutput, gSector, SECTOR_SIZE, iv.bytes);
+        if (memcmp(gOutput, gExpected, SECTOR_SIZE) != 0) {
+            printf("\nSector %" PRIu64 " mismatch with serial tweaks\n",
+                   sector);
+            rc = 1;
+        }
+
+        // Partial tail, exercises ciphertext stealing after a large batch.
+        const size_t len = SECTOR_SIZE + 1 + (size_t)sector;
+        xts_encrypt(&ctx, gOutput, gSector, len, iv.bytes);
+        if (memcmp(gOutput, gExpected, SECTOR_SIZE - 16) != 0) {
+            printf("\nSector %" PRIu64 " (len %zu) prefix mismatch\n",
+                   sector, len);
+            rc = 1;
+        }
+        xts_decrypt(&ctx, gOutput, gOutput, len, iv.bytes);
+        if (memcmp(gOutput, gSector, len) != 0) {
+            printf("\nSector %" PRIu64 " (len %zu) round trip mismatch\n",
+                   sector, len);
+            rc = 1;
+        }
+    }
+
+    xts_destroy(&ctx);
+    return rc;
+}
+
+// ----------------------------------------------------------------------
+// 4 KiB sector benchmark
+
+#define BENCH_SECTORS (8)
+
+enum XtsBenchMode {
+    kVectorEncrypt,
+    kVectorDecrypt,
+    kSerialEncrypt,
+};
+
+static void
+bench_sectors(const char* name, enum XtsBenchMode mode,
+              const struct xts_context* ctx, const struct xts_keys* keys)
+{
+    uint64_t cycles = 0;
+    uint64_t instret = 0;
+
+    for (uint64_t sector = 0; sector < BENCH_SECTORS; sector++) {
+        const uint128 iv = { .dwords = { sector, 0 } };
+
+        const uint64_t cycle_start = bench_read_cycle();
+        const uint64_t instret_start = bench_read_instret();
+        switch (mode) {
+          case kVectorEncrypt:
+            xts_encrypt(ctx, gOutput, gSector, SECTOR_SIZE, iv.bytes);
+            break;
+          case kVectorDecrypt:
+            xts_decrypt(ctx, gOutput, gSector, SECTOR_SIZE, iv.bytes);
+            break;
+          case kSerialEncrypt:
+            xts_serial_encrypt(keys, gOutput, gSector, SECTOR_SIZE,
+                               iv.bytes);
+            break;
+        }
+        instret += bench_read_instret() - instret_start;
+        cycles += bench_read_cycle() - cycle_start;
+    }
+
+    const uint64_t bytes = BENCH_SECTORS * SECTOR_SIZE;
+    LOG("%-28s: %8" PRIu64 " instret/sector, %6.2f instret/B,"
+        " %6.2f cycles/B",
+        name, instret / BENCH_SECTORS, (double)instret / bytes,
+        (double)cycles / bytes);
+}
+
+static void
+run_benchmarks(size_t keylen)
+{
+    static const uint8_t kKeys[64] = { 1, 2, 3, 4, [32] = 5, 6, 7, 8 };
+
+    struct xts_keys keys;
+    init_keys(&keys, &kKeys[0], &kKeys[32], keylen);
+    struct xts_context ctx;
+    if (xts_init(&ctx, &keys.data, &keys.tweak) != 0) {
+        printf("\nxts_init failed\n");
+        exit(1);
+    }
+
+    LOG("------ XTS-AES-%zu, 4 KiB sectors (VLEN = %" PRIu64 ")",
+        keylen, vlen_bits());
+    bench_sectors("encrypt, vgmul tweaks", kVectorEncrypt, &ctx, &keys);
+    bench_sectors("decrypt, vgmul tweaks", kVectorDecrypt, &ctx, &keys);
+    bench_sectors("encrypt, serial tweak chain", kSerialEncrypt, &ctx, &keys);
+
+    xts_destroy(&ctx);
+}
+
+int
+main()
+{
+    const uint64_t vlen = vlen_bits();
+    LOG("VLEN = %" PRIu64, vlen);
+
+    const size_t num_tests = sizeof(kTests) / sizeof(*kTests);
+    for (size_t i = 0; i < num_tests; i++) {
+        LOG("--- Running '%s' test...", kTests[i].name);
+        if (run_test(&kTests[i]) != 0) {
+            printf("Test '%s' failed\n", kTests[i].name);
+            exit(1);
+        }
+    }
+
+    const size_t kKeylens[] = { 128, 256 };
+    for (size_t i = 0; i < 2; i++) {
+        LOG("--- Running XTS-AES-%zu sector test...", kKeylens[i]);
+        if (run_sector_test(kKeylens[i]) != 0) {
+            printf("XTS-AES-%zu sector test failed\n", kKeylens[i]);
+            exit(1);
+        }
+    }
+    LOG("Success, %zu AES-XTS tests run.", num_tests + 2);
+
+    run_benchmarks(128);
+    run_benchmarks(256);
+    return 0;
+}
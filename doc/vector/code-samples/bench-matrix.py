@@ -0,0 +1,105 @@
+#!/usr/bin/python3
+# SPDX-FileCopyrightText: Copyright (c) 2022 by Rivos Inc.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+#
+# Collects the BENCH lines (see bench.h) of "make bench" logs into a
+# VLEN x LMUL x routine throughput matrix.
+#
+# Routines are grouped by their name less the "_lmul<n>" suffix, so that
+# e.g. zvkned_aes128_encode_vs_lmul1/2/4 are shown as the LMUL=1/2/4 rows
+# of zvkned_aes128_encode_vs. There is one column per VLEN, holding the
+# cycles (or instructions) per byte at one input length.
+
+import argparse
+import csv
+import re
+import sys
+
+from collections import defaultdict
+
+BENCH_RE = re.compile(
+    r'^BENCH vlen=(\d+) lmul=(\d+) routine=(\S+) bytes=(\d+)'
+    r' instret=(\d+) cycles=(\d+)')
+
+
+def parse_logs(paths):
+    rows = []
+    for path in paths:
+        with open(path) as f:
+            for line in f:
+                m = BENCH_RE.match(line)
+                if not m:
+                    continue
+                vlen, lmul, routine, nbytes, instret, cycles = m.groups()
+                rows.append({
+                    'vlen': int(vlen),
+                    'lmul': int(lmul),
+                    'routine': routine,
+                    'family': re.sub(r'_lmul\d+$', '', routine),
+                    'bytes': int(nbytes),
+                    'instret': int(instret),
+                    'cycles': int(cycles),
+                })
+    return rows
+
+
+def print_matrix(rows, metric, nbytes):
+    vlens = sorted(set(r['vlen'] for r in rows))
+    cells = defaultdict(dict)
+    for r in rows:
+        if r['bytes'] == nbytes:
+            cells[(r['family'], r['lmul'])][r['vlen']] = r[metric] / nbytes
+
+    print('%s per byte at %d bytes' % (metric, nbytes))
+    header = '%-32s %4s' % ('routine', 'LMUL') + \
+             ''.join(' %10s' % ('VLEN=%d' % v) for v in vlens)
+    print(header)
+    print('-' * len(header))
+
+    last = None
+    for family, lmul in sorted(cells):
+        if last is not None and family != last:
+            print()
+        last = family
+        line = '%-32s %4s' % (family, lmul if lmul else '-')
+        for v in vlens:
+            value = cells[(family, lmul)].get(v)
+            line += ' %10s' % ('-' if value is None else '%.2f' % value)
+        print(line)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Tabulate "make bench" logs as a VLEN x LMUL x routine'
+                    ' matrix.')
+    parser.add_argument('logs', nargs='+')
+    parser.add_argument('--metric', choices=['cycles', 'instret'],
+                        default='cycles')
+    parser.add_argument('--bytes', type=int, default=None,
+                        help='Input length to show. Default: the longest.')
+    parser.add_argument('--csv', default=None,
+                        help='Also write every measurement to this file.')
+    args = parser.parse_args()
+
+    rows = parse_logs(args.logs)
+    if not rows:
+        sys.stderr.write('bench-matrix.py: no BENCH lines found\n')
+        sys.exit(1)
+
+    nbytes = args.bytes or max(r['bytes'] for r in rows)
+    print_matrix(rows, args.metric, nbytes)
+
+    if args.csv:
+        with open(args.csv, 'w') as f:
+            writer = csv.DictWriter(f, fieldnames=[
+                'routine', 'family', 'lmul', 'vlen', 'bytes', 'instret',
+                'cycles'])
+            writer.writeheader()
+            for r in sorted(rows, key=lambda r: (
+                    r['family'], r['lmul'], r['vlen'], r['bytes'])):
+                writer.writerow(r)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,95 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bench.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log.h"
+#include "vlen-bits.h"
+
+uint64_t
+bench_read_cycle(void)
+{
+    uint64_t cycle;
+    __asm__ volatile("rdcycle %0" : "=r"(cycle));
+    return cycle;
+}
+
+uint64_t
+bench_read_instret(void)
+{
+    uint64_t instret;
+    __asm__ volatile("rdinstret %0" : "=r"(instret));
+    return instret;
+}
+
+bool
+bench_requested(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bench") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns the <n> of a "..._lmul<n>" routine name, or 0 if there is none.
+static unsigned
+routine_lmul(const char* routine)
+{
+    const char* suffix = strstr(routine, "_lmul");
+    return suffix != NULL ? (unsigned)strtoul(suffix + 5, NULL, 10) : 0;
+}
+
+void
+bench_sweep(
+    const char* routine,
+    bench_fn_t fn,
+    const void* ctx,
+    size_t granule
+) {
+    __attribute__((aligned(16)))
+    static uint8_t buf[BENCH_MAX_BYTES];
+
+    const uint64_t vlen = vlen_bits();
+    const unsigned lmul = routine_lmul(routine);
+
+    for (size_t len = BENCH_MIN_BYTES; len <= BENCH_MAX_BYTES; len *= 2) {
+        const size_t run_len = len - (len % granule);
+        if (run_len == 0) {
+            continue;
+        }
+        memset(buf, 0x5a, run_len);
+
+        // Warm up.
+        fn(ctx, buf, run_len);
+
+        const uint64_t cycle_start = bench_read_cycle();
+        const uint64_t instret_start = bench_read_instret();
+        for (size_t i = 0; i < BENCH_ITERATIONS; i++) {
+            fn(ctx, buf, run_len);
+        }
+        const uint64_t instret = bench_read_instret() - instret_start;
+        const uint64_t cycles = bench_read_cycle() - cycle_start;
+
+        LOG("BENCH vlen=%" PRIu64 " lmul=%u routine=%s bytes=%zu"
+            " instret=%" PRIu64 " cycles=%" PRIu64,
+            vlen, lmul, routine, run_len,
+            instret / BENCH_ITERATIONS, cycles / BENCH_ITERATIONS);
+    }
+}
@@ -0,0 +1,74 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmark mode of the test programs.
+//
+// A test program started with "--bench" skips its known answer tests,
+// and times each routine of its routine table over a sweep of input
+// lengths instead. Each measurement is logged as one line of the form
+//
+//   BENCH vlen=<bits> lmul=<n> routine=<name> bytes=<n> instret=<n> cycles=<n>
+//
+// where instret and cycles are per call, averaged over BENCH_ITERATIONS
+// calls. bench-matrix.py collects these lines from the logs of the
+// "make bench" runs.
+//
+// Spike reports a cycle count equal to the retired instruction count,
+// the two only differ on hardware (or timing model) runs.
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Shortest and longest input lengths of a sweep, doubling in between.
+#define BENCH_MIN_BYTES (64)
+#define BENCH_MAX_BYTES (16384)
+
+// Number of timed calls per length, after one warm up call.
+#define BENCH_ITERATIONS (8)
+
+// A routine being timed, run in place over 'len' bytes of 'buf'.
+typedef void (*bench_fn_t)(
+    const void* ctx,
+    uint8_t* buf,
+    size_t len
+);
+
+// Current values of the cycle and retired instruction counters, for the
+// programs that time their own routines outside of bench_sweep().
+extern uint64_t
+bench_read_cycle(void);
+
+extern uint64_t
+bench_read_instret(void);
+
+// Returns true if the program was started with "--bench".
+extern bool
+bench_requested(int argc, char** argv);
+
+// Times 'fn' over each length of the sweep, rounded down to a multiple
+// of 'granule', and logs one BENCH line per length. The LMUL logged is
+// taken from the "_lmul<n>" suffix of 'routine', if it has one.
+extern void
+bench_sweep(
+    const char* routine,
+    bench_fn_t fn,
+    const void* ctx,
+    size_t granule
+);
+
+#endif  // BENCH_H_
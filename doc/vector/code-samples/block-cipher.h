@@ -0,0 +1,54 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef BLOCK_CIPHER_H_
+#define BLOCK_CIPHER_H_
+
+#include <stdint.h>
+
+// Size in bytes of the blocks of the ciphers supported by the mode
+// drivers (AES and SM4 both use 128 bit blocks).
+#define BLOCK_CIPHER_BLOCK_SIZE (16)
+
+// Function pointer type for routines encoding 'n' bytes, a multiple
+// of BLOCK_CIPHER_BLOCK_SIZE, from 'src' into 'dest', one block at a time
+// (i.e., in ECB mode), using a pre-expanded key. Returns the number of
+// bytes processed.
+//
+// The Zvkned and Zvksed ".vs" encoding routines have this signature, e.g.,
+//   zvkned_aes128_encode_vs_lmul4, zvksed_sm4_encode_vs.
+//
+// Modes of operation issue all independent blocks in a single call so
+// that they end up in different element groups of the same vector
+// register group. Most of them (CTR, GCM, CCM) only ever call the forward
+// (encode) direction of the cipher.
+typedef uint64_t (block_encode_fn_t)(
+   void* dest,
+   const void* src,
+   uint64_t n,
+   const uint32_t* expanded_key
+);
+
+struct block_cipher {
+    const char* name;
+    block_encode_fn_t* encode;
+    // Inverse cipher, e.g., zvkned_aes128_decode_vs_lmul2. Only required
+    // by modes decrypting with the inverse cipher (XTS), may be NULL.
+    block_encode_fn_t* decode;
+    // Expanded key passed to 'encode' and 'decode', 32b aligned.
+    const uint32_t* expanded_key;
+};
+
+#endif  // BLOCK_CIPHER_H_
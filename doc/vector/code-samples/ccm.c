@@ -0,0 +1,250 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ccm.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+typedef union uint128 {
+    uint64_t dwords[2];
+    uint32_t words[4];
+    uint8_t bytes[16];
+} uint128;
+
+// State of the serial CBC-MAC computation over the formatted header
+// (B0 followed by the encoded AAD).
+//
+// The input of the next cipher invocation, Y_{i-1} ^ B_i, is kept
+// "pending" rather than encoded right away. This lets the last header
+// block be encoded together with the first counter block.
+struct cbc_mac {
+    const struct block_cipher* cipher;
+    uint128 pending;
+    // Partial block being assembled, 'fill' bytes are valid.
+    uint128 partial;
+    size_t fill;
+};
+
+static void
+cbc_mac_block(struct cbc_mac* mac, const uint128* block)
+{
+    uint128 Y;
+    mac->cipher->encode(&Y, &mac->pending, 16, mac->cipher->expanded_key);
+    mac->pending.dwords[0] = Y.dwords[0] ^ block->dwords[0];
+    mac->pending.dwords[1] = Y.dwords[1] ^ block->dwords[1];
+}
+
+static void
+cbc_mac_absorb(struct cbc_mac* mac, const uint8_t* data, size_t len)
+{
+    while (len > 0) {
+        const size_t n = MIN(len, 16 - mac->fill);
+        memcpy(&mac->partial.bytes[mac->fill], data, n);
+        mac->fill += n;
+        data += n;
+        len -= n;
+        if (mac->fill == 16) {
+            cbc_mac_block(mac, &mac->partial);
+            mac->fill = 0;
+        }
+    }
+}
+
+// Pads the partial block, if any, with zeroes.
+static void
+cbc_mac_pad(struct cbc_mac* mac)
+{
+    if (mac->fill != 0) {
+        memset(&mac->partial.bytes[mac->fill], 0, 16 - mac->fill);
+        cbc_mac_block(mac, &mac->partial);
+        mac->fill = 0;
+    }
+}
+
+// Writes 'value' in big-endian format in the last 'q' bytes of 'block'.
+static void
+store_be(uint128* block, size_t q, uint64_t value)
+{
+    for (size_t i = 0; i < q; i++) {
+        block->bytes[15 - i] = (uint8_t)value;
+        value >>= 8;
+    }
+}
+
+// Shared logic of ccm_encrypt/ccm_decrypt.
+//
+// The CBC-MAC is inherently serial while CTR is parallel. Both are run
+// in a single loop, each iteration encoding two blocks, the MAC input and
+// a counter block, with a single call to the cipher. The two blocks land
+// in different element groups of the same vector register group, hence
+// the CTR encryption comes "for free" in the latency shadow of the MAC.
+//
+// For decryption the MAC input for block i is the plain text, which is
+// only known once the keystream block S_i has been computed. To use the
+// same schedule for both directions, the MAC lags one block behind CTR:
+// iteration i encodes (Y_{i-1} ^ P_{i-1}, Ctr_i). The extra iteration at
+// the end encodes the last MAC input together with Ctr_0, whose encoding
+// S_0 masks the tag.
+static void
+ccm_transform(
+    const struct block_cipher* cipher,
+    bool encrypt,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t* nonce,
+    size_t noncelen,
+    const uint8_t* aad,
+    size_t aadlen,
+    uint8_t* tag,
+    size_t taglen
+)
+{
+    assert(noncelen >= 7 && noncelen <= 13);
+    assert(taglen >= 4 && taglen <= 16 && (taglen % 2) == 0);
+
+    // Size of the length field (a.k.a. L in RFC 3610).
+    const size_t q = 15 - noncelen;
+    assert(q >= 8 || len < ((uint64_t)1 << (8 * q)));
+    // The 0xffff prefix (64 bits lengths) is not supported.
+    assert(aadlen <= UINT32_MAX);
+
+    // Formatting of B0 (SP 800-38C, A.2.1)
+    //   Flags || N || Q
+    //   Flags = 0 || Adata || [(t-2)/2]_3 || [q-1]_3
+    uint128 b0 = {};
+    b0.bytes[0] = (aadlen > 0 ? 0x40 : 0) |
+                  (uint8_t)(((taglen - 2) / 2) << 3) |
+                  (uint8_t)(q - 1);
+    memcpy(&b0.bytes[1], nonce, noncelen);
+    store_be(&b0, q, len);
+
+    // Formatting of the counter blocks (SP 800-38C, A.3)
+    //   Flags || N || [i]_8q
+    //   Flags = 0 || 0 || 000 || [q-1]_3
+    uint128 ctr = {};
+    ctr.bytes[0] = (uint8_t)(q - 1);
+    memcpy(&ctr.bytes[1], nonce, noncelen);
+
+    struct cbc_mac mac = {
+        .cipher = cipher,
+        .pending = b0,  // Y_{-1} is 0
+        .fill = 0,
+    };
+
+    // Formatting of the associated data (SP 800-38C, A.2.2)
+    if (aadlen > 0) {
+        uint8_t encoded_len[6];
+        size_t encoded_len_size;
+        if (aadlen < 0xff00) {
+            encoded_len[0] = (uint8_t)(aadlen >> 8);
+            encoded_len[1] = (uint8_t)aadlen;
+            encoded_len_size = 2;
+        } else {
+            encoded_len[0] = 0xff;
+            encoded_len[1] = 0xfe;
+            encoded_len[2] = (uint8_t)(aadlen >> 24);
+            encoded_len[3] = (uint8_t)(aadlen >> 16);
+            encoded_len[4] = (uint8_t)(aadlen >> 8);
+            encoded_len[5] = (uint8_t)aadlen;
+            encoded_len_size = 6;
+        }
+        cbc_mac_absorb(&mac, encoded_len, encoded_len_size);
+        cbc_mac_absorb(&mac, aad, aadlen);
+        cbc_mac_pad(&mac);
+    }
+
+    // in[0]: CBC-MAC input, in[1]: counter block
+    // out[0]: CBC-MAC state, out[1]: keystream block
+    __attribute__((aligned(16)))
+    uint128 in[2];
+    __attribute__((aligned(16)))
+    uint128 out[2];
+
+    in[0] = mac.pending;
+    for (size_t i = 1; ; i++) {
+        const size_t offset = 16 * (i - 1);
+        const bool last = offset >= len;
+
+        in[1] = ctr;
+        store_be(&in[1], q, last ? 0 : i);
+        cipher->encode(out, in, sizeof(in), cipher->expanded_key);
+        if (last) {
+            break;
+        }
+
+        // The MAC is computed over the (zero padded) plain text.
+        const size_t n = MIN(16, len - offset);
+        uint128 block = {};
+        if (encrypt) {
+            memcpy(&block, &src[offset], n);
+        }
+        for (size_t j = 0; j < n; j++) {
+            dest[offset + j] = src[offset + j] ^ out[1].bytes[j];
+        }
+        if (!encrypt) {
+            memcpy(&block, &dest[offset], n);
+        }
+        in[0].dwords[0] = out[0].dwords[0] ^ block.dwords[0];
+        in[0].dwords[1] = out[0].dwords[1] ^ block.dwords[1];
+    }
+
+    // T = MSB_t(Y_r) xor MSB_t(S_0)
+    for (size_t j = 0; j < taglen; j++) {
+        tag[j] = out[0].bytes[j] ^ out[1].bytes[j];
+    }
+}
+
+void
+ccm_encrypt(
+    const struct block_cipher* cipher,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t* nonce,
+    size_t noncelen,
+    const uint8_t* aad,
+    size_t aadlen,
+    uint8_t* tag,
+    size_t taglen
+)
+{
+    ccm_transform(cipher, true, dest, src, len, nonce, noncelen,
+                  aad, aadlen, tag, taglen);
+}
+
+void
+ccm_decrypt(
+    const struct block_cipher* cipher,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t* nonce,
+    size_t noncelen,
+    const uint8_t* aad,
+    size_t aadlen,
+    uint8_t* tag,
+    size_t taglen
+)
+{
+    ccm_transform(cipher, false, dest, src, len, nonce, noncelen,
+                  aad, aadlen, tag, taglen);
+}
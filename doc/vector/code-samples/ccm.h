@@ -0,0 +1,66 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef CCM_H_
+#define CCM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "block-cipher.h"
+
+// Counter with CBC-MAC mode (NIST SP 800-38C, RFC 3610) on top of any
+// 128 bit block cipher.
+//
+// 'noncelen' shall be in [7, 13], 'taglen' an even number in [4, 16].
+// 'len' bytes are read from 'src' and the transformed text is written to
+// 'dest' ('src' and 'dest' may alias). 'taglen' bytes of authentication
+// tag are written to 'tag'.
+//
+// For decryption the tag is computed over the recovered plain text, it is
+// the responsibility of the caller to compare it with the expected tag
+// before releasing the plain text.
+//
+// All buffers should be 32b aligned on processors that do not support
+// unaligned vector accesses.
+extern void
+ccm_encrypt(
+    const struct block_cipher* cipher,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t* nonce,
+    size_t noncelen,
+    const uint8_t* aad,
+    size_t aadlen,
+    uint8_t* tag,
+    size_t taglen
+);
+
+extern void
+ccm_decrypt(
+    const struct block_cipher* cipher,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t* nonce,
+    size_t noncelen,
+    const uint8_t* aad,
+    size_t aadlen,
+    uint8_t* tag,
+    size_t taglen
+);
+
+#endif  // CCM_H_
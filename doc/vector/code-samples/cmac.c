@@ -0,0 +1,78 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cmac.h"
+
+typedef union uint128 {
+    uint64_t dwords[2];
+    uint32_t words[4];
+    uint8_t bytes[16];
+} uint128;
+
+// Multiplication by x in GF(2^128), with the big-endian bit ordering
+// used by SP 800-38B (the MSB of byte 0 is the highest degree term).
+static void
+cmac_double(uint128* out, const uint128* in)
+{
+    const uint8_t msb = in->bytes[0] >> 7;
+    for (size_t i = 0; i < 15; i++) {
+        out->bytes[i] = (in->bytes[i] << 1) | (in->bytes[i + 1] >> 7);
+    }
+    out->bytes[15] = (in->bytes[15] << 1) ^ (msb ? 0x87 : 0);
+}
+
+void
+cmac(
+    const struct block_cipher* cipher,
+    const uint8_t* msg,
+    size_t len,
+    uint8_t mac[CMAC_TAG_SIZE]
+)
+{
+    uint128 k = {0};
+    uint128 x = {0};
+    uint128 last = {0};
+
+    // Subkeys: L = E_K(0^128), K1 = L.x, K2 = L.x^2.
+    cipher->encode(&k, &k, 16, cipher->expanded_key);
+    cmac_double(&k, &k);
+
+    // The last block (complete or not) is always held back as it gets
+    // a subkey mixed in. The empty message is one incomplete block.
+    const size_t full = (len == 0) ? 0 : (len - 1) / 16;
+    const size_t rem = len - 16 * full;
+
+    for (size_t i = 0; i < full; i++) {
+        uint128 block;
+        memcpy(&block, &msg[16 * i], 16);
+        x.dwords[0] ^= block.dwords[0];
+        x.dwords[1] ^= block.dwords[1];
+        cipher->encode(&x, &x, 16, cipher->expanded_key);
+    }
+
+    memcpy(&last, &msg[16 * full], rem);
+    if (rem != 16) {
+        last.bytes[rem] = 0x80;
+        cmac_double(&k, &k);
+    }
+
+    x.dwords[0] ^= last.dwords[0] ^ k.dwords[0];
+    x.dwords[1] ^= last.dwords[1] ^ k.dwords[1];
+    cipher->encode(&x, &x, 16, cipher->expanded_key);
+    memcpy(mac, &x, CMAC_TAG_SIZE);
+}
@@ -0,0 +1,40 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef CMAC_H_
+#define CMAC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "block-cipher.h"
+
+#define CMAC_TAG_SIZE (16)
+
+// Cipher-based MAC (NIST SP 800-38B, RFC 4493) on top of any 128 bit
+// block cipher. 'len' bytes of 'msg' are authenticated, the full 16 byte
+// MAC is written to 'mac'. 'len' may be zero.
+//
+// CMAC is a single serial CBC chain, one block cipher invocation per
+// 16 bytes of message.
+extern void
+cmac(
+    const struct block_cipher* cipher,
+    const uint8_t* msg,
+    size_t len,
+    uint8_t mac[CMAC_TAG_SIZE]
+);
+
+#endif  // CMAC_H_
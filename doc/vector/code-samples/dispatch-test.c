@@ -0,0 +1,149 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks the VLEN aware entry points of dispatch.h against the FIPS-197
+// AES-128 example and the "abc" examples of SHA-256 and SM3, and logs
+// which implementation each one picked.
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dispatch.h"
+#include "log.h"
+#include "vlen-bits.h"
+#include "zvkned.h"
+#include "zvknh.h"
+
+// FIPS-197, Appendix C.1
+__attribute__((aligned(16)))
+static const uint8_t kAesKey[16] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kAesPlaintext[16] = {
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+    0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff,
+};
+
+static const uint8_t kAesCiphertext[16] = {
+    0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+    0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a,
+};
+
+// "abc", padded to one block. The message length sits in the last byte
+// for both SHA-256 and SM3.
+__attribute__((aligned(16)))
+static const uint8_t kAbcBlock[64] = {
+    0x61, 0x62, 0x63, 0x80, [63] = 0x18,
+};
+
+static const uint8_t kSha256Abc[32] = {
+    0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,
+    0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+    0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+    0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad,
+};
+
+// GB/T 32905-2016, Example 1.
+static const uint8_t kSm3Abc[32] = {
+    0x66, 0xc7, 0xf0, 0xf4, 0x62, 0xee, 0xed, 0xd9,
+    0xd1, 0xf2, 0xd4, 0x6b, 0xdc, 0x10, 0xe4, 0xe2,
+    0x41, 0x67, 0xc4, 0x87, 0x5c, 0xf2, 0xf7, 0xa2,
+    0x29, 0x7d, 0xa0, 0x2b, 0x8f, 0x4b, 0xa8, 0xe0,
+};
+
+// Converts a SHA-256 state from the order of kSha256InitialHash to the
+// big endian digest of FIPS 180-4.
+static void
+sha256_digest(uint8_t* digest, const uint8_t* hash)
+{
+    // Word order of the state: f, e, b, a, h, g, d, c.
+    static const int kWord[8] = { 3, 2, 7, 6, 1, 0, 5, 4 };
+    uint32_t words[8];
+
+    memcpy(words, hash, sizeof(words));
+    for (int i = 0; i < 8; i++) {
+        const uint32_t w = words[kWord[i]];
+        digest[4 * i + 0] = w >> 24;
+        digest[4 * i + 1] = w >> 16;
+        digest[4 * i + 2] = w >> 8;
+        digest[4 * i + 3] = w;
+    }
+}
+
+static int
+check(const char* name, const char* impl, const uint8_t* got,
+      const uint8_t* expected, size_t len)
+{
+    if (memcmp(got, expected, len) != 0) {
+        LOG("*** %s (%s) failed", name, impl);
+        return 1;
+    }
+    LOG("- %s -> %s: passed", name, impl);
+    return 0;
+}
+
+int
+main()
+{
+    const uint64_t vlen = vlen_bits();
+    LOG("VLEN = %" PRIu64, vlen);
+
+    int failures = 0;
+
+    uint32_t expanded[44];
+    zvkned_aes128_expand_key(expanded, kAesKey);
+
+    __attribute__((aligned(16)))
+    uint8_t block[16];
+
+    aes128_encrypt_ecb(block, kAesPlaintext, sizeof(block), expanded);
+    failures += check("aes128_encrypt_ecb", aes128_encrypt_ecb_impl(),
+                      block, kAesCiphertext, sizeof(block));
+
+    // The AES decode routines take the same expanded key as the encode
+    // ones, and apply it in reverse.
+    aes128_decrypt_ecb(block, kAesCiphertext, sizeof(block), expanded);
+    failures += check("aes128_decrypt_ecb", aes128_decrypt_ecb_impl(),
+                      block, kAesPlaintext, sizeof(block));
+
+    if (vlen >= 128) {
+        uint8_t hash[SHA256_DIGEST_SIZE];
+        uint8_t digest[SHA256_DIGEST_SIZE];
+        memcpy(hash, kSha256InitialHash, sizeof(hash));
+        sha256_blocks(hash, kAbcBlock, 1);
+        sha256_digest(digest, hash);
+        failures += check("sha256_blocks", sha256_blocks_impl(),
+                          digest, kSha256Abc, sizeof(digest));
+    } else {
+        LOG("Skipping sha256_blocks, VLEN < 128");
+    }
+
+    __attribute__((aligned(16)))
+    uint8_t sm3[32];
+    sm3_hash(sm3, kAbcBlock, sizeof(kAbcBlock));
+    failures += check("sm3_hash", sm3_hash_impl(), sm3, kSm3Abc, sizeof(sm3));
+
+    if (failures != 0) {
+        printf("%d dispatch tests failed\n", failures);
+        exit(1);
+    }
+    LOG("Success, all dispatched routines passed.");
+    return 0;
+}
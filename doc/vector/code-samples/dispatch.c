@@ -0,0 +1,294 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dispatch.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "log.h"
+#include "routines.h"
+#include "vlen-bits.h"
+#include "zvkned.h"
+#include "zvknh.h"
+#include "zvksh.h"
+
+struct impl {
+    const char* name;
+    // Minimum VLEN (bits) the implementation runs with.
+    size_t min_vlen;
+    union {
+        aes_transform_t* aes;
+        block_fn_t sha256;
+        hash_fn_t sm3;
+    } fn;
+};
+
+struct dispatch {
+    const char* name;
+    // Number of entries of the routine table the candidates come from.
+    size_t count;
+    // Sets 'impl' to entry 'i' of that table, and returns false if the
+    // entry does not implement this function.
+    bool (*candidate)(size_t i, struct impl* impl);
+    // Returns the cycles one call of 'impl' takes over 'len' bytes.
+    uint64_t (*time)(const struct impl* impl, uint8_t* buf, size_t len);
+    // The pick, once made. The name is NULL until then.
+    struct impl selected;
+};
+
+// ----------------------------------------------------------------------
+// Candidates
+//
+// Taken from the routine tables of routines.h, which the known answer
+// tests run too, in their order of preference.
+
+static bool
+aes_candidate(size_t i, size_t keylen, enum TransformDirection direction,
+              struct impl* impl)
+{
+    const struct aes_routine* const routine = &kAESRoutines[i];
+    if (routine->keylen != keylen || routine->direction != direction) {
+        return false;
+    }
+    impl->name = routine->name;
+    impl->min_vlen = routine->min_vlen;
+    impl->fn.aes = routine->fn;
+    return true;
+}
+
+static bool
+aes128_encrypt_candidate(size_t i, struct impl* impl)
+{
+    return aes_candidate(i, 128, kEncode, impl);
+}
+
+static bool
+aes128_decrypt_candidate(size_t i, struct impl* impl)
+{
+    return aes_candidate(i, 128, kDecode, impl);
+}
+
+static bool
+sha256_candidate(size_t i, struct impl* impl)
+{
+    impl->name = sha256_routines[i].name;
+    impl->min_vlen = sha256_routines[i].min_vlen;
+    impl->fn.sha256 = sha256_routines[i].hash_fn;
+    return true;
+}
+
+static bool
+sm3_candidate(size_t i, struct impl* impl)
+{
+    impl->name = sm3_routines[i].name;
+    impl->min_vlen = sm3_routines[i].min_vlen;
+    impl->fn.sm3 = sm3_routines[i].hash_fn;
+    return true;
+}
+
+// ----------------------------------------------------------------------
+// Calibration
+
+static uint64_t
+time_aes(const struct impl* impl, uint8_t* buf, size_t len)
+{
+    __attribute__((aligned(16)))
+    static const uint8_t kKey[16] = { 0 };
+    uint32_t expanded[44];
+
+    zvkned_aes128_expand_key(expanded, kKey);
+    const uint64_t start = bench_read_cycle();
+    impl->fn.aes(buf, buf, len, expanded);
+    return bench_read_cycle() - start;
+}
+
+static uint64_t
+time_sha256(const struct impl* impl, uint8_t* buf, size_t len)
+{
+    uint8_t hash[SHA256_DIGEST_SIZE];
+
+    memcpy(hash, kSha256InitialHash, sizeof(hash));
+    const uint64_t start = bench_read_cycle();
+    for (size_t i = 0; i < len; i += SHA256_BLOCK_SIZE) {
+        impl->fn.sha256(hash, buf + i);
+    }
+    return bench_read_cycle() - start;
+}
+
+static uint64_t
+time_sm3(const struct impl* impl, uint8_t* buf, size_t len)
+{
+    __attribute__((aligned(16)))
+    uint32_t hash[8];
+
+    const uint64_t start = bench_read_cycle();
+    impl->fn.sm3(hash, buf, len);
+    return bench_read_cycle() - start;
+}
+
+static struct dispatch aes128_encrypt_dispatch = {
+    "aes128_encrypt_ecb", NUM_AES_ROUTINES, aes128_encrypt_candidate,
+    time_aes, { NULL },
+};
+
+static struct dispatch aes128_decrypt_dispatch = {
+    "aes128_decrypt_ecb", NUM_AES_ROUTINES, aes128_decrypt_candidate,
+    time_aes, { NULL },
+};
+
+static struct dispatch sha256_dispatch = {
+    "sha256_blocks", NUM_SHA256_ROUTINES, sha256_candidate, time_sha256,
+    { NULL },
+};
+
+static struct dispatch sm3_dispatch = {
+    "sm3_hash", NUM_SM3_ROUTINES, sm3_candidate, time_sm3, { NULL },
+};
+
+#if defined(DISPATCH_STATIC)
+
+// Picks the first implementation of 'd' the running VLEN allows.
+static void
+dispatch_pick(struct dispatch* d)
+{
+    const uint64_t vlen = vlen_bits();
+    struct impl impl;
+
+    for (size_t i = 0; i < d->count; i++) {
+        if (d->candidate(i, &impl) && vlen >= impl.min_vlen) {
+            d->selected = impl;
+            return;
+        }
+    }
+
+    LOG("*** %s: no implementation supports VLEN=%" PRIu64, d->name, vlen);
+    abort();
+}
+
+#else
+
+// Picks the fastest implementation of 'd' the running VLEN allows.
+static void
+dispatch_pick(struct dispatch* d)
+{
+    __attribute__((aligned(16)))
+    static uint8_t buf[DISPATCH_CALIBRATION_BYTES];
+
+    const uint64_t vlen = vlen_bits();
+    uint64_t best_cycles = UINT64_MAX;
+    struct impl impl;
+
+    memset(buf, 0x5a, sizeof(buf));
+
+    for (size_t i = 0; i < d->count; i++) {
+        if (!d->candidate(i, &impl) || vlen < impl.min_vlen) {
+            continue;
+        }
+        // Warm up, then keep the faster of two timed calls.
+        d->time(&impl, buf, sizeof(buf));
+        uint64_t cycles = d->time(&impl, buf, sizeof(buf));
+        const uint64_t again = d->time(&impl, buf, sizeof(buf));
+        if (again < cycles) {
+            cycles = again;
+        }
+        if (cycles < best_cycles) {
+            d->selected = impl;
+            best_cycles = cycles;
+        }
+    }
+
+    if (d->selected.name == NULL) {
+        LOG("*** %s: no implementation supports VLEN=%" PRIu64,
+            d->name, vlen);
+        abort();
+    }
+}
+
+#endif  // DISPATCH_STATIC
+
+static inline const struct impl*
+dispatch_get(struct dispatch* d)
+{
+    if (d->selected.name == NULL) {
+        dispatch_pick(d);
+    }
+    return &d->selected;
+}
+
+// ----------------------------------------------------------------------
+// Entry points
+
+void
+aes128_encrypt_ecb(
+    void* dest,
+    const void* src,
+    uint64_t n,
+    const uint32_t* expanded_key
+) {
+    dispatch_get(&aes128_encrypt_dispatch)->fn.aes(dest, src, n, expanded_key);
+}
+
+void
+aes128_decrypt_ecb(
+    void* dest,
+    const void* src,
+    uint64_t n,
+    const uint32_t* expanded_key
+) {
+    dispatch_get(&aes128_decrypt_dispatch)->fn.aes(dest, src, n, expanded_key);
+}
+
+void
+sha256_blocks(uint8_t* hash, const void* blocks, size_t nblocks)
+{
+    const block_fn_t fn = dispatch_get(&sha256_dispatch)->fn.sha256;
+    const uint8_t* block = blocks;
+    for (size_t i = 0; i < nblocks; i++) {
+        fn(hash, block + i * SHA256_BLOCK_SIZE);
+    }
+}
+
+void
+sm3_hash(void* dest, const void* src, uint64_t length)
+{
+    dispatch_get(&sm3_dispatch)->fn.sm3(dest, src, length);
+}
+
+const char*
+aes128_encrypt_ecb_impl(void)
+{
+    return dispatch_get(&aes128_encrypt_dispatch)->name;
+}
+
+const char*
+aes128_decrypt_ecb_impl(void)
+{
+    return dispatch_get(&aes128_decrypt_dispatch)->name;
+}
+
+const char*
+sha256_blocks_impl(void)
+{
+    return dispatch_get(&sha256_dispatch)->name;
+}
+
+const char*
+sm3_hash_impl(void)
+{
+    return dispatch_get(&sm3_dispatch)->name;
+}
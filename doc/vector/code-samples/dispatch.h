@@ -0,0 +1,81 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// VLEN aware dispatch of the AES-128, SHA-256 and SM3 routines.
+//
+// Each function below has several implementations, which differ in the
+// LMUL (and so the minimum VLEN) they use. The first call of a function
+// picks, for the VLEN of the running hart, the fastest implementation
+// that VLEN allows, and every later call goes straight to it.
+//
+// The pick is made by timing each legal implementation over
+// DISPATCH_CALIBRATION_BYTES of input with rdcycle, ties going to the
+// earlier entry of a static preference table. Building with
+// -DDISPATCH_STATIC skips the timing, and takes the first legal entry
+// of the table instead.
+
+#ifndef DISPATCH_H_
+#define DISPATCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Input length each implementation is timed over when calibrating.
+#define DISPATCH_CALIBRATION_BYTES (1024)
+
+// AES-128 ECB encryption of 'n' bytes (a multiple of 16) from 'src' to
+// 'dest', with a key expanded by zvkned_aes128_expand_key.
+extern void
+aes128_encrypt_ecb(
+    void* dest,
+    const void* src,
+    uint64_t n,
+    const uint32_t* expanded_key
+);
+
+// AES-128 ECB decryption, as aes128_encrypt_ecb.
+extern void
+aes128_decrypt_ecb(
+    void* dest,
+    const void* src,
+    uint64_t n,
+    const uint32_t* expanded_key
+);
+
+// Updates the SHA-256 state 'hash' with 'nblocks' 64 byte blocks.
+// 'hash' is kept in the order of kSha256InitialHash (see zvknh.h).
+extern void
+sha256_blocks(
+    uint8_t* hash,
+    const void* blocks,
+    size_t nblocks
+);
+
+// SM3 hash of 'length' bytes (a multiple of 64) of an already padded
+// message, written as 32 bytes to 'dest'.
+extern void
+sm3_hash(
+    void* dest,
+    const void* src,
+    uint64_t length
+);
+
+// Name of the implementation each function dispatches to. Picks one if
+// that has not happened yet.
+extern const char* aes128_encrypt_ecb_impl(void);
+extern const char* aes128_decrypt_ecb_impl(void);
+extern const char* sha256_blocks_impl(void);
+extern const char* sm3_hash_impl(void);
+
+#endif  // DISPATCH_H_
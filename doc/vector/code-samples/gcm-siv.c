@@ -0,0 +1,213 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "block-cipher.h"
+#include "gcm-siv.h"
+#include "polyval.h"
+#include "zvkned.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+// Number of counter blocks encoded per call to the block cipher.
+#define GCM_SIV_CTR_BATCH_BLOCKS (16)
+
+typedef union uint128 {
+    uint64_t dwords[2];
+    uint32_t words[4];
+    uint8_t bytes[16];
+} uint128;
+
+// Per-nonce keys (RFC 8452, Section 4).
+struct derived_keys {
+    struct polyval_key auth;
+    struct aes_gcm_siv_key enc;
+};
+
+static block_encode_fn_t*
+aes_encode_fn(size_t keylen)
+{
+    return keylen == 128 ? &zvkned_aes128_encode_vs_lmul4
+                         : &zvkned_aes256_encode_vs_lmul4;
+}
+
+void
+aes_gcm_siv_init(
+    struct aes_gcm_siv_key* key,
+    const uint8_t* raw_key,
+    size_t keylen
+)
+{
+    assert(keylen == 128 || keylen == 256);
+    key->keylen = keylen;
+    if (keylen == 128) {
+        zvkned_aes128_expand_key(key->expanded, raw_key);
+    } else {
+        zvkned_aes256_expand_key(key->expanded, raw_key);
+    }
+}
+
+// The i-th derived block is the first half of AES(K, LE32(i) || nonce).
+// The 4 (AES-128) or 6 (AES-256) blocks are encoded in a single call.
+static void
+derive_keys(
+    const struct aes_gcm_siv_key* key,
+    const uint8_t nonce[GCM_SIV_NONCE_SIZE],
+    struct derived_keys* derived
+)
+{
+    const size_t nblocks = key->keylen == 128 ? 4 : 6;
+    uint128 in[6];
+    uint128 out[6];
+    for (size_t i = 0; i < nblocks; i++) {
+        in[i].words[0] = (uint32_t)i;
+        memcpy(&in[i].bytes[4], nonce, GCM_SIV_NONCE_SIZE);
+    }
+    aes_encode_fn(key->keylen)(out, in, 16 * nblocks, key->expanded);
+
+    uint128 auth_key;
+    auth_key.dwords[0] = out[0].dwords[0];
+    auth_key.dwords[1] = out[1].dwords[0];
+    polyval_init(&derived->auth, auth_key.bytes);
+
+    uint8_t enc_key[32];
+    for (size_t i = 2; i < nblocks; i++) {
+        memcpy(&enc_key[8 * (i - 2)], &out[i].dwords[0], 8);
+    }
+    aes_gcm_siv_init(&derived->enc, enc_key, key->keylen);
+}
+
+static void
+compute_tag(
+    const struct derived_keys* derived,
+    const uint8_t* pt,
+    size_t len,
+    const uint8_t nonce[GCM_SIV_NONCE_SIZE],
+    const uint8_t* aad,
+    size_t aadlen,
+    uint128* tag
+)
+{
+    uint128 S = {};
+    polyval_update(&derived->auth, S.bytes, aad, aadlen);
+    polyval_update(&derived->auth, S.bytes, pt, len);
+
+    // Length block: LE64(bit length of AAD) || LE64(bit length of text)
+    uint128 lengths;
+    lengths.dwords[0] = (uint64_t)aadlen * 8;
+    lengths.dwords[1] = (uint64_t)len * 8;
+    polyval_update(&derived->auth, S.bytes, lengths.bytes, 16);
+
+    for (size_t i = 0; i < GCM_SIV_NONCE_SIZE; i++) {
+        S.bytes[i] ^= nonce[i];
+    }
+    S.bytes[15] &= 0x7f;
+    aes_encode_fn(derived->enc.keylen)(tag, &S, 16, derived->enc.expanded);
+}
+
+// CTR mode with a 32 bit little-endian counter in the first word of the
+// block, starting from the tag with its most significant bit set.
+static void
+ctr32(
+    const struct aes_gcm_siv_key* key,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint128* tag
+)
+{
+    block_encode_fn_t* const encode = aes_encode_fn(key->keylen);
+
+    uint128 counter_blocks[GCM_SIV_CTR_BATCH_BLOCKS];
+    uint8_t keystream[16 * GCM_SIV_CTR_BATCH_BLOCKS];
+
+    uint128 ctr = *tag;
+    ctr.bytes[15] |= 0x80;
+
+    size_t offset = 0;
+    while (offset < len) {
+        const size_t n = MIN(len - offset, sizeof(keystream));
+        const size_t nblocks = (n + 15) / 16;
+        for (size_t i = 0; i < nblocks; i++) {
+            counter_blocks[i] = ctr;
+            ctr.words[0]++;  // Wraps around modulo 2^32.
+        }
+        encode(keystream, counter_blocks, 16 * nblocks, key->expanded);
+        for (size_t i = 0; i < n; i++) {
+            dest[offset + i] = src[offset + i] ^ keystream[i];
+        }
+        offset += n;
+    }
+}
+
+void
+aes_gcm_siv_encrypt(
+    const struct aes_gcm_siv_key* key,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t nonce[GCM_SIV_NONCE_SIZE],
+    const uint8_t* aad,
+    size_t aadlen,
+    uint8_t tag[GCM_SIV_TAG_SIZE]
+)
+{
+    struct derived_keys derived;
+    derive_keys(key, nonce, &derived);
+
+    // The tag is computed over the plain text, before it may be
+    // overwritten by an in-place encryption.
+    uint128 T;
+    compute_tag(&derived, src, len, nonce, aad, aadlen, &T);
+    ctr32(&derived.enc, dest, src, len, &T);
+    memcpy(tag, &T, GCM_SIV_TAG_SIZE);
+}
+
+int
+aes_gcm_siv_decrypt(
+    const struct aes_gcm_siv_key* key,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t nonce[GCM_SIV_NONCE_SIZE],
+    const uint8_t* aad,
+    size_t aadlen,
+    const uint8_t tag[GCM_SIV_TAG_SIZE]
+)
+{
+    struct derived_keys derived;
+    derive_keys(key, nonce, &derived);
+
+    uint128 T;
+    memcpy(&T, tag, GCM_SIV_TAG_SIZE);
+    ctr32(&derived.enc, dest, src, len, &T);
+
+    uint128 expected;
+    compute_tag(&derived, dest, len, nonce, aad, aadlen, &expected);
+
+    uint8_t diff = 0;
+    for (size_t i = 0; i < GCM_SIV_TAG_SIZE; i++) {
+        diff |= expected.bytes[i] ^ tag[i];
+    }
+    if (diff != 0) {
+        memset(dest, 0, len);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GCM_SIV_H_
+#define GCM_SIV_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define GCM_SIV_NONCE_SIZE (12)
+#define GCM_SIV_TAG_SIZE (16)
+
+// AES-GCM-SIV key-generating key (RFC 8452), expanded for AES-128 or
+// AES-256 encryption.
+struct aes_gcm_siv_key {
+    uint32_t expanded[60];
+    size_t keylen;  // In bits, 128 or 256.
+};
+
+extern void
+aes_gcm_siv_init(
+    struct aes_gcm_siv_key* key,
+    const uint8_t* raw_key,
+    size_t keylen
+);
+
+// AES-GCM-SIV (RFC 8452) using Zvkned for the key derivation and CTR32
+// encryption and Zvkg for POLYVAL.
+//
+// 'len' bytes are read from 'src' and the transformed text is written to
+// 'dest' ('src' and 'dest' may alias). All buffers should be 32b aligned
+// on processors that do not support unaligned vector accesses.
+extern void
+aes_gcm_siv_encrypt(
+    const struct aes_gcm_siv_key* key,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t nonce[GCM_SIV_NONCE_SIZE],
+    const uint8_t* aad,
+    size_t aadlen,
+    uint8_t tag[GCM_SIV_TAG_SIZE]
+);
+
+// Returns 0 if 'tag' authenticates the decrypted text. Otherwise returns 1
+// and 'dest' is zeroed.
+extern int
+aes_gcm_siv_decrypt(
+    const struct aes_gcm_siv_key* key,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t nonce[GCM_SIV_NONCE_SIZE],
+    const uint8_t* aad,
+    size_t aadlen,
+    const uint8_t tag[GCM_SIV_TAG_SIZE]
+);
+
+#endif  // GCM_SIV_H_
@@ -0,0 +1,200 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "gcm.h"
+#include "zvkg.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+// Number of counter blocks encoded by a single call to the block cipher.
+// Larger batches allow the cipher routine to fill wider register groups
+// (e.g., 16 blocks are 4 LMUL=4 register groups at VLEN=128, one at
+// VLEN=512).
+#define GCM_CTR_BATCH_BLOCKS (16)
+
+typedef union uint128 {
+    uint64_t dwords[2];
+    uint32_t words[4];
+    uint8_t bytes[16];
+} uint128;
+
+// Absorbs 'len' bytes of 'data' into the GHASH accumulator 'Y', padding
+// the trailing partial block, if any, with zeroes.
+static void
+ghash(uint128* Y, const uint8_t* data, size_t len, const uint128* H)
+{
+    const size_t full_blocks = len / 16;
+    zvkg_ghash(Y, data, H, full_blocks);
+
+    const size_t remaining_bytes = len % 16;
+    if (remaining_bytes != 0) {
+        uint128 block = {};
+        memcpy(&block, &data[16 * full_blocks], remaining_bytes);
+        zvkg_ghash(Y, &block, H, 1);
+    }
+}
+
+// Compute the Initial Counter Block (ICB, a.k.a. Y0, a.k.a. J0)
+static uint128
+initial_counter_block(const uint128* H, const uint8_t* iv, size_t ivlen)
+{
+    uint128 icb = {};
+
+    if (ivlen == 12) {
+        // Easy case, len(IV) == 96 bits
+        // ICB = IV || 0...0  || 1   (round# starts at 1)
+        memcpy(&icb, iv, 12);
+        icb.bytes[15] = 1;
+        return icb;
+    }
+
+    // Hard case, ICB is GHASH on 128b blocks, with iv padded with 0s
+    // to fill full blocks, then a trailing block consisting of
+    // 0_64 || len(iv)_64
+    assert(ivlen > 0);  // Logic is unclear if ivlen == 0
+
+    ghash(&icb, iv, ivlen, H);
+
+    uint128 lengths = {};
+    lengths.dwords[1] = __builtin_bswap64(8 * ivlen);
+    zvkg_vghsh(&icb, &lengths, H);
+    return icb;
+}
+
+// Shared logic of gcm_encrypt/gcm_decrypt.
+//
+// The counter blocks are generated in batches of GCM_CTR_BATCH_BLOCKS and
+// encoded with a single call to the block cipher. The very first batch
+// starts at the ICB itself, whose encoding E(K,Y0) is only used to mask the
+// tag, which saves a separate single block call to the cipher.
+static void
+gcm_transform(
+    const struct block_cipher* cipher,
+    bool encrypt,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t* iv,
+    size_t ivlen,
+    const uint8_t* aad,
+    size_t aadlen,
+    uint8_t tag[GCM_TAG_SIZE]
+)
+{
+    __attribute__((aligned(16)))
+    uint128 counter_blocks[GCM_CTR_BATCH_BLOCKS];
+    __attribute__((aligned(16)))
+    uint8_t keystream[16 * GCM_CTR_BATCH_BLOCKS];
+
+    // H = ENC_K(0)
+    uint128 H = {};
+    cipher->encode(&H, &H, 16, cipher->expanded_key);
+
+    const uint128 icb = initial_counter_block(&H, iv, ivlen);
+    // The counter is stored in the last 4 bytes, in big-endian format.
+    const uint32_t icb_counter = __builtin_bswap32(icb.words[3]);
+
+    uint128 X = {};
+    ghash(&X, aad, aadlen, &H);
+
+    uint128 tag_mask = {};
+    uint32_t counter = 0;  // Relative to the ICB.
+    size_t remaining_bytes = len;
+    do {
+        const size_t text_blocks = (remaining_bytes + 15) / 16;
+        const size_t nblocks = MIN(GCM_CTR_BATCH_BLOCKS,
+                                   text_blocks + (counter == 0));
+        for (size_t i = 0; i < nblocks; i++) {
+            counter_blocks[i] = icb;
+            counter_blocks[i].words[3] =
+                __builtin_bswap32(icb_counter + counter + (uint32_t)i);
+        }
+        cipher->encode(keystream, counter_blocks, 16 * nblocks,
+                       cipher->expanded_key);
+
+        const uint8_t* stream = keystream;
+        size_t stream_bytes = 16 * nblocks;
+        if (counter == 0) {
+            memcpy(&tag_mask, keystream, 16);
+            stream += 16;
+            stream_bytes -= 16;
+        }
+        counter += nblocks;
+
+        const size_t nbytes = MIN(remaining_bytes, stream_bytes);
+        if (!encrypt) {
+            ghash(&X, src, nbytes, &H);
+        }
+        for (size_t i = 0; i < nbytes; i++) {
+            dest[i] = src[i] ^ stream[i];
+        }
+        if (encrypt) {
+            ghash(&X, dest, nbytes, &H);
+        }
+
+        src += nbytes;
+        dest += nbytes;
+        remaining_bytes -= nbytes;
+    } while (remaining_bytes > 0);
+
+    // "Lengths block", len(AA)_64 || len(C)_64
+    uint128 lengths;
+    lengths.dwords[0] = __builtin_bswap64(8 * aadlen);
+    lengths.dwords[1] = __builtin_bswap64(8 * len);
+    zvkg_vghsh(&X, &lengths, &H);
+
+    // T = GHASH(H,A,C) xor E(K,Y0)
+    X.dwords[0] ^= tag_mask.dwords[0];
+    X.dwords[1] ^= tag_mask.dwords[1];
+    memcpy(tag, &X, GCM_TAG_SIZE);
+}
+
+void
+gcm_encrypt(
+    const struct block_cipher* cipher,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t* iv,
+    size_t ivlen,
+    const uint8_t* aad,
+    size_t aadlen,
+    uint8_t tag[GCM_TAG_SIZE]
+)
+{
+    gcm_transform(cipher, true, dest, src, len, iv, ivlen, aad, aadlen, tag);
+}
+
+void
+gcm_decrypt(
+    const struct block_cipher* cipher,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t* iv,
+    size_t ivlen,
+    const uint8_t* aad,
+    size_t aadlen,
+    uint8_t tag[GCM_TAG_SIZE]
+)
+{
+    gcm_transform(cipher, false, dest, src, len, iv, ivlen, aad, aadlen, tag);
+}
@@ -0,0 +1,65 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GCM_H_
+#define GCM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "block-cipher.h"
+
+#define GCM_TAG_SIZE (16)
+
+// Galois/Counter Mode (NIST SP 800-38D) on top of any 128 bit block
+// cipher, using the Zvkg instructions for GHASH.
+//
+// 'len' bytes are read from 'src' and the transformed text is written to
+// 'dest' ('src' and 'dest' may alias). The full 128 bit authentication
+// tag is written to 'tag', callers truncate it as needed.
+//
+// For decryption the tag is computed over the cipher text in 'src', it is
+// the responsibility of the caller to compare it with the expected tag
+// before releasing the plain text.
+//
+// All buffers should be 32b aligned on processors that do not support
+// unaligned vector accesses.
+extern void
+gcm_encrypt(
+    const struct block_cipher* cipher,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t* iv,
+    size_t ivlen,
+    const uint8_t* aad,
+    size_t aadlen,
+    uint8_t tag[GCM_TAG_SIZE]
+);
+
+extern void
+gcm_decrypt(
+    const struct block_cipher* cipher,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t* iv,
+    size_t ivlen,
+    const uint8_t* aad,
+    size_t aadlen,
+    uint8_t tag[GCM_TAG_SIZE]
+);
+
+#endif  // GCM_H_
@@ -0,0 +1,375 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Multi-buffer job manager (jobmgr.h).
+//
+// Checks SHA-256 jobs against the FIPS 180-2 examples, and jobs of mixed
+// lengths run in batches against the same jobs run one at a time, AES-128
+// jobs against the FIPS-197 example, and the timeout and flush logic with
+// a fake clock.
+//
+// Started with "--bench", it instead submits JOBS_PER_RUN small jobs back
+// to back for each batch size from 1 to JOBMGR_MAX_BATCH, and logs the
+// throughput (cycles per job) against the latency (cycles from submission
+// to completion) of each, one line per batch size:
+//
+//   JOBS vlen=<bits> routine=<name> batch=<n> bytes=<n> cycles_per_job=<n>
+//        instret_per_job=<n> latency_avg=<n> latency_max=<n>
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "jobmgr.h"
+#include "log.h"
+#include "vlen-bits.h"
+#include "zvkned.h"
+
+#define MAX_JOBS (256)
+
+// Jobs submitted per batch size in benchmark mode.
+#define JOBS_PER_RUN (256)
+
+// Message (and text) length of the benchmark jobs, one packet header.
+#define BENCH_JOB_BYTES (64)
+
+#define AES128_EXPANDED_KEY_WORDS (44)
+
+static struct job gJobs[MAX_JOBS];
+
+__attribute__((aligned(16)))
+static uint8_t gSrc[MAX_JOBS][JOBMGR_SHA256_MAX_BYTES];
+__attribute__((aligned(16)))
+static uint8_t gDest[MAX_JOBS][JOBMGR_SHA256_MAX_BYTES];
+__attribute__((aligned(16)))
+static uint8_t gExpected[MAX_JOBS][JOBMGR_SHA256_MAX_BYTES];
+__attribute__((aligned(16)))
+static uint32_t gKeys[MAX_JOBS][AES128_EXPANDED_KEY_WORDS];
+
+// Number of callbacks made.
+static size_t gDone;
+
+// ----------------------------------------------------------------------
+// FIPS 180-2, Appendix B.1 and B.2, and FIPS-197, Appendix C.1
+
+static const char kAbc[] = "abc";
+static const char kAbcdbcde[] =
+    "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+
+static const uint8_t kSha256Abc[32] = {
+    0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,
+    0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+    0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+    0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad,
+};
+
+static const uint8_t kSha256Abcdbcde[32] = {
+    0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8,
+    0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+    0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67,
+    0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1,
+};
+
+static const uint8_t kSha256Empty[32] = {
+    0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14,
+    0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24,
+    0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c,
+    0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kFipsKey[16] = {
+    0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,
+    0x08,0x09,0x0a,0x0b,0x0c,0x0d,0x0e,0x0f,
+};
+
+static const uint8_t kFipsPt[16] = {
+    0x00,0x11,0x22,0x33,0x44,0x55,0x66,0x77,
+    0x88,0x99,0xaa,0xbb,0xcc,0xdd,0xee,0xff,
+};
+
+static const uint8_t kFipsCt[16] = {
+    0x69,0xc4,0xe0,0xd8,0x6a,0x7b,0x04,0x30,
+    0xd8,0xcd,0xb7,0x80,0x70,0xb4,0xc5,0x5a,
+};
+
+static uint8_t
+rand8()
+{
+    return rand() / ((RAND_MAX + 1u) / 256);
+}
+
+static void
+rand_bytes(uint8_t* dest, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        dest[i] = rand8();
+    }
+}
+
+static void
+count_done(struct job* job)
+{
+    (void)job;
+    gDone++;
+}
+
+// Fake clock, for the timeout tests.
+static uint64_t gNow;
+
+static uint64_t
+fake_clock(void)
+{
+    return gNow;
+}
+
+// Sets up job 'i', with 'len' random bytes unless 'src' is given.
+static struct job*
+setup_job(size_t i, enum job_alg alg, const void* src, size_t len)
+{
+    struct job* job = &gJobs[i];
+    memset(job, 0, sizeof(*job));
+    if (src != NULL) {
+        memcpy(gSrc[i], src, len);
+    } else {
+        rand_bytes(gSrc[i], len);
+    }
+    job->alg = alg;
+    job->src = gSrc[i];
+    job->len = len;
+    job->dest = gDest[i];
+    job->done = count_done;
+    if (alg == JOB_AES128_ENCRYPT) {
+        __attribute__((aligned(16)))
+        uint8_t key[16];
+        rand_bytes(key, sizeof(key));
+        zvkned_aes128_expand_key(gKeys[i], key);
+        job->expanded_key = gKeys[i];
+    }
+    return job;
+}
+
+// Runs 'n' jobs in batches of 'batch', returning the number of failures.
+static int
+run_jobs(size_t n, size_t batch)
+{
+    struct jobmgr mgr;
+    struct jobmgr_config config = { .batch = { batch, batch } };
+    jobmgr_init(&mgr, &config);
+
+    gDone = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (jobmgr_submit(&mgr, &gJobs[i]) < 0) {
+            LOG("*** job %zu rejected", i);
+            return 1;
+        }
+    }
+    jobmgr_flush(&mgr);
+    if (gDone != n) {
+        LOG("*** %zu of %zu jobs completed", gDone, n);
+        return 1;
+    }
+    return 0;
+}
+
+static int
+check(const char* name, const uint8_t* got, const uint8_t* expected,
+      size_t len)
+{
+    if (memcmp(got, expected, len) != 0) {
+        LOG("*** %s failed", name);
+        return 1;
+    }
+    return 0;
+}
+
+// Known answers, each in the middle of a batch of random messages.
+static int
+run_known_answer_tests(size_t batch)
+{
+    int failures = 0;
+    const size_t n = 2 * batch + 5;
+
+    for (size_t i = 0; i < n; i++) {
+        setup_job(i, i % 2 ? JOB_AES128_ENCRYPT : JOB_SHA256, NULL,
+                  16 * (1 + rand8() % 4));
+    }
+    setup_job(batch, JOB_SHA256, kAbc, strlen(kAbc));
+    setup_job(batch + 2, JOB_SHA256, kAbcdbcde, strlen(kAbcdbcde));
+    setup_job(batch + 4, JOB_SHA256, "", 0);
+    struct job* aes = setup_job(batch + 1, JOB_AES128_ENCRYPT, kFipsPt, 16);
+    zvkned_aes128_expand_key(gKeys[batch + 1], kFipsKey);
+    aes->expanded_key = gKeys[batch + 1];
+
+    failures += run_jobs(n, batch);
+    failures += check("SHA-256 \"abc\"", gDest[batch], kSha256Abc, 32);
+    failures += check("SHA-256 \"abcdbcde...\"", gDest[batch + 2],
+                      kSha256Abcdbcde, 32);
+    failures += check("SHA-256 \"\"", gDest[batch + 4], kSha256Empty, 32);
+    failures += check("AES-128 FIPS-197", gDest[batch + 1], kFipsCt, 16);
+    return failures;
+}
+
+// Jobs of random lengths, in batches, against the same jobs one by one.
+static int
+run_random_tests(size_t batch)
+{
+    int failures = 0;
+    const size_t n = MAX_JOBS;
+
+    for (size_t i = 0; i < n; i++) {
+        if (rand8() % 2) {
+            setup_job(i, JOB_SHA256, NULL, rand() % JOBMGR_SHA256_MAX_BYTES);
+        } else {
+            setup_job(i, JOB_AES128_ENCRYPT, NULL,
+                      16 * (rand8() % (JOBMGR_AES128_MAX_BYTES / 16 + 1)));
+        }
+    }
+
+    failures += run_jobs(n, 1);
+    for (size_t i = 0; i < n; i++) {
+        memcpy(gExpected[i], gDest[i], JOBMGR_SHA256_MAX_BYTES);
+    }
+    failures += run_jobs(n, batch);
+    for (size_t i = 0; i < n; i++) {
+        const size_t len = gJobs[i].alg == JOB_SHA256 ? 32 : gJobs[i].len;
+        if (memcmp(gDest[i], gExpected[i], len) != 0) {
+            LOG("*** job %zu (%s, %zu bytes) differs in batches of %zu",
+                i, gJobs[i].alg == JOB_SHA256 ? "sha256" : "aes128",
+                gJobs[i].len, batch);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+static int
+run_timeout_tests(void)
+{
+    int failures = 0;
+    struct jobmgr mgr;
+    struct jobmgr_config config = {
+        .batch = { 8, 8 },
+        .timeout = 100,
+        .clock = fake_clock,
+    };
+    jobmgr_init(&mgr, &config);
+
+    gNow = 1000;
+    gDone = 0;
+    for (size_t i = 0; i < 3; i++) {
+        jobmgr_submit(&mgr, setup_job(i, JOB_SHA256, NULL, 100));
+    }
+    gNow += 99;
+    failures += jobmgr_poll(&mgr) != 0 || gDone != 0;
+    gNow += 1;
+    failures += jobmgr_poll(&mgr) != 3 || gDone != 3 || mgr.timeouts != 1;
+
+    // A submission runs the queues which timed out.
+    jobmgr_submit(&mgr, setup_job(0, JOB_AES128_ENCRYPT, NULL, 32));
+    gNow += 100;
+    failures += jobmgr_submit(&mgr, setup_job(1, JOB_SHA256, NULL, 5)) != 1;
+    failures += jobmgr_flush(&mgr) != 1 || gDone != 5;
+    failures += gJobs[0].completed != 1200 || gJobs[0].submitted != 1100;
+
+    // Invalid jobs are rejected.
+    failures += jobmgr_submit(&mgr, setup_job(0, JOB_AES128_ENCRYPT, NULL,
+                                              17)) != -1;
+    struct job* job = setup_job(0, JOB_SHA256, NULL, 0);
+    job->len = JOBMGR_SHA256_MAX_BYTES + 1;
+    failures += jobmgr_submit(&mgr, job) != -1;
+    failures += jobmgr_flush(&mgr) != 0;
+
+    if (failures != 0) {
+        LOG("*** timeout tests failed");
+    }
+    return failures;
+}
+
+// ----------------------------------------------------------------------
+// Benchmark mode
+
+static void
+run_benchmark(enum job_alg alg, const char* routine)
+{
+    const uint64_t vlen = vlen_bits();
+
+    for (size_t i = 0; i < JOBS_PER_RUN; i++) {
+        setup_job(i, alg, NULL, BENCH_JOB_BYTES);
+        gJobs[i].done = NULL;
+    }
+
+    for (size_t batch = 1; batch <= JOBMGR_MAX_BATCH; batch *= 2) {
+        struct jobmgr mgr;
+        struct jobmgr_config config = { .batch = { batch, batch } };
+        jobmgr_init(&mgr, &config);
+
+        const uint64_t cycle_start = bench_read_cycle();
+        const uint64_t instret_start = bench_read_instret();
+        for (size_t i = 0; i < JOBS_PER_RUN; i++) {
+            jobmgr_submit(&mgr, &gJobs[i]);
+        }
+        jobmgr_flush(&mgr);
+        const uint64_t instret = bench_read_instret() - instret_start;
+        const uint64_t cycles = bench_read_cycle() - cycle_start;
+
+        uint64_t latency_sum = 0;
+        uint64_t latency_max = 0;
+        for (size_t i = 0; i < JOBS_PER_RUN; i++) {
+            const uint64_t latency = gJobs[i].completed - gJobs[i].submitted;
+            latency_sum += latency;
+            latency_max = latency > latency_max ? latency : latency_max;
+        }
+
+        LOG("JOBS vlen=%" PRIu64 " routine=%s batch=%zu bytes=%d"
+            " cycles_per_job=%" PRIu64 " instret_per_job=%" PRIu64
+            " latency_avg=%" PRIu64 " latency_max=%" PRIu64,
+            vlen, routine, batch, BENCH_JOB_BYTES,
+            cycles / JOBS_PER_RUN, instret / JOBS_PER_RUN,
+            latency_sum / JOBS_PER_RUN, latency_max);
+    }
+}
+
+int
+main(int argc, char** argv)
+{
+    const uint64_t vlen = vlen_bits();
+    LOG("VLEN = %" PRIu64 ", default batch %zu", vlen, jobmgr_default_batch());
+
+    if (bench_requested(argc, argv)) {
+        run_benchmark(JOB_SHA256, "sha256");
+        run_benchmark(JOB_AES128_ENCRYPT, "aes128");
+        return 0;
+    }
+
+    int failures = 0;
+    const size_t batches[] = { 1, 3, jobmgr_default_batch(), JOBMGR_MAX_BATCH };
+    for (size_t i = 0; i < sizeof(batches) / sizeof(batches[0]); i++) {
+        LOG("- batches of %zu", batches[i]);
+        failures += run_known_answer_tests(batches[i]);
+        failures += run_random_tests(batches[i]);
+    }
+    LOG("- timeouts");
+    failures += run_timeout_tests();
+
+    if (failures != 0) {
+        printf("%d job manager tests failed\n", failures);
+        exit(1);
+    }
+    LOG("Success, all job manager tests passed.");
+    return 0;
+}
@@ -0,0 +1,260 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "jobmgr.h"
+
+#include <string.h>
+
+#include "bench.h"
+#include "vlen-bits.h"
+#include "zvkned.h"
+#include "zvknh.h"
+
+// Padded length of the longest SHA-256 message: the message, the 0x80
+// byte and the 8 byte length, rounded up to a block.
+#define SHA256_PADDED_MAX \
+    ((JOBMGR_SHA256_MAX_BYTES + 9 + SHA256_BLOCK_SIZE - 1) & \
+     ~(size_t)(SHA256_BLOCK_SIZE - 1))
+
+#define AES128_MAX_BLOCKS (JOBMGR_MAX_BATCH * JOBMGR_AES128_MAX_BYTES / 16)
+
+// Padded messages of a SHA-256 batch, and their states.
+__attribute__((aligned(16)))
+static uint8_t gSha256Padded[JOBMGR_MAX_BATCH][SHA256_PADDED_MAX];
+__attribute__((aligned(16)))
+static uint32_t gSha256States[JOBMGR_MAX_BATCH][8];
+
+// Texts and block keys of an AES-128 batch.
+__attribute__((aligned(16)))
+static uint8_t gAesText[16 * AES128_MAX_BLOCKS];
+static const uint32_t* gAesKeys[AES128_MAX_BLOCKS];
+
+size_t
+jobmgr_default_batch(void)
+{
+    const size_t lanes = vlen_bits() * 2 / 128;
+    if (lanes < 1) {
+        return 1;
+    }
+    return lanes < JOBMGR_MAX_BATCH ? lanes : JOBMGR_MAX_BATCH;
+}
+
+void
+jobmgr_init(struct jobmgr* mgr, const struct jobmgr_config* config)
+{
+    memset(mgr, 0, sizeof(*mgr));
+    if (config != NULL) {
+        mgr->config = *config;
+    }
+    for (int alg = 0; alg < JOB_NUM_ALGS; alg++) {
+        size_t* batch = &mgr->config.batch[alg];
+        if (*batch == 0) {
+            *batch = jobmgr_default_batch();
+        }
+        if (*batch > JOBMGR_MAX_BATCH) {
+            *batch = JOBMGR_MAX_BATCH;
+        }
+    }
+    if (mgr->config.clock == NULL) {
+        mgr->config.clock = bench_read_cycle;
+    }
+}
+
+// Converts a SHA-256 state from the order of kSha256InitialHash to the
+// big endian digest of FIPS 180-4.
+static void
+sha256_digest(uint8_t* digest, const uint32_t* hash)
+{
+    // Word order of the state: f, e, b, a, h, g, d, c.
+    static const int kWord[8] = { 3, 2, 7, 6, 1, 0, 5, 4 };
+    for (int i = 0; i < 8; i++) {
+        const uint32_t w = hash[kWord[i]];
+        digest[4 * i + 0] = w >> 24;
+        digest[4 * i + 1] = w >> 16;
+        digest[4 * i + 2] = w >> 8;
+        digest[4 * i + 3] = w;
+    }
+}
+
+// Pads 'len' bytes of 'src' into 'dest', returning the number of blocks.
+static size_t
+sha256_pad(uint8_t* dest, const void* src, size_t len)
+{
+    const size_t nblocks = (len + 9 + SHA256_BLOCK_SIZE - 1) / SHA256_BLOCK_SIZE;
+    const size_t padded = nblocks * SHA256_BLOCK_SIZE;
+    const uint64_t bits = (uint64_t)len * 8;
+
+    memcpy(dest, src, len);
+    dest[len] = 0x80;
+    memset(dest + len + 1, 0, padded - len - 1);
+    for (int i = 0; i < 8; i++) {
+        dest[padded - 1 - i] = bits >> (8 * i);
+    }
+    return nblocks;
+}
+
+// Hashes the messages of 'n' jobs together. Messages are sorted by length,
+// longest first, so that those still running at block 'b' are always the
+// first few: each call of the kernel covers a prefix of the batch.
+static void
+run_sha256(struct job** jobs, size_t n)
+{
+    size_t nblocks[JOBMGR_MAX_BATCH];
+    size_t order[JOBMGR_MAX_BATCH];
+    const void* blocks[JOBMGR_MAX_BATCH];
+
+    for (size_t i = 0; i < n; i++) {
+        nblocks[i] = sha256_pad(gSha256Padded[i], jobs[i]->src, jobs[i]->len);
+        size_t j = i;
+        for (; j > 0 && nblocks[order[j - 1]] < nblocks[i]; j--) {
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+        memcpy(gSha256States[i], kSha256InitialHash, sizeof(gSha256States[i]));
+    }
+
+    size_t active = n;
+    for (size_t b = 0; active > 0; b++) {
+        while (active > 0 && nblocks[order[active - 1]] <= b) {
+            active--;
+        }
+        for (size_t k = 0; k < active; k++) {
+            blocks[k] = gSha256Padded[order[k]] + b * SHA256_BLOCK_SIZE;
+        }
+        // The states follow the sorted order of the messages.
+        sha256_block_multi_lmul2(&gSha256States[0][0], blocks, active);
+    }
+
+    for (size_t k = 0; k < n; k++) {
+        sha256_digest(jobs[order[k]]->dest, gSha256States[k]);
+    }
+}
+
+// Encrypts the blocks of 'n' jobs in one call, each with its job's key.
+static void
+run_aes128(struct job** jobs, size_t n)
+{
+    size_t nblocks = 0;
+    for (size_t i = 0; i < n; i++) {
+        memcpy(&gAesText[16 * nblocks], jobs[i]->src, jobs[i]->len);
+        for (size_t j = 0; j < jobs[i]->len / 16; j++) {
+            gAesKeys[nblocks++] = jobs[i]->expanded_key;
+        }
+    }
+
+    zvkned_aes128_encode_multi_key(gAesText, gAesText, gAesKeys, nblocks);
+
+    size_t offset = 0;
+    for (size_t i = 0; i < n; i++) {
+        memcpy(jobs[i]->dest, &gAesText[offset], jobs[i]->len);
+        offset += jobs[i]->len;
+    }
+}
+
+// Runs the queue of 'alg', whatever its length.
+static size_t
+run_queue(struct jobmgr* mgr, int alg)
+{
+    struct job* jobs[JOBMGR_MAX_BATCH];
+    const size_t n = mgr->queued[alg];
+    if (n == 0) {
+        return 0;
+    }
+    // Copied, since the callbacks may submit (and so queue) new jobs.
+    memcpy(jobs, mgr->queue[alg], n * sizeof(jobs[0]));
+
+    switch (alg) {
+      case JOB_SHA256:
+        run_sha256(jobs, n);
+        break;
+      case JOB_AES128_ENCRYPT:
+        run_aes128(jobs, n);
+        break;
+    }
+
+    mgr->queued[alg] = 0;
+    mgr->batches++;
+
+    const uint64_t now = mgr->config.clock();
+    for (size_t i = 0; i < n; i++) {
+        jobs[i]->completed = now;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (jobs[i]->done != NULL) {
+            jobs[i]->done(jobs[i]);
+        }
+    }
+    return n;
+}
+
+size_t
+jobmgr_poll(struct jobmgr* mgr)
+{
+    size_t completed = 0;
+    if (mgr->config.timeout == 0) {
+        return 0;
+    }
+    const uint64_t now = mgr->config.clock();
+    for (int alg = 0; alg < JOB_NUM_ALGS; alg++) {
+        if (mgr->queued[alg] > 0 &&
+            now - mgr->queue[alg][0]->submitted >= mgr->config.timeout) {
+            mgr->timeouts++;
+            completed += run_queue(mgr, alg);
+        }
+    }
+    return completed;
+}
+
+int
+jobmgr_submit(struct jobmgr* mgr, struct job* job)
+{
+    switch (job->alg) {
+      case JOB_SHA256:
+        if (job->len > JOBMGR_SHA256_MAX_BYTES) {
+            return -1;
+        }
+        break;
+      case JOB_AES128_ENCRYPT:
+        if (job->len > JOBMGR_AES128_MAX_BYTES || job->len % 16 != 0 ||
+            job->expanded_key == NULL) {
+            return -1;
+        }
+        break;
+      default:
+        return -1;
+    }
+
+    const int alg = job->alg;
+    size_t completed = 0;
+
+    job->submitted = mgr->config.clock();
+    job->completed = 0;
+    mgr->queue[alg][mgr->queued[alg]++] = job;
+
+    if (mgr->queued[alg] >= mgr->config.batch[alg]) {
+        completed += run_queue(mgr, alg);
+    }
+    completed += jobmgr_poll(mgr);
+    return (int)completed;
+}
+
+size_t
+jobmgr_flush(struct jobmgr* mgr)
+{
+    size_t completed = 0;
+    for (int alg = 0; alg < JOB_NUM_ALGS; alg++) {
+        completed += run_queue(mgr, alg);
+    }
+    return completed;
+}
@@ -0,0 +1,119 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Multi-buffer job manager for small hash and cipher requests.
+//
+// A network stack issues many small, independent requests, each too short
+// to keep a vector unit busy. A batch of them does, when each element
+// group works on a different request: SHA-256 jobs are run by
+// sha256_block_multi_lmul2 (one message per element group, Zvknh) and
+// AES-128 jobs by zvkned_aes128_encode_multi_key (one key per element
+// group, the ".vv" forms of Zvkned).
+//
+// jobmgr_submit queues a job on the queue of its algorithm. When a queue
+// holds 'batch' jobs they are run together, and the 'done' callback of
+// each is called. So that jobs are not held back at low load, any queue
+// whose oldest job has waited 'timeout' cycles or more is run by the next
+// jobmgr_submit or jobmgr_poll call. jobmgr_flush runs every queue.
+//
+// Jobs complete asynchronously from the point of view of the submitter,
+// but all the work happens in the calling thread, within those calls.
+
+#ifndef JOBMGR_H_
+#define JOBMGR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Most jobs in a batch.
+#define JOBMGR_MAX_BATCH (64)
+
+// Longest SHA-256 message, and longest AES-128 text, of a job.
+#define JOBMGR_SHA256_MAX_BYTES (1024)
+#define JOBMGR_AES128_MAX_BYTES (256)
+
+enum job_alg {
+    // SHA-256 of 'len' bytes of 'src', written as 32 bytes to 'dest'.
+    JOB_SHA256 = 0,
+    // AES-128 ECB encryption of 'len' bytes (a multiple of 16) of 'src'
+    // to 'dest', with 'expanded_key' (from zvkned_aes128_expand_key).
+    JOB_AES128_ENCRYPT,
+    JOB_NUM_ALGS
+};
+
+struct job;
+
+typedef void (*job_done_fn_t)(struct job* job);
+
+struct job {
+    enum job_alg alg;
+    const void* src;
+    size_t len;
+    void* dest;
+    const uint32_t* expanded_key;
+    // Called once the job is done, or NULL.
+    job_done_fn_t done;
+    void* user;
+
+    // Clock values at submission and completion, set by the manager.
+    uint64_t submitted;
+    uint64_t completed;
+};
+
+typedef uint64_t (*jobmgr_clock_fn_t)(void);
+
+struct jobmgr_config {
+    // Jobs per batch of each algorithm, at most JOBMGR_MAX_BATCH.
+    // 0 picks jobmgr_default_batch().
+    size_t batch[JOB_NUM_ALGS];
+    // Longest a job waits for its batch to fill, in clock ticks. 0 means
+    // forever, i.e. until the batch is full or jobmgr_flush is called.
+    uint64_t timeout;
+    // Clock for the timeout and the job time stamps. NULL for rdcycle.
+    jobmgr_clock_fn_t clock;
+};
+
+struct jobmgr {
+    struct jobmgr_config config;
+    struct job* queue[JOB_NUM_ALGS][JOBMGR_MAX_BATCH];
+    size_t queued[JOB_NUM_ALGS];
+
+    // Batches run, and how many of those were run because of the timeout.
+    uint64_t batches;
+    uint64_t timeouts;
+};
+
+// Jobs that one pass of the multi-buffer kernels covers at the running
+// VLEN, i.e. VLEN * 2 / 128 (they use LMUL=2).
+extern size_t
+jobmgr_default_batch(void);
+
+extern void
+jobmgr_init(struct jobmgr* mgr, const struct jobmgr_config* config);
+
+// Queues 'job', then runs its queue if that is full and any other queue
+// which timed out. Returns the number of jobs completed, or -1 (and
+// queues nothing) if 'job' is invalid or too long.
+extern int
+jobmgr_submit(struct jobmgr* mgr, struct job* job);
+
+// Runs every queue which timed out. Returns the number of jobs completed.
+extern size_t
+jobmgr_poll(struct jobmgr* mgr);
+
+// Runs every queue, full or not. Returns the number of jobs completed.
+extern size_t
+jobmgr_flush(struct jobmgr* mgr);
+
+#endif  // JOBMGR_H_
@@ -0,0 +1,70 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "polyval.h"
+#include "zvkg.h"
+
+typedef union uint128 {
+    uint64_t dwords[2];
+    uint32_t words[4];
+    uint8_t bytes[16];
+} uint128;
+
+void
+polyval_init(struct polyval_key* key, const uint8_t H[16])
+{
+    // h <- mulX_GHASH(ByteReverse(H)): in the GHASH bit order a
+    // multiplication by x is a right shift of the 128 bit big-endian
+    // value, reduced by xoring 0xe1 into the first byte.
+    uint128 h;
+    for (size_t i = 0; i < 16; i++) {
+        h.bytes[i] = H[15 - i];
+    }
+    const uint8_t carry = h.bytes[15] & 1;
+    for (size_t i = 15; i > 0; i--) {
+        h.bytes[i] = (h.bytes[i] >> 1) | (h.bytes[i - 1] << 7);
+    }
+    h.bytes[0] = (h.bytes[0] >> 1) ^ (carry ? 0xe1 : 0);
+
+    // powers[] = h^N, ..., h^2, h^1
+    const uint128 zero = {};
+    uint128 p = h;
+    for (size_t i = POLYVAL_NUM_POWERS; i > 0; i--) {
+        memcpy(&key->powers[4 * (i - 1)], &p, sizeof(p));
+        zvkg_vghsh(&p, &zero, &h);  // p <- p o h
+    }
+}
+
+void
+polyval_update(
+    const struct polyval_key* key,
+    uint8_t S[16],
+    const uint8_t* data,
+    size_t len
+)
+{
+    const size_t nblocks = len / 16;
+    zvkg_polyval(S, data, key->powers, POLYVAL_NUM_POWERS, nblocks);
+
+    const size_t rem = len % 16;
+    if (rem != 0) {
+        uint128 block = {};
+        memcpy(&block, &data[16 * nblocks], rem);
+        zvkg_polyval(S, &block, key->powers, POLYVAL_NUM_POWERS, 1);
+    }
+}
@@ -0,0 +1,49 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef POLYVAL_H_
+#define POLYVAL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Number of powers of H kept in a polyval_key. POLYVAL absorbs up to that
+// many blocks per reduction (fewer when the vector register group holds
+// fewer element groups). Shall be a power of 2.
+#define POLYVAL_NUM_POWERS (16)
+
+// POLYVAL (RFC 8452, Section 3) over the Zvkg vghsh instruction.
+//
+// 'powers' holds H^POLYVAL_NUM_POWERS, ..., H^1 in GHASH byte order, H
+// being mulX_GHASH(ByteReverse(key)) (RFC 8452, Appendix A).
+struct polyval_key {
+    uint32_t powers[4 * POLYVAL_NUM_POWERS];
+};
+
+extern void
+polyval_init(struct polyval_key* key, const uint8_t H[16]);
+
+// Absorbs 'len' bytes of 'data' into the accumulator 'S' (16 bytes, 32b
+// aligned). A trailing partial block is zero padded, so separate calls
+// can be used to hash separately padded fields (e.g., AAD and plain text).
+extern void
+polyval_update(
+    const struct polyval_key* key,
+    uint8_t S[16],
+    const uint8_t* data,
+    size_t len
+);
+
+#endif  // POLYVAL_H_
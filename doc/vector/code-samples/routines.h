@@ -0,0 +1,93 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Routine tables: the vector kernels of each algorithm, with the minimum
+// VLEN each one runs with.
+//
+// The known answer tests run every entry the VLEN allows, and dispatch.c
+// picks among the same entries, so each table lists an algorithm's
+// kernels most preferred first. Higher LMUL variants process more element
+// groups per instruction, so come first where a smaller VLEN allows them.
+//
+// aes-routines.c, sha-routines.c and sm3-routines.c each define one
+// algorithm's tables, so that a program only links the kernels it uses.
+
+#ifndef ROUTINES_H_
+#define ROUTINES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Function type of the AES encode/decode routines of zvkned.h.
+typedef uint64_t (aes_transform_t)(
+   void* dest,
+   const void* src,
+   uint64_t n,
+   const uint32_t* expanded_key
+);
+
+enum TransformDirection {
+    kEncode,
+    kDecode,
+};
+
+struct aes_routine {
+    const char* name;
+    const char* descr;
+    aes_transform_t* fn;
+    size_t keylen;
+    // Minimum VLEN (in bits) required to run this routine.
+    size_t min_vlen;
+    enum TransformDirection direction;
+};
+
+// AES-128 and AES-256 encode and decode, in that order.
+#define NUM_AES_ROUTINES (14)
+extern const struct aes_routine kAESRoutines[NUM_AES_ROUTINES];
+
+typedef void (*block_fn_t)(uint8_t* hash, const void* block);
+
+struct sha_routine {
+    const char* name;
+    // Minimum VLEN (bits) required to run this hash routine.
+    size_t min_vlen;
+    // Function pointer to the block hashing routine.
+    block_fn_t hash_fn;
+};
+
+#define NUM_SHA256_ROUTINES (2)
+extern const struct sha_routine sha256_routines[NUM_SHA256_ROUTINES];
+
+#define NUM_SHA512_ROUTINES (2)
+extern const struct sha_routine sha512_routines[NUM_SHA512_ROUTINES];
+
+typedef void (*hash_fn_t)(
+    void* dest,
+    const void* src,
+    uint64_t length
+);
+
+struct sm3_routine {
+    const char* name;
+    // Minimum VLEN (bits) required to run this hash routine.
+    size_t min_vlen;
+    // Function pointer to the block hashing routine.
+    hash_fn_t hash_fn;
+};
+
+#define NUM_SM3_ROUTINES (3)
+extern const struct sm3_routine sm3_routines[NUM_SM3_ROUTINES];
+
+#endif  // ROUTINES_H_
@@ -0,0 +1,44 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "routines.h"
+
+#include "zvknh.h"
+
+const struct sha_routine sha256_routines[NUM_SHA256_ROUTINES] = {
+    {
+        .name = "sha256_block_lmul1",
+        .min_vlen = 128,
+        .hash_fn = sha256_block_lmul1,
+    },
+    {
+        .name = "sha256_block_vslide_lmul1",
+        .min_vlen = 128,
+        .hash_fn = sha256_block_vslide_lmul1,
+    },
+};
+
+const struct sha_routine sha512_routines[NUM_SHA512_ROUTINES] = {
+    {
+        .name = "sha512_block_lmul1",
+        .min_vlen = 256,
+        .hash_fn = sha512_block_lmul1,
+    },
+    {
+        .name = "sha512_block_lmul2",
+        .min_vlen = 128,
+        .hash_fn = sha512_block_lmul2,
+    },
+};
@@ -20,7 +20,9 @@
 #include <string.h>
 
 #include "zvknh.h"
+#include "bench.h"
 #include "log.h"
+#include "routines.h"
 #include "vlen-bits.h"
 
 // 'sha-test.h' must be included before the test vector headers.
@@ -29,47 +31,6 @@
 #include "test-vectors/sha256-vectors.h"
 #include "test-vectors/sha512-vectors.h"
 
-typedef void (*block_fn_t)(uint8_t* hash, const void* block);
-
-struct sha_routine {
-    const char* name;
-    // Minimum VLEN (bits) required to run this hash routine.
-    size_t min_vlen;
-    // Function pointer to the block hashing routine.
-    block_fn_t hash_fn;
-};
-
-// SHA-256 block hashing routines.
-#define NUM_SHA256_ROUTINES (2)
-const struct sha_routine sha256_routines[NUM_SHA256_ROUTINES] = {
-    {
-        .name = "sha256_block_lmul1",
-        .min_vlen = 128,
-        .hash_fn = sha256_block_lmul1,
-    },
-    {
-        .name = "sha256_block_vslide_lmul1",
-        .min_vlen = 128,
-        .hash_fn = sha256_block_vslide_lmul1,
-    },
-};
-
-// SHA-512 block hashing routines.
-#define NUM_SHA512_ROUTINES (2)
-const struct sha_routine sha512_routines[NUM_SHA512_ROUTINES] = {
-    {
-        .name = "sha512_block_lmul1",
-        .min_vlen = 256,
-        .hash_fn = sha512_block_lmul1,
-    },
-    {
-        .name = "sha512_block_lmul2",
-        .min_vlen = 128,
-        .hash_fn = sha512_block_lmul2,
-    },
-};
-
-
 struct sha_params {
     size_t digest_size;
     size_t block_size;
@@ -264,12 +225,57 @@ run_suite(
     LOG("Success, %d tests were run.", suite->count);
 }
 
+struct bench_ctx {
+    const struct sha_params* params;
+    const struct sha_routine* routine;
+};
+
+// Hashes the whole buffer, one block at a time, without padding.
+static void
+bench_transform(const void* ctx, uint8_t* buf, size_t len)
+{
+    const struct bench_ctx* const bench = ctx;
+    const size_t block_size = bench->params->block_size;
+    uint8_t hash[SHA512_DIGEST_SIZE];
+
+    memcpy(hash, bench->params->initial_hash,
+           bench->params->initial_hash_size);
+    for (size_t i = 0; i < len; i += block_size) {
+        bench->routine->hash_fn(hash, buf + i);
+    }
+}
+
+static void
+run_benchmarks(const struct sha_params* params)
+{
+    const uint64_t vlen = vlen_bits();
+    for (size_t i = 0; i < params->num_routines; ++i) {
+        const struct bench_ctx ctx = {
+            .params = params,
+            .routine = &params->routines[i],
+        };
+        if (vlen < ctx.routine->min_vlen) {
+            LOG("Skipping '%s' due to VLEN < min_vlen (%zu < %zu)",
+                ctx.routine->name, vlen, ctx.routine->min_vlen);
+            continue;
+        }
+        bench_sweep(ctx.routine->name, bench_transform, &ctx,
+                    params->block_size);
+    }
+}
+
 int
-main()
+main(int argc, char** argv)
 {
     const uint64_t vlen = vlen_bits();
     LOG("VLEN = %" PRIu64, vlen);
 
+    if (bench_requested(argc, argv)) {
+        run_benchmarks(&sha256_params);
+        run_benchmarks(&sha512_params);
+        return 0;
+    }
+
     if (true) {
         const size_t num_tests256 = sizeof(sha256_suites) / sizeof(*sha256_suites);
         for (size_t i = 0; i < num_tests256; i++) {
@@ -0,0 +1,38 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "routines.h"
+
+#include "zvksh.h"
+
+// LMUL=1 needs a VLEN of 256 to hold the 8 word state in one register,
+// LMUL=2 and 4 spread it over a group at smaller VLENs.
+const struct sm3_routine sm3_routines[NUM_SM3_ROUTINES] = {
+    {
+        .name = "zvksh_sm3_encode_lmul1",
+        .min_vlen = 256,
+        .hash_fn = zvksh_sm3_encode_lmul1,
+    },
+    {
+        .name = "zvksh_sm3_encode_lmul2",
+        .min_vlen = 128,
+        .hash_fn = zvksh_sm3_encode_lmul2,
+    },
+    {
+        .name = "zvksh_sm3_encode_lmul4",
+        .min_vlen = 64,
+        .hash_fn = zvksh_sm3_encode_lmul4,
+    },
+};
@@ -20,7 +20,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "bench.h"
 #include "log.h"
+#include "routines.h"
 #include "vlen-bits.h"
 
 #include "zvksh.h"
@@ -32,40 +34,6 @@
 // SM3 produces a 256 bits / 32 bytes hash.
 #define SM3_HASH_BYTES (32)
 
-typedef void (*hash_fn_t)(
-    void* dest,
-    const void* src,
-    uint64_t length
-);
-
-struct sm3_routine {
-    const char* name;
-    // Minimum VLEN (bits) required to run this hash routine.
-    size_t min_vlen;
-    // Function pointer to the block hashing routine.
-    hash_fn_t hash_fn;
-};
-
-// SM3 block hashing routines.
-#define NUM_SM3_ROUTINES (3)
-const struct sm3_routine sm3_routines[NUM_SM3_ROUTINES] = {
-    {
-        .name = "zvksh_sm3_encode_lmul1",
-        .min_vlen = 256,
-        .hash_fn = zvksh_sm3_encode_lmul1,
-    },
-    {
-        .name = "zvksh_sm3_encode_lmul2",
-        .min_vlen = 128,
-        .hash_fn = zvksh_sm3_encode_lmul2,
-    },
-    {
-        .name = "zvksh_sm3_encode_lmul4",
-        .min_vlen = 64,
-        .hash_fn = zvksh_sm3_encode_lmul4,
-    },
-};
-
 // Pad input to block size, append delimiter and length.
 static size_t
 sm3_pad(uint8_t* output, const uint8_t* input, size_t len)
@@ -141,11 +109,42 @@ static int run_sm3_test(const struct sm3_test_vector* vector)
     return 0;
 }
 
-int main()
+// Hashes the whole buffer, taken as already padded.
+static void
+bench_transform(const void* ctx, uint8_t* buf, size_t len)
+{
+    const struct sm3_routine* const routine = ctx;
+    __attribute__((aligned(16)))
+    uint32_t hash[SM3_HASH_BYTES / sizeof(uint32_t)];
+
+    routine->hash_fn(hash, buf, len);
+}
+
+static void
+run_benchmarks(void)
+{
+    const uint64_t vlen = vlen_bits();
+    for (size_t i = 0; i < NUM_SM3_ROUTINES; ++i) {
+        const struct sm3_routine* const routine = &sm3_routines[i];
+        if (vlen < routine->min_vlen) {
+            LOG("Skipping '%s' due to VLEN < min_vlen (%zu < %zu)",
+                routine->name, vlen, routine->min_vlen);
+            continue;
+        }
+        bench_sweep(routine->name, bench_transform, routine, 64);
+    }
+}
+
+int main(int argc, char** argv)
 {
     const uint64_t vlen = vlen_bits();
     LOG("VLEN = %" PRIu64, vlen);
 
+    if (bench_requested(argc, argv)) {
+        run_benchmarks();
+        return 0;
+    }
+
     LOG("--- Running SM3 test suite...");
     const size_t vector_count = sizeof(sm3_test_vectors) / sizeof(sm3_test_vectors[0]);
     for (size_t i = 0; i < vector_count; ++i) {
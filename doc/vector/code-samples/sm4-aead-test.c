@@ -0,0 +1,406 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// SM4-GCM and SM4-CCM using the Zvksed (SM4) and Zvkg (GHASH) extensions.
+//
+// The GCM and CCM drivers (gcm.c, ccm.c) are cipher agnostic, they are
+// instantiated here with the SM4 routines from zvksed.s and validated
+// against the test vectors from RFC 8998. A simple throughput comparison
+// with AES-128-GCM, using the same GCM driver and the same VLEN, is run
+// after the tests.
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "block-cipher.h"
+#include "ccm.h"
+#include "gcm.h"
+#include "log.h"
+#include "vlen-bits.h"
+#include "zvkned.h"
+#include "zvksed.h"
+
+// ----------------------------------------------------------------------
+// SM4 block test vector from GB/T 32907-2016, Appendix A.1
+
+__attribute__((aligned(16)))
+static const uint8_t kSm4BlockKey[16] = {
+    0x01,0x23,0x45,0x67,0x89,0xab,0xcd,0xef,
+    0xfe,0xdc,0xba,0x98,0x76,0x54,0x32,0x10,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kSm4BlockCt[16] = {
+    0x68,0x1e,0xdf,0x34,0xd2,0x06,0x96,0x5e,
+    0x86,0xb3,0xe9,0x4f,0x53,0x6e,0x42,0x46,
+};
+
+// ----------------------------------------------------------------------
+// Test vectors from RFC 8998, Appendix A.1 (SM4-GCM) and A.2 (SM4-CCM).
+// Both use the same key, IV/nonce, AAD and plain text.
+
+__attribute__((aligned(16)))
+static const uint8_t kRfc8998Key[16] = {
+    0x01,0x23,0x45,0x67,0x89,0xab,0xcd,0xef,
+    0xfe,0xdc,0xba,0x98,0x76,0x54,0x32,0x10,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kRfc8998Iv[12] = {
+    0x00,0x00,0x12,0x34,0x56,0x78,0x00,0x00,
+    0x00,0x00,0xab,0xcd,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kRfc8998Aad[20] = {
+    0xfe,0xed,0xfa,0xce,0xde,0xad,0xbe,0xef,
+    0xfe,0xed,0xfa,0xce,0xde,0xad,0xbe,0xef,
+    0xab,0xad,0xda,0xd2,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kRfc8998Pt[64] = {
+    0xaa,0xaa,0xaa,0xaa,0xaa,0xaa,0xaa,0xaa,
+    0xbb,0xbb,0xbb,0xbb,0xbb,0xbb,0xbb,0xbb,
+    0xcc,0xcc,0xcc,0xcc,0xcc,0xcc,0xcc,0xcc,
+    0xdd,0xdd,0xdd,0xdd,0xdd,0xdd,0xdd,0xdd,
+    0xee,0xee,0xee,0xee,0xee,0xee,0xee,0xee,
+    0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,
+    0xee,0xee,0xee,0xee,0xee,0xee,0xee,0xee,
+    0xaa,0xaa,0xaa,0xaa,0xaa,0xaa,0xaa,0xaa,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kRfc8998GcmCt[64] = {
+    0x17,0xf3,0x99,0xf0,0x8c,0x67,0xd5,0xee,
+    0x19,0xd0,0xdc,0x99,0x69,0xc4,0xbb,0x7d,
+    0x5f,0xd4,0x6f,0xd3,0x75,0x64,0x89,0x06,
+    0x91,0x57,0xb2,0x82,0xbb,0x20,0x07,0x35,
+    0xd8,0x27,0x10,0xca,0x5c,0x22,0xf0,0xcc,
+    0xfa,0x7c,0xbf,0x93,0xd4,0x96,0xac,0x15,
+    0xa5,0x68,0x34,0xcb,0xcf,0x98,0xc3,0x97,
+    0xb4,0x02,0x4a,0x26,0x91,0x23,0x3b,0x8d,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kRfc8998GcmTag[16] = {
+    0x83,0xde,0x35,0x41,0xe4,0xc2,0xb5,0x81,
+    0x77,0xe0,0x65,0xa9,0xbf,0x7b,0x62,0xec,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kRfc8998CcmCt[64] = {
+    0x48,0xaf,0x93,0x50,0x1f,0xa6,0x2a,0xdb,
+    0xcd,0x41,0x4c,0xce,0x60,0x34,0xd8,0x95,
+    0xdd,0xa1,0xbf,0x8f,0x13,0x2f,0x04,0x20,
+    0x98,0x66,0x15,0x72,0xe7,0x48,0x30,0x94,
+    0xfd,0x12,0xe5,0x18,0xce,0x06,0x2c,0x98,
+    0xac,0xee,0x28,0xd9,0x5d,0xf4,0x41,0x6b,
+    0xed,0x31,0xa2,0xf0,0x44,0x76,0xc1,0x8b,
+    0xb4,0x0c,0x84,0xa7,0x4b,0x97,0xdc,0x5b,
+};
+
+__attribute__((aligned(16)))
+static const uint8_t kRfc8998CcmTag[16] = {
+    0x16,0x84,0x2d,0x4f,0xa1,0x86,0xf5,0x6a,
+    0xb3,0x32,0x56,0x97,0x1f,0xa1,0x10,0xf4,
+};
+
+// ----------------------------------------------------------------------
+
+enum AeadMode {
+    kGcm,
+    kCcm,
+};
+
+struct aead_test {
+    const char* name;
+    enum AeadMode mode;
+    const uint8_t* key;
+    const uint8_t* iv;
+    const uint8_t* aad;
+    const uint8_t* pt;
+    const uint8_t* ct;
+    const uint8_t* tag;
+    // Lengths are in bytes.
+    size_t ivlen;
+    size_t aadlen;
+    size_t len;
+    size_t taglen;
+};
+
+static const struct aead_test kTests[] = {
+    {
+        .name = "RFC 8998 A.1 SM4-GCM",
+        .mode = kGcm,
+        .key = kRfc8998Key,
+        .iv = kRfc8998Iv,
+        .ivlen = sizeof(kRfc8998Iv),
+        .aad = kRfc8998Aad,
+        .aadlen = sizeof(kRfc8998Aad),
+        .pt = kRfc8998Pt,
+        .ct = kRfc8998GcmCt,
+        .len = sizeof(kRfc8998Pt),
+        .tag = kRfc8998GcmTag,
+        .taglen = sizeof(kRfc8998GcmTag),
+    },
+    {
+        .name = "RFC 8998 A.2 SM4-CCM",
+        .mode = kCcm,
+        .key = kRfc8998Key,
+        .iv = kRfc8998Iv,
+        .ivlen = sizeof(kRfc8998Iv),
+        .aad = kRfc8998Aad,
+        .aadlen = sizeof(kRfc8998Aad),
+        .pt = kRfc8998Pt,
+        .ct = kRfc8998CcmCt,
+        .len = sizeof(kRfc8998Pt),
+        .tag = kRfc8998CcmTag,
+        .taglen = sizeof(kRfc8998CcmTag),
+    },
+};
+
+#define BUF_SIZE (4096)
+
+struct sm4_key {
+    uint32_t round_keys[32];
+};
+
+static struct block_cipher
+sm4_cipher(struct sm4_key* key, const uint8_t* raw_key)
+{
+    zvksed_sm4_expand_key(key->round_keys, raw_key);
+    const struct block_cipher cipher = {
+        .name = "SM4",
+        .encode = &zvksed_sm4_encode_vs,
+        .expanded_key = key->round_keys,
+    };
+    return cipher;
+}
+
+static void
+aead_transform(
+    const struct aead_test* test,
+    const struct block_cipher* cipher,
+    bool encrypt,
+    uint8_t* dest,
+    const uint8_t* src,
+    uint8_t tag[16]
+)
+{
+    switch (test->mode) {
+      case kGcm:
+        if (encrypt) {
+            gcm_encrypt(cipher, dest, src, test->len, test->iv, test->ivlen,
+                        test->aad, test->aadlen, tag);
+        } else {
+            gcm_decrypt(cipher, dest, src, test->len, test->iv, test->ivlen,
+                        test->aad, test->aadlen, tag);
+        }
+        break;
+      case kCcm:
+        if (encrypt) {
+            ccm_encrypt(cipher, dest, src, test->len, test->iv, test->ivlen,
+                        test->aad, test->aadlen, tag, test->taglen);
+        } else {
+            ccm_decrypt(cipher, dest, src, test->len, test->iv, test->ivlen,
+                        test->aad, test->aadlen, tag, test->taglen);
+        }
+        break;
+    }
+}
+
+static void
+print_mismatch(const char* what, const uint8_t* output,
+               const uint8_t* expected, size_t len)
+{
+    printf("\n%s mismatch", what);
+    printf("\noutput:   0x");
+    for (size_t i = 0; i < len; i++) {
+        printf("%02x", output[i]);
+    }
+    printf("\nexpected: 0x");
+    for (size_t i = 0; i < len; i++) {
+        printf("%02x", expected[i]);
+    }
+    printf("\n");
+}
+
+static int
+run_test(const struct aead_test* test, bool encrypt)
+{
+    __attribute__((aligned(16)))
+    uint8_t buf[BUF_SIZE];
+    __attribute__((aligned(16)))
+    uint8_t tag[16];
+
+    assert(test->len <= sizeof(buf));
+
+    struct sm4_key key;
+    const struct block_cipher cipher = sm4_cipher(&key, test->key);
+
+    const uint8_t* const input = encrypt ? test->pt : test->ct;
+    const uint8_t* const expected = encrypt ? test->ct : test->pt;
+    aead_transform(test, &cipher, encrypt, buf, input, tag);
+
+    if (memcmp(tag, test->tag, test->taglen) != 0) {
+        print_mismatch("Tag", tag, test->tag, test->taglen);
+        return 1;
+    }
+    if (memcmp(buf, expected, test->len) != 0) {
+        print_mismatch("Text", buf, expected, test->len);
+        return 1;
+    }
+
+    // A corrupted cipher text must not authenticate.
+    if (!encrypt && test->len > 0) {
+        memcpy(buf, test->ct, test->len);
+        buf[test->len - 1] ^= 0x01;
+        aead_transform(test, &cipher, false, buf, buf, tag);
+        if (memcmp(tag, test->tag, test->taglen) == 0) {
+            printf("\nCorrupted cipher text was authenticated\n");
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int
+run_block_test(void)
+{
+    __attribute__((aligned(16)))
+    uint8_t buf[16];
+
+    struct sm4_key key;
+    zvksed_sm4_expand_key(key.round_keys, kSm4BlockKey);
+    // GB/T 32907 uses the key as plain text.
+    zvksed_sm4_encode_vs(buf, kSm4BlockKey, sizeof(buf), key.round_keys);
+    if (memcmp(buf, kSm4BlockCt, sizeof(buf)) != 0) {
+        print_mismatch("Block", buf, kSm4BlockCt, sizeof(buf));
+        return 1;
+    }
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+// Throughput comparison
+//
+// All the configurations share the same VLEN (the one of the current run)
+// and the same GCM driver, only the block cipher differs.
+
+static void
+bench_aead(const char* name, const struct block_cipher* cipher,
+           enum AeadMode mode, size_t len)
+{
+    __attribute__((aligned(16)))
+    static uint8_t buf[BUF_SIZE];
+    __attribute__((aligned(16)))
+    uint8_t tag[16];
+
+    assert(len <= sizeof(buf));
+    memset(buf, 0x5a, len);
+
+    const struct aead_test test = {
+        .mode = mode,
+        .iv = kRfc8998Iv,
+        .ivlen = sizeof(kRfc8998Iv),
+        .aad = kRfc8998Aad,
+        .aadlen = sizeof(kRfc8998Aad),
+        .len = len,
+        .taglen = 16,
+    };
+
+    // Warm up.
+    aead_transform(&test, cipher, true, buf, buf, tag);
+
+    const uint64_t cycle_start = bench_read_cycle();
+    const uint64_t instret_start = bench_read_instret();
+    for (size_t i = 0; i < BENCH_ITERATIONS; i++) {
+        aead_transform(&test, cipher, true, buf, buf, tag);
+    }
+    const uint64_t instret = bench_read_instret() - instret_start;
+    const uint64_t cycles = bench_read_cycle() - cycle_start;
+
+    const uint64_t bytes = BENCH_ITERATIONS * len;
+    LOG("%-12s %5zu B: %8" PRIu64 " instret/op, %6.2f instret/B,"
+        " %6.2f cycles/B",
+        name, len, instret / BENCH_ITERATIONS,
+        (double)instret / bytes, (double)cycles / bytes);
+}
+
+static void
+run_benchmarks(void)
+{
+    static const size_t kSizes[] = { 64, 256, 1024, 4096 };
+
+    struct sm4_key sm4_key;
+    const struct block_cipher sm4 = sm4_cipher(&sm4_key, kRfc8998Key);
+
+    __attribute__((aligned(16)))
+    uint32_t aes_key[44];
+    zvkned_aes128_expand_key(aes_key, kRfc8998Key);
+    const struct block_cipher aes = {
+        .name = "AES-128",
+        .encode = &zvkned_aes128_encode_vs_lmul4,
+        .expanded_key = aes_key,
+    };
+
+    for (size_t i = 0; i < sizeof(kSizes) / sizeof(*kSizes); i++) {
+        bench_aead("AES-128-GCM", &aes, kGcm, kSizes[i]);
+        bench_aead("SM4-GCM", &sm4, kGcm, kSizes[i]);
+        bench_aead("SM4-CCM", &sm4, kCcm, kSizes[i]);
+    }
+}
+
+int
+main()
+{
+    const uint64_t vlen = vlen_bits();
+    LOG("VLEN = %" PRIu64, vlen);
+    if (vlen < 128) {
+        LOG("Skipping SM4 AEAD tests due to VLEN < 128");
+        return 0;
+    }
+
+    LOG("--- Running SM4 block test...");
+    if (run_block_test() != 0) {
+        printf("SM4 block test failed\n");
+        exit(1);
+    }
+
+    const size_t num_tests = sizeof(kTests) / sizeof(*kTests);
+    for (size_t i = 0; i < num_tests; i++) {
+        LOG("--- Running '%s' encryption test...", kTests[i].name);
+        if (run_test(&kTests[i], true) != 0) {
+            printf("Test '%s' (encryption) failed\n", kTests[i].name);
+            exit(1);
+        }
+        LOG("--- Running '%s' decryption test...", kTests[i].name);
+        if (run_test(&kTests[i], false) != 0) {
+            printf("Test '%s' (decryption) failed\n", kTests[i].name);
+            exit(1);
+        }
+    }
+    LOG("Success, %zu SM4 AEAD tests run.", 2 * num_tests);
+
+    LOG("------ Throughput (VLEN = %" PRIu64 ")", vlen);
+    run_benchmarks();
+    return 0;
+}
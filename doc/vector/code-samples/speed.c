@@ -0,0 +1,375 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// rvcrypto-speed: "openssl speed" for the vector kernels.
+//
+//   rvcrypto-speed [-c cycles] [-i impl,...] [-l] [algorithm ...]
+//
+// Times each algorithm, with each kernel implementing it that the VLEN
+// of the hart allows, over inputs of each of kSizes bytes. Each size is
+// run for a budget of 'cycles' cycles, rather than a number of calls, so
+// that slow and fast kernels take about as long. One table row is printed
+// per algorithm, kernel and size, with the rate in operations (calls) per
+// second of wall clock time and in bytes per rdcycle cycle. The table is
+// that of benchmarks/cli/rvcrypto-speed, so the scalar and vector results
+// can be put side by side. These samples build without the benchmarks
+// tree, so the timing loop and list parsing are a copy of that tool's:
+// change both together.
+//
+// Hash rows time the compression of every block of a padded message of
+// the given length, as hashing it would.
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "bench.h"
+#include "block-cipher.h"
+#include "gcm.h"
+#include "log.h"
+#include "vlen-bits.h"
+#include "zvkned.h"
+#include "zvknh.h"
+#include "zvksed.h"
+#include "zvksh.h"
+
+// Cycles each algorithm is timed for at each size, unless -c is given.
+#define SPEED_CYCLES (100000000)
+
+#define SPEED_MAX_BYTES (16384)
+
+// Input lengths in bytes, as openssl speed.
+static const size_t kSizes[] = { 16, 64, 256, 1024, 8192, 16384 };
+
+// Inputs and keys shared by every kernel, 32b aligned as they require.
+struct speed_ctx {
+    __attribute__((aligned(16)))
+    uint8_t buf[SPEED_MAX_BYTES + SHA512_BLOCK_SIZE];
+    __attribute__((aligned(16)))
+    uint8_t key[32];
+    __attribute__((aligned(16)))
+    uint8_t iv[16];
+    __attribute__((aligned(16)))
+    uint32_t round_keys[60];
+    __attribute__((aligned(16)))
+    uint8_t hash[SHA512_DIGEST_SIZE];
+    struct block_cipher cipher;
+};
+
+struct speed_routine {
+    const char* algorithm;
+    const char* name;
+    // Minimum VLEN (bits) the kernel runs with.
+    size_t min_vlen;
+    // Makes the key schedule, once per kernel. May be NULL.
+    void (*setup)(struct speed_ctx* ctx, const struct speed_routine* r);
+    // One operation, over the first 'len' bytes of ctx->buf.
+    void (*run)(struct speed_ctx* ctx, const struct speed_routine* r,
+                size_t len);
+    union {
+        block_encode_fn_t* block;
+        void (*sm4_vv)(void* dest, const void* src, uint64_t length,
+                       const void* master_key);
+        void (*sha)(uint8_t* hash, const void* block);
+        void (*sm3)(void* dest, const void* src, uint64_t length);
+    } fn;
+};
+
+// ----------------------------------------------------------------------
+// Algorithms
+
+static void
+setup_aes128(struct speed_ctx* ctx, const struct speed_routine* r)
+{
+    zvkned_aes128_expand_key(ctx->round_keys, ctx->key);
+}
+
+static void
+setup_aes256(struct speed_ctx* ctx, const struct speed_routine* r)
+{
+    zvkned_aes256_expand_key(ctx->round_keys, ctx->key);
+}
+
+static void
+setup_aes128_gcm(struct speed_ctx* ctx, const struct speed_routine* r)
+{
+    zvkned_aes128_expand_key(ctx->round_keys, ctx->key);
+    ctx->cipher.name = "AES-128";
+    ctx->cipher.encode = r->fn.block;
+    ctx->cipher.decode = NULL;
+    ctx->cipher.expanded_key = ctx->round_keys;
+}
+
+static void
+setup_sm4(struct speed_ctx* ctx, const struct speed_routine* r)
+{
+    zvksed_sm4_expand_key(ctx->round_keys, ctx->key);
+}
+
+static void
+run_block(struct speed_ctx* ctx, const struct speed_routine* r, size_t len)
+{
+    r->fn.block(ctx->buf, ctx->buf, len, ctx->round_keys);
+}
+
+static void
+run_gcm(struct speed_ctx* ctx, const struct speed_routine* r, size_t len)
+{
+    gcm_encrypt(&ctx->cipher, ctx->buf, ctx->buf, len, ctx->iv, 12,
+                NULL, 0, ctx->hash);
+}
+
+static void
+run_sm4_vv(struct speed_ctx* ctx, const struct speed_routine* r, size_t len)
+{
+    r->fn.sm4_vv(ctx->buf, ctx->buf, len, ctx->key);
+}
+
+static void
+run_sha256(struct speed_ctx* ctx, const struct speed_routine* r, size_t len)
+{
+    // The padding adds a 0x80 byte and a 64-bit length.
+    const size_t nblocks = (len + 9 + SHA256_BLOCK_SIZE - 1) / SHA256_BLOCK_SIZE;
+
+    memcpy(ctx->hash, kSha256InitialHash, sizeof(kSha256InitialHash));
+    for (size_t i = 0; i < nblocks; i++) {
+        r->fn.sha(ctx->hash, ctx->buf + i * SHA256_BLOCK_SIZE);
+    }
+}
+
+static void
+run_sha512(struct speed_ctx* ctx, const struct speed_routine* r, size_t len)
+{
+    // The padding adds a 0x80 byte and a 128-bit length.
+    const size_t nblocks = (len + 17 + SHA512_BLOCK_SIZE - 1) / SHA512_BLOCK_SIZE;
+
+    memcpy(ctx->hash, kSha512InitialHash, sizeof(kSha512InitialHash));
+    for (size_t i = 0; i < nblocks; i++) {
+        r->fn.sha(ctx->hash, ctx->buf + i * SHA512_BLOCK_SIZE);
+    }
+}
+
+static void
+run_sm3(struct speed_ctx* ctx, const struct speed_routine* r, size_t len)
+{
+    const size_t padded = (len + 9 + 63) / 64 * 64;
+
+    r->fn.sm3(ctx->hash, ctx->buf, padded);
+}
+
+#define BLOCK(ALG, SETUP, RUN, FN, MIN_VLEN) \
+    { ALG, #FN, MIN_VLEN, SETUP, RUN, { .block = FN } }
+
+static const struct speed_routine kRoutines[] = {
+    BLOCK("aes-128-ecb", setup_aes128, run_block, zvkned_aes128_encode_vs_lmul1, 128),
+    BLOCK("aes-128-ecb", setup_aes128, run_block, zvkned_aes128_encode_vs_lmul2, 64),
+    BLOCK("aes-128-ecb", setup_aes128, run_block, zvkned_aes128_encode_vs_lmul4, 32),
+    BLOCK("aes-128-ecb", setup_aes128, run_block, zvkned_aes128_encode_vv_lmul1, 128),
+    BLOCK("aes-256-ecb", setup_aes256, run_block, zvkned_aes256_encode_vs_lmul1, 128),
+    BLOCK("aes-256-ecb", setup_aes256, run_block, zvkned_aes256_encode_vs_lmul2, 64),
+    BLOCK("aes-256-ecb", setup_aes256, run_block, zvkned_aes256_encode_vs_lmul4, 32),
+    BLOCK("aes-256-ecb", setup_aes256, run_block, zvkned_aes256_encode_vv_lmul1, 128),
+    BLOCK("aes-128-ecb-dec", setup_aes128, run_block, zvkned_aes128_decode_vs_lmul1, 128),
+    BLOCK("aes-128-ecb-dec", setup_aes128, run_block, zvkned_aes128_decode_vs_lmul2, 64),
+    BLOCK("aes-128-ecb-dec", setup_aes128, run_block, zvkned_aes128_decode_vv_lmul1, 128),
+    // gcm.c with Zvkg, over the Zvkned kernel the GCM test uses.
+    BLOCK("aes-128-gcm", setup_aes128_gcm, run_gcm, zvkned_aes128_encode_vs_lmul4, 128),
+    BLOCK("sm4-ecb", setup_sm4, run_block, zvksed_sm4_encode_vs, 128),
+    { "sm4-ecb", "zvksed_sm4_encode_vv", 128, NULL, run_sm4_vv,
+      { .sm4_vv = zvksed_sm4_encode_vv } },
+    { "sha256", "sha256_block_lmul1", 128, NULL, run_sha256,
+      { .sha = sha256_block_lmul1 } },
+    { "sha256", "sha256_block_vslide_lmul1", 128, NULL, run_sha256,
+      { .sha = sha256_block_vslide_lmul1 } },
+    { "sha512", "sha512_block_lmul1", 256, NULL, run_sha512,
+      { .sha = sha512_block_lmul1 } },
+    { "sha512", "sha512_block_lmul2", 128, NULL, run_sha512,
+      { .sha = sha512_block_lmul2 } },
+    { "sm3", "zvksh_sm3_encode_lmul1", 256, NULL, run_sm3,
+      { .sm3 = zvksh_sm3_encode_lmul1 } },
+    { "sm3", "zvksh_sm3_encode_lmul2", 128, NULL, run_sm3,
+      { .sm3 = zvksh_sm3_encode_lmul2 } },
+    { "sm3", "zvksh_sm3_encode_lmul4", 64, NULL, run_sm3,
+      { .sm3 = zvksh_sm3_encode_lmul4 } },
+};
+
+#define NUM_ROUTINES (sizeof(kRoutines) / sizeof(kRoutines[0]))
+
+// ----------------------------------------------------------------------
+// Timing
+
+static uint64_t
+now_ns(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000000 + (uint64_t)tv.tv_usec * 1000;
+}
+
+// Runs 'r' over 'len' bytes until 'budget' cycles have passed. Calls are
+// made in batches, so that reading the counters costs little next to short
+// operations. Each batch is sized from the rate of those before it to end
+// near the budget, and at most doubles.
+static void
+time_routine(
+    struct speed_ctx* ctx,
+    const struct speed_routine* r,
+    size_t len,
+    uint64_t budget,
+    uint64_t* ops,
+    uint64_t* cycles,
+    uint64_t* ns
+) {
+    // Warm up.
+    r->run(ctx, r, len);
+
+    *ops = 0;
+    *cycles = 0;
+    *ns = 0;
+
+    for (uint64_t batch = 1; *cycles < budget;) {
+        const uint64_t ns_start = now_ns();
+        const uint64_t cycle_start = bench_read_cycle();
+        for (uint64_t i = 0; i < batch; i++) {
+            r->run(ctx, r, len);
+        }
+        *cycles += bench_read_cycle() - cycle_start;
+        *ns += now_ns() - ns_start;
+        *ops += batch;
+
+        const uint64_t per_op = *cycles / *ops + 1;
+        const uint64_t left = *cycles < budget ? (budget - *cycles) / per_op : 0;
+        batch = left < 2 * batch ? left + 1 : 2 * batch;
+    }
+}
+
+// Returns true if 'name' is in the comma separated 'list', or if 'list'
+// is NULL.
+static bool
+listed(const char* list, const char* name)
+{
+    const size_t len = strlen(name);
+    if (list == NULL) {
+        return true;
+    }
+    for (;;) {
+        if (strncmp(list, name, len) == 0 &&
+            (list[len] == ',' || list[len] == '\0')) {
+            return true;
+        }
+        const char* const next = strchr(list, ',');
+        if (next == NULL) {
+            return false;
+        }
+        list = next + 1;
+    }
+}
+
+static void
+usage(void)
+{
+    printf("usage: rvcrypto-speed [-c cycles] [-i impl,...] [-l] [algorithm ...]\n"
+           "  -c  cycles to time each algorithm and size for, default %d\n"
+           "  -i  kernels to time, default all the VLEN allows\n"
+           "  -l  list algorithms and kernels\n"
+           "With no algorithm, time them all.\n", SPEED_CYCLES);
+    exit(2);
+}
+
+int
+main(int argc, char** argv)
+{
+    static struct speed_ctx ctx;
+    uint64_t budget = SPEED_CYCLES;
+    const char* impls = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:i:l")) != -1) {
+        switch (opt) {
+          case 'c':
+            budget = strtoull(optarg, NULL, 0);
+            break;
+          case 'i':
+            impls = optarg;
+            break;
+          case 'l':
+            for (size_t i = 0; i < NUM_ROUTINES; i++) {
+                LOG("%-16s %s (VLEN>=%zu)", kRoutines[i].algorithm,
+                    kRoutines[i].name, kRoutines[i].min_vlen);
+            }
+            return 0;
+          default:
+            usage();
+        }
+    }
+
+    for (int i = optind; i < argc; i++) {
+        size_t r = 0;
+        while (r < NUM_ROUTINES && strcmp(argv[i], kRoutines[r].algorithm)) {
+            r++;
+        }
+        if (r == NUM_ROUTINES) {
+            LOG("rvcrypto-speed: unknown algorithm %s", argv[i]);
+            usage();
+        }
+    }
+
+    // Fixed inputs: the rates do not depend on the data.
+    memset(ctx.buf, 0x5a, sizeof(ctx.buf));
+    memset(ctx.key, 0xa5, sizeof(ctx.key));
+    memset(ctx.iv, 0x3c, sizeof(ctx.iv));
+
+    const uint64_t vlen = vlen_bits();
+    int rows = 0;
+
+    LOG("# rvcrypto-speed: VLEN=%" PRIu64 ", %" PRIu64
+        " cycles per algorithm and size", vlen, budget);
+    LOG("%-16s %-30s %6s %14s %12s",
+        "algorithm", "implementation", "bytes", "ops/s", "bytes/cycle");
+
+    for (size_t i = 0; i < NUM_ROUTINES; i++) {
+        const struct speed_routine* const r = &kRoutines[i];
+
+        bool wanted = optind == argc;
+        for (int a = optind; a < argc; a++) {
+            wanted |= strcmp(argv[a], r->algorithm) == 0;
+        }
+        if (!wanted || !listed(impls, r->name) || vlen < r->min_vlen) {
+            continue;
+        }
+        if (r->setup != NULL) {
+            r->setup(&ctx, r);
+        }
+
+        for (size_t s = 0; s < sizeof(kSizes) / sizeof(kSizes[0]); s++) {
+            uint64_t ops, cycles, ns;
+            time_routine(&ctx, r, kSizes[s], budget, &ops, &cycles, &ns);
+
+            LOG("%-16s %-30s %6zu %14.1f %12.4f", r->algorithm, r->name,
+                kSizes[s], ns ? ops * 1e9 / ns : 0.0,
+                cycles ? (double)ops * kSizes[s] / cycles : 0.0);
+            rows++;
+        }
+    }
+
+    if (rows == 0) {
+        LOG("rvcrypto-speed: nothing to time");
+        return 1;
+    }
+    return 0;
+}
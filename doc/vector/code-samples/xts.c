@@ -0,0 +1,222 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vlen-bits.h"
+#include "xts.h"
+#include "zvkg.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+// Number of blocks transformed by a single call to the block cipher,
+// a 4 KiB sector is transformed in one call.
+#define XTS_BATCH_BLOCKS (256)
+
+typedef union uint128 {
+    uint64_t dwords[2];
+    uint32_t words[4];
+    uint8_t bytes[16];
+} uint128;
+
+// T <- T o alpha, in the XTS (little-endian) representation.
+static void
+mul_alpha(uint128* T)
+{
+    const uint64_t carry = T->dwords[1] >> 63;
+    T->dwords[1] = (T->dwords[1] << 1) | (T->dwords[0] >> 63);
+    T->dwords[0] = (T->dwords[0] << 1) ^ (carry * 0x87);
+}
+
+// Reverses the order of the bits in each byte, converting between
+// the XTS and GCM representations of field elements.
+static uint128
+brev8(uint128 x)
+{
+    for (size_t i = 0; i < 16; i++) {
+        uint8_t b = x.bytes[i];
+        b = (uint8_t)((b & 0xf0) >> 4 | (b & 0x0f) << 4);
+        b = (uint8_t)((b & 0xcc) >> 2 | (b & 0x33) << 2);
+        b = (uint8_t)((b & 0xaa) >> 1 | (b & 0x55) << 1);
+        x.bytes[i] = b;
+    }
+    return x;
+}
+
+int
+xts_init(
+    struct xts_context* ctx,
+    const struct block_cipher* data,
+    const struct block_cipher* tweak
+)
+{
+    assert(data->encode != NULL && data->decode != NULL);
+    assert(tweak->encode != NULL);
+
+    ctx->data = data;
+    ctx->tweak = tweak;
+
+    // zvkg_xts_tweaks needs alpha^0 up to alpha^K, K being the number
+    // of element groups in a LMUL=4 register group.
+    const size_t max_egs = (4 * vlen_bits()) / 128;
+    ctx->num_alpha_powers = (max_egs > 0 ? max_egs : 1) + 1;
+    ctx->alpha_powers = aligned_alloc(16, 16 * ctx->num_alpha_powers);
+    if (ctx->alpha_powers == NULL) {
+        return -1;
+    }
+
+    // The powers below alpha^128 are single bits, the reduction only
+    // kicks in for larger VLENs.
+    uint128 power = { .bytes = { 1 } };
+    for (size_t i = 0; i < ctx->num_alpha_powers; i++) {
+        const uint128 gcm_power = brev8(power);
+        memcpy(&ctx->alpha_powers[4 * i], &gcm_power, 16);
+        mul_alpha(&power);
+    }
+    return 0;
+}
+
+void
+xts_destroy(struct xts_context* ctx)
+{
+    free(ctx->alpha_powers);
+    ctx->alpha_powers = NULL;
+    ctx->num_alpha_powers = 0;
+}
+
+// dest[i] = a[i] xor b[i], 'dest' and 'a' may alias and are not
+// required to be aligned.
+static void
+xor_blocks(void* dest, const void* a, const uint128* b, size_t nblocks)
+{
+    for (size_t i = 0; i < nblocks; i++) {
+        uint128 x;
+        memcpy(&x, (const uint8_t*)a + 16 * i, 16);
+        x.dwords[0] ^= b[i].dwords[0];
+        x.dwords[1] ^= b[i].dwords[1];
+        memcpy((uint8_t*)dest + 16 * i, &x, 16);
+    }
+}
+
+// Shared logic of xts_encrypt/xts_decrypt.
+//
+// Full blocks are processed in batches of XTS_BATCH_BLOCKS: the tweaks for
+// the whole batch are computed with zvkg_xts_tweaks, then the batch goes
+// through a single call to the block cipher. When 'len' is not a multiple
+// of the block size, the last full block and the partial block are handled
+// with ciphertext stealing.
+static void
+xts_transform(
+    const struct xts_context* ctx,
+    bool encrypt,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t iv[XTS_TWEAK_SIZE]
+)
+{
+    __attribute__((aligned(16)))
+    uint128 tweaks[XTS_BATCH_BLOCKS];
+    __attribute__((aligned(16)))
+    uint128 buf[XTS_BATCH_BLOCKS];
+
+    assert(len >= 16);
+
+    block_encode_fn_t* const transform =
+        encrypt ? ctx->data->encode : ctx->data->decode;
+    const uint32_t* const key = ctx->data->expanded_key;
+
+    // T = E_K2(i)
+    uint128 T;
+    memcpy(&T, iv, 16);
+    ctx->tweak->encode(&T, &T, 16, ctx->tweak->expanded_key);
+
+    const size_t remaining_bytes = len % 16;
+    // With ciphertext stealing the last full block is handled separately.
+    size_t remaining_blocks = len / 16 - (remaining_bytes != 0);
+
+    while (remaining_blocks > 0) {
+        const size_t nblocks = MIN(XTS_BATCH_BLOCKS, remaining_blocks);
+        zvkg_xts_tweaks(tweaks, &T, ctx->alpha_powers, nblocks);
+
+        // CC = E_K1(P xor T) xor T  (or D_K1 for decryption)
+        xor_blocks(buf, src, tweaks, nblocks);
+        transform(buf, buf, 16 * nblocks, key);
+        xor_blocks(dest, buf, tweaks, nblocks);
+
+        T = tweaks[nblocks - 1];
+        mul_alpha(&T);
+        src += 16 * nblocks;
+        dest += 16 * nblocks;
+        remaining_blocks -= nblocks;
+    }
+
+    if (remaining_bytes == 0) {
+        return;
+    }
+
+    // Ciphertext stealing, src/dest point to the last full block,
+    // followed by 'remaining_bytes' bytes.
+    // tweaks[0] is T_{m-1}, tweaks[1] T_m.
+    zvkg_xts_tweaks(tweaks, &T, ctx->alpha_powers, 2);
+    // Encryption uses the tweaks in order, decryption swaps them.
+    const uint128* const first_tweak = &tweaks[encrypt ? 0 : 1];
+    const uint128* const last_tweak = &tweaks[encrypt ? 1 : 0];
+
+    // CC = E_K1(P_{m-1} xor T) xor T  (or D_K1 for decryption)
+    uint128 cc;
+    xor_blocks(&cc, src, first_tweak, 1);
+    transform(&cc, &cc, 16, key);
+    xor_blocks(&cc, &cc, first_tweak, 1);
+
+    // PP = P_m || CC[r:], C_m = CC[:r]
+    uint128 pp = cc;
+    memcpy(&pp, &src[16], remaining_bytes);
+    memcpy(&dest[16], &cc, remaining_bytes);
+
+    // C_{m-1} = E_K1(PP xor T') xor T'
+    xor_blocks(&pp, &pp, last_tweak, 1);
+    transform(&pp, &pp, 16, key);
+    xor_blocks(dest, &pp, last_tweak, 1);
+}
+
+void
+xts_encrypt(
+    const struct xts_context* ctx,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t iv[XTS_TWEAK_SIZE]
+)
+{
+    xts_transform(ctx, true, dest, src, len, iv);
+}
+
+void
+xts_decrypt(
+    const struct xts_context* ctx,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t iv[XTS_TWEAK_SIZE]
+)
+{
+    xts_transform(ctx, false, dest, src, len, iv);
+}
@@ -0,0 +1,77 @@
+// Copyright 2022 Rivos Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XTS_H_
+#define XTS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "block-cipher.h"
+
+#define XTS_TWEAK_SIZE (16)
+
+// XEX-based tweaked-codebook mode with ciphertext stealing (IEEE 1619,
+// NIST SP 800-38E) on top of any 128 bit block cipher.
+//
+// 'data' is the cipher keyed with Key1, it must provide both 'encode' and
+// 'decode'. 'tweak' is the cipher keyed with Key2, only its 'encode' is
+// used.
+struct xts_context {
+    const struct block_cipher* data;
+    const struct block_cipher* tweak;
+    // alpha^0 ... alpha^num_alpha_powers-1, in GCM bit order, used by
+    // zvkg_xts_tweaks. Allocated by xts_init.
+    uint32_t* alpha_powers;
+    size_t num_alpha_powers;
+};
+
+// Initializes 'ctx', precomputing the powers of alpha required for the
+// current VLEN. Returns 0 on success.
+extern int
+xts_init(
+    struct xts_context* ctx,
+    const struct block_cipher* data,
+    const struct block_cipher* tweak
+);
+
+extern void
+xts_destroy(struct xts_context* ctx);
+
+// Encrypts (resp. decrypts) the 'len' bytes data unit (e.g., a disk sector)
+// at 'src' into 'dest', 'len' >= 16. 'iv' is the 128 bit tweak value,
+// typically the little-endian data unit sequence number.
+//
+// All buffers should be 32b aligned on processors that do not support
+// unaligned vector accesses.
+extern void
+xts_encrypt(
+    const struct xts_context* ctx,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t iv[XTS_TWEAK_SIZE]
+);
+
+extern void
+xts_decrypt(
+    const struct xts_context* ctx,
+    uint8_t* dest,
+    const uint8_t* src,
+    size_t len,
+    const uint8_t iv[XTS_TWEAK_SIZE]
+);
+
+#endif  // XTS_H_
@@ -15,6 +15,7 @@
 #ifndef ZVKG_H_
 #define ZVKG_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 // Y, X, and H point to 128 bits values, 32b aligned if the processor
@@ -56,4 +57,44 @@ zvkg_vgmul_vv(
     size_t n
 );
 
+// Y and H point to 128 bits values, X to an array of 'n' 128 bits
+// values, 32b aligned if the processor does not support unaligned access.
+//
+//   for i in [0, n): Y <- (Y xor X[i]) o H
+// where 'o' is the Galois Field Multiplication in GF(2^128).
+extern void
+zvkg_ghash(
+    void* Y,
+    const void* X,
+    const void* H,
+    size_t n
+);
+
+// Computes 'n' consecutive XTS tweaks, tweaks[i] = T o alpha^i.
+// 'alpha_powers' points to alpha^0 ... alpha^K, in GCM bit order, with
+// K >= 4*VLEN/128. All pointers should be 32b aligned if the processor
+// does not support unaligned access.
+extern void
+zvkg_xts_tweaks(
+    void* tweaks,
+    const void* T,
+    const void* alpha_powers,
+    size_t n
+);
+
+// Absorbs 'n' 128 bits blocks at 'X' into the POLYVAL (RFC 8452)
+// accumulator 'Y', K blocks at a time with one reduction per batch.
+// 'H_powers' points to H^num_powers, ..., H^1 in GHASH byte order, where H
+// is mulX_GHASH(ByteReverse(key)). 'num_powers' shall be a power of 2.
+// All pointers should be 32b aligned if the processor does not support
+// unaligned access.
+extern void
+zvkg_polyval(
+    void* Y,
+    const void* X,
+    const void* H_powers,
+    size_t num_powers,
+    size_t n
+);
+
 #endif  // ZVKG_H_
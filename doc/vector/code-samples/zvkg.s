@@ -140,3 +140,226 @@ zvkg_vgmul_vv:
 2:
     ret
 
+
+# zvkg_ghash
+#
+# Absorbs 'n' consecutive 128 bit blocks at 'X' into the GHASH
+# accumulator 'Y', i.e., for each block X[i] in order,
+#     Y <- (Y ^ X[i]) o H
+#
+# Unlike zvkg_vghsh, Y and H are kept in vector registers across
+# blocks, only X[i] is loaded from memory on each iteration. This
+# is the serial GHASH chain used by the GCM driver (gcm.c).
+# The input arrays should be 32b aligned on processors that do not
+# support unaligned 32b vector loads/stores.
+#
+#   void zvkg_ghash(
+#       uint32_t* Y,        // a0
+#       const uint32_t* X,  // a1
+#       const uint32_t* H,  // a2
+#       size_t    n         // a3
+#   );
+#
+.balign 4
+.global zvkg_ghash
+zvkg_ghash:
+    beqz a3, 2f  # Early exit in the "0 blocks to process" case
+    # We use LMUL=4 to enable runs with VLEN=32, as a proof of concept.
+    # Once VLEN>=128, we can simply use LMUL=1.
+    vsetivli x0, 4, e32, m4, ta, ma
+
+    vle32.v v0, (a0)
+    vle32.v v8, (a2)
+1:
+    vle32.v v4, (a1)
+    vghsh.vv v0, v8, v4  # Y(v0) = (Y(v0) ^ X(v4)) o H(v8)
+
+    add a1, a1, 16
+    add a3, a3, -1
+    bnez a3, 1b          # More blocks to process?
+
+    vse32.v v0, (a0)
+2:
+    ret
+
+# zvkg_xts_tweaks
+#
+# Computes 'n' consecutive XTS tweaks (IEEE 1619),
+#     tweaks[i] = T o alpha^i,  for i in [0, n)
+# where 'o' is the multiplication in GF(2^128) and alpha the primitive
+# element (x). XTS and GCM use the same field polynomial but XTS values are
+# little-endian with the bits of each byte in the reverse order compared to
+# GCM. Inputs are converted with vbrev8 before vgmul, and back afterwards.
+#
+# Rather than a serial chain of doublings, each iteration produces VL/4
+# tweaks at once: the tweaks are initialized as T o alpha^j for each element
+# group j, then all of them are multiplied by alpha^(VL/4) to obtain the
+# next VL/4 tweaks.
+#
+# 'alpha_powers' points to alpha^0, alpha^1, ..., alpha^K in GCM bit order,
+# where K is at least the number of element groups in a LMUL=4 register
+# group (4*VLEN/128).
+#
+# The input arrays should be 32b aligned on processors that do not
+# support unaligned 32b vector loads/stores.
+#
+#   void zvkg_xts_tweaks(
+#       void* tweaks,               // a0
+#       const void* T,              // a1
+#       const void* alpha_powers,   // a2
+#       size_t    n                 // a3
+#   );
+#
+.balign 4
+.global zvkg_xts_tweaks
+zvkg_xts_tweaks:
+    beqz a3, 2f  # Early exit in the "0 tweaks to compute" case
+    # a3 becomes the number of 32b elements to produce.
+    slli a3, a3, 2
+
+    # Load T, the first tweak.
+    vsetivli x0, 4, e32, m4, ta, ma
+    vle32.v v24, (a1)
+
+    vsetvli t0, a3, e32, m4, ta, ma
+    # Generate vector of [0, 1, 2, 3, 0, 1, 2, 3, ...] indices, used to
+    # broadcast a 128 bit value to all the element groups.
+    vid.v v16
+    vand.vi v16, v16, 3
+
+    # v12 <- brev8(T) in all element groups.
+    vrgather.vv v12, v24, v16
+    vbrev8.v v12, v12
+    # v4 <- [alpha^0, alpha^1, ...], one power per element group.
+    vle32.v v4, (a2)
+    # v12 <- [T o alpha^0, T o alpha^1, ...]
+    vgmul.vv v12, v4
+
+1:
+    vsetvli t0, a3, e32, m4, ta, ma
+
+    # Store the tweaks, converted back to the XTS bit order.
+    vbrev8.v v0, v12
+    vse32.v v0, (a0)
+
+    # v8 <- alpha^(t0/4) in all element groups, the factor advancing
+    # all tweaks by the number of element groups just processed.
+    slli t1, t0, 2              # t1 <- offset of alpha^(t0/4), 16*t0/4
+    add t1, a2, t1
+    vsetivli x0, 4, e32, m4, ta, ma
+    vle32.v v24, (t1)
+    vsetvli t0, a3, e32, m4, ta, ma
+    vrgather.vv v8, v24, v16
+    vgmul.vv v12, v8
+
+    sub a3, a3, t0              # Decrement number of remaining 32b elements
+    slli t0, t0, 2              # t0 (#bytes) <- t0 (#4B) * 4
+    add a0, a0, t0
+    bnez a3, 1b                 # More tweaks to compute?
+
+2:
+    ret
+
+# zvkg_polyval
+#
+# Absorbs 'n' consecutive 128 bit blocks at 'X' into the POLYVAL (RFC 8452)
+# accumulator 'Y'. POLYVAL is GHASH with byte-reversed inputs and outputs
+# and a key mulX_GHASH(ByteReverse(H)) (RFC 8452, Appendix A). The byte
+# reversal of each 128 bit block is done with vrev8 (Zvbb) on 32b words
+# followed by a reversal of the words within the element group.
+#
+# Blocks are processed in batches of K, one per element group, with the
+# aggregated reduction
+#     Y <- ((Y ^ X[0]) o H^K) ^ (X[1] o H^(K-1)) ^ ... ^ (X[K-1] o H)
+# i.e., a single vghsh for the whole batch, followed by a XOR reduction of
+# the element groups. K is the number of element groups in a LMUL=4 register
+# group, capped to 'num_powers'. A final partial batch of k blocks uses the
+# last k powers.
+#
+# 'H_powers' points to H^num_powers, ..., H^2, H^1, in GHASH byte order,
+# where H is the GHASH form of the POLYVAL key. 'num_powers' shall be a
+# power of 2. 'Y' and 'X' are in POLYVAL byte order.
+# The input arrays should be 32b aligned on processors that do not
+# support unaligned 32b vector loads/stores.
+#
+#   void zvkg_polyval(
+#       void* Y,                // a0
+#       const void* X,          // a1
+#       const void* H_powers,   // a2
+#       size_t num_powers,      // a3
+#       size_t n                // a4
+#   );
+#
+.balign 4
+.global zvkg_polyval
+zvkg_polyval:
+    beqz a4, 4f  # Early exit in the "0 blocks to process" case
+    # a3 and a4 become numbers of 32b elements.
+    slli a3, a3, 2
+    slli a4, a4, 2
+
+    # t2 <- 4*K, the number of 32b elements in a full batch.
+    vsetvli t2, a3, e32, m4, ta, ma
+    # Indices reversing the order of the 32b words of each element group.
+    vid.v v16
+    vxor.vi v16, v16, 3
+
+    # v0[0] <- ByteReverse(Y)
+    vsetivli x0, 4, e32, m4, ta, ma
+    vle32.v v20, (a0)
+    vrev8.v v20, v20
+    vrgather.vv v0, v20, v16
+
+1:
+    mv t0, a4
+    bleu t0, t2, 2f
+    mv t0, t2
+2:
+    vsetvli t0, t0, e32, m4, ta, ma
+
+    # v4 <- ByteReverse(X[i]) for the k = t0/4 blocks of this batch.
+    vle32.v v20, (a1)
+    vrev8.v v20, v20
+    vrgather.vv v4, v20, v16
+
+    # v24 <- H^k, ..., H^1, the last k entries of the powers table.
+    sub t1, a3, t0
+    slli t1, t1, 2
+    add t1, a2, t1
+    vle32.v v24, (t1)
+
+    # Fold the accumulator into the first block of the batch, leaving the
+    # other blocks untouched.
+    vsetivli x0, 4, e32, m4, tu, ma
+    vxor.vv v4, v4, v0
+
+    # Multiply every block by its power of H. v0 is cleared on the full
+    # batch width so that the reduction below only sees k products.
+    vsetvli x0, t2, e32, m4, ta, ma
+    vmv.v.i v0, 0
+    vsetvli x0, t0, e32, m4, tu, ma
+    vghsh.vv v0, v24, v4
+
+    # XOR reduction of the element groups into v0[0].
+    vsetvli x0, t2, e32, m4, ta, ma
+    srli t1, t2, 1
+    li t3, 4
+3:
+    bltu t1, t3, 5f
+    vslidedown.vx v8, v0, t1
+    vxor.vv v0, v0, v8
+    srli t1, t1, 1
+    j 3b
+5:
+    sub a4, a4, t0              # Decrement number of remaining 32b elements
+    slli t0, t0, 2              # t0 (#bytes) <- t0 (#4B) * 4
+    add a1, a1, t0
+    bnez a4, 1b                 # More blocks to process?
+
+    # Y <- ByteReverse(v0[0])
+    vsetivli x0, 4, e32, m4, ta, ma
+    vrev8.v v20, v0
+    vrgather.vv v4, v20, v16
+    vse32.v v4, (a0)
+4:
+    ret
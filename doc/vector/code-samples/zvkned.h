@@ -66,6 +66,15 @@ zvkned_aes128_encode_vv_lmul1(
    const uint32_t* expanded_key
 );
 
+// Encodes 'n' blocks, block 'i' of 'src' with the expanded key 'keys[i]'.
+extern void
+zvkned_aes128_encode_multi_key(
+   void* dest,
+   const void* src,
+   const uint32_t* const* keys,
+   uint64_t n
+);
+
 
 // AES-128 Decoding
 
@@ -738,6 +738,118 @@ zvkned_aes128_encode_vv_lmul1:
 # zvkned_aes128_encode_vv_lmul1
 
 
+# zvkned_aes128_encode_multi_key
+#
+# Encodes 'n' blocks of 16 bytes from 'src' into 'dest', block 'i' being
+# encoded with the AES-128 expanded key (44 words, as produced by
+# 'zvkned_aes128_expand_key') at 'keys[i]'. This serves many sessions
+# encrypting one or a few blocks each, e.g., a VPN concentrator, in a
+# single pass instead of one call (with its key loads) per session.
+#
+# This is the use case noted in (I) at the top of this file: each element
+# group holds a distinct key, so the round keys are loaded with indexed
+# loads (one per round), and the ".vv" forms of the AES instructions are
+# used.
+#
+# This variant uses LMUL=2 for the text and the round keys, which keeps
+# the 11 round key groups (v10-v31) resident, and requires VLEN>=64.
+#
+# C/C++ Signature
+#   extern "C" void
+#   zvkned_aes128_encode_multi_key(
+#       void* dest,                   // a0
+#       const void* src,              // a1
+#       const uint32_t* const* keys,  // a2
+#       uint64_t n                    // a3
+#   );
+#  a0=dest, a1=src, a2=&keys[0], a3=n
+#
+.balign 4
+.global zvkned_aes128_encode_multi_key
+zvkned_aes128_encode_multi_key:
+    beqz a3, 2f  # Early exit in the "0 blocks to process" case
+    # t3 <- n * 4, number of remaining 4B elements
+    slli t3, a3, 2
+
+1:
+    # t2 receives the number of 4B elements processed in this iteration,
+    # i.e., 4 times the number of blocks/keys.
+    vsetvli t2, t3, e32, m2, ta, ma
+
+    # Compute in v4 the address of each 4B element of the first round key
+    # of each element group, i.e., v4[i] <- keys[i/4] + 4 * (i%4).
+    # Addresses are 64b wide, the index EEW is 64 (EMUL=4).
+    vsetvli x0, t2, e64, m4, ta, ma
+    vid.v v4                    # v4[i] <- i
+    vsrl.vi v0, v4, 2           # v0[i] <- i / 4, the element group index
+    vsll.vi v0, v0, 3           # v0[i] <- offset of keys[i/4] in 'keys'
+    vluxei64.v v0, (a2), v0     # v0[i] <- keys[i/4]
+    vand.vi v4, v4, 3           # v4[i] <- i % 4
+    vsll.vi v4, v4, 2           # v4[i] <- 4 * (i % 4)
+    vadd.vv v4, v4, v0          # v4[i] <- keys[i/4] + 4 * (i % 4)
+
+    # Gather the 11 round keys of each element group into v10-v30, the
+    # base register t4 selecting the round (16 bytes per round key).
+    vsetvli x0, t2, e32, m2, ta, ma
+    mv t4, x0
+    vluxei64.v v10, (t4), v4    # w[ 0, 3]
+    addi t4, t4, 16
+    vluxei64.v v12, (t4), v4    # w[ 4, 7]
+    addi t4, t4, 16
+    vluxei64.v v14, (t4), v4    # w[ 8,11]
+    addi t4, t4, 16
+    vluxei64.v v16, (t4), v4    # w[12,15]
+    addi t4, t4, 16
+    vluxei64.v v18, (t4), v4    # w[16,19]
+    addi t4, t4, 16
+    vluxei64.v v20, (t4), v4    # w[20,23]
+    addi t4, t4, 16
+    vluxei64.v v22, (t4), v4    # w[24,27]
+    addi t4, t4, 16
+    vluxei64.v v24, (t4), v4    # w[28,31]
+    addi t4, t4, 16
+    vluxei64.v v26, (t4), v4    # w[32,35]
+    addi t4, t4, 16
+    vluxei64.v v28, (t4), v4    # w[36,39]
+    addi t4, t4, 16
+    vluxei64.v v30, (t4), v4    # w[40,43]
+
+    # Load plain text from `src`.
+    vle32.v v0, (a1)
+
+    # Initial AddRoundKey
+    vxor.vv v0, v0, v10
+    # Middle rounds, vaesem performs
+    # SubBytes+ShiftRows+MixColumns+AddRoundKey
+    vaesem.vv v0, v12
+    vaesem.vv v0, v14
+    vaesem.vv v0, v16
+    vaesem.vv v0, v18
+    vaesem.vv v0, v20
+    vaesem.vv v0, v22
+    vaesem.vv v0, v24
+    vaesem.vv v0, v26
+    vaesem.vv v0, v28
+    # Final round, SubBytes+ShiftRows+AddRoundKey.
+    vaesef.vv v0, v30
+
+    # Store cypher text
+    vse32.v v0, (a0)
+
+    sub t3, t3, t2              # Decrement count (4B elements)
+    slli t1, t2, 1              # t1 <- t2 / 4 * 8, bytes of 'keys' consumed
+    add a2, a2, t1
+    slli t2, t2, 2              # t2 (#bytes) <- t2 (#4B) * 4
+    add a1, a1, t2              # Increment source address (bytes)
+    add a0, a0, t2              # Increment target address (bytes)
+
+    bnez t3, 1b                 # Continue the loop?
+
+2:
+    ret
+# zvkned_aes128_encode_multi_key
+
+
 ######################################################################
 # AES-128 Decode Routines
 ######################################################################
@@ -101,6 +101,16 @@ sha256_block_vslide_lmul1(
     const void* block
 );
 
+// Updates the states of 'n' messages, laid out one after the other in
+// 'hashes' (8 words each, in the order of kSha256InitialHash), with the
+// 64 byte block 'blocks[i]' of message 'i'. Requires VLEN>=64.
+extern void
+sha256_block_multi_lmul2(
+    uint32_t* hashes,
+    const void* const* blocks,
+    uint64_t n
+);
+
 extern void
 sha512_block_lmul1(
     uint8_t* hash,
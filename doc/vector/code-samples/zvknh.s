@@ -875,6 +875,251 @@ sha256_block_vslide_lmul1:
 
 # sha256_block_vslide_lmul1
 
+
+# sha256_block_multi_lmul2
+#
+# Updates the SHA-256 states of 'n' independent messages with one 64 byte
+# block each: state 'i' (8 words at hashes + 8 * i, in the order of
+# sha256_block_lmul1) with the block at blocks[i]. This is a multi-buffer
+# kernel for many short messages, e.g. the packets of a network stack,
+# each too short to keep a vector unit busy on its own.
+#
+# Each element group holds a different message: vsha2ms, vsha2cl and
+# vsha2ch work on every element group of a register group independently.
+# The message words are gathered through 'blocks' with indexed loads, as
+# the round keys are in zvkned_aes128_encode_multi_key, the states with
+# indexed loads and stores, and each quad-round's constants are gathered
+# into every element group.
+#
+# A pass covers VLEN * 2 / 128 messages (LMUL=2), so this requires
+# VLEN>=64. Larger 'n' are done in several passes.
+#
+# C/C++ Signature
+#   extern "C" void
+#   sha256_block_multi_lmul2(
+#       uint32_t* hashes,              // a0
+#       const void* const* blocks,     // a1
+#       uint64_t n                     // a2
+#   );
+#
+.balign 4
+.global sha256_block_multi_lmul2
+sha256_block_multi_lmul2:
+    beqz a2, 2f  # Early exit in the "0 messages to process" case
+
+    # Register use in this function:
+    #
+    # SCALARS:
+    #  a0: state of the first message of this pass.
+    #  a1: block pointer of the first message of this pass.
+    #  t1: VLMAX, in 4B elements.
+    #  t2: 4B elements of this pass, 4 per message.
+    #  t3: 4B elements left to process, 4 per message.
+    #  t5: a0 + 16, second half of each state.
+    #  t6: round constants.
+    #
+    # VECTOR GROUPS (LMUL=2, except v4 which is an EMUL=4 index group)
+    #  v0      = mask of the first element of each element group.
+    #  v4-v7   = address of each 4B element of each message's block.
+    #  v8-v14  = message schedule words, as v10-v13 of sha256_block_lmul1.
+    #  v16     = temporary, Wt+Kt
+    #  v18     = Kt, in every element group
+    #  v20/v22 = working state {a,b,e,f}/{c,d,g,h}, as v16/v17
+    #  v24/v26 = initial state, as v26/v27
+    #  v28     = offset of each 4B element of each message's state
+    #  v30     = 4 * (i % 4), offset of each 4B element of a Kt quad
+
+    vsetvli t1, x0, e32, m2, ta, ma
+    slli t3, a2, 2
+
+1:
+    # t2 <- min(t3, VLMAX), so that a pass never splits an element group.
+    mv t2, t3
+    bleu t2, t1, 3f
+    mv t2, t1
+3:
+    # v4[i] <- blocks[i/4] + 4 * (i%4), the address of word i%4 of the
+    # first quad of the block of message i/4. Addresses are 64b wide.
+    vsetvli x0, t2, e64, m4, ta, ma
+    vid.v v4                    # v4[i] <- i
+    vsrl.vi v0, v4, 2           # v0[i] <- i / 4, the element group index
+    vsll.vi v0, v0, 3           # v0[i] <- offset of blocks[i/4] in 'blocks'
+    vluxei64.v v0, (a1), v0     # v0[i] <- blocks[i/4]
+    vand.vi v4, v4, 3
+    vsll.vi v4, v4, 2           # v4[i] <- 4 * (i % 4)
+    vadd.vv v4, v4, v0
+
+    vsetvli x0, t2, e32, m2, ta, ma
+    vid.v v16
+    vand.vi v30, v16, 3
+    vsll.vi v30, v30, 2         # v30[i] <- 4 * (i % 4)
+    vsrl.vi v28, v16, 2
+    vsll.vi v28, v28, 5
+    vadd.vv v28, v28, v30       # v28[i] <- 32 * (i / 4) + 4 * (i % 4)
+    vmseq.vi v0, v30, 0         # v0.mask[i] = (i % 4 == 0)
+
+    # Gather and byte swap W[15:0] of every message.
+    mv t4, x0
+    vluxei64.v v8, (t4), v4
+    vrev8.v v8, v8
+    addi t4, t4, 16
+    vluxei64.v v10, (t4), v4
+    vrev8.v v10, v10
+    addi t4, t4, 16
+    vluxei64.v v12, (t4), v4
+    vrev8.v v12, v12
+    addi t4, t4, 16
+    vluxei64.v v14, (t4), v4
+    vrev8.v v14, v14
+
+    # Gather the states.
+    addi t5, a0, 16
+    vluxei32.v v20, (a0), v28   # {a,b,e,f} of each message
+    vluxei32.v v22, (t5), v28   # {c,d,g,h} of each message
+    vmv.v.v v24, v20
+    vmv.v.v v26, v22
+
+    la t6, SHA256_ROUND_CONSTANTS
+
+    # Quad-round 0
+    vluxei32.v v18, (t6), v30
+    addi t6, t6, 16
+    vadd.vv v16, v18, v8
+    vsha2cl.vv v22, v20, v16
+    vsha2ch.vv v20, v22, v16
+    vmerge.vvm v16, v12, v10, v0
+    vsha2ms.vv v8, v16, v14
+    # Quad-round 1
+    vluxei32.v v18, (t6), v30
+    addi t6, t6, 16
+    vadd.vv v16, v18, v10
+    vsha2cl.vv v22, v20, v16
+    vsha2ch.vv v20, v22, v16
+    vmerge.vvm v16, v14, v12, v0
+    vsha2ms.vv v10, v16, v8
+    # Quad-round 2
+    vluxei32.v v18, (t6), v30
+    addi t6, t6, 16
+    vadd.vv v16, v18, v12
+    vsha2cl.vv v22, v20, v16
+    vsha2ch.vv v20, v22, v16
+    vmerge.vvm v16, v8, v14, v0
+    vsha2ms.vv v12, v16, v10
+    # Quad-round 3
+    vluxei32.v v18, (t6), v30
+    addi t6, t6, 16
+    vadd.vv v16, v18, v14
+    vsha2cl.vv v22, v20, v16
+    vsha2ch.vv v20, v22, v16
+    vmerge.vvm v16, v10, v8, v0
+    vsha2ms.vv v14, v16, v12
+    # Quad-round 4
+    vluxei32.v v18, (t6), v30
+    addi t6, t6, 16
+    vadd.vv v16, v18, v8
+    vsha2cl.vv v22, v20, v16
+    vsha2ch.vv v20, v22, v16
+    vmerge.vvm v16, v12, v10, v0
+    vsha2ms.vv v8, v16, v14
+    # Quad-round 5
+    vluxei32.v v18, (t6), v30
+    addi t6, t6, 16
+    vadd.vv v16, v18, v10
+    vsha2cl.vv v22, v20, v16
+    vsha2ch.vv v20, v22, v16
+    vmerge.vvm v16, v14, v12, v0
+    vsha2ms.vv v10, v16, v8
+    # Quad-round 6
+    vluxei32.v v18, (t6), v30
+    addi t6, t6, 16
+    vadd.vv v16, v18, v12
+    vsha2cl.vv v22, v20, v16
+    vsha2ch.vv v20, v22, v16
+    vmerge.vvm v16, v8, v14, v0
+    vsha2ms.vv v12, v16, v10
+    # Quad-round 7
+    vluxei32.v v18, (t6), v30
+    addi t6, t6, 16
+    vadd.vv v16, v18, v14
+    vsha2cl.vv v22, v20, v16
+    vsha2ch.vv v20, v22, v16
+    vmerge.vvm v16, v10, v8, v0
+    vsha2ms.vv v14, v16, v12
+    # Quad-round 8
+    vluxei32.v v18, (t6), v30
+    addi t6, t6, 16
+    vadd.vv v16, v18, v8
+    vsha2cl.vv v22, v20, v16
+    vsha2ch.vv v20, v22, v16
+    vmerge.vvm v16, v12, v10, v0
+    vsha2ms.vv v8, v16, v14
+    # Quad-round 9
+    vluxei32.v v18, (t6), v30
+    addi t6, t6, 16
+    vadd.vv v16, v18, v10
+    vsha2cl.vv v22, v20, v16
+    vsha2ch.vv v20, v22, v16
+    vmerge.vvm v16, v14, v12, v0
+    vsha2ms.vv v10, v16, v8
+    # Quad-round 10
+    vluxei32.v v18, (t6), v30
+    addi t6, t6, 16
+    vadd.vv v16, v18, v12
+    vsha2cl.vv v22, v20, v16
+    vsha2ch.vv v20, v22, v16
+    vmerge.vvm v16, v8, v14, v0
+    vsha2ms.vv v12, v16, v10
+    # Quad-round 11
+    vluxei32.v v18, (t6), v30
+    addi t6, t6, 16
+    vadd.vv v16, v18, v14
+    vsha2cl.vv v22, v20, v16
+    vsha2ch.vv v20, v22, v16
+    vmerge.vvm v16, v10, v8, v0
+    vsha2ms.vv v14, v16, v12
+    # Quad-round 12
+    vluxei32.v v18, (t6), v30
+    addi t6, t6, 16
+    vadd.vv v16, v18, v8
+    vsha2cl.vv v22, v20, v16
+    vsha2ch.vv v20, v22, v16
+    # Quad-round 13
+    vluxei32.v v18, (t6), v30
+    addi t6, t6, 16
+    vadd.vv v16, v18, v10
+    vsha2cl.vv v22, v20, v16
+    vsha2ch.vv v20, v22, v16
+    # Quad-round 14
+    vluxei32.v v18, (t6), v30
+    addi t6, t6, 16
+    vadd.vv v16, v18, v12
+    vsha2cl.vv v22, v20, v16
+    vsha2ch.vv v20, v22, v16
+    # Quad-round 15
+    vluxei32.v v18, (t6), v30
+    # No t6 increment needed.
+    vadd.vv v16, v18, v14
+    vsha2cl.vv v22, v20, v16
+    vsha2ch.vv v20, v22, v16
+
+    # H' = H+{a',b',c',...,h'}, scattered back to each message's state.
+    vadd.vv v20, v24, v20
+    vadd.vv v22, v26, v22
+    vsuxei32.v v20, (a0), v28
+    vsuxei32.v v22, (t5), v28
+
+    sub t3, t3, t2              # Decrement count (4B elements)
+    slli t0, t2, 3              # t0 <- t2 / 4 * 32, bytes of 'hashes' done
+    add a0, a0, t0
+    slli t0, t2, 1              # t0 <- t2 / 4 * 8, bytes of 'blocks' done
+    add a1, a1, t0
+
+    bnez t3, 1b
+
+2:
+    ret
+# sha256_block_multi_lmul2
+
 ######################################################################
 # SHA-512 Routines
 ######################################################################
@@ -33,4 +33,23 @@ zvksed_sm4_decode_vv(
     const void* masterKey
 );
 
+// Expands the 16 bytes (big-endian) 'key' into the 32 round keys
+// used by zvksed_sm4_encode_vs. 'dest' and 'key' should be 32b aligned.
+extern void
+zvksed_sm4_expand_key(
+    uint32_t* dest,     // uint32_t[32], 32b aligned
+    const void* key     // char[16], 32b aligned
+);
+
+// Encodes 'length' bytes (multiple of 16) of byte-oriented plain text
+// with the round keys produced by zvksed_sm4_expand_key. Returns the
+// number of bytes processed.
+extern uint64_t
+zvksed_sm4_encode_vs(
+    void* dest,
+    const void* src,
+    uint64_t length,
+    const uint32_t* round_keys
+);
+
 #endif  // ZVKSED_H_
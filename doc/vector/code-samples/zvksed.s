@@ -206,3 +206,162 @@ zvksed_sm4_decode_vv:
     add a1, a1, 16
     bnez a2, 1b
     ret
+
+# zvksed_sm4_expand_key
+#
+# Expands the 128 bit 'key' into the 32 round keys used by the
+# SM4 encryption, writing them at 'dest' (32 * 4B = 128B).
+#
+# Unlike the routines above, which operate on 32-bit words, 'key' is
+# a byte string in the big-endian order of GB/T 32907 (e.g., as found
+# in RFC 8998 test vectors). The round keys are stored in native word
+# order, four per round, as expected by the 'vsm4r.vs' based routines.
+#
+# Requires VLEN>=128.
+#
+# C/C++ Signature
+#   extern "C" void
+#   zvksed_sm4_expand_key(
+#       uint32_t dest[32],   // a0
+#       const void* key      // a1
+#   );
+#  a0=dest, a1=key
+#
+.balign 4
+.global zvksed_sm4_expand_key
+zvksed_sm4_expand_key:
+    vsetivli x0, 4, e32, m1, ta, ma
+
+    # Load the key and convert its big-endian words to native words.
+    vle32.v v10, (a1)
+    vrev8.v v10, v10
+
+    # Stage -1 of key expansion, round_key rk{-3:-1}
+    la t6, FK
+    vle32.v v11, (t6)
+    vxor.vv v10, v10, v11
+
+    # Generate and store the round keys, 4 per vsm4k instruction.
+    vsm4k.vi v10, v10, 0
+    vse32.v v10, (a0)   # rk[0:3]
+    add a0, a0, 16
+    vsm4k.vi v10, v10, 1
+    vse32.v v10, (a0)   # rk[4:7]
+    add a0, a0, 16
+    vsm4k.vi v10, v10, 2
+    vse32.v v10, (a0)   # rk[8:11]
+    add a0, a0, 16
+    vsm4k.vi v10, v10, 3
+    vse32.v v10, (a0)   # rk[12:15]
+    add a0, a0, 16
+    vsm4k.vi v10, v10, 4
+    vse32.v v10, (a0)   # rk[16:19]
+    add a0, a0, 16
+    vsm4k.vi v10, v10, 5
+    vse32.v v10, (a0)   # rk[20:23]
+    add a0, a0, 16
+    vsm4k.vi v10, v10, 6
+    vse32.v v10, (a0)   # rk[24:27]
+    add a0, a0, 16
+    vsm4k.vi v10, v10, 7
+    vse32.v v10, (a0)   # rk[28:31]
+
+    ret
+# zvksed_sm4_expand_key
+
+# zvksed_sm4_encode_vs
+#
+# Encodes the 'n' bytes of plain text at 'src' with the round keys
+# produced by zvksed_sm4_expand_key, placing the cipher text at 'dest'.
+# 'src' and 'dest' are byte strings (big-endian words), which makes this
+# routine a drop-in block cipher for byte oriented modes (CTR, GCM, CCM).
+#
+# 'n' should be a multiple of 16 bytes (128b).
+#
+# Returns the number of bytes processed, which is 'n' when 'n'
+# is a multiple of 16, and  floor(n/16)*16 otherwise.
+#
+# This variant uses LMUL=4, encoding up to 4*VLEN/128 blocks per
+# iteration, with the round keys broadcast from a single element group
+# by the 'vsm4r.vs' instructions. The round keys are kept in vector
+# registers for the whole duration of the routine.
+#
+# Requires VLEN>=128.
+#
+# C/C++ Signature
+#   extern "C" uint64_t
+#   zvksed_sm4_encode_vs(
+#       void* dest,                  // a0
+#       const void* src,             // a1
+#       uint64_t n,                  // a2
+#       const uint32_t round_keys[32]  // a3
+#   );
+#  a0=dest, a1=src, a2=n, a3=&round_keys[0]
+#
+.balign 4
+.global zvksed_sm4_encode_vs
+zvksed_sm4_encode_vs:
+    # a2 on input is number of bytes of the plaintext. We round it down
+    # to a multiple of 16 bytes (128b), keep that in t0 that we return.
+    andi t0, a2, -16
+    beqz t0, 2f  # Early exit in the "0 bytes to process" case
+    # t3 <- t0 / 4, number of remaining 4B elements
+    srli t3, t0, 2
+
+    # Load the round keys, one element group per register.
+    vsetivli x0, 4, e32, m1, ta, ma
+    vle32.v v16, (a3)   # rk[0:3]
+    add a3, a3, 16
+    vle32.v v17, (a3)   # rk[4:7]
+    add a3, a3, 16
+    vle32.v v18, (a3)   # rk[8:11]
+    add a3, a3, 16
+    vle32.v v19, (a3)   # rk[12:15]
+    add a3, a3, 16
+    vle32.v v20, (a3)   # rk[16:19]
+    add a3, a3, 16
+    vle32.v v21, (a3)   # rk[20:23]
+    add a3, a3, 16
+    vle32.v v22, (a3)   # rk[24:27]
+    add a3, a3, 16
+    vle32.v v23, (a3)   # rk[28:31]
+
+1:
+    vsetvli t2, t3, e32, m4, ta, ma
+
+    # Load plain text from 'src', converting words to native order.
+    vle32.v v0, (a1)
+    vrev8.v v0, v0
+
+    vsm4r.vs v0, v16    # with round key rk[0:3]
+    vsm4r.vs v0, v17    # with round key rk[4:7]
+    vsm4r.vs v0, v18    # with round key rk[8:11]
+    vsm4r.vs v0, v19    # with round key rk[12:15]
+    vsm4r.vs v0, v20    # with round key rk[16:19]
+    vsm4r.vs v0, v21    # with round key rk[20:23]
+    vsm4r.vs v0, v22    # with round key rk[24:27]
+    vsm4r.vs v0, v23    # with round key rk[28:31]
+
+    # The output of SM4 is the last four words in reverse order.
+    # Indices [3, 2, 1, 0, 7, 6, 5, 4, ...] reverse the order of the words
+    # within each element group.
+    vid.v v8
+    vxor.vi v8, v8, 3
+    vrgather.vv v4, v0, v8
+    vrev8.v v4, v4
+
+    # Save the cipher text.
+    vse32.v v4, (a0)
+
+    # t2 contains the number of 32b/4B elements processed
+    sub t3, t3, t2              # Decrement count (4B elements)
+    slli t2, t2, 2              # t2 (#bytes) <- t2 (#4B) * 4
+    add a1, a1, t2              # Increment source address (bytes)
+    add a0, a0, t2              # Increment target address (bytes)
+
+    bnez t3, 1b                 # Continue the loop?
+
+2:
+    mv a0, t0  # 'n' bytes result, computed on entry.
+    ret
+# zvksed_sm4_encode_vs